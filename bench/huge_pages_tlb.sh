@@ -0,0 +1,81 @@
+#!/usr/bin/env bash
+# Huge-page benchmark: propagation time and data-TLB misses per --huge-pages mode.
+#
+# Usage:
+#   bench/huge_pages_tlb.sh <bgp_simulator> <topology> <announcements.csv> [rov_asns.txt]
+#
+# Environment:
+#   MODES     space-separated modes (default: "off thp explicit")
+#   RUNS      repetitions per mode, best time is reported (default: 3)
+#
+# TLB counters come from `perf stat -e dTLB-loads,dTLB-load-misses` over the
+# whole run; without perf (or without permission to read the counters) the
+# columns are left empty. explicit mode needs reserved pages:
+#   sudo sysctl vm.nr_hugepages=512
+#
+# Output: CSV on stdout
+#   mode,propagate_ms,total_ms,dtlb_loads,dtlb_misses,miss_pct
+
+set -euo pipefail
+
+if [ $# -lt 3 ]; then
+    sed -n '2,17p' "$0"
+    exit 1
+fi
+
+SIM=$1
+TOPOLOGY=$2
+ANNOUNCEMENTS=$3
+ROV=${4:-}
+
+MODES=${MODES:-"off thp explicit"}
+RUNS=${RUNS:-3}
+OUT=$(mktemp -d)
+trap 'rm -rf "$OUT"' EXIT
+
+ROV_ARGS=()
+if [ -n "$ROV" ]; then
+    ROV_ARGS=(--rov-asns "$ROV")
+fi
+
+PERF=()
+if command -v perf > /dev/null && perf stat -e dTLB-load-misses true > /dev/null 2>&1; then
+    PERF=(perf stat -x, -e dTLB-loads,dTLB-load-misses -o "$OUT/perf.txt")
+else
+    echo "perf unavailable: reporting times only" >&2
+fi
+
+# Sum a perf counter (perf may split it across core types)
+counter() {
+    [ -f "$OUT/perf.txt" ] || return 0
+    awk -F, -v ev="$1" '$3 ~ ev "$" || $3 ~ ev "/" { sum += $1 } END { if (sum) print sum }' "$OUT/perf.txt"
+}
+
+echo "mode,propagate_ms,total_ms,dtlb_loads,dtlb_misses,miss_pct"
+
+for mode in $MODES; do
+    best_prop=""
+    best_total=""
+    loads=""
+    misses=""
+    for _ in $(seq "$RUNS"); do
+        rm -f "$OUT/perf.txt"
+        "${PERF[@]}" "$SIM" --huge-pages "$mode" --relationships "$TOPOLOGY" \
+            --announcements "$ANNOUNCEMENTS" "${ROV_ARGS[@]}" \
+            --output "$OUT/ribs.csv" > "$OUT/log.txt" 2> "$OUT/err.txt"
+        prop=$(awk '/Step 7/ { step = 1 } step && /Time:/ { print $2; exit }' "$OUT/log.txt")
+        total=$(awk '/^Total time:/ { print $3 }' "$OUT/log.txt")
+        if [ -z "$best_prop" ] || [ "$prop" -lt "$best_prop" ]; then
+            best_prop=$prop
+            best_total=$total
+            loads=$(counter dTLB-loads)
+            misses=$(counter dTLB-load-misses)
+        fi
+    done
+    pct=""
+    if [ -n "$loads" ] && [ -n "$misses" ]; then
+        pct=$(awk -v l="$loads" -v m="$misses" 'BEGIN { printf "%.3f", 100 * m / l }')
+    fi
+    echo "$mode,$best_prop,$best_total,$loads,$misses,$pct"
+    grep -h "Huge pages" "$OUT/log.txt" >&2 || true
+done
@@ -0,0 +1,82 @@
+#!/usr/bin/env bash
+# Propagation benchmark: serial engine vs parallel engine, with and without
+# NUMA pinning, and under numactl memory policies when numactl is available.
+#
+# Usage:
+#   bench/numa_propagation.sh <bgp_simulator> <topology> <announcements.csv> [rov_asns.txt]
+#
+# Environment:
+#   THREADS   space-separated thread counts (default: "1 <half cores> <all cores>")
+#   RUNS      repetitions per configuration, best time is reported (default: 3)
+#
+# Single-socket machines can emulate NUMA nodes with the kernel parameter
+# numa=fake=2 (CONFIG_NUMA_EMU); numactl --hardware should then list 2 nodes.
+#
+# Output: CSV on stdout
+#   policy,threads,numa,propagate_ms
+#   policy is "default" or the numactl memory policy that wrapped the run.
+#   "interleave" and "membind0" show the cost of remote memory that
+#   owner-first-touch (--numa) avoids.
+
+set -euo pipefail
+
+if [ $# -lt 3 ]; then
+    sed -n '2,20p' "$0"
+    exit 1
+fi
+
+SIM=$1
+TOPOLOGY=$2
+ANNOUNCEMENTS=$3
+ROV=${4:-}
+
+CORES=$(nproc)
+THREADS=${THREADS:-"1 $(( CORES > 1 ? CORES / 2 : 1 )) $CORES"}
+RUNS=${RUNS:-3}
+OUT=$(mktemp -d)
+trap 'rm -rf "$OUT"' EXIT
+
+ROV_ARGS=()
+if [ -n "$ROV" ]; then
+    ROV_ARGS=(--rov-asns "$ROV")
+fi
+
+# Best propagation time (Step 7) over RUNS runs
+run_case() {
+    local best=""
+    for _ in $(seq "$RUNS"); do
+        local ms
+        ms=$("$@" --relationships "$TOPOLOGY" --announcements "$ANNOUNCEMENTS" \
+                  "${ROV_ARGS[@]}" --output "$OUT/ribs.csv" |
+             awk '/Step 7/ { step = 1 } step && /Time:/ { print $2; exit }')
+        if [ -z "$best" ] || [ "$ms" -lt "$best" ]; then
+            best=$ms
+        fi
+    done
+    echo "$best"
+}
+
+echo "policy,threads,numa,propagate_ms"
+
+if command -v numactl > /dev/null; then
+    numactl --hardware >&2 || true
+    POLICIES="default interleave membind0"
+else
+    echo "numactl not found: running without memory policies" >&2
+    POLICIES="default"
+fi
+
+for policy in $POLICIES; do
+    case $policy in
+        default)    WRAP=() ;;
+        interleave) WRAP=(numactl --interleave=all) ;;
+        membind0)   WRAP=(numactl --membind=0) ;;
+    esac
+
+    for threads in $THREADS; do
+        echo "$policy,$threads,no,$(run_case "${WRAP[@]}" "$SIM" --threads "$threads")"
+        if [ "$threads" -gt 1 ]; then
+            echo "$policy,$threads,yes,$(run_case "${WRAP[@]}" "$SIM" --threads "$threads" --numa)"
+        fi
+    done
+done
@@ -1,164 +1,373 @@
-#ifndef AS_GRAPH_H
-#define AS_GRAPH_H
-
-#include <cstdint>
-#include <string>
-#include <vector>
-#include <unordered_map>
-#include <unordered_set>
-#include <functional>
-
-// Optimal architecture for AS Graph with memory and speed constraints
-// - Use uint32_t for ASN (maximum 32-bit as per BGP RFC)
-// - Use flat vectors instead of smart pointers for cache locality
-// - Use hash maps for O(1) lookups
-// - Preallocate to avoid reallocation
-
-using ASN = uint32_t;
-
-// Relationship types from CAIDA data
-enum class RelationType : int8_t {
-    CUSTOMER = -1,  // AS1 is provider, AS2 is customer
-    PEER = 0,       // Peer-to-peer
-    PROVIDER = 1    // AS1 is customer, AS2 is provider
-};
-
-// Forward declaration
-class BGPPolicy;
-
-// Forward declare for reference wrapper
-struct ASNode;
-
-// Compact AS node structure - only what we need
-// Store references to neighbors instead of ASNs to avoid hash lookups
-struct ASNode {
-    ASN asn;
-
-    // Store references to neighbor nodes for direct access (no hash lookups!)
-    // Using reference_wrapper because references can't be reassigned
-    std::vector<std::reference_wrapper<ASNode>> providers;
-    std::vector<std::reference_wrapper<ASNode>> customers;
-    std::vector<std::reference_wrapper<ASNode>> peers;
-
-    // For cycle detection and propagation
-    int propagation_rank = -1;
-    bool visited = false;  // For DFS cycle detection
-    bool in_stack = false; // For DFS cycle detection
-
-    // BGP Policy (owned by this node, use reference not pointer)
-    BGPPolicy* policy = nullptr;
-
-    ASNode() : asn(0) {}
-    explicit ASNode(ASN asn_val) : asn(asn_val) {
-        // Reserve reasonable sizes to reduce reallocations
-        providers.reserve(4);
-        customers.reserve(8);
-        peers.reserve(4);
-    }
-
-    ~ASNode();
-};
-
-class ASGraph {
-private:
-    // Main storage: ASN -> ASNode
-    // Using unordered_map for sparse ASN space (not all ASNs from 0-2^32 exist)
-    std::unordered_map<ASN, ASNode> nodes;
-
-    // Quick existence check
-    std::unordered_set<ASN> asn_set;
-
-    // Statistics
-    size_t edge_count = 0;
-    size_t provider_customer_edges = 0;
-    size_t peer_edges = 0;
-
-    // Helper: Get or create node
-    ASNode& getOrCreateNode(ASN asn);
-
-    // Cycle detection using DFS
-    bool hasCycleDFS(ASN current, ASN parent, std::unordered_set<ASN>& visited,
-                     std::unordered_set<ASN>& recursion_stack, bool check_providers);
-
-public:
-    ASGraph();
-
-    // Build graph from CAIDA file
-    bool buildFromFile(const std::string& filename);
-
-    // Add relationship between two ASes
-    void addRelationship(ASN as1, ASN as2, RelationType rel_type);
-
-    // Check for cycles in provider-customer relationships
-    bool detectCycles();
-
-    // Get node by ASN (nullptr if doesn't exist) - inline for hot paths
-    inline const ASNode* getNode(ASN asn) const {
-        auto it = nodes.find(asn);
-        return (it != nodes.end()) ? &(it->second) : nullptr;
-    }
-
-    inline ASNode* getNode(ASN asn) {
-        auto it = nodes.find(asn);
-        return (it != nodes.end()) ? &(it->second) : nullptr;
-    }
-
-    // Check if ASN exists
-    bool hasNode(ASN asn) const;
-
-    // Statistics
-    size_t getNodeCount() const { return nodes.size(); }
-    size_t getEdgeCount() const { return edge_count; }
-    size_t getProviderCustomerEdges() const { return provider_customer_edges; }
-    size_t getPeerEdges() const { return peer_edges; }
-
-    // For iteration
-    const std::unordered_map<ASN, ASNode>& getNodes() const { return nodes; }
-    std::unordered_map<ASN, ASNode>& getNodes() { return nodes; }
-
-    // Memory optimization: reserve space if we know approximate size
-    void reserveNodes(size_t count);
-
-    // BGP Functionality (Section 3)
-
-    // Initialize BGP policies for all nodes
-    void initializeBGP();
-
-    // Flatten graph: assign propagation ranks
-    void flattenGraph();
-
-    // Get flattened graph (vector of vectors by rank)
-    const std::vector<std::vector<ASN>>& getRankedASes() const { return ranked_ases; }
-
-    // Seed announcement at a specific AS
-    void seedAnnouncement(ASN origin_asn, const std::string& prefix_str, bool rov_invalid = false);
-
-    // Propagate announcements through the entire graph
-    // Returns: number of announcements propagated
-    size_t propagateAnnouncements();
-
-    // Export local RIBs to CSV
-    bool exportToCSV(const std::string& filename) const;
-
-    // ROV Functionality (Section 4)
-
-    // Load ROV ASNs from file and upgrade their policies
-    bool loadROVASNs(const std::string& filename);
-
-    // Get count of ASes deploying ROV
-    size_t getROVASNCount() const;
-
-private:
-    // Flattened graph for efficient propagation
-    std::vector<std::vector<ASN>> ranked_ases;
-
-    // ROV tracking
-    std::unordered_set<ASN> rov_asns;
-
-    // Propagation helpers
-    void propagateUp();      // Send to providers
-    void propagateAcross();  // Send to peers (one hop only)
-    void propagateDown();    // Send to customers
-};
-
-#endif // AS_GRAPH_H
+#ifndef AS_GRAPH_H
+#define AS_GRAPH_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <memory>
+#include "aspa.h"
+#include "path_end.h"
+#include "route_leak.h"
+#include "content_hash.h"
+#include "huge_pages.h"
+#include "route_selection.h"
+
+// Optimal architecture for AS Graph with memory and speed constraints
+// - Use uint32_t for ASN (maximum 32-bit as per BGP RFC)
+// - Use flat vectors instead of smart pointers for cache locality
+// - Use hash maps for O(1) lookups
+// - Preallocate to avoid reallocation
+
+using ASN = uint32_t;
+
+// Relationship types from CAIDA data
+enum class RelationType : int8_t {
+    CUSTOMER = -1,  // AS1 is provider, AS2 is customer
+    PEER = 0,       // Peer-to-peer
+    PROVIDER = 1    // AS1 is customer, AS2 is provider
+};
+
+// Canonical typed edge: as1 < as2, rel describes as2 from as1's side
+// (same convention as the CAIDA "as1|as2|rel" columns)
+struct GraphEdge {
+    ASN as1;
+    ASN as2;
+    RelationType rel;
+
+    bool operator<(const GraphEdge& other) const {
+        if (as1 != other.as1) return as1 < other.as1;
+        if (as2 != other.as2) return as2 < other.as2;
+        return rel < other.rel;
+    }
+    bool operator==(const GraphEdge& other) const {
+        return as1 == other.as1 && as2 == other.as2 && rel == other.rel;
+    }
+};
+
+// Forward declarations
+class BGPPolicy;
+class ParallelPropagator;
+struct TopologyDiff;
+
+// Announcement as seeded by the caller (recorded for result cache keys)
+struct SeedAnnouncement {
+    ASN origin_asn;
+    std::string prefix;   // Normalized via Prefix::parse().toString()
+    bool rov_invalid;
+};
+
+// Forward declare for reference wrapper
+struct ASNode;
+
+// Neighbor references; backed by huge pages when enabled (see huge_pages.h)
+using NeighborList = std::vector<std::reference_wrapper<ASNode>, HugePageAllocator<std::reference_wrapper<ASNode>>>;
+
+// Compact AS node structure - only what we need
+// Store references to neighbors instead of ASNs to avoid hash lookups
+struct ASNode {
+    ASN asn;
+
+    // Store references to neighbor nodes for direct access (no hash lookups!)
+    // Using reference_wrapper because references can't be reassigned
+    NeighborList providers;
+    NeighborList customers;
+    NeighborList peers;
+
+    // For cycle detection and propagation
+    int propagation_rank = -1;
+    bool visited = false;  // For DFS cycle detection
+    bool in_stack = false; // For DFS cycle detection
+
+    // BGP Policy (owned by this node, use reference not pointer)
+    BGPPolicy* policy = nullptr;
+
+    ASNode() : asn(0) {}
+    explicit ASNode(ASN asn_val) : asn(asn_val) {
+        // Reserve reasonable sizes to reduce reallocations
+        providers.reserve(4);
+        customers.reserve(8);
+        peers.reserve(4);
+    }
+
+    ~ASNode();
+};
+
+// Node storage: ASN -> ASNode
+using NodeMap = std::unordered_map<ASN, ASNode, std::hash<ASN>, std::equal_to<ASN>,
+                                   HugePageAllocator<std::pair<const ASN, ASNode>>>;
+
+class ASGraph {
+private:
+    // Main storage: ASN -> ASNode
+    // Using unordered_map for sparse ASN space (not all ASNs from 0-2^32 exist)
+    NodeMap nodes;
+
+    // Quick existence check
+    std::unordered_set<ASN> asn_set;
+
+    // Topology fingerprint, computed lazily and dropped on any topology change
+    mutable Hash128 fingerprint_cache;
+    mutable bool fingerprint_valid = false;
+
+    // Statistics
+    size_t edge_count = 0;
+    size_t provider_customer_edges = 0;
+    size_t peer_edges = 0;
+
+    // Helper: Get or create node
+    ASNode& getOrCreateNode(ASN asn);
+
+    // Cycle detection using DFS
+    bool hasCycleDFS(ASN current, ASN parent, std::unordered_set<ASN>& visited,
+                     std::unordered_set<ASN>& recursion_stack, bool check_providers);
+
+public:
+    ASGraph();
+    ~ASGraph();
+
+    // Build graph from CAIDA file (binary snapshots are detected and loaded too)
+    bool buildFromFile(const std::string& filename);
+
+    // Binary snapshot: sorted ASNs and canonical edges plus the fingerprint
+    // Loading skips text parsing and reuses the stored fingerprint once it has
+    // been checked against the content
+    bool saveSnapshot(const std::string& filename) const;
+    bool loadSnapshot(const std::string& filename);
+    static bool isSnapshotFile(const std::string& filename);
+
+    // Read a snapshot's sorted ASNs, sorted canonical edges and stored fingerprint
+    // without building a graph; fails if the file is truncated or the content
+    // does not hash to the stored fingerprint
+    static bool readSnapshot(const std::string& filename, std::vector<ASN>& asns,
+                             std::vector<GraphEdge>& edges, Hash128& fingerprint);
+
+    // Add relationship between two ASes
+    void addRelationship(ASN as1, ASN as2, RelationType rel_type);
+
+    // Remove a typed relationship (every duplicate copy); false if absent
+    bool removeRelationship(ASN as1, ASN as2, RelationType rel_type);
+
+    // Update the topology in place from a diff (see topology_diff.h)
+    // Surviving nodes keep their policies, added nodes get one from initializeBGP()
+    // Ranks must be recomputed with flattenGraph()
+    // Returns false if the diff does not match this graph (the rest is still applied)
+    bool applyDiff(const TopologyDiff& diff);
+
+    // Check for cycles in provider-customer relationships
+    bool detectCycles();
+
+    // Get node by ASN (nullptr if doesn't exist) - inline for hot paths
+    inline const ASNode* getNode(ASN asn) const {
+        auto it = nodes.find(asn);
+        return (it != nodes.end()) ? &(it->second) : nullptr;
+    }
+
+    inline ASNode* getNode(ASN asn) {
+        auto it = nodes.find(asn);
+        return (it != nodes.end()) ? &(it->second) : nullptr;
+    }
+
+    // Check if ASN exists
+    bool hasNode(ASN asn) const;
+
+    // Summary printed after a text load (nodes, edges, fingerprint)
+    void printLoadSummary(size_t line_count, size_t parsed_count) const;
+
+    // Statistics
+    size_t getNodeCount() const { return nodes.size(); }
+    size_t getEdgeCount() const { return edge_count; }
+    size_t getProviderCustomerEdges() const { return provider_customer_edges; }
+    size_t getPeerEdges() const { return peer_edges; }
+
+    // For iteration
+    const NodeMap& getNodes() const { return nodes; }
+    NodeMap& getNodes() { return nodes; }
+
+    // Memory optimization: reserve space if we know approximate size
+    void reserveNodes(size_t count);
+
+    // Sorted, de-duplicated typed edge list (one entry per AS pair)
+    std::vector<GraphEdge> getCanonicalEdges(unsigned threads = 0) const;
+
+    // Order-independent 128-bit hash of the node set and typed edge set
+    // Identical topologies give identical fingerprints regardless of file order
+    Hash128 fingerprint(unsigned threads = 0) const;
+
+    // BGP Functionality (Section 3)
+
+    // Initialize BGP policies for nodes without one (ROV for known ROV ASNs)
+    void initializeBGP();
+
+    // Clear every RIB and the recorded seeds; topology and policies are kept
+    void resetRoutingState();
+
+    // Flatten graph: assign propagation ranks
+    void flattenGraph();
+
+    // Get flattened graph (vector of vectors by rank)
+    const std::vector<std::vector<ASN>>& getRankedASes() const { return ranked_ases; }
+
+    // Seed announcement at a specific AS
+    void seedAnnouncement(ASN origin_asn, const std::string& prefix_str, bool rov_invalid = false);
+
+    // Propagate announcements through the entire graph
+    // IPv4 and IPv6 prefixes run through separate engine instantiations; with the
+    // serial engine both run concurrently when both were seeded
+    // Returns: number of announcements propagated
+    size_t propagateAnnouncements();
+
+    // Propagation engine: 1 thread runs the serial engine, more run the parallel
+    // engine (see propagation_engine.h); numa_aware pins workers per NUMA node
+    void setPropagationThreads(unsigned threads, bool numa_aware = false);
+    unsigned getPropagationThreads() const { return propagation_threads; }
+
+    // Route-selection policy of both engines (see route_selection.h)
+    // seed only affects RouteSelection::HASH_TIE_BREAK
+    void setRouteSelection(RouteSelection selection, uint32_t seed = 0) {
+        route_selection = selection;
+        selection_seed = seed;
+    }
+    RouteSelection getRouteSelection() const { return route_selection; }
+    uint32_t getSelectionSeed() const { return selection_seed; }
+
+    // Export local RIBs to CSV
+    bool exportToCSV(const std::string& filename) const;
+
+    // ROV Functionality (Section 4)
+
+    // Load ROV ASNs from file and upgrade their policies
+    bool loadROVASNs(const std::string& filename);
+
+    // Get count of ASes deploying ROV
+    size_t getROVASNCount() const;
+
+    // ASPA: records (who may be whose provider) and the ASes that verify paths
+    // Deployers get the ASPA policy (which also filters ROV-invalid routes if
+    // they deploy ROV). Change deployers between runs, before seeding: their
+    // policies are replaced, and with them any routes they hold.
+    bool loadASPA(const std::string& filename) { return aspa_table.loadFromFile(filename); }
+    void setASPA(std::vector<std::pair<ASN, ASN>> pairs) { aspa_table.assign(std::move(pairs)); }
+    const AspaTable& getASPATable() const { return aspa_table; }
+    bool loadASPAASNs(const std::string& filename);
+    void setASPAASNs(const std::unordered_set<ASN>& asns);
+    const std::unordered_set<ASN>& getASPAASNs() const { return aspa_asns; }
+
+    // Path-end validation: records (each origin's authorized neighbors) and the
+    // ASes that check the last hop against them. Same rules as ASPA deployers;
+    // an AS in both sets runs ASPA.
+    bool loadPathEnd(const std::string& filename) { return pathend_table.loadFromFile(filename); }
+    void setPathEnd(const std::vector<std::pair<ASN, ASN>>& pairs) { pathend_table.assign(pairs); }
+    const PathEndTable& getPathEndTable() const { return pathend_table; }
+    bool loadPathEndASNs(const std::string& filename);
+    void setPathEndASNs(const std::unordered_set<ASN>& asns);
+    const std::unordered_set<ASN>& getPathEndASNs() const { return pathend_asns; }
+
+    // Route leaks: ASes exporting beyond the valley-free rules (see route_leak.h)
+    // With leakers, propagation runs the three-phase engine and then the
+    // worklist engine until no route changes, or for at most round_limit rounds
+    bool loadLeakers(const std::string& filename, LeakPolicy default_policy = LeakPolicy::ALL);
+    void setLeakers(const std::unordered_map<ASN, LeakPolicy>& asns) { leakers = asns; }
+    const std::unordered_map<ASN, LeakPolicy>& getLeakers() const { return leakers; }
+    void setLeakRoundLimit(size_t round_limit) { leak_round_limit = round_limit; }
+    size_t getLeakRoundLimit() const { return leak_round_limit; }
+    const LeakStats& getLeakStats() const { return leak_stats; }
+
+    // Vantage-point retention
+    // When set, only these ASes keep their RIBs after propagation. Every AS still
+    // takes part; other RIBs are freed as soon as the Down phase no longer reads them.
+    void setVantagePoints(const std::unordered_set<ASN>& asns) { vantage_points = asns; }
+    bool loadVantagePoints(const std::string& filename);
+    const std::unordered_set<ASN>& getVantagePoints() const { return vantage_points; }
+    bool retainsRIB(ASN asn) const { return vantage_points.empty() || vantage_points.count(asn) > 0; }
+
+    // Routes of the last propagation freed by vantage-point retention
+    size_t getReleasedRouteCount() const { return released_routes; }
+
+    // Inputs that determine the propagation result
+    const std::unordered_set<ASN>& getROVASNs() const { return rov_asns; }
+    const std::vector<SeedAnnouncement>& getSeeds() const { return seeds; }
+
+private:
+    // Flattened graph for efficient propagation
+    std::vector<std::vector<ASN>> ranked_ases;
+
+    // ROV tracking
+    std::unordered_set<ASN> rov_asns;
+
+    // ASPA records and deployers
+    AspaTable aspa_table;
+    std::unordered_set<ASN> aspa_asns;
+
+    // Path-end records and deployers
+    PathEndTable pathend_table;
+    std::unordered_set<ASN> pathend_asns;
+
+    // Leakers and the outcome of the last leak propagation
+    std::unordered_map<ASN, LeakPolicy> leakers;
+    size_t leak_round_limit = 1000;
+    LeakStats leak_stats;
+
+    // New policy for asn according to the ROV, ASPA and path-end deployer sets
+    BGPPolicy* createPolicy(ASN asn) const;
+
+    // Replace deployers with asns, re-creating the policies of ASes that changed
+    void updateDeployers(std::unordered_set<ASN>& deployers, const std::unordered_set<ASN>& asns);
+
+    // Seeded announcements, in seeding order
+    std::vector<SeedAnnouncement> seeds;
+
+    // Vantage points (empty: every AS keeps its RIB)
+    std::unordered_set<ASN> vantage_points;
+    size_t released_routes = 0;
+
+    // Address families with seeded announcements
+    bool seeded_ipv4 = false;
+    bool seeded_ipv6 = false;
+
+    RouteSelection route_selection = RouteSelection::STANDARD;
+    uint32_t selection_seed = 0;
+
+    // Parallel engine settings; the engine and its worker pool live across runs
+    unsigned propagation_threads = 1;
+    bool numa_aware = false;
+    std::unique_ptr<ParallelPropagator> parallel_engine;
+
+    // Propagation helpers, one instantiation per address family (P = IPv4Prefix
+    // or IPv6Prefix) and route-selection policy S; verbose prints the phase banners
+    template <typename S> size_t propagateWith(const S& selection);
+    template <typename S> size_t propagateValleyFree(const S& selection);     // Three-phase engines
+    template <typename S> size_t propagateLeaks(const S& selection);          // Worklist engine, then retention
+    template <typename P, typename S> size_t propagateFamily(const S& selection, bool verbose);  // Returns routes released
+    template <typename P, typename S> void propagateUp(const S& selection, bool verbose);        // Send to providers
+    template <typename P, typename S> void propagateAcross(const S& selection, bool verbose);    // Send to peers (one hop only)
+    template <typename P, typename S> size_t propagateDown(const S& selection, bool verbose);    // Send to customers
+};
+
+// Incremental parser for CAIDA "as1|as2|rel|source" text
+// Accepts arbitrary chunks (file blocks, decompressor output, network buffers)
+// and adds each complete line to the graph; only a partial line is buffered
+class RelationshipStreamParser {
+private:
+    ASGraph& graph;
+    std::string carry;  // Incomplete line from the previous chunk
+    size_t line_count = 0;
+    size_t parsed_count = 0;
+
+    void parseLine(const char* begin, const char* end);
+
+public:
+    explicit RelationshipStreamParser(ASGraph& target);
+
+    void feed(const char* data, size_t len);
+
+    // Parse a final line without a trailing newline
+    void finish();
+
+    size_t getLineCount() const { return line_count; }
+    size_t getParsedCount() const { return parsed_count; }
+};
+
+#endif // AS_GRAPH_H
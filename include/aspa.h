@@ -0,0 +1,94 @@
+#ifndef ASPA_H
+#define ASPA_H
+
+#include "announcement.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ASPA (Autonomous System Provider Authorization) path verification
+// Follows draft-ietf-sidrops-aspa-verification: a route from a customer or peer
+// must have climbed customer-to-provider at every hop (upstream check); a route
+// from a provider may climb, then descend, but never valley (downstream check).
+
+enum class AspaState : uint8_t {
+    VALID,
+    UNKNOWN,  // Not disproven, but some hop lacks an attestation
+    INVALID
+};
+
+// "valid", "unknown" or "invalid"
+const char* aspaStateName(AspaState state);
+
+// Is provider an authorized provider of customer?
+enum class AspaHop : uint8_t {
+    PROVIDER,
+    NOT_PROVIDER,
+    NO_ATTESTATION  // customer has no ASPA record
+};
+
+// Ramp lengths of a path, counted in ASes. Up ramps run from the origin, down
+// ramps from the most recent hop; max_* treat missing attestations as
+// authorized, min_* as unauthorized. They do not depend on who receives the
+// path, so one computation serves every neighbor and both checks.
+struct AspaRamps {
+    uint16_t max_up = 1;
+    uint16_t min_up = 1;
+    uint16_t max_down = 1;
+    uint16_t min_down = 1;
+};
+
+// Read "AS, then a list of ASes" records, one AS per line (ASPA and path-end
+// files): pairs gets (first, other) per listed AS, or (first, 0) for a line
+// with no list. Separators are commas, '|' or whitespace; "AS" prefixes are
+// accepted and a header line is skipped. False if the file cannot be opened.
+bool readASNRecordFile(const std::string& filename, std::vector<std::pair<ASN, ASN>>& pairs,
+                       size_t& skipped);
+
+// ASPA records as sorted per-customer provider arrays
+// Customers with a record get dense ids (their index in a sorted array); the
+// providers of customer i are providers[offsets[i] .. offsets[i + 1]), sorted.
+// Read-only after loading, so verification may run from any number of threads.
+class AspaTable {
+private:
+    std::vector<ASN> customers;
+    std::vector<uint32_t> offsets;
+    std::vector<ASN> providers;
+
+    // Unique per assign(); path-summary caches are keyed by it (see aspa.cpp)
+    uint64_t generation = 0;
+
+    AspaRamps extend(const AspaRamps& ramps, uint32_t length, ASN old_front, ASN new_front) const;
+
+public:
+    // Replace all records with these (customer, provider) pairs
+    // A pair with provider 0 registers a customer with no providers (AS0 record)
+    void assign(std::vector<std::pair<ASN, ASN>> pairs);
+
+    // One record per line: customer then its providers, separated by commas,
+    // '|' or whitespace ("AS" prefixes accepted, lines of one customer merged)
+    bool loadFromFile(const std::string& filename);
+
+    AspaHop hop(ASN customer, ASN provider) const;
+
+    // Ramps of path (most recent hop first, origin last). Summaries of path
+    // suffixes are cached per thread, so a suffix shared by many paths (every
+    // route an AS sends is its neighbor's route plus one hop) is walked once
+    // and each longer path costs one extension per new hop.
+    AspaRamps ramps(const ASN* path, size_t length) const;
+
+    // Verification of a path received over relationship received_from
+    AspaState verify(const ASN* path, size_t length, RelationshipType received_from) const;
+
+    bool empty() const { return customers.empty(); }
+    size_t getCustomerCount() const { return customers.size(); }
+    size_t getProviderCount() const { return providers.size(); }
+
+    // Raw records, for fingerprints
+    const std::vector<ASN>& getCustomers() const { return customers; }
+    const std::vector<uint32_t>& getOffsets() const { return offsets; }
+    const std::vector<ASN>& getProviders() const { return providers; }
+};
+
+#endif // ASPA_H
@@ -1,69 +1,260 @@
-#ifndef BGP_POLICY_H
-#define BGP_POLICY_H
-
-#include "announcement.h"
-#include <unordered_map>
-#include <vector>
-
-// Abstract BGP Policy class
-class BGPPolicy {
-protected:
-    // Local RIB: prefix -> best announcement
-    // Using unordered_map for O(1) lookups
-    std::unordered_map<Prefix, Announcement> local_rib;
-
-    // Received queue: prefix -> list of received announcements
-    // Cleared after processing
-    std::unordered_map<Prefix, std::vector<Announcement>> received_queue;
-
-public:
-    virtual ~BGPPolicy() = default;
-
-    // Receive an announcement (add to received queue)
-    virtual void receiveAnnouncement(const Announcement& ann);
-
-    // Process received queue and update local RIB
-    // current_asn: ASN to prepend to paths when storing
-    // Returns: true if any announcements changed
-    virtual bool processReceivedQueue(ASN current_asn);
-
-    // Get announcement from local RIB
-    virtual const Announcement* getAnnouncement(const Prefix& prefix) const;
-
-    // Get all announcements in local RIB
-    virtual const std::unordered_map<Prefix, Announcement>& getLocalRIB() const {
-        return local_rib;
-    }
-
-    // Clear received queue
-    virtual void clearReceivedQueue();
-
-    // Seed an announcement directly into local RIB (for origin ASes)
-    virtual void seedAnnouncement(const Announcement& ann);
-
-    // Get statistics
-    size_t getLocalRIBSize() const { return local_rib.size(); }
-    size_t getReceivedQueueSize() const { return received_queue.size(); }
-};
-
-// Standard BGP implementation
-class BGP : public BGPPolicy {
-public:
-    // Inherited methods use default BGP behavior
-    bool processReceivedQueue(ASN current_asn) override;
-};
-
-// ROV (Route Origin Validation) - extends BGP with ROV defense
-class ROV : public BGP {
-public:
-    // Override to filter rov_invalid announcements
-    void receiveAnnouncement(const Announcement& ann) override;
-
-    // Statistics
-    size_t getDroppedCount() const { return dropped_count; }
-
-private:
-    size_t dropped_count = 0;
-};
-
-#endif // BGP_POLICY_H
+#ifndef BGP_POLICY_H
+#define BGP_POLICY_H
+
+#include "announcement.h"
+#include "aspa.h"
+#include "path_end.h"
+#include "route_selection.h"
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
+// RIB containers, one set per address family (P = IPv4Prefix or IPv6Prefix)
+// Nodes and vectors come from the huge-page arena when enabled
+using AnnouncementList = std::vector<Announcement, HugePageAllocator<Announcement>>;
+template <typename P>
+using BasicLocalRIB = std::unordered_map<P, Announcement, std::hash<P>, std::equal_to<P>,
+                                         HugePageAllocator<std::pair<const P, Announcement>>>;
+template <typename P>
+using BasicReceivedQueue = std::unordered_map<P, AnnouncementList, std::hash<P>, std::equal_to<P>,
+                                              HugePageAllocator<std::pair<const P, AnnouncementList>>>;
+
+using LocalRIB4 = BasicLocalRIB<IPv4Prefix>;
+using LocalRIB6 = BasicLocalRIB<IPv6Prefix>;
+
+// Routing state of one address family
+template <typename P>
+struct RoutingTable {
+    // Local RIB: prefix -> best announcement
+    BasicLocalRIB<P> local_rib;
+
+    // Received queue: prefix -> list of received announcements
+    // Cleared after processing
+    BasicReceivedQueue<P> received_queue;
+};
+
+// Abstract BGP Policy class
+// IPv4 and IPv6 routes live in separate tables keyed by the family's own prefix
+// type, so the propagation engines (templated on P) never hash or compare the
+// generic Prefix. The two families touch disjoint state and may run concurrently.
+class BGPPolicy {
+protected:
+    RoutingTable<IPv4Prefix> table4;
+    RoutingTable<IPv6Prefix> table6;
+
+    template <typename P> RoutingTable<P>& table();
+    template <typename P> const RoutingTable<P>& table() const;
+
+    // Receive-time filter; false drops the announcement before it is queued
+    // Same verdict as admits(), plus the drop counters
+    virtual bool acceptAnnouncement(Announcement& ann) {
+        (void)ann;
+        return true;
+    }
+
+public:
+    virtual ~BGPPolicy() = default;
+
+    // Would this AS accept ann? Changes nothing but ann's cached verdict
+    // (see PathEndState); used where routes are evaluated outside the engines
+    virtual bool admits(Announcement& ann) const {
+        (void)ann;
+        return true;
+    }
+
+    // Receive an announcement for prefix (add to received queue)
+    template <typename P>
+    void receiveAnnouncement(const P& prefix, Announcement ann) {
+        if (acceptAnnouncement(ann)) {
+            table<P>().received_queue[prefix].push_back(std::move(ann));
+        }
+    }
+
+    // Process received queue and update local RIB
+    // current_asn: ASN to prepend to paths when storing
+    // selection: route-selection policy (see route_selection.h)
+    // Returns: true if any announcements changed
+    template <typename P, typename Selection = StandardSelection>
+    bool processReceivedQueue(ASN current_asn, const Selection& selection = Selection()) {
+        RoutingTable<P>& t = table<P>();
+        bool changed = false;
+
+        for (auto& pair : t.received_queue) {
+            AnnouncementList& candidates = pair.second;
+            if (candidates.empty()) {
+                continue;
+            }
+
+            // Find best announcement among candidates (lowest key)
+            const Announcement* best = &candidates[0];
+            auto best_key = selection.key(*best);
+            for (size_t i = 1; i < candidates.size(); i++) {
+                auto key = selection.key(candidates[i]);
+                if (key < best_key) {
+                    best = &candidates[i];
+                    best_key = key;
+                }
+            }
+
+            // IMPORTANT: Prepend current ASN to the path when storing
+            Announcement stored_ann = *best;
+            stored_ann.as_path.insert(stored_ann.as_path.begin(), current_asn);
+
+            // Keep the existing route unless the new one is strictly better
+            auto rib_it = t.local_rib.find(pair.first);
+            if (rib_it == t.local_rib.end()) {
+                t.local_rib.emplace(pair.first, std::move(stored_ann));
+                changed = true;
+            } else if (selection.key(stored_ann) < selection.key(rib_it->second)) {
+                rib_it->second = std::move(stored_ann);
+                changed = true;
+            }
+        }
+
+        return changed;
+    }
+
+    // Remove prefix from the local RIB, moving its route into *removed if given
+    // Returns false if there was no route
+    template <typename P>
+    bool withdrawRoute(const P& prefix, Announcement* removed = nullptr) {
+        auto& rib = table<P>().local_rib;
+        auto it = rib.find(prefix);
+        if (it == rib.end()) {
+            return false;
+        }
+        if (removed) {
+            *removed = std::move(it->second);
+        }
+        rib.erase(it);
+        return true;
+    }
+
+    // Get announcement from local RIB
+    const Announcement* getAnnouncement(const Prefix& prefix) const;
+
+    // Get all announcements of one family in local RIB
+    template <typename P>
+    const BasicLocalRIB<P>& getLocalRIB() const {
+        return table<P>().local_rib;
+    }
+
+    // Call fn(prefix, announcement) for every local RIB entry, IPv4 first
+    template <typename Fn>
+    void forEachRoute(Fn fn) const {
+        for (const auto& pair : table4.local_rib) fn(Prefix(pair.first), pair.second);
+        for (const auto& pair : table6.local_rib) fn(Prefix(pair.first), pair.second);
+    }
+
+    // Clear received queue of one family
+    template <typename P>
+    void clearReceivedQueue() {
+        table<P>().received_queue.clear();
+    }
+
+    // Drop all routing state before a new run (hash tables keep their buckets)
+    virtual void reset();
+
+    // Seed an announcement directly into local RIB (for origin ASes)
+    void seedAnnouncement(const Prefix& prefix, const Announcement& ann);
+
+    // Free one family's local RIB and queue, buckets included; returns the number of routes dropped
+    template <typename P>
+    size_t releaseLocalRIB() {
+        RoutingTable<P>& t = table<P>();
+        size_t released = t.local_rib.size();
+        BasicLocalRIB<P>().swap(t.local_rib);
+        BasicReceivedQueue<P>().swap(t.received_queue);
+        return released;
+    }
+
+    // Get statistics
+    size_t getLocalRIBSize() const { return table4.local_rib.size() + table6.local_rib.size(); }
+    size_t getReceivedQueueSize() const { return table4.received_queue.size() + table6.received_queue.size(); }
+};
+
+template <> inline RoutingTable<IPv4Prefix>& BGPPolicy::table<IPv4Prefix>() { return table4; }
+template <> inline RoutingTable<IPv6Prefix>& BGPPolicy::table<IPv6Prefix>() { return table6; }
+template <> inline const RoutingTable<IPv4Prefix>& BGPPolicy::table<IPv4Prefix>() const { return table4; }
+template <> inline const RoutingTable<IPv6Prefix>& BGPPolicy::table<IPv6Prefix>() const { return table6; }
+
+// Standard BGP implementation
+class BGP : public BGPPolicy {
+    // Inherited methods use default BGP behavior
+};
+
+// ROV (Route Origin Validation) - extends BGP with ROV defense
+class ROV : public BGP {
+protected:
+    // Override to filter rov_invalid announcements
+    bool acceptAnnouncement(Announcement& ann) override;
+
+public:
+    bool admits(Announcement& ann) const override { return !ann.rov_invalid; }
+    void reset() override;
+
+    // Statistics
+    size_t getDroppedCount() const { return dropped_count.load(std::memory_order_relaxed); }
+
+private:
+    // Shared by the IPv4 and IPv6 engines
+    std::atomic<size_t> dropped_count{0};
+};
+
+// ASPA - extends BGP with AS path verification against a shared ASPA table
+// Drops announcements whose path is ASPA-invalid for the relationship they
+// arrived over (unknown paths are kept). An AS that also deploys ROV drops
+// ROV-invalid announcements first.
+class ASPA : public BGP {
+protected:
+    bool acceptAnnouncement(Announcement& ann) override;
+
+public:
+    bool admits(Announcement& ann) const override;
+
+    ASPA(const AspaTable& aspa_table, bool rov) : table(aspa_table), filter_rov(rov) {}
+
+    void reset() override;
+
+    // Statistics
+    size_t getDroppedCount() const { return dropped_count.load(std::memory_order_relaxed); }
+    size_t getROVDroppedCount() const { return rov_dropped_count.load(std::memory_order_relaxed); }
+    bool filtersROV() const { return filter_rov; }
+
+private:
+    const AspaTable& table;  // Owned by the graph
+    bool filter_rov;
+
+    std::atomic<size_t> dropped_count{0};
+    std::atomic<size_t> rov_dropped_count{0};
+};
+
+// Path-end validation - extends BGP with a last-hop check against a shared
+// path-end table. The verdict is computed once per route and cached in the
+// announcement, so the ASes downstream of the first checker pay one byte
+// compare. An AS that also deploys ROV drops ROV-invalid announcements first.
+class PathEnd : public BGP {
+protected:
+    bool acceptAnnouncement(Announcement& ann) override;
+
+public:
+    bool admits(Announcement& ann) const override;
+
+    PathEnd(const PathEndTable& path_end_table, bool rov) : table(path_end_table), filter_rov(rov) {}
+
+    void reset() override;
+
+    // Statistics
+    size_t getDroppedCount() const { return dropped_count.load(std::memory_order_relaxed); }
+    size_t getROVDroppedCount() const { return rov_dropped_count.load(std::memory_order_relaxed); }
+    bool filtersROV() const { return filter_rov; }
+
+private:
+    const PathEndTable& table;  // Owned by the graph
+    bool filter_rov;
+
+    std::atomic<size_t> dropped_count{0};
+    std::atomic<size_t> rov_dropped_count{0};
+};
+
+#endif // BGP_POLICY_H
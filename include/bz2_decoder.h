@@ -0,0 +1,55 @@
+#ifndef BZ2_DECODER_H
+#define BZ2_DECODER_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Receives decompressed bytes in order; return false to abort decoding
+using Bz2Sink = std::function<bool(const char* data, size_t len)>;
+
+// Incremental bzip2 decoder (libbz2) with a fixed-size output buffer
+// Compressed input may arrive in chunks of any size, e.g. straight from a
+// network write callback; memory use stays bounded by the buffer size.
+// Concatenated streams (as written by pbzip2) are decoded back to back.
+class Bz2StreamDecoder {
+private:
+    struct State;
+    std::unique_ptr<State> state;
+    std::vector<char> out_buffer;
+    std::string error;
+
+public:
+    explicit Bz2StreamDecoder(size_t buffer_size = 256 * 1024);
+    ~Bz2StreamDecoder();
+
+    Bz2StreamDecoder(const Bz2StreamDecoder&) = delete;
+    Bz2StreamDecoder& operator=(const Bz2StreamDecoder&) = delete;
+
+    // Decompress a chunk of input, passing output to sink as buffers fill
+    bool feed(const char* data, size_t len, const Bz2Sink& sink);
+
+    // True if all input so far ended exactly on a stream boundary
+    bool finish();
+
+    const std::string& getError() const { return error; }
+};
+
+// True if the buffer starts with a bzip2 stream header ("BZh1".."BZh9")
+bool isBz2Data(const char* data, size_t len);
+
+// Multi-threaded decompression of a complete in-memory .bz2 file
+// bzip2 blocks are independent and start with a 48-bit magic number at an
+// arbitrary bit offset. Blocks are located by scanning for that magic, each
+// one is re-wrapped as a single-block stream and decoded by libbz2 on a
+// worker thread. Output reaches the sink in original order, with at most a
+// few blocks per thread buffered. If a block still fails to decode after
+// rejoining it with the next pieces (a spurious magic, or damaged data), the
+// serial decoder takes over and delivers only the output the sink has not
+// seen yet; its error is the one reported.
+bool decompressBz2Parallel(const char* data, size_t len, const Bz2Sink& sink,
+                           unsigned threads = 0, std::string* error = nullptr);
+
+#endif // BZ2_DECODER_H
@@ -0,0 +1,67 @@
+#ifndef CONTENT_HASH_H
+#define CONTENT_HASH_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// 128-bit content hash
+// Not cryptographic: used to key caches and detect unchanged inputs, where
+// accidental collisions must be negligible but adversarial inputs are not a concern
+struct Hash128 {
+    uint64_t high = 0;
+    uint64_t low = 0;
+
+    Hash128() = default;
+    Hash128(uint64_t h, uint64_t l) : high(h), low(l) {}
+
+    // 32 lowercase hex characters
+    std::string toHex() const;
+
+    bool operator==(const Hash128& other) const {
+        return high == other.high && low == other.low;
+    }
+    bool operator!=(const Hash128& other) const { return !(*this == other); }
+};
+
+// Streaming hasher: feed bytes with update(), read the result with digest()
+// Processes 8-byte words through two independently seeded lanes
+class ContentHasher {
+private:
+    uint64_t lane1;
+    uint64_t lane2;
+    uint64_t total_bytes = 0;
+
+    // Bytes not yet forming a full 8-byte word
+    uint8_t tail[8];
+    size_t tail_len = 0;
+
+    void mixWord(uint64_t word);
+
+public:
+    ContentHasher();
+
+    void update(const void* data, size_t len);
+    void update(const std::string& str) { update(str.data(), str.size()); }
+
+    // Convenience for fixed-width integers (hashed in host byte order)
+    void updateU64(uint64_t value) { update(&value, sizeof(value)); }
+
+    Hash128 digest() const;
+};
+
+// Strong 64-bit mixer (splitmix64 finalizer), shared by order-independent hashes
+inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Hash the full contents of a file
+// Returns false if the file cannot be read
+bool hashFile(const std::string& filename, Hash128& out);
+
+#endif // CONTENT_HASH_H
@@ -0,0 +1,69 @@
+#ifndef HUGE_PAGES_H
+#define HUGE_PAGES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Huge-page backed storage for the graph and RIB containers
+// Random neighbor and RIB access over ~80k ASes touches far more 4 KB pages
+// than the TLB covers; 2 MB pages cut the misses.
+//
+// Modes:
+//   OFF          plain operator new (default)
+//   TRANSPARENT  2 MB-aligned regions with madvise(MADV_HUGEPAGE)
+//   EXPLICIT     MAP_HUGETLB regions (reserved pages), falling back to TRANSPARENT
+//
+// When enabled, small objects (map nodes, paths, neighbor lists) come from
+// process-wide size-class free lists carved out of those regions, so they are
+// packed densely instead of spread across the malloc heap. Each thread caches
+// a batch per size class and hands its cache back when it exits, so memory of
+// short-lived worker threads is reused rather than lost.
+enum class HugePageMode {
+    OFF,
+    TRANSPARENT,
+    EXPLICIT
+};
+
+// Must be called before the first allocation through HugePageAllocator;
+// returns false (and keeps the current mode) once allocation has started
+bool setHugePageMode(HugePageMode mode);
+HugePageMode getHugePageMode();
+
+// "off", "thp" or "explicit"
+bool parseHugePageMode(const std::string& text, HugePageMode& mode);
+const char* hugePageModeName(HugePageMode mode);
+
+struct HugePageStats {
+    uint64_t explicit_bytes = 0;     // Mapped with MAP_HUGETLB
+    uint64_t transparent_bytes = 0;  // Mapped with MADV_HUGEPAGE
+    uint64_t anon_huge_bytes = 0;    // AnonHugePages of this process (kernel view)
+};
+HugePageStats getHugePageStats();
+
+void* hugePageAllocate(size_t bytes);
+void hugePageFree(void* ptr, size_t bytes) noexcept;
+
+// Standard allocator over hugePageAllocate (stateless, all instances equal)
+template <typename T>
+struct HugePageAllocator {
+    using value_type = T;
+
+    HugePageAllocator() noexcept = default;
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(hugePageAllocate(n * sizeof(T)));
+    }
+    void deallocate(T* ptr, size_t n) noexcept {
+        hugePageFree(ptr, n * sizeof(T));
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const HugePageAllocator<T>&, const HugePageAllocator<U>&) { return true; }
+template <typename T, typename U>
+bool operator!=(const HugePageAllocator<T>&, const HugePageAllocator<U>&) { return false; }
+
+#endif // HUGE_PAGES_H
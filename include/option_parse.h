@@ -0,0 +1,30 @@
+#ifndef OPTION_PARSE_H
+#define OPTION_PARSE_H
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+
+// Parse a command-line value as a whole decimal number of type T
+// Returns false if text is empty, signed, has trailing characters or does not
+// fit in T; value is left unchanged then. Callers print the error and usage.
+template <typename T>
+bool parseUnsigned(const char* text, T& value) {
+    if (!text || !std::isdigit(static_cast<unsigned char>(text[0]))) {
+        return false;
+    }
+
+    errno = 0;
+    char* end = nullptr;
+    unsigned long long parsed = std::strtoull(text, &end, 10);
+    if (errno == ERANGE || *end != '\0' ||
+        parsed > static_cast<unsigned long long>(std::numeric_limits<T>::max())) {
+        return false;
+    }
+
+    value = static_cast<T>(parsed);
+    return true;
+}
+
+#endif // OPTION_PARSE_H
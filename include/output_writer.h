@@ -0,0 +1,98 @@
+#ifndef OUTPUT_WRITER_H
+#define OUTPUT_WRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct OutputWriterOptions {
+    size_t buffer_size = 4 << 20;  // Bytes per buffer (rounded up to 4 KB)
+    unsigned queue_depth = 4;      // Buffers in flight while the caller keeps filling
+    bool direct_io = false;        // O_DIRECT: bypass the page cache
+    bool use_io_uring = true;      // Otherwise (or when unavailable) a pwrite thread
+};
+
+// Sequential file writer that keeps several large buffers in flight
+// write() copies into the current buffer; a full buffer is submitted at its file
+// offset and the caller moves on to the next free one, blocking only when all
+// queue_depth buffers are still being written.
+//
+// Backends:
+//   io_uring  IORING_OP_WRITE submissions through the raw syscalls (no liburing)
+//   pwrite    one background thread draining a queue of buffers
+//
+// With direct_io, buffers are 4 KB aligned and every write is a multiple of
+// 4 KB; the padded tail is cut off with ftruncate on close. Filesystems that
+// reject O_DIRECT (tmpfs) fall back to buffered writes with a warning.
+class OutputWriter {
+private:
+    struct Buffer {
+        char* data = nullptr;
+        size_t fill = 0;
+        size_t length = 0;       // Bytes submitted (fill, padded for O_DIRECT)
+        uint64_t at = 0;         // File offset of the submitted write
+        bool busy = false;       // Submitted, not yet completed
+    };
+
+    class Ring;                  // io_uring state (src/output_writer.cpp)
+
+    std::string filename;
+    OutputWriterOptions options;
+    int fd = -1;
+    bool direct = false;
+    std::atomic<bool> failed;
+
+    std::vector<Buffer> buffers;
+    size_t current = 0;          // Buffer being filled
+    uint64_t offset = 0;         // File offset of the current buffer
+    uint64_t total_bytes = 0;
+
+    std::unique_ptr<Ring> ring;
+
+    // pwrite backend
+    std::thread writer_thread;
+    std::mutex mutex;
+    std::condition_variable submit_cv;
+    std::condition_variable done_cv;
+    std::deque<size_t> jobs;     // Buffers waiting for the writer thread
+    bool stopping = false;
+
+    void writerLoop();
+    void submit(size_t index, size_t length);
+    void waitForBuffer(size_t index);
+    void waitForAll();
+    bool writeFully(const char* data, size_t length, uint64_t at);
+    void release();
+
+public:
+    OutputWriter();
+    ~OutputWriter();
+
+    OutputWriter(const OutputWriter&) = delete;
+    OutputWriter& operator=(const OutputWriter&) = delete;
+
+    // Create or truncate filename
+    bool open(const std::string& filename, const OutputWriterOptions& options = OutputWriterOptions());
+
+    // Append bytes (false once any write has failed)
+    bool write(const char* data, size_t length);
+    bool write(const std::string& data) { return write(data.data(), data.size()); }
+
+    // Flush, wait for all writes and close; reports any write error
+    bool close();
+
+    bool isOpen() const { return fd >= 0; }
+    uint64_t getBytesWritten() const { return total_bytes; }
+
+    // "io_uring", "pwrite" (plus "+O_DIRECT")
+    std::string getBackendName() const;
+};
+
+#endif // OUTPUT_WRITER_H
@@ -0,0 +1,93 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Minimal fork-join helpers over std::thread
+// Work is split into contiguous ranges, one per thread; small inputs run inline
+
+// Number of worker threads to use by default (at least 1)
+inline unsigned defaultThreadCount() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+// Call fn(begin, end, worker) on disjoint ranges covering [0, count)
+// Runs inline when count is below min_per_thread or only one thread is requested
+template <typename Fn>
+void parallelFor(size_t count, unsigned threads, Fn fn, size_t min_per_thread = 4096) {
+    if (threads == 0) threads = defaultThreadCount();
+    size_t max_useful = std::max<size_t>(1, count / std::max<size_t>(1, min_per_thread));
+    size_t workers = std::min<size_t>(threads, max_useful);
+
+    if (workers <= 1) {
+        fn(size_t(0), count, 0u);
+        return;
+    }
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    size_t chunk = (count + workers - 1) / workers;
+
+    for (size_t w = 1; w < workers; w++) {
+        size_t begin = std::min(count, w * chunk);
+        size_t end = std::min(count, begin + chunk);
+        pool.emplace_back(fn, begin, end, static_cast<unsigned>(w));
+    }
+    fn(size_t(0), std::min(count, chunk), 0u);
+
+    for (auto& t : pool) {
+        t.join();
+    }
+}
+
+// Sort chunks in parallel, then merge neighbouring runs pairwise
+template <typename T, typename Compare>
+void parallelSort(std::vector<T>& data, unsigned threads, Compare comp) {
+    if (threads == 0) threads = defaultThreadCount();
+    size_t count = data.size();
+    size_t runs = std::min<size_t>(threads, std::max<size_t>(1, count / 65536));
+
+    if (runs <= 1) {
+        std::sort(data.begin(), data.end(), comp);
+        return;
+    }
+
+    size_t chunk = (count + runs - 1) / runs;
+    std::vector<size_t> bounds;
+    for (size_t r = 0; r <= runs; r++) {
+        bounds.push_back(std::min(count, r * chunk));
+    }
+
+    parallelFor(runs, threads, [&](size_t begin, size_t end, unsigned) {
+        for (size_t r = begin; r < end; r++) {
+            std::sort(data.begin() + bounds[r], data.begin() + bounds[r + 1], comp);
+        }
+    }, 1);
+
+    // Each pass halves the number of sorted runs
+    while (bounds.size() > 2) {
+        size_t pairs = (bounds.size() - 1) / 2;
+        parallelFor(pairs, threads, [&](size_t begin, size_t end, unsigned) {
+            for (size_t p = begin; p < end; p++) {
+                std::inplace_merge(data.begin() + bounds[2 * p],
+                                   data.begin() + bounds[2 * p + 1],
+                                   data.begin() + bounds[2 * p + 2], comp);
+            }
+        }, 1);
+
+        std::vector<size_t> merged;
+        for (size_t i = 0; i < bounds.size(); i += 2) {
+            merged.push_back(bounds[i]);
+        }
+        if (merged.back() != bounds.back()) {
+            merged.push_back(bounds.back());
+        }
+        bounds.swap(merged);
+    }
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,60 @@
+#ifndef PATH_END_H
+#define PATH_END_H
+
+#include "announcement.h"
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Path-end validation: an origin publishes the ASes adjacent to it, and a path
+// whose last hop before the origin is not one of them is invalid. This stops
+// forged-origin announcements ([attacker, victim]) that pass ROV.
+
+// "unchecked", "valid", "unknown" or "invalid"
+const char* pathEndStateName(PathEndState state);
+
+// Records as one hash set of packed (origin << 32 | neighbor) keys; the key
+// (origin << 32 | 0) marks an origin with a record (AS 0 is never a neighbor).
+// A check is at most two probes. Read-only after loading.
+class PathEndTable {
+private:
+    std::unordered_set<uint64_t> keys;
+    size_t origin_count = 0;
+
+    static uint64_t key(ASN origin, ASN neighbor) {
+        return (static_cast<uint64_t>(origin) << 32) | neighbor;
+    }
+
+public:
+    // Replace all records with (origin, neighbor) pairs; neighbor 0 registers
+    // an origin with no authorized neighbors
+    void assign(const std::vector<std::pair<ASN, ASN>>& pairs);
+
+    // One record per line: origin then its authorized neighbors (same format as
+    // ASPA records, see readASNRecordFile)
+    bool loadFromFile(const std::string& filename);
+
+    // Verdict for path (most recent hop first, origin last). A path of the
+    // origin alone is VALID: its receiver is the hop before the origin.
+    PathEndState check(const ASN* path, size_t length) const {
+        if (length < 2) {
+            return PathEndState::VALID;
+        }
+        ASN origin = path[length - 1];
+        if (keys.empty() || !keys.count(key(origin, 0))) {
+            return PathEndState::UNKNOWN;
+        }
+        return keys.count(key(origin, path[length - 2])) ? PathEndState::VALID : PathEndState::INVALID;
+    }
+
+    bool empty() const { return origin_count == 0; }
+    size_t getOriginCount() const { return origin_count; }
+    size_t getNeighborCount() const { return keys.size() - origin_count; }
+
+    // Packed keys in ascending order, for fingerprints
+    std::vector<uint64_t> getSortedKeys() const;
+};
+
+#endif // PATH_END_H
@@ -0,0 +1,89 @@
+#ifndef PROPAGATION_ENGINE_H
+#define PROPAGATION_ENGINE_H
+
+#include "announcement.h"
+#include "as_graph.h"
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// CPUs grouped by NUMA node, restricted to the CPUs this process may use
+// (so numactl --cpunodebind and taskset are respected)
+// Falls back to a single node when sysfs has no NUMA information
+std::vector<std::vector<int>> detectNumaNodes();
+
+// Persistent worker threads
+// With NUMA pinning, workers are spread round-robin over NUMA nodes and each is
+// pinned to one CPU of its node before it allocates anything
+class WorkerPool {
+private:
+    std::vector<std::thread> threads;
+    std::vector<int> worker_node;  // NUMA node of each worker (-1 when unpinned)
+
+    std::mutex mutex;
+    std::condition_variable start_cv;
+    std::condition_variable done_cv;
+    std::function<void(unsigned)> task;
+    uint64_t generation = 0;
+    unsigned pending = 0;
+    bool stopping = false;
+
+    void workerLoop(unsigned worker, int cpu);
+
+public:
+    WorkerPool(unsigned count, bool pin_numa);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Run fn(worker) on every worker and wait for all of them
+    void run(const std::function<void(unsigned)>& fn);
+
+    unsigned size() const { return static_cast<unsigned>(threads.size()); }
+    int getWorkerNode(unsigned worker) const { return worker_node[worker]; }
+};
+
+// Parallel three-phase propagation (same results as the serial engine)
+// Runs one address family at a time (P = IPv4Prefix or IPv6Prefix).
+// Pull model: each AS reads its neighbors' finished RIBs and fills only its own
+// received queue and RIB, so ASes within a rank run concurrently without locks.
+// Every AS has a fixed owning worker, so its RIB entries and queue buffers are
+// allocated and first-touched by that worker (local memory when pinned).
+class ParallelPropagator {
+private:
+    ASGraph& graph;
+    WorkerPool pool;
+
+    // owned[rank][worker]: ASes of that rank processed by that worker
+    std::vector<std::vector<std::vector<ASNode*>>> owned;
+
+    // Vantage-point retention (empty when every AS keeps its RIB)
+    // releasable[rank][worker]: ASes with customers, not vantage points, whose
+    // lowest-ranked customer is at that rank; freed by their owner once it is done
+    std::vector<std::vector<std::vector<ASNode*>>> releasable;
+    std::vector<size_t> released;  // Routes freed per worker
+
+    void partition();
+
+    template <typename P, typename S> void propagateUp(const S& selection);
+    template <typename P, typename S> void propagateAcross(const S& selection);
+    template <typename P, typename S> void propagateDown(const S& selection);
+
+public:
+    ParallelPropagator(ASGraph& graph, unsigned threads, bool numa_aware);
+
+    // Requires flattenGraph(); returns the number of RIB entries of family P,
+    // released_routes of which were freed by vantage-point retention
+    // S: route-selection policy (see route_selection.h); instantiated in
+    // propagation_engine.cpp for both families and every policy
+    template <typename P, typename S>
+    size_t propagate(size_t& released_routes, const S& selection);
+
+    const WorkerPool& getPool() const { return pool; }
+};
+
+#endif // PROPAGATION_ENGINE_H
@@ -0,0 +1,84 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include "as_graph.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// On-disk cache of simulation outputs
+// A run is keyed by a content hash of its normalized inputs:
+// - graph fingerprint
+// - seeded announcements (sorted)
+// - ROV deploying ASes (sorted)
+// - vantage points (sorted, when RIB retention is on)
+// - route-selection policy (when not the standard one)
+// - ASPA and path-end deployers and records (when deployed)
+// - route leakers and the leak round limit (when leaking)
+// - engine version and output format
+// Entries are stored as <directory>/<key>.out and evicted least-recently-used
+// first once the directory grows past max_bytes.
+class ResultCache {
+private:
+    std::string directory;
+    uint64_t max_bytes;
+
+    // Everything besides the topology that a run's output depends on
+    // Filled from a graph by makeKey only, so no input can be left out of a key
+    struct CacheInputs {
+        std::string graph_fingerprint;
+        std::string output_format;
+        std::vector<SeedAnnouncement> seeds;
+        std::vector<ASN> rov_asns;
+        std::vector<ASN> vantage_points;
+        RouteSelection route_selection = RouteSelection::STANDARD;
+        uint32_t selection_seed = 0;
+        std::vector<ASN> aspa_asns;
+        std::string aspa_fingerprint;     // ASPA records
+        std::vector<ASN> pathend_asns;
+        std::string pathend_fingerprint;  // Path-end records
+        std::vector<std::pair<ASN, LeakPolicy>> leakers;
+        size_t leak_round_limit = 0;
+    };
+
+    // Normalize inputs (order must not matter) and hash them
+    static std::string hashInputs(CacheInputs inputs);
+
+    std::string entryPath(const std::string& key) const;
+
+public:
+    // Bump whenever a change alters propagation results or output bytes
+    // 1.1: --sorted row order
+    // 1.2: per-address-family RIBs and engines
+    // 1.3: route-selection policies
+    // 1.4: ASPA path verification
+    // 1.5: path-end validation
+    // 1.6: route leaks
+    static constexpr const char* ENGINE_VERSION = "1.6";
+
+    ResultCache(const std::string& directory, uint64_t max_bytes);
+
+    // Key of a run on graph: its seeds, ROV set, ASPA and path-end deployment
+    // and records, route leakers, vantage points and route selection, plus the
+    // topology fingerprint and output format
+    static std::string makeKey(const ASGraph& graph,
+                               const std::string& graph_fingerprint,
+                               const std::string& output_format);
+
+    // On a hit, copy the stored output to output_filename and return true
+    bool lookup(const std::string& key, const std::string& output_filename);
+
+    // Store output_filename under key, then evict down to the size limit
+    bool store(const std::string& key, const std::string& output_filename);
+
+    // Remove least-recently-used entries until the cache fits in max_bytes
+    void evict();
+
+    // Total size of cached entries in bytes
+    uint64_t getSizeBytes() const;
+
+    const std::string& getDirectory() const { return directory; }
+    uint64_t getMaxBytes() const { return max_bytes; }
+};
+
+#endif // RESULT_CACHE_H
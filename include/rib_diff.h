@@ -0,0 +1,57 @@
+#ifndef RIB_DIFF_H
+#define RIB_DIFF_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Route differences between two simulation outputs, by change type
+struct RibDiffCounts {
+    uint64_t old_rows = 0;
+    uint64_t new_rows = 0;
+    uint64_t unchanged = 0;
+    uint64_t added = 0;             // (asn, prefix) routed only in the new run
+    uint64_t removed = 0;           // (asn, prefix) routed only in the old run
+    uint64_t origin_changed = 0;    // Different origin AS
+    uint64_t next_hop_changed = 0;  // Same origin, different next hop
+    uint64_t path_changed = 0;      // Same origin and next hop, different path
+
+    uint64_t changed() const { return origin_changed + next_hop_changed + path_changed; }
+    void add(const RibDiffCounts& other);
+};
+
+struct RibDiffOptions {
+    unsigned threads = 0;           // Worker threads (0 = all cores)
+    bool write_rows = true;         // Write the changed rows, not only the counts
+};
+
+// Sorted simulation output: one CSV or the shards listed in a manifest
+// Rows must be in --sorted order (ASN, then prefix); shards must be uncompressed
+// and split by ASN range, so that the shard files concatenate in key order.
+class SortedRibInput {
+private:
+    std::vector<std::string> files;
+    std::vector<uint64_t> sizes;
+    std::vector<uint64_t> data_start;  // Offset of the first row (after the header)
+
+public:
+    bool open(const std::string& path);
+
+    size_t getFileCount() const { return files.size(); }
+    const std::string& getFile(size_t index) const { return files[index]; }
+    uint64_t getSize(size_t index) const { return sizes[index]; }
+    uint64_t getDataStart(size_t index) const { return data_start[index]; }
+    uint64_t getTotalBytes() const;
+};
+
+// Merge-join two sorted outputs
+// The key space is cut into ASN ranges located by binary search in both inputs;
+// each range is merged by one worker with a few MB of buffers, so memory does not
+// depend on input size. With write_rows, output gets rows
+//   change,asn,prefix,old_as_path,new_as_path
+// with change one of added, removed, origin, next_hop, path.
+bool diffRibOutputs(const std::string& old_input, const std::string& new_input,
+                    const std::string& output, const RibDiffOptions& options,
+                    RibDiffCounts& counts);
+
+#endif // RIB_DIFF_H
@@ -0,0 +1,96 @@
+#ifndef RIB_EXPORT_H
+#define RIB_EXPORT_H
+
+#include "announcement.h"
+#include "as_graph.h"
+#include "output_writer.h"
+#include "route_state.h"
+#include <string>
+#include <vector>
+
+// How rows are assigned to output shards
+enum class ShardKey {
+    ASN_RANGE,     // Contiguous ASN ranges with about equal row counts
+    PREFIX_HASH    // Stable hash of the prefix
+};
+
+// Row selection for exportRibsCsv and exportRibShards (empty lists select everything)
+// The lists are compiled before any row is formatted: ASes are looked up directly,
+// prefixes and origins become bitmaps over dense ids (seeded prefixes in prefix
+// order, seed origins in ASN order), so unselected rows cost almost nothing.
+struct RibFilter {
+    std::vector<ASN> asns;         // ASes whose RIBs are exported
+    std::vector<Prefix> prefixes;
+    std::vector<ASN> origins;      // Origin AS (last AS of the path)
+    bool rov_invalid_only = false;
+
+    bool active() const {
+        return !asns.empty() || !prefixes.empty() || !origins.empty() || rov_invalid_only;
+    }
+};
+
+// One ASN or one prefix per line; blank lines and '#' comments are skipped
+bool readAsnList(const std::string& filename, std::vector<ASN>& asns);
+bool readPrefixList(const std::string& filename, std::vector<Prefix>& prefixes);
+
+struct RibExportOptions {
+    unsigned threads = 1;          // Formatting threads (0 = all cores)
+    OutputWriterOptions writer;
+    bool sorted = false;           // Rows ordered by (ASN, prefix); see exportRibsCsv
+    RibFilter filter;              // Not supported by exportRibsDelta
+
+    // Sharded export (exportRibShards)
+    unsigned shards = 0;
+    ShardKey shard_key = ShardKey::ASN_RANGE;
+    bool compress_shards = false;  // bzip2 each shard (.csv.bz2)
+};
+
+// One written shard, as listed in the manifest
+struct RibShardInfo {
+    std::string file;              // Name relative to the manifest's directory
+    uint64_t rows = 0;
+    uint64_t bytes = 0;            // File size (compressed when compress_shards)
+    std::string checksum;          // Content hash of the file (hashFile / bgp.hash_file)
+    ASN first_asn = 0;             // ASN_RANGE only; 0 for an empty shard
+    ASN last_asn = 0;
+};
+
+// Prefix order of sorted output: IPv4 before IPv6, then address, then length
+bool prefixLess(const Prefix& a, const Prefix& b);
+
+// Append one row: asn,prefix,"(as1, as2, as3)" or "(as1,)" for single-AS paths
+void appendRibRow(std::string& out, ASN asn, const std::string& prefix, const Announcement& ann);
+
+// Write every local RIB as asn,prefix,as_path rows (header included)
+// Nodes are formatted in blocks by the worker threads; finished blocks go to an
+// OutputWriter, which writes them in the background while the next blocks are
+// formatted. Row order matches graph iteration order unless options.sorted, which
+// orders rows by ASN, then prefix (IPv4 before IPv6, then address, then length)
+// so that runs can be compared byte for byte.
+// rows (optional) receives the number of rows written.
+bool exportRibsCsv(const ASGraph& graph, const std::string& filename,
+                   const RibExportOptions& options, size_t* rows = nullptr);
+
+// Write the RIBs as options.shards files plus a JSON manifest
+// For output "dir/ribs.csv": dir/ribs-00000-of-00004.csv ... and dir/ribs.manifest.json.
+// Every shard has its own thread, buffer, optional bzip2 stream and writer; each
+// shard carries the CSV header. Rows within a shard follow ascending ASN
+// (and prefix order with options.sorted).
+bool exportRibShards(const ASGraph& graph, const std::string& filename,
+                     const RibExportOptions& options, std::vector<RibShardInfo>* shards = nullptr);
+
+// Route keys of every RIB entry, sorted by (asn, prefix), for --save-route-state
+// Fails if a RIB holds a prefix that was never seeded.
+bool buildRouteState(const ASGraph& graph, RouteState& state, unsigned threads = 0);
+
+// Write only the rows that differ from a baseline run (sorted by asn, prefix)
+// - new or changed route: the usual asn,prefix,"(path)" row
+// - route present in the baseline but gone now: asn,prefix, with an empty as_path
+// Routes are compared by route key, so no baseline paths are needed.
+bool exportRibsDelta(const ASGraph& graph, const std::string& filename, const RouteState& baseline,
+                     const RibExportOptions& options, size_t* rows = nullptr);
+
+// Manifest path for an output filename (ribs.csv -> ribs.manifest.json)
+std::string shardManifestPath(const std::string& filename);
+
+#endif // RIB_EXPORT_H
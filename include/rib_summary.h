@@ -0,0 +1,40 @@
+#ifndef RIB_SUMMARY_H
+#define RIB_SUMMARY_H
+
+#include "announcement.h"
+#include "as_graph.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Aggregates over every local RIB, for runs that do not need the routes themselves
+struct PrefixRibSummary {
+    Prefix prefix;
+    uint64_t reach = 0;                                // ASes with a route
+    uint64_t path_length_total = 0;
+    std::vector<std::pair<ASN, uint64_t>> origins;     // Origin AS -> ASes routing to it, largest first
+};
+
+struct RibSummary {
+    // Paths of MAX_PATH_BIN or more ASes share the last histogram bin
+    static constexpr size_t MAX_PATH_BIN = 64;
+
+    uint64_t ases = 0;
+    uint64_t routed_ases = 0;
+    uint64_t routes = 0;
+    uint64_t rov_invalid_routes = 0;
+    uint64_t relationship_counts[4] = {};              // By RelationshipType (origin, customer, peer, provider)
+    std::vector<uint64_t> path_length_histogram;       // Index = AS path length
+    uint64_t path_length_total = 0;
+    std::vector<PrefixRibSummary> prefixes;            // In prefix order (see prefixLess)
+};
+
+// Computed straight from RIB storage by `threads` workers (0 = all cores); each
+// worker keeps private counters that are merged at the end
+RibSummary summarizeRibs(const ASGraph& graph, unsigned threads = 0);
+
+// Small JSON document (reach, origin shares, path lengths, relationship mix)
+bool writeRibSummaryJson(const RibSummary& summary, const std::string& filename);
+
+#endif // RIB_SUMMARY_H
@@ -0,0 +1,111 @@
+#ifndef ROUTE_LEAK_H
+#define ROUTE_LEAK_H
+
+#include "announcement.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Route leaks (RFC 7908)
+// A leaker re-exports routes learned from providers and peers, which the
+// valley-free rules only allow towards customers. The policy says to whom.
+
+enum class LeakPolicy : uint8_t {
+    PROVIDERS = 1,  // Provider and peer routes also to providers (types 1 and 4)
+    PEERS = 2,      // Provider and peer routes also to peers (types 2 and 3)
+    ALL = 3         // Both: every route to every neighbor
+};
+
+// Parse "providers", "peers" or "all"
+bool parseLeakPolicy(const std::string& text, LeakPolicy& policy);
+const char* leakPolicyName(LeakPolicy policy);
+
+// Does a sender with leak policy `leaks` (0 for none) send ann to a neighbor
+// that will receive it as received_from? Routes from customers and originated
+// routes go everywhere and everything goes to customers (valley-free).
+inline bool exportsRoute(const Announcement& ann, RelationshipType received_from, uint8_t leaks) {
+    if (received_from == RelationshipType::PROVIDER ||
+        ann.received_from == RelationshipType::ORIGIN ||
+        ann.received_from == RelationshipType::CUSTOMER) {
+        return true;
+    }
+    uint8_t needed = static_cast<uint8_t>(received_from == RelationshipType::CUSTOMER ? LeakPolicy::PROVIDERS
+                                                                                      : LeakPolicy::PEERS);
+    return (leaks & needed) != 0;
+}
+
+// Outcome of the last leak propagation (both families)
+struct LeakStats {
+    size_t rounds = 0;       // Worklist rounds until no AS was left to reprocess
+    size_t evaluations = 0;  // Routes re-selected
+    size_t updates = 0;      // Routes that changed
+    bool converged = true;   // False if the round limit was reached first
+};
+
+class ASGraph;
+struct ASNode;
+
+// Worklist fixpoint propagation of leaked routes
+// Starts from the result of the three-phase engine, in which every AS already
+// holds the best route its neighbors export under the valley-free rules, and
+// keeps that invariant for every AS off the worklist. When an AS's route
+// changes, each neighbor that routed through it re-selects that prefix from
+// scratch over what its neighbors export now (so a route a neighbor no longer
+// has is implicitly withdrawn); a neighbor offered a route better than its own
+// only compares the two; the others keep their choice. Each AS is queued at
+// most once at a time, and the ASes queued while a round runs form the next
+// round. Runs serially; seeded routes are never replaced.
+class LeakPropagator {
+private:
+    ASGraph& graph;
+    std::unordered_map<const ASNode*, uint8_t> leak_mask;  // Leakers only
+
+    uint8_t leaksOf(const ASNode& node) const {
+        auto it = leak_mask.find(&node);
+        return it == leak_mask.end() ? 0 : it->second;
+    }
+
+    // A neighbor's route to compare with the current one
+    template <typename P>
+    struct Offer {
+        P prefix;
+        const ASNode* sender;
+        RelationshipType received_from;
+    };
+
+    // Work queued at one AS
+    template <typename P>
+    struct Work {
+        std::unordered_set<P> reselect;  // Prefixes to re-select from scratch
+        std::vector<Offer<P>> offers;
+
+        bool empty() const { return reselect.empty() && offers.empty(); }
+    };
+
+    enum class Effect : uint8_t { NONE, RESELECT, OFFER };
+
+    // What sender's current route for prefix means to receiver: RESELECT if
+    // receiver routes through sender, OFFER if sender now offers a better route
+    // offered: sender's route if sender exports it to receiver, else nullptr
+    template <typename P, typename S>
+    Effect effectOf(const ASNode& sender, const Announcement* offered, const ASNode& receiver,
+                    RelationshipType received_from, const P& prefix, const S& selection) const;
+
+    // Do node's work; changed gets the prefixes whose route changed
+    template <typename P, typename S>
+    void resolve(ASNode& node, const Work<P>& work, const S& selection,
+                 std::vector<P>& changed, LeakStats& stats);
+
+public:
+    explicit LeakPropagator(ASGraph& graph);
+
+    // Requires a completed three-phase run with every RIB retained
+    // S: route-selection policy (see route_selection.h); instantiated in
+    // route_leak.cpp for both families and every policy
+    template <typename P, typename S>
+    LeakStats propagate(const S& selection, size_t round_limit);
+};
+
+#endif // ROUTE_LEAK_H
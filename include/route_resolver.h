@@ -0,0 +1,83 @@
+#ifndef ROUTE_RESOLVER_H
+#define ROUTE_RESOLVER_H
+
+#include "announcement.h"
+#include "route_selection.h"
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+class ASGraph;
+struct ASNode;
+
+// Demand-driven route resolution
+// Answers "which route does this AS select for this prefix" without a global
+// propagation, by evaluating the valley-free rules backwards from the asking AS:
+//   customer route  best over customers' customer routes (origin routes included)
+//   peer route      best over peers' customer routes, if there is no customer route
+//   provider route  best over providers' routes, if there is neither
+// Customer routes exist only at the origins and their transitive providers, so
+// that set is collected once per prefix and customers outside it are skipped.
+// Every route computed on the way is memoized, and later queries for the same
+// prefix reuse it. Results match the propagation engines for the graph's seeds,
+// policies and route selection; route leakers are not modeled.
+//
+// Reads the graph's seeds and route selection when built and on clear(), and
+// its topology and policies during queries: after changing any of them, call
+// clear() (or use a new resolver).
+class RouteResolver {
+private:
+    // A memoized route; an entry without a route is also an answer
+    struct Route {
+        bool present = false;
+        Announcement ann;
+    };
+
+    // Everything known about one prefix
+    template <typename P>
+    struct PrefixRoutes {
+        std::unordered_map<ASN, Announcement> origins;  // Seeded routes
+        std::unordered_set<ASN> reach;                  // Origins and their transitive providers
+        bool reach_built = false;
+        std::unordered_map<ASN, Route> customer_routes; // Routes sent up and across
+        std::unordered_map<ASN, Route> routes;          // Selected routes
+    };
+
+    const ASGraph& graph;
+    RouteSelection route_selection = RouteSelection::STANDARD;
+    uint32_t selection_seed = 0;
+
+    std::unordered_map<IPv4Prefix, PrefixRoutes<IPv4Prefix>> routes4;
+    std::unordered_map<IPv6Prefix, PrefixRoutes<IPv6Prefix>> routes6;
+    size_t computed = 0;
+
+    template <typename P> std::unordered_map<P, PrefixRoutes<P>>& routesOf();
+
+    template <typename P, typename S>
+    const Announcement* resolveWith(ASN asn, const P& prefix, const S& selection);
+
+    // Memoized on first use; an AS whose route is still being computed has
+    // none (only reachable through a provider cycle)
+    template <typename P, typename S>
+    const Route& customerRoute(const ASNode& node, PrefixRoutes<P>& state, const S& selection);
+    template <typename P, typename S>
+    const Route& bestRoute(const ASNode& node, PrefixRoutes<P>& state, const S& selection);
+
+public:
+    explicit RouteResolver(const ASGraph& graph);
+
+    // Route that asn selects for prefix, as stored in its local RIB after
+    // propagation (nullptr if it has none or asn is unknown)
+    // Valid until the next clear()
+    const Announcement* resolve(ASN asn, const Prefix& prefix);
+    const Announcement* resolve(ASN asn, const std::string& prefix) { return resolve(asn, Prefix::parse(prefix)); }
+
+    // Forget every memoized route and re-read the graph's seeds and route selection
+    void clear();
+
+    // Routes computed since the last clear() (customer and selected routes);
+    // a measure of the subgraph the queries touched
+    size_t getComputedRouteCount() const { return computed; }
+};
+
+#endif // ROUTE_RESOLVER_H
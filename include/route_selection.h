@@ -0,0 +1,104 @@
+#ifndef ROUTE_SELECTION_H
+#define ROUTE_SELECTION_H
+
+#include "announcement.h"
+#include <cstdint>
+#include <string>
+
+// Route-selection policies
+// A policy is a type with key(ann): the whole decision packed into one integer,
+// lowest key wins, equal keys keep the route seen first. The propagation engines
+// are templated on the policy, so each variant compiles to integer compares with
+// no per-route switch or virtual call. Every key ends in a per-neighbor tie
+// breaker, so results do not depend on queue order (serial and parallel agree).
+//
+// To add a policy: define the type, add a RouteSelection value, extend
+// parseRouteSelection(), routeSelectionName() and withRouteSelection(), and
+// instantiate the parallel and leak engines for it (end of propagation_engine.cpp
+// and route_leak.cpp).
+
+enum class RouteSelection : uint8_t {
+    STANDARD,            // Relationship, shortest path, lowest next hop
+    IGNORE_PATH_LENGTH,  // Relationship, lowest next hop
+    HASH_TIE_BREAK,      // Relationship, shortest path, seeded hash of next hop
+    LOWEST_ORIGIN        // Relationship, shortest path, lowest origin ASN, lowest next hop
+};
+
+// Parse "standard", "ignore-path-length", "hash-tie-break" or "lowest-origin"
+bool parseRouteSelection(const std::string& text, RouteSelection& selection);
+const char* routeSelectionName(RouteSelection selection);
+
+namespace route_key {
+    // Relationship in the top byte, path length below it (paths stay far below 2^24)
+    inline uint64_t relationshipAndLength(const Announcement& ann) {
+        return (static_cast<uint64_t>(ann.received_from) << 56) |
+               (static_cast<uint64_t>(ann.as_path.size() & 0xFFFFFF) << 32);
+    }
+
+    // Bijective 32-bit mix (murmur3 finalizer): distinct ASNs never tie
+    inline uint32_t mix32(uint32_t x) {
+        x ^= x >> 16;
+        x *= 0x85ebca6bU;
+        x ^= x >> 13;
+        x *= 0xc2b2ae35U;
+        x ^= x >> 16;
+        return x;
+    }
+}
+
+// Relationship, then path length, then lowest next hop (also Announcement::isBetterThan)
+struct StandardSelection {
+    using Key = uint64_t;
+    Key key(const Announcement& ann) const {
+        return route_key::relationshipAndLength(ann) | ann.next_hop_asn;
+    }
+};
+
+struct IgnorePathLengthSelection {
+    using Key = uint64_t;
+    Key key(const Announcement& ann) const {
+        return (static_cast<uint64_t>(ann.received_from) << 56) | ann.next_hop_asn;
+    }
+};
+
+// Pseudo-random but reproducible tie breaks; another seed gives another draw
+struct HashTieBreakSelection {
+    using Key = uint64_t;
+    uint32_t seed = 0;
+
+    Key key(const Announcement& ann) const {
+        return route_key::relationshipAndLength(ann) | route_key::mix32(ann.next_hop_asn ^ seed);
+    }
+};
+
+// Origin ASN and next hop do not both fit below the first two criteria in 64 bits
+struct LowestOriginSelection {
+    using Key = unsigned __int128;
+    Key key(const Announcement& ann) const {
+        uint64_t high = route_key::relationshipAndLength(ann) |
+                        (ann.as_path.empty() ? 0 : ann.as_path.back());
+        return (static_cast<Key>(high) << 32) | ann.next_hop_asn;
+    }
+};
+
+// Call fn(policy) with the policy object for selection and return its result
+// The only runtime dispatch, taken once per propagation
+template <typename Fn>
+auto withRouteSelection(RouteSelection selection, uint32_t seed, Fn&& fn) {
+    switch (selection) {
+        case RouteSelection::IGNORE_PATH_LENGTH:
+            return fn(IgnorePathLengthSelection());
+        case RouteSelection::HASH_TIE_BREAK: {
+            HashTieBreakSelection hashed;
+            hashed.seed = seed;
+            return fn(hashed);
+        }
+        case RouteSelection::LOWEST_ORIGIN:
+            return fn(LowestOriginSelection());
+        case RouteSelection::STANDARD:
+        default:
+            return fn(StandardSelection());
+    }
+}
+
+#endif // ROUTE_SELECTION_H
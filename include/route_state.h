@@ -0,0 +1,40 @@
+#ifndef ROUTE_STATE_H
+#define ROUTE_STATE_H
+
+#include "announcement.h"
+#include "content_hash.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Compact routing state of a run: a 64-bit route key per (asn, prefix)
+// Saved with --save-route-state and used as the baseline of delta exports
+// (--delta-from), which write only the routes whose key differs.
+struct RouteState {
+    struct Entry {
+        ASN asn;
+        uint32_t prefix;     // Index into prefixes
+        uint64_t route_key;  // routeKey() of the selected announcement
+    };
+
+    std::vector<Prefix> prefixes;       // In prefixLess order
+    std::vector<std::string> prefix_text;
+    std::vector<Entry> entries;         // Sorted by (asn, prefix)
+
+    void clear();
+};
+
+// Hash of the AS path; equal keys mean the same exported route
+inline uint64_t routeKey(const Announcement& ann) {
+    uint64_t key = mix64(ann.as_path.size() + 0x9e3779b97f4a7c15ULL);
+    for (ASN asn : ann.as_path) {
+        key = mix64(key ^ asn) + 0x632be59bd9b4e019ULL;
+    }
+    return key;
+}
+
+// Binary file: header, prefix table, then 16-byte entries (host byte order)
+bool saveRouteState(const RouteState& state, const std::string& filename);
+bool loadRouteState(const std::string& filename, RouteState& state);
+
+#endif // ROUTE_STATE_H
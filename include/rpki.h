@@ -0,0 +1,173 @@
+#ifndef RPKI_H
+#define RPKI_H
+
+#include "announcement.h"
+#include "as_graph.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// RPKI route origin validation (RFC 6811) against a VRP dump
+// Replaces the precomputed rov_invalid column of the announcements file
+
+enum class RpkiState : uint8_t {
+    NOT_FOUND,  // No VRP covers the prefix
+    VALID,      // A covering VRP authorizes the origin at this length
+    INVALID     // Covered, but no covering VRP matches
+};
+
+// "not-found", "valid" or "invalid"
+const char* rpkiStateName(RpkiState state);
+
+namespace rpki_detail {
+    template <typename P> struct Family;
+
+    template <> struct Family<IPv4Prefix> {
+        using Address = uint32_t;
+        static constexpr unsigned BITS = 32;
+        static Address address(const IPv4Prefix& prefix) { return prefix.address; }
+    };
+
+    template <> struct Family<IPv6Prefix> {
+        using Address = unsigned __int128;
+        static constexpr unsigned BITS = 128;
+        static Address address(const IPv6Prefix& prefix) {
+            return (static_cast<Address>(prefix.high) << 64) | prefix.low;
+        }
+    };
+
+    // First `length` bits of address, the rest zeroed
+    template <typename Address, unsigned BITS>
+    inline Address maskAddress(Address address, unsigned length) {
+        return length == 0 ? Address(0) : address & (~Address(0) << (BITS - length));
+    }
+}
+
+// VRPs of one address family as a compressed prefix trie
+// Distinct VRP prefixes are stored in (address, length) order, each with the index
+// of its nearest enclosing VRP prefix, so the trie is kept as nested intervals with
+// parent links and no per-bit nodes. Every VRP covering a route encloses the last
+// VRP prefix starting at or before the route's address, so a lookup is one binary
+// search (narrowed by a table over the top 16 address bits) and a walk up that
+// prefix's parent chain, which is only as long as the VRP nesting depth.
+template <typename P>
+class VrpTable {
+public:
+    using Family = rpki_detail::Family<P>;
+    using Address = typename Family::Address;
+
+    struct Entry {
+        Address address;      // Masked to length
+        uint8_t length;
+        uint8_t max_length;
+        ASN asn;
+    };
+
+    // Replace the table with entries (sorted in place by `threads` workers)
+    void build(std::vector<Entry>& entries, unsigned threads);
+
+    RpkiState validate(const P& prefix, ASN origin) const {
+        if (starts.empty()) {
+            return RpkiState::NOT_FOUND;
+        }
+
+        unsigned length = prefix.prefix_len;
+        Address address = mask(Family::address(prefix), length);
+        size_t bucket = bucketOf(address);
+        size_t after = std::upper_bound(starts.begin() + buckets[bucket],
+                                        starts.begin() + buckets[bucket + 1], address) - starts.begin();
+
+        bool covered = false;
+        for (uint32_t i = after == 0 ? NO_PARENT : static_cast<uint32_t>(after - 1);
+             i != NO_PARENT; i = nodes[i].parent) {
+            const Node& node = nodes[i];
+            if (node.length > length || mask(address, node.length) != starts[i]) {
+                continue;
+            }
+
+            covered = true;
+            for (uint32_t a = node.auth_begin; a < nodes[i + 1].auth_begin; a++) {
+                // AS 0 VRPs never match (RFC 7607)
+                if (authorizations[a].asn == origin && origin != 0 &&
+                    length <= authorizations[a].max_length) {
+                    return RpkiState::VALID;
+                }
+            }
+        }
+        return covered ? RpkiState::INVALID : RpkiState::NOT_FOUND;
+    }
+
+    // Number of VRPs (duplicates removed)
+    size_t size() const { return authorizations.size(); }
+
+private:
+    static constexpr uint32_t NO_PARENT = UINT32_MAX;
+    static constexpr unsigned BUCKET_BITS = 16;
+
+    struct Node {
+        uint32_t parent;      // Nearest enclosing VRP prefix, or NO_PARENT
+        uint32_t auth_begin;  // Authorizations up to the next node's auth_begin
+        uint8_t length;
+    };
+
+    struct Authorization {
+        ASN asn;
+        uint8_t max_length;
+    };
+
+    static Address mask(Address address, unsigned length) {
+        return rpki_detail::maskAddress<Address, Family::BITS>(address, length);
+    }
+    static size_t bucketOf(Address address) {
+        return static_cast<size_t>(address >> (Family::BITS - BUCKET_BITS));
+    }
+
+    std::vector<Address> starts;                // Distinct VRP prefixes, ascending
+    std::vector<Node> nodes;                    // Same index as starts, plus an end sentinel
+    std::vector<Authorization> authorizations;  // Grouped by prefix
+    std::vector<uint32_t> buckets;              // First prefix of each top-16-bit value, plus the end
+};
+
+// Seed validation outcome
+struct RpkiSeedCounts {
+    size_t valid = 0;
+    size_t invalid = 0;
+    size_t not_found = 0;
+    size_t changed = 0;   // Seeds whose rov_invalid bit differed from the input
+};
+
+// Both families' VRPs; read-only after loading, so lookups may run concurrently
+class RpkiIndex {
+private:
+    VrpTable<IPv4Prefix> vrps4;
+    VrpTable<IPv6Prefix> vrps6;
+
+public:
+    // Load a VRP CSV: prefix,maxLength,ASN per line ("AS" before the ASN and an
+    // empty maxLength are accepted; a header line is skipped). Routinator-style
+    // ASN,prefix,maxLength[,...] rows are recognized by their first column.
+    // Parsing and sorting are split over `threads` workers (0 = all cores).
+    bool loadFromFile(const std::string& filename, unsigned threads = 0);
+
+    // Origin validation of one route
+    RpkiState validate(const Prefix& prefix, ASN origin) const {
+        return prefix.is_ipv6 ? vrps6.validate(prefix.v6, origin) : vrps4.validate(prefix.v4, origin);
+    }
+
+    // Validation of (prefix, AS) at every hop of path (origin last), as seen by
+    // an AS that checked each hop instead of only the origin. A forged-origin
+    // path [..., X, V] is VALID at V; the state at X shows whether the AS that
+    // injected it is authorized for the prefix at all.
+    void validatePath(const Prefix& prefix, const std::vector<ASN>& path,
+                      std::vector<RpkiState>& states) const;
+
+    // Set rov_invalid of every seed from its (prefix, origin) state
+    RpkiSeedCounts validateSeeds(std::vector<SeedAnnouncement>& seeds, unsigned threads = 0) const;
+
+    size_t size() const { return vrps4.size() + vrps6.size(); }
+    size_t getIPv4Count() const { return vrps4.size(); }
+    size_t getIPv6Count() const { return vrps6.size(); }
+};
+
+#endif // RPKI_H
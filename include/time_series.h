@@ -0,0 +1,73 @@
+#ifndef TIME_SERIES_H
+#define TIME_SERIES_H
+
+#include "as_graph.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Outcome of one month in a time-series run
+struct MonthSummary {
+    std::string label;
+    std::string fingerprint;
+    size_t nodes = 0;
+    size_t edges = 0;
+
+    // Topology change from the previous month (zero for the first)
+    size_t nodes_added = 0;
+    size_t nodes_removed = 0;
+    size_t edges_added = 0;
+    size_t edges_removed = 0;
+    size_t edges_changed = 0;
+
+    // Routing outcome
+    size_t rib_entries = 0;
+    size_t ases_with_routes = 0;
+    double avg_path_length = 0.0;
+    size_t rov_invalid_routes = 0;
+
+    long long update_ms = 0;     // Load or diff + apply
+    long long propagate_ms = 0;  // Reset, rank, seed and propagate
+};
+
+// Runs the same seeds and ROV set against a sequence of topologies in one process
+// The graph is kept between months: each new topology is applied as a diff, so
+// unchanged ASes keep their nodes, policies and RIB tables (cleared, not freed)
+// A month whose topology equals the previous one reuses its results without propagating
+class TimeSeriesRunner {
+private:
+    ASGraph graph;
+    std::vector<SeedAnnouncement> seeds;
+    std::string rov_asns_file;
+    std::string previous_file;
+    bool started = false;
+    bool unchanged = false;     // Current topology equals the previous one
+    MonthSummary last_summary;  // Outcome of the last propagated month
+
+    bool advanceTopology(const std::string& topology_file, MonthSummary& summary);
+    void summarizeRIBs(MonthSummary& summary) const;
+
+public:
+    TimeSeriesRunner(std::vector<SeedAnnouncement> seeds, std::string rov_asns_file);
+
+    // Move to topology_file (text, .bz2 or snapshot), propagate and summarize
+    bool runMonth(const std::string& label, const std::string& topology_file, MonthSummary& summary);
+
+    // Engine used for every month (see ASGraph::setPropagationThreads)
+    void setPropagationThreads(unsigned threads, bool numa_aware) {
+        graph.setPropagationThreads(threads, numa_aware);
+    }
+
+    // Route-selection policy used for every month (see ASGraph::setRouteSelection)
+    void setRouteSelection(RouteSelection selection, uint32_t seed) {
+        graph.setRouteSelection(selection, seed);
+    }
+
+    const ASGraph& getGraph() const { return graph; }
+};
+
+// CSV with one row per month
+void writeMonthSummaryHeader(std::ostream& out);
+void writeMonthSummaryRow(std::ostream& out, const MonthSummary& summary);
+
+#endif // TIME_SERIES_H
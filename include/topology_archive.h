@@ -0,0 +1,53 @@
+#ifndef TOPOLOGY_ARCHIVE_H
+#define TOPOLOGY_ARCHIVE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Local archive of monthly CAIDA topologies
+// Layout under the root directory:
+//   raw/<content hash>.bz2        downloaded files, stored once per distinct content
+//   objects/<fingerprint>.snap    binary graph snapshots, one per distinct topology
+//   index.txt                     "YYYYMM fingerprint content_hash" per month
+// Months whose topology did not change share one snapshot object.
+class TopologyArchive {
+public:
+    struct MonthEntry {
+        std::string fingerprint;   // Topology fingerprint (hex), names the snapshot
+        std::string content_hash;  // Hash of the downloaded file (hex), names the raw copy
+    };
+
+private:
+    std::string root;
+    std::map<std::string, MonthEntry> months;  // Sorted by YYYYMM
+
+    std::string indexPath() const;
+    bool saveIndex() const;
+
+public:
+    explicit TopologyArchive(const std::string& root_dir);
+
+    // Read index.txt (a missing index is an empty archive)
+    bool load();
+
+    // Store a downloaded .bz2 for a month and convert it to a snapshot once
+    // The file is moved into the archive
+    bool addMonth(const std::string& month, const std::string& downloaded_file);
+
+    bool hasMonth(const std::string& month) const;
+
+    // Snapshot path for a month, or empty if the month is not archived
+    std::string getSnapshotPath(const std::string& month) const;
+
+    // Archived months in ascending order
+    std::vector<std::string> getMonths() const;
+
+    const std::map<std::string, MonthEntry>& getEntries() const { return months; }
+    const std::string& getRoot() const { return root; }
+
+    // True for strings of the form YYYYMM
+    static bool isValidMonth(const std::string& month);
+};
+
+#endif // TOPOLOGY_ARCHIVE_H
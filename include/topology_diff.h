@@ -0,0 +1,59 @@
+#ifndef TOPOLOGY_DIFF_H
+#define TOPOLOGY_DIFF_H
+
+#include "as_graph.h"
+#include <string>
+#include <vector>
+
+// Relationship of an AS pair that exists in both topologies with a new type
+struct EdgeChange {
+    ASN as1;
+    ASN as2;
+    RelationType old_rel;
+    RelationType new_rel;
+};
+
+// Typed difference between two topologies
+// All lists are sorted (edges by AS pair), so they can be streamed or merged
+struct TopologyDiff {
+    Hash128 old_fingerprint;
+    Hash128 new_fingerprint;
+
+    std::vector<ASN> added_nodes;
+    std::vector<ASN> removed_nodes;
+    std::vector<GraphEdge> added_edges;
+    std::vector<GraphEdge> removed_edges;
+    std::vector<EdgeChange> changed_edges;
+
+    bool empty() const {
+        return added_nodes.empty() && removed_nodes.empty() && added_edges.empty() &&
+               removed_edges.empty() && changed_edges.empty();
+    }
+};
+
+// Diff sorted node lists and sorted canonical edge lists
+// Inputs are split at AS-pair boundaries and merged on parallel workers
+TopologyDiff diffEdgeLists(const std::vector<ASN>& old_nodes,
+                           const std::vector<GraphEdge>& old_edges,
+                           const std::vector<ASN>& new_nodes,
+                           const std::vector<GraphEdge>& new_edges,
+                           unsigned threads = 0);
+
+// Diff two loaded graphs
+TopologyDiff diffTopologies(const ASGraph& old_graph, const ASGraph& new_graph,
+                            unsigned threads = 0);
+
+// Diff two snapshots straight from their stored sorted lists (no graph is built)
+bool diffSnapshotFiles(const std::string& old_snapshot, const std::string& new_snapshot,
+                       TopologyDiff& diff, unsigned threads = 0);
+
+// Text form, one change per line:
+//   +node <asn>            -node <asn>
+//   +edge <as1>|<as2>|<rel>    -edge <as1>|<as2>|<rel>
+//   ~edge <as1>|<as2>|<old rel>|<new rel>
+// Relationship codes follow the CAIDA convention from as1's side
+// (-1: as2 is a customer, 0: peers, 1: as2 is a provider)
+bool writeTopologyDiff(const TopologyDiff& diff, const std::string& filename);
+bool readTopologyDiff(const std::string& filename, TopologyDiff& diff);
+
+#endif // TOPOLOGY_DIFF_H
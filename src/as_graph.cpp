@@ -1,600 +1,1461 @@
-#include "as_graph.h"
-#include <fstream>
-#include <sstream>
-#include <iostream>
-#include <algorithm>
-#include <cstring>
-#include <chrono>
-
-ASGraph::ASGraph() {
-    // Reserve space for expected ~100k nodes to avoid rehashing
-    nodes.reserve(120000);
-    asn_set.reserve(120000);
-}
-
-void ASGraph::reserveNodes(size_t count) {
-    nodes.reserve(count);
-    asn_set.reserve(count);
-}
-
-ASNode& ASGraph::getOrCreateNode(ASN asn) {
-    // Fast path: check if exists
-    auto it = nodes.find(asn);
-    if (it != nodes.end()) {
-        return it->second;
-    }
-
-    // Create new node
-    asn_set.insert(asn);
-    auto result = nodes.emplace(asn, ASNode(asn));
-    return result.first->second;
-}
-
-void ASGraph::addRelationship(ASN as1, ASN as2, RelationType rel_type) {
-    ASNode& node1 = getOrCreateNode(as1);
-    ASNode& node2 = getOrCreateNode(as2);
-
-    edge_count++;
-
-    switch (rel_type) {
-        case RelationType::PROVIDER:
-            // as1 is customer, as2 is provider
-            node1.providers.push_back(std::ref(node2));
-            node2.customers.push_back(std::ref(node1));
-            provider_customer_edges++;
-            break;
-
-        case RelationType::CUSTOMER:
-            // as1 is provider, as2 is customer
-            node1.customers.push_back(std::ref(node2));
-            node2.providers.push_back(std::ref(node1));
-            provider_customer_edges++;
-            break;
-
-        case RelationType::PEER:
-            // Peer to peer
-            node1.peers.push_back(std::ref(node2));
-            node2.peers.push_back(std::ref(node1));
-            peer_edges++;
-            break;
-    }
-}
-
-bool ASGraph::buildFromFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Cannot open file " << filename << std::endl;
-        return false;
-    }
-
-    std::cout << "Parsing AS relationships from " << filename << "..." << std::endl;
-
-    std::string line;
-    line.reserve(128); // Pre-allocate reasonable line size
-
-    size_t line_count = 0;
-    size_t parsed_count = 0;
-
-    // Fast parsing - avoid string operations where possible
-    while (std::getline(file, line)) {
-        line_count++;
-
-        // Skip comments and empty lines
-        if (line.empty() || line[0] == '#') {
-            continue;
-        }
-
-        // Fast parsing: ASN1|ASN2|relationship|source
-        // We only need first 3 fields
-        const char* str = line.c_str();
-        char* end;
-
-        // Parse AS1
-        ASN as1 = static_cast<ASN>(std::strtoul(str, &end, 10));
-        if (end == str || *end != '|') continue;
-
-        // Parse AS2
-        str = end + 1;
-        ASN as2 = static_cast<ASN>(std::strtoul(str, &end, 10));
-        if (end == str || *end != '|') continue;
-
-        // Parse relationship type
-        str = end + 1;
-        int rel_val = std::atoi(str);
-
-        RelationType rel_type;
-        switch (rel_val) {
-            case -1:
-                rel_type = RelationType::CUSTOMER;
-                break;
-            case 0:
-                rel_type = RelationType::PEER;
-                break;
-            case 1:
-                rel_type = RelationType::PROVIDER;
-                break;
-            default:
-                continue; // Invalid relationship type
-        }
-
-        addRelationship(as1, as2, rel_type);
-        parsed_count++;
-
-        // Progress indicator every 100k lines
-        if (parsed_count % 100000 == 0) {
-            std::cout << "  Parsed " << parsed_count << " relationships..." << std::endl;
-        }
-    }
-
-    file.close();
-
-    std::cout << "Parsing complete:" << std::endl;
-    std::cout << "  Total lines: " << line_count << std::endl;
-    std::cout << "  Parsed relationships: " << parsed_count << std::endl;
-    std::cout << "  Nodes (ASes): " << nodes.size() << std::endl;
-    std::cout << "  Provider-Customer edges: " << provider_customer_edges << std::endl;
-    std::cout << "  Peer edges: " << peer_edges << std::endl;
-
-    return true;
-}
-
-bool ASGraph::hasCycleDFS(ASN current, ASN parent, std::unordered_set<ASN>& visited,
-                          std::unordered_set<ASN>& recursion_stack, bool check_providers) {
-    visited.insert(current);
-    recursion_stack.insert(current);
-
-    auto it = nodes.find(current);
-    if (it == nodes.end()) {
-        recursion_stack.erase(current);
-        return false;
-    }
-
-    const ASNode& node = it->second;
-
-    // Check either providers (going up) or customers (going down)
-    const auto& neighbors = check_providers ? node.providers : node.customers;
-
-    for (const auto& neighbor_ref : neighbors) {
-        ASN neighbor = neighbor_ref.get().asn;
-        // Skip parent in undirected traversal
-        if (neighbor == parent) {
-            continue;
-        }
-
-        // If neighbor is in recursion stack, we found a cycle
-        if (recursion_stack.find(neighbor) != recursion_stack.end()) {
-            return true;
-        }
-
-        // If not visited, recurse
-        if (visited.find(neighbor) == visited.end()) {
-            if (hasCycleDFS(neighbor, current, visited, recursion_stack, check_providers)) {
-                return true;
-            }
-        }
-    }
-
-    recursion_stack.erase(current);
-    return false;
-}
-
-bool ASGraph::detectCycles() {
-    std::cout << "Checking for cycles in provider-customer relationships..." << std::endl;
-
-    std::unordered_set<ASN> visited;
-    std::unordered_set<ASN> recursion_stack;
-
-    // Check for cycles by traversing provider relationships
-    for (const auto& pair : nodes) {
-        ASN asn = pair.first;
-
-        if (visited.find(asn) == visited.end()) {
-            if (hasCycleDFS(asn, 0, visited, recursion_stack, true)) {
-                std::cerr << "ERROR: Cycle detected in provider-customer relationships!" << std::endl;
-                std::cerr << "The AS graph contains cycles, which violates the DAG assumption." << std::endl;
-                return true; // Cycle found
-            }
-        }
-    }
-
-    // Also check customer relationships (downward)
-    visited.clear();
-    recursion_stack.clear();
-
-    for (const auto& pair : nodes) {
-        ASN asn = pair.first;
-
-        if (visited.find(asn) == visited.end()) {
-            if (hasCycleDFS(asn, 0, visited, recursion_stack, false)) {
-                std::cerr << "ERROR: Cycle detected in customer-provider relationships!" << std::endl;
-                std::cerr << "The AS graph contains cycles, which violates the DAG assumption." << std::endl;
-                return true; // Cycle found
-            }
-        }
-    }
-
-    std::cout << "No cycles detected. Graph is a valid DAG." << std::endl;
-    return false; // No cycles
-}
-
-bool ASGraph::hasNode(ASN asn) const {
-    return asn_set.find(asn) != asn_set.end();
-}
-
-// BGP Functionality Implementation
-
-#include "bgp_policy.h"
-#include <fstream>
-#include <queue>
-#include <algorithm>
-
-ASNode::~ASNode() {
-    delete policy;
-}
-
-void ASGraph::initializeBGP() {
-    std::cout << "Initializing BGP policies for all nodes..." << std::endl;
-
-    for (auto& pair : nodes) {
-        ASNode& node = pair.second;
-        if (node.policy == nullptr) {
-            node.policy = new BGP();
-        }
-    }
-
-    std::cout << "BGP policies initialized for " << nodes.size() << " nodes" << std::endl;
-}
-
-void ASGraph::flattenGraph() {
-    std::cout << "Flattening graph (assigning propagation ranks)..." << std::endl;
-
-    // BFS to assign ranks
-    // Rank 0 = ASes with no customers (edges)
-    // Rank increases as we go up the provider chain
-    // Each AS rank = MAX(all customer ranks) + 1
-
-    std::unordered_map<ASN, int> ranks;
-    std::unordered_map<ASN, int> customer_count; // Track how many customers are unranked
-
-    // Initialize: rank 0 for nodes with no customers, count customers for others
-    std::queue<ASN> ready_queue;
-    for (auto& pair : nodes) {
-        ASNode& node = pair.second;
-        if (node.customers.empty()) {
-            ranks[node.asn] = 0;
-            ready_queue.push(node.asn);
-        } else {
-            customer_count[node.asn] = node.customers.size();
-        }
-    }
-
-    // Process nodes in topological order
-    int max_rank = 0;
-    while (!ready_queue.empty()) {
-        ASN current = ready_queue.front();
-        ready_queue.pop();
-
-        ASNode* node = getNode(current);
-        if (!node) continue;
-
-        int current_rank = ranks[current];
-
-        // Update all providers of this node
-        for (auto& provider_ref : node->providers) {
-            ASNode& provider = provider_ref.get();
-            ASN provider_asn = provider.asn;
-
-            auto count_it = customer_count.find(provider_asn);
-            if (count_it == customer_count.end()) continue; // Already processed or no customers
-
-            // Update the rank if this customer has higher rank
-            int new_provider_rank = current_rank + 1;
-            auto rank_it = ranks.find(provider_asn);
-            if (rank_it == ranks.end()) {
-                ranks[provider_asn] = new_provider_rank;
-            } else {
-                ranks[provider_asn] = std::max(ranks[provider_asn], new_provider_rank);
-            }
-
-            // Decrement customer count
-            count_it->second--;
-            if (count_it->second == 0) {
-                // All customers of this provider are ranked, so provider is ready
-                ready_queue.push(provider_asn);
-                customer_count.erase(count_it);
-                max_rank = std::max(max_rank, ranks[provider_asn]);
-            }
-        }
-    }
-
-    // Assign propagation_rank to each node and build ranked_ases vector
-    ranked_ases.clear();
-    ranked_ases.resize(max_rank + 1);
-
-    for (auto& pair : nodes) {
-        ASNode& node = pair.second;
-        int rank = ranks[node.asn];
-        node.propagation_rank = rank;
-        ranked_ases[rank].push_back(node.asn);
-    }
-
-    std::cout << "Graph flattened. Max rank: " << max_rank << std::endl;
-    for (size_t i = 0; i < ranked_ases.size(); i++) {
-        std::cout << "  Rank " << i << ": " << ranked_ases[i].size() << " ASes" << std::endl;
-    }
-}
-
-
-size_t ASGraph::propagateAnnouncements() {
-    std::cout << "Propagating announcements..." << std::endl;
-
-    size_t total_propagated = 0;
-
-    // Phase 1: UP (to providers)
-    propagateUp();
-
-    // Phase 2: ACROSS (to peers, one hop only)
-    propagateAcross();
-
-    // Phase 3: DOWN (to customers)
-    propagateDown();
-
-    // Count total announcements
-    for (const auto& pair : nodes) {
-        total_propagated += pair.second.policy->getLocalRIBSize();
-    }
-
-    std::cout << "Propagation complete. Total announcements: " << total_propagated << std::endl;
-    return total_propagated;
-}
-
-void ASGraph::propagateUp() {
-    std::cout << "  Phase 1: Propagating UP (to providers)..." << std::endl;
-
-    // Go from rank 0 upwards
-    for (size_t rank = 0; rank < ranked_ases.size(); rank++) {
-        // Send announcements from this rank
-        for (ASN asn : ranked_ases[rank]) {
-            auto node_it = nodes.find(asn);
-            if (node_it == nodes.end() || !node_it->second.policy) continue;
-
-            ASNode& node = node_it->second;
-            if (node.providers.empty()) continue;
-
-            const auto& local_rib = node.policy->getLocalRIB();
-            if (local_rib.empty()) continue;
-
-            // Send to providers (only announcements from customers or origin)
-            for (const auto& rib_pair : local_rib) {
-                const Announcement& ann = rib_pair.second;
-
-                // Valley-free routing: only send to providers if learned from customer or origin
-                if (ann.received_from != RelationshipType::CUSTOMER &&
-                    ann.received_from != RelationshipType::ORIGIN) {
-                    continue;
-                }
-
-                for (auto& provider_ref : node.providers) {
-                    ASNode& provider = provider_ref.get();
-
-                    // Don't send if provider is in AS path (loop prevention)
-                    if (ann.containsAS(provider.asn)) continue;
-                    if (!provider.policy) continue;
-
-                    Announcement new_ann = ann.copy_with_new_hop(asn, RelationshipType::CUSTOMER);
-                    provider.policy->receiveAnnouncement(new_ann);
-                }
-            }
-        }
-
-        // Process received queue for next rank
-        if (rank + 1 < ranked_ases.size()) {
-            for (ASN asn : ranked_ases[rank + 1]) {
-                auto node_it = nodes.find(asn);
-                if (node_it != nodes.end() && node_it->second.policy) {
-                    node_it->second.policy->processReceivedQueue(asn);
-                    node_it->second.policy->clearReceivedQueue();
-                }
-            }
-        }
-    }
-}
-
-void ASGraph::propagateAcross() {
-    std::cout << "  Phase 2: Propagating ACROSS (to peers)..." << std::endl;
-
-    // Send from ALL ASes - optimize by avoiding repeated lookups
-    for (auto& pair : nodes) {
-        ASNode& node = pair.second;
-        if (!node.policy || node.peers.empty()) continue;
-
-        const auto& local_rib = node.policy->getLocalRIB();
-        if (local_rib.empty()) continue;
-
-        for (const auto& rib_pair : local_rib) {
-            const Announcement& ann = rib_pair.second;
-
-            // Valley-free routing: only send to peers if learned from customer or origin
-            if (ann.received_from != RelationshipType::CUSTOMER &&
-                ann.received_from != RelationshipType::ORIGIN) {
-                continue;
-            }
-
-            // Cache to avoid redundant containsAS checks for same peer
-            for (auto& peer_ref : node.peers) {
-                ASNode& peer = peer_ref.get();
-
-                // Don't send if peer is in AS path (loop prevention)
-                if (ann.containsAS(peer.asn)) continue;
-                if (!peer.policy) continue;
-
-                Announcement new_ann = ann.copy_with_new_hop(node.asn, RelationshipType::PEER);
-                peer.policy->receiveAnnouncement(new_ann);
-            }
-        }
-    }
-
-    // Process ALL at once (to prevent multiple hops)
-    for (auto& pair : nodes) {
-        if (pair.second.policy) {
-            pair.second.policy->processReceivedQueue(pair.second.asn);
-            pair.second.policy->clearReceivedQueue();
-        }
-    }
-}
-
-void ASGraph::propagateDown() {
-    std::cout << "  Phase 3: Propagating DOWN (to customers)..." << std::endl;
-
-    // Go from highest rank downwards
-    for (int rank = ranked_ases.size() - 1; rank >= 0; rank--) {
-        // Send announcements
-        for (ASN asn : ranked_ases[rank]) {
-            auto node_it = nodes.find(asn);
-            if (node_it == nodes.end() || !node_it->second.policy) continue;
-
-            ASNode& node = node_it->second;
-            if (node.customers.empty()) continue;
-
-            const auto& local_rib = node.policy->getLocalRIB();
-            if (local_rib.empty()) continue;
-
-            // Send all announcements to customers
-            for (const auto& rib_pair : local_rib) {
-                const Announcement& ann = rib_pair.second;
-
-                for (auto& customer_ref : node.customers) {
-                    ASNode& customer = customer_ref.get();
-
-                    // Don't send if customer is in AS path
-                    if (ann.containsAS(customer.asn)) continue;
-                    if (!customer.policy) continue;
-
-                    Announcement new_ann = ann.copy_with_new_hop(asn, RelationshipType::PROVIDER);
-                    customer.policy->receiveAnnouncement(new_ann);
-                }
-            }
-        }
-
-        // Process received queue for next rank down
-        if (rank - 1 >= 0) {
-            for (ASN asn : ranked_ases[rank - 1]) {
-                auto node_it = nodes.find(asn);
-                if (node_it != nodes.end() && node_it->second.policy) {
-                    node_it->second.policy->processReceivedQueue(asn);
-                    node_it->second.policy->clearReceivedQueue();
-                }
-            }
-        }
-    }
-}
-
-bool ASGraph::exportToCSV(const std::string& filename) const {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Cannot open file " << filename << " for writing" << std::endl;
-        return false;
-    }
-
-    // Write header
-    file << "asn,prefix,as_path\n";
-
-    // Write all announcements
-    size_t count = 0;
-    for (const auto& node_pair : nodes) {
-        const ASNode& node = node_pair.second;
-        if (!node.policy) continue;
-
-        for (const auto& rib_pair : node.policy->getLocalRIB()) {
-            const Prefix& prefix = rib_pair.first;
-            const Announcement& ann = rib_pair.second;
-
-            // Format: asn,prefix,"as1 as2 as3"
-            file << node.asn << "," << prefix.toString() << ",\"";
-
-            for (size_t i = 0; i < ann.as_path.size(); i++) {
-                if (i > 0) file << " ";
-                file << ann.as_path[i];
-            }
-
-            file << "\"\n";
-            count++;
-        }
-    }
-
-    file.close();
-    std::cout << "Exported " << count << " announcements to " << filename << std::endl;
-    return true;
-}
-
-// ROV Functionality Implementation
-
-void ASGraph::seedAnnouncement(ASN origin_asn, const std::string& prefix_str, bool rov_invalid) {
-    ASNode* node = getNode(origin_asn);
-    if (!node || !node->policy) {
-        std::cerr << "Error: Cannot seed announcement at AS" << origin_asn << std::endl;
-        return;
-    }
-
-    Prefix prefix = Prefix::parse(prefix_str);
-    Announcement ann(prefix, origin_asn, RelationshipType::ORIGIN, rov_invalid);
-
-    node->policy->seedAnnouncement(ann);
-    
-    if (rov_invalid) {
-        std::cout << "Seeded ROV INVALID announcement " << prefix_str << " at AS" << origin_asn << std::endl;
-    } else {
-        std::cout << "Seeded announcement " << prefix_str << " at AS" << origin_asn << std::endl;
-    }
-}
-
-bool ASGraph::loadROVASNs(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Cannot open ROV ASN file " << filename << std::endl;
-        return false;
-    }
-
-    std::cout << "Loading ROV ASNs from " << filename << "..." << std::endl;
-
-    std::string line;
-    size_t loaded = 0;
-    size_t upgraded = 0;
-
-    while (std::getline(file, line)) {
-        // Skip empty lines and comments
-        if (line.empty() || line[0] == '#') {
-            continue;
-        }
-
-        // Parse ASN
-        ASN asn = static_cast<ASN>(std::strtoul(line.c_str(), nullptr, 10));
-        
-        if (asn == 0) {
-            continue; // Invalid ASN
-        }
-
-        rov_asns.insert(asn);
-        loaded++;
-
-        // Upgrade policy to ROV if AS exists
-        ASNode* node = getNode(asn);
-        if (node && node->policy) {
-            // Replace BGP with ROV
-            delete node->policy;
-            node->policy = new ROV();
-            upgraded++;
-        }
-    }
-
-    file.close();
-
-    std::cout << "Loaded " << loaded << " ROV ASNs" << std::endl;
-    std::cout << "Upgraded " << upgraded << " ASes to ROV policy" << std::endl;
-
-    return true;
-}
-
-size_t ASGraph::getROVASNCount() const {
-    return rov_asns.size();
-}
+#include "as_graph.h"
+#include "bz2_decoder.h"
+#include "parallel.h"
+#include "propagation_engine.h"
+#include "topology_diff.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <chrono>
+#include <iterator>
+#include <thread>
+
+ASGraph::ASGraph() {
+    // Reserve space for expected ~100k nodes to avoid rehashing
+    nodes.reserve(120000);
+    asn_set.reserve(120000);
+}
+
+ASGraph::~ASGraph() = default;
+
+void ASGraph::reserveNodes(size_t count) {
+    nodes.reserve(count);
+    asn_set.reserve(count);
+}
+
+ASNode& ASGraph::getOrCreateNode(ASN asn) {
+    // Fast path: check if exists
+    auto it = nodes.find(asn);
+    if (it != nodes.end()) {
+        return it->second;
+    }
+
+    // Create new node
+    asn_set.insert(asn);
+    auto result = nodes.emplace(asn, ASNode(asn));
+    return result.first->second;
+}
+
+void ASGraph::addRelationship(ASN as1, ASN as2, RelationType rel_type) {
+    ASNode& node1 = getOrCreateNode(as1);
+    ASNode& node2 = getOrCreateNode(as2);
+
+    edge_count++;
+    fingerprint_valid = false;
+
+    switch (rel_type) {
+        case RelationType::PROVIDER:
+            // as1 is customer, as2 is provider
+            node1.providers.push_back(std::ref(node2));
+            node2.customers.push_back(std::ref(node1));
+            provider_customer_edges++;
+            break;
+
+        case RelationType::CUSTOMER:
+            // as1 is provider, as2 is customer
+            node1.customers.push_back(std::ref(node2));
+            node2.providers.push_back(std::ref(node1));
+            provider_customer_edges++;
+            break;
+
+        case RelationType::PEER:
+            // Peer to peer
+            node1.peers.push_back(std::ref(node2));
+            node2.peers.push_back(std::ref(node1));
+            peer_edges++;
+            break;
+    }
+}
+
+namespace {
+    // Drop every reference to asn from a neighbor list; returns how many were dropped
+    size_t eraseNeighbor(NeighborList& list, ASN asn) {
+        auto it = std::remove_if(list.begin(), list.end(),
+                                 [asn](const std::reference_wrapper<ASNode>& ref) {
+                                     return ref.get().asn == asn;
+                                 });
+        size_t removed = list.end() - it;
+        list.erase(it, list.end());
+        return removed;
+    }
+}
+
+bool ASGraph::removeRelationship(ASN as1, ASN as2, RelationType rel_type) {
+    ASNode* node1 = getNode(as1);
+    ASNode* node2 = getNode(as2);
+    if (!node1 || !node2) {
+        return false;
+    }
+
+    size_t removed = 0;
+    switch (rel_type) {
+        case RelationType::PROVIDER:
+            removed = eraseNeighbor(node1->providers, as2);
+            eraseNeighbor(node2->customers, as1);
+            provider_customer_edges -= removed;
+            break;
+
+        case RelationType::CUSTOMER:
+            removed = eraseNeighbor(node1->customers, as2);
+            eraseNeighbor(node2->providers, as1);
+            provider_customer_edges -= removed;
+            break;
+
+        case RelationType::PEER:
+            removed = eraseNeighbor(node1->peers, as2);
+            eraseNeighbor(node2->peers, as1);
+            peer_edges -= removed;
+            break;
+    }
+
+    edge_count -= removed;
+    fingerprint_valid = false;
+    return removed > 0;
+}
+
+bool ASGraph::applyDiff(const TopologyDiff& diff) {
+    bool matched = true;
+    bool known_old = fingerprint_valid && fingerprint_cache == diff.old_fingerprint;
+
+    // Removals first so that changed pairs never hold both relationships
+    for (const GraphEdge& e : diff.removed_edges) {
+        matched &= removeRelationship(e.as1, e.as2, e.rel);
+    }
+    for (const EdgeChange& c : diff.changed_edges) {
+        matched &= removeRelationship(c.as1, c.as2, c.old_rel);
+        addRelationship(c.as1, c.as2, c.new_rel);
+    }
+
+    for (ASN asn : diff.added_nodes) {
+        matched &= !hasNode(asn);
+        getOrCreateNode(asn);
+    }
+    for (const GraphEdge& e : diff.added_edges) {
+        addRelationship(e.as1, e.as2, e.rel);
+    }
+
+    for (ASN asn : diff.removed_nodes) {
+        ASNode* node = getNode(asn);
+        if (!node) {
+            matched = false;
+            continue;
+        }
+
+        // A complete diff already removed these; detach leftovers before erasing
+        std::vector<GraphEdge> leftover;
+        for (const auto& ref : node->providers) leftover.push_back({asn, ref.get().asn, RelationType::PROVIDER});
+        for (const auto& ref : node->customers) leftover.push_back({asn, ref.get().asn, RelationType::CUSTOMER});
+        for (const auto& ref : node->peers) leftover.push_back({asn, ref.get().asn, RelationType::PEER});
+        for (const GraphEdge& e : leftover) {
+            removeRelationship(e.as1, e.as2, e.rel);
+        }
+        matched &= leftover.empty();
+
+        nodes.erase(asn);
+        asn_set.erase(asn);
+    }
+
+    ranked_ases.clear();
+
+    // Carry a known fingerprint across a chain of exact diffs
+    fingerprint_valid = matched && known_old && diff.new_fingerprint != Hash128();
+    fingerprint_cache = diff.new_fingerprint;
+
+    if (!matched) {
+        std::cerr << "Warning: Topology diff did not match the graph exactly" << std::endl;
+    }
+    return matched;
+}
+
+namespace {
+    // Bounded decimal parse (input is not NUL-terminated)
+    inline bool parseNumber(const char*& p, const char* end, bool allow_sign, long long& out) {
+        while (p < end && (*p == ' ' || *p == '\t')) p++;
+
+        bool negative = false;
+        if (allow_sign && p < end && (*p == '-' || *p == '+')) {
+            negative = (*p == '-');
+            p++;
+        }
+
+        const char* digits_start = p;
+        unsigned long long value = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            value = value * 10 + static_cast<unsigned>(*p - '0');
+            p++;
+        }
+        if (p == digits_start) return false;
+
+        out = negative ? -static_cast<long long>(value) : static_cast<long long>(value);
+        return true;
+    }
+}
+
+RelationshipStreamParser::RelationshipStreamParser(ASGraph& target) : graph(target) {
+    carry.reserve(128);
+}
+
+void RelationshipStreamParser::parseLine(const char* str, const char* end) {
+    line_count++;
+
+    // Skip comments and empty lines
+    if (str == end || *str == '#' || *str == '\r') {
+        return;
+    }
+
+    // Fast parsing: ASN1|ASN2|relationship|source
+    // We only need first 3 fields
+    long long as1, as2, rel_val;
+
+    // Parse AS1
+    if (!parseNumber(str, end, false, as1) || str == end || *str != '|') return;
+
+    // Parse AS2
+    str++;
+    if (!parseNumber(str, end, false, as2) || str == end || *str != '|') return;
+
+    // Parse relationship type
+    str++;
+    if (!parseNumber(str, end, true, rel_val)) return;
+
+    RelationType rel_type;
+    switch (rel_val) {
+        case -1:
+            rel_type = RelationType::CUSTOMER;
+            break;
+        case 0:
+            rel_type = RelationType::PEER;
+            break;
+        case 1:
+            rel_type = RelationType::PROVIDER;
+            break;
+        default:
+            return; // Invalid relationship type
+    }
+
+    graph.addRelationship(static_cast<ASN>(as1), static_cast<ASN>(as2), rel_type);
+    parsed_count++;
+
+    // Progress indicator every 100k lines
+    if (parsed_count % 100000 == 0) {
+        std::cout << "  Parsed " << parsed_count << " relationships..." << std::endl;
+    }
+}
+
+void RelationshipStreamParser::feed(const char* data, size_t len) {
+    const char* p = data;
+    const char* end = data + len;
+
+    // Finish a line split across chunks
+    if (!carry.empty()) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!newline) {
+            carry.append(p, end - p);
+            return;
+        }
+        carry.append(p, newline - p);
+        parseLine(carry.data(), carry.data() + carry.size());
+        carry.clear();
+        p = newline + 1;
+    }
+
+    // Complete lines straight from the chunk
+    while (p < end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!newline) {
+            carry.assign(p, end - p);
+            return;
+        }
+        parseLine(p, newline);
+        p = newline + 1;
+    }
+}
+
+void RelationshipStreamParser::finish() {
+    if (!carry.empty()) {
+        parseLine(carry.data(), carry.data() + carry.size());
+        carry.clear();
+    }
+}
+
+void ASGraph::printLoadSummary(size_t line_count, size_t parsed_count) const {
+    std::cout << "Parsing complete:" << std::endl;
+    std::cout << "  Total lines: " << line_count << std::endl;
+    std::cout << "  Parsed relationships: " << parsed_count << std::endl;
+    std::cout << "  Nodes (ASes): " << nodes.size() << std::endl;
+    std::cout << "  Provider-Customer edges: " << provider_customer_edges << std::endl;
+    std::cout << "  Peer edges: " << peer_edges << std::endl;
+    std::cout << "  Fingerprint: " << fingerprint().toHex() << std::endl;
+}
+
+bool ASGraph::buildFromFile(const std::string& filename) {
+    if (isSnapshotFile(filename)) {
+        return loadSnapshot(filename);
+    }
+
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open file " << filename << std::endl;
+        return false;
+    }
+
+    std::cout << "Parsing AS relationships from " << filename << "..." << std::endl;
+
+    RelationshipStreamParser parser(*this);
+
+    char header[4] = {0, 0, 0, 0};
+    file.read(header, sizeof(header));
+    std::streamsize header_len = file.gcount();
+    file.clear();
+    file.seekg(0);
+
+    if (isBz2Data(header, static_cast<size_t>(header_len))) {
+        // Compressed topology: decode blocks on all cores, parse in order here
+        std::vector<char> compressed((std::istreambuf_iterator<char>(file)),
+                                     std::istreambuf_iterator<char>());
+        std::string error;
+        bool ok = decompressBz2Parallel(compressed.data(), compressed.size(),
+                                        [&parser](const char* data, size_t len) {
+                                            parser.feed(data, len);
+                                            return true;
+                                        }, 0, &error);
+        if (!ok) {
+            std::cerr << "Error: Cannot decompress " << filename << ": " << error << std::endl;
+            return false;
+        }
+    } else {
+        // Read in large blocks; the parser splits lines itself
+        std::vector<char> buffer(1 << 20);
+        while (file) {
+            file.read(buffer.data(), buffer.size());
+            std::streamsize got = file.gcount();
+            if (got > 0) {
+                parser.feed(buffer.data(), static_cast<size_t>(got));
+            }
+        }
+    }
+    parser.finish();
+
+    file.close();
+
+    printLoadSummary(parser.getLineCount(), parser.getParsedCount());
+    return true;
+}
+
+bool ASGraph::hasCycleDFS(ASN current, ASN parent, std::unordered_set<ASN>& visited,
+                          std::unordered_set<ASN>& recursion_stack, bool check_providers) {
+    visited.insert(current);
+    recursion_stack.insert(current);
+
+    auto it = nodes.find(current);
+    if (it == nodes.end()) {
+        recursion_stack.erase(current);
+        return false;
+    }
+
+    const ASNode& node = it->second;
+
+    // Check either providers (going up) or customers (going down)
+    const auto& neighbors = check_providers ? node.providers : node.customers;
+
+    for (const auto& neighbor_ref : neighbors) {
+        ASN neighbor = neighbor_ref.get().asn;
+        // Skip parent in undirected traversal
+        if (neighbor == parent) {
+            continue;
+        }
+
+        // If neighbor is in recursion stack, we found a cycle
+        if (recursion_stack.find(neighbor) != recursion_stack.end()) {
+            return true;
+        }
+
+        // If not visited, recurse
+        if (visited.find(neighbor) == visited.end()) {
+            if (hasCycleDFS(neighbor, current, visited, recursion_stack, check_providers)) {
+                return true;
+            }
+        }
+    }
+
+    recursion_stack.erase(current);
+    return false;
+}
+
+bool ASGraph::detectCycles() {
+    std::cout << "Checking for cycles in provider-customer relationships..." << std::endl;
+
+    std::unordered_set<ASN> visited;
+    std::unordered_set<ASN> recursion_stack;
+
+    // Check for cycles by traversing provider relationships
+    for (const auto& pair : nodes) {
+        ASN asn = pair.first;
+
+        if (visited.find(asn) == visited.end()) {
+            if (hasCycleDFS(asn, 0, visited, recursion_stack, true)) {
+                std::cerr << "ERROR: Cycle detected in provider-customer relationships!" << std::endl;
+                std::cerr << "The AS graph contains cycles, which violates the DAG assumption." << std::endl;
+                return true; // Cycle found
+            }
+        }
+    }
+
+    // Also check customer relationships (downward)
+    visited.clear();
+    recursion_stack.clear();
+
+    for (const auto& pair : nodes) {
+        ASN asn = pair.first;
+
+        if (visited.find(asn) == visited.end()) {
+            if (hasCycleDFS(asn, 0, visited, recursion_stack, false)) {
+                std::cerr << "ERROR: Cycle detected in customer-provider relationships!" << std::endl;
+                std::cerr << "The AS graph contains cycles, which violates the DAG assumption." << std::endl;
+                return true; // Cycle found
+            }
+        }
+    }
+
+    std::cout << "No cycles detected. Graph is a valid DAG." << std::endl;
+    return false; // No cycles
+}
+
+bool ASGraph::hasNode(ASN asn) const {
+    return asn_set.find(asn) != asn_set.end();
+}
+
+// Topology Fingerprint and Snapshots
+
+std::vector<GraphEdge> ASGraph::getCanonicalEdges(unsigned threads) const {
+    std::vector<GraphEdge> edges;
+    edges.reserve(provider_customer_edges + peer_edges);
+
+    // Each edge is stored on both endpoints; emit it once, from the provider
+    // side for provider-customer edges and from the lower ASN for peers
+    for (const auto& pair : nodes) {
+        const ASNode& node = pair.second;
+
+        for (const auto& customer_ref : node.customers) {
+            ASN customer = customer_ref.get().asn;
+            if (node.asn < customer) {
+                edges.push_back({node.asn, customer, RelationType::CUSTOMER});
+            } else {
+                edges.push_back({customer, node.asn, RelationType::PROVIDER});
+            }
+        }
+
+        for (const auto& peer_ref : node.peers) {
+            ASN peer = peer_ref.get().asn;
+            if (node.asn < peer) {
+                edges.push_back({node.asn, peer, RelationType::PEER});
+            }
+        }
+    }
+
+    parallelSort(edges, threads, std::less<GraphEdge>());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    return edges;
+}
+
+namespace {
+    constexpr uint64_t NODE_SALT = 0x6a09e667f3bcc908ULL;
+    constexpr uint64_t EDGE_SALT = 0xbb67ae8584caa73bULL;
+    constexpr uint64_t LANE_SALT = 0x3c6ef372fe94f82bULL;
+
+    // Two independent 64-bit sums of per-element hashes
+    // Addition commutes, so chunks can be summed in any order on any thread
+    struct LaneSums {
+        uint64_t lane1 = 0;
+        uint64_t lane2 = 0;
+
+        void add(uint64_t element_hash) {
+            lane1 += element_hash;
+            lane2 += mix64(element_hash ^ LANE_SALT);
+        }
+        void add(const LaneSums& other) {
+            lane1 += other.lane1;
+            lane2 += other.lane2;
+        }
+    };
+
+    template <typename T, typename HashFn>
+    LaneSums parallelLaneSums(const std::vector<T>& items, unsigned threads, HashFn hash) {
+        if (threads == 0) threads = defaultThreadCount();
+        std::vector<LaneSums> partial(threads);
+
+        parallelFor(items.size(), threads, [&](size_t begin, size_t end, unsigned worker) {
+            LaneSums local;
+            for (size_t i = begin; i < end; i++) {
+                local.add(hash(items[i]));
+            }
+            partial[worker] = local;
+        });
+
+        LaneSums total;
+        for (const LaneSums& p : partial) {
+            total.add(p);
+        }
+        return total;
+    }
+}
+
+namespace {
+    // Fingerprint of a node set and canonical edge list (any order)
+    Hash128 topologyFingerprint(const std::vector<ASN>& asns, const std::vector<GraphEdge>& edges,
+                                unsigned threads) {
+        LaneSums node_sums = parallelLaneSums(asns, threads, [](ASN asn) {
+            return mix64(asn ^ NODE_SALT);
+        });
+        LaneSums edge_sums = parallelLaneSums(edges, threads, [](const GraphEdge& e) {
+            uint64_t key = (static_cast<uint64_t>(e.as1) << 32) | e.as2;
+            return mix64(key ^ mix64(static_cast<uint64_t>(static_cast<int64_t>(e.rel)) + EDGE_SALT));
+        });
+
+        // Fold the sums and set sizes through the sequential hasher
+        ContentHasher hasher;
+        hasher.updateU64(asns.size());
+        hasher.updateU64(node_sums.lane1);
+        hasher.updateU64(node_sums.lane2);
+        hasher.updateU64(edges.size());
+        hasher.updateU64(edge_sums.lane1);
+        hasher.updateU64(edge_sums.lane2);
+        return hasher.digest();
+    }
+}
+
+Hash128 ASGraph::fingerprint(unsigned threads) const {
+    if (fingerprint_valid) {
+        return fingerprint_cache;
+    }
+
+    std::vector<ASN> asns;
+    asns.reserve(nodes.size());
+    for (const auto& pair : nodes) {
+        asns.push_back(pair.first);
+    }
+
+    fingerprint_cache = topologyFingerprint(asns, getCanonicalEdges(threads), threads);
+    fingerprint_valid = true;
+    return fingerprint_cache;
+}
+
+namespace {
+    const char SNAPSHOT_MAGIC[8] = {'B', 'G', 'P', 'S', 'N', 'A', 'P', '\0'};
+    constexpr uint32_t SNAPSHOT_VERSION = 1;
+
+    // Fixed-size header; integers are stored in host byte order
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t fingerprint_high;
+        uint64_t fingerprint_low;
+        uint64_t node_count;
+        uint64_t edge_count;
+    };
+
+    struct SnapshotEdge {
+        uint32_t as1;
+        uint32_t as2;
+        int32_t rel;
+    };
+}
+
+bool ASGraph::isSnapshotFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    if (!file.read(magic, sizeof(magic))) {
+        return false;
+    }
+    return std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+}
+
+bool ASGraph::saveSnapshot(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open file " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    std::vector<ASN> asns;
+    asns.reserve(nodes.size());
+    for (const auto& pair : nodes) {
+        asns.push_back(pair.first);
+    }
+    std::sort(asns.begin(), asns.end());
+
+    std::vector<GraphEdge> edges = getCanonicalEdges();
+    std::vector<SnapshotEdge> records;
+    records.reserve(edges.size());
+    for (const GraphEdge& e : edges) {
+        records.push_back({e.as1, e.as2, static_cast<int32_t>(e.rel)});
+    }
+
+    Hash128 fp = fingerprint();
+
+    SnapshotHeader header;
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.reserved = 0;
+    header.fingerprint_high = fp.high;
+    header.fingerprint_low = fp.low;
+    header.node_count = asns.size();
+    header.edge_count = records.size();
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(asns.data()), asns.size() * sizeof(ASN));
+    file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(SnapshotEdge));
+    file.close();
+
+    if (!file) {
+        std::cerr << "Error: Failed writing snapshot " << filename << std::endl;
+        return false;
+    }
+
+    std::cout << "Saved snapshot " << filename << " (" << asns.size() << " nodes, "
+              << records.size() << " edges, fingerprint " << fp.toHex() << ")" << std::endl;
+    return true;
+}
+
+bool ASGraph::readSnapshot(const std::string& filename, std::vector<ASN>& asns,
+                           std::vector<GraphEdge>& edges, Hash128& fp) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open file " << filename << std::endl;
+        return false;
+    }
+
+    SnapshotHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        std::cerr << "Error: " << filename << " is not a graph snapshot" << std::endl;
+        return false;
+    }
+    if (header.version != SNAPSHOT_VERSION) {
+        std::cerr << "Error: Unsupported snapshot version " << header.version << std::endl;
+        return false;
+    }
+
+    // Check the counts against the file size before allocating for them
+    file.seekg(0, std::ios::end);
+    uint64_t payload = static_cast<uint64_t>(file.tellg()) - sizeof(header);
+    file.seekg(sizeof(header));
+    if (header.node_count > payload / sizeof(ASN) ||
+        header.edge_count > (payload - header.node_count * sizeof(ASN)) / sizeof(SnapshotEdge) ||
+        header.node_count * sizeof(ASN) + header.edge_count * sizeof(SnapshotEdge) != payload) {
+        std::cerr << "Error: Snapshot " << filename << " is truncated or has a corrupt header" << std::endl;
+        return false;
+    }
+
+    asns.resize(header.node_count);
+    std::vector<SnapshotEdge> records(header.edge_count);
+    file.read(reinterpret_cast<char*>(asns.data()), asns.size() * sizeof(ASN));
+    file.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(SnapshotEdge));
+    if (!file) {
+        std::cerr << "Error: Truncated snapshot " << filename << std::endl;
+        return false;
+    }
+
+    edges.clear();
+    edges.reserve(records.size());
+    for (const SnapshotEdge& e : records) {
+        edges.push_back({e.as1, e.as2, static_cast<RelationType>(e.rel)});
+    }
+
+    // The stored fingerprint keys cached results, so it must match the content
+    fp = Hash128(header.fingerprint_high, header.fingerprint_low);
+    if (topologyFingerprint(asns, edges, 0) != fp) {
+        std::cerr << "Error: Snapshot " << filename << " does not match its stored fingerprint" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ASGraph::loadSnapshot(const std::string& filename) {
+    std::cout << "Loading graph snapshot from " << filename << "..." << std::endl;
+
+    std::vector<ASN> asns;
+    std::vector<GraphEdge> edges;
+    Hash128 stored_fingerprint;
+    if (!readSnapshot(filename, asns, edges, stored_fingerprint)) {
+        return false;
+    }
+
+    bool was_empty = nodes.empty();
+    if (asns.size() > nodes.bucket_count()) {
+        reserveNodes(asns.size() + asns.size() / 5);
+    }
+
+    for (ASN asn : asns) {
+        getOrCreateNode(asn);
+    }
+    for (const GraphEdge& e : edges) {
+        addRelationship(e.as1, e.as2, e.rel);
+    }
+
+    // The stored fingerprint was checked against the content in readSnapshot;
+    // reuse it only if the graph holds exactly that content
+    if (was_empty && nodes.size() == asns.size() &&
+        provider_customer_edges + peer_edges == edges.size()) {
+        fingerprint_cache = stored_fingerprint;
+        fingerprint_valid = true;
+    }
+
+    std::cout << "Snapshot loaded:" << std::endl;
+    std::cout << "  Nodes (ASes): " << nodes.size() << std::endl;
+    std::cout << "  Provider-Customer edges: " << provider_customer_edges << std::endl;
+    std::cout << "  Peer edges: " << peer_edges << std::endl;
+    std::cout << "  Fingerprint: " << fingerprint().toHex() << std::endl;
+
+    return true;
+}
+
+// BGP Functionality Implementation
+
+#include "bgp_policy.h"
+#include <fstream>
+#include <queue>
+#include <algorithm>
+
+ASNode::~ASNode() {
+    delete policy;
+}
+
+void ASGraph::initializeBGP() {
+    std::cout << "Initializing BGP policies for all nodes..." << std::endl;
+
+    // ASes listed as ROV, ASPA or path-end deployers (e.g. added by a topology diff) start with that policy
+    for (auto& pair : nodes) {
+        ASNode& node = pair.second;
+        if (node.policy == nullptr) {
+            node.policy = createPolicy(node.asn);
+        }
+    }
+
+    std::cout << "BGP policies initialized for " << nodes.size() << " nodes" << std::endl;
+}
+
+void ASGraph::flattenGraph() {
+    std::cout << "Flattening graph (assigning propagation ranks)..." << std::endl;
+
+    // BFS to assign ranks
+    // Rank 0 = ASes with no customers (edges)
+    // Rank increases as we go up the provider chain
+    // Each AS rank = MAX(all customer ranks) + 1
+
+    std::unordered_map<ASN, int> ranks;
+    std::unordered_map<ASN, int> customer_count; // Track how many customers are unranked
+
+    // Initialize: rank 0 for nodes with no customers, count customers for others
+    std::queue<ASN> ready_queue;
+    for (auto& pair : nodes) {
+        ASNode& node = pair.second;
+        if (node.customers.empty()) {
+            ranks[node.asn] = 0;
+            ready_queue.push(node.asn);
+        } else {
+            customer_count[node.asn] = node.customers.size();
+        }
+    }
+
+    // Process nodes in topological order
+    int max_rank = 0;
+    while (!ready_queue.empty()) {
+        ASN current = ready_queue.front();
+        ready_queue.pop();
+
+        ASNode* node = getNode(current);
+        if (!node) continue;
+
+        int current_rank = ranks[current];
+
+        // Update all providers of this node
+        for (auto& provider_ref : node->providers) {
+            ASNode& provider = provider_ref.get();
+            ASN provider_asn = provider.asn;
+
+            auto count_it = customer_count.find(provider_asn);
+            if (count_it == customer_count.end()) continue; // Already processed or no customers
+
+            // Update the rank if this customer has higher rank
+            int new_provider_rank = current_rank + 1;
+            auto rank_it = ranks.find(provider_asn);
+            if (rank_it == ranks.end()) {
+                ranks[provider_asn] = new_provider_rank;
+            } else {
+                ranks[provider_asn] = std::max(ranks[provider_asn], new_provider_rank);
+            }
+
+            // Decrement customer count
+            count_it->second--;
+            if (count_it->second == 0) {
+                // All customers of this provider are ranked, so provider is ready
+                ready_queue.push(provider_asn);
+                customer_count.erase(count_it);
+                max_rank = std::max(max_rank, ranks[provider_asn]);
+            }
+        }
+    }
+
+    // Assign propagation_rank to each node and build ranked_ases vector
+    ranked_ases.clear();
+    ranked_ases.resize(max_rank + 1);
+
+    for (auto& pair : nodes) {
+        ASNode& node = pair.second;
+        int rank = ranks[node.asn];
+        node.propagation_rank = rank;
+        ranked_ases[rank].push_back(node.asn);
+    }
+
+    std::cout << "Graph flattened. Max rank: " << max_rank << std::endl;
+    for (size_t i = 0; i < ranked_ases.size(); i++) {
+        std::cout << "  Rank " << i << ": " << ranked_ases[i].size() << " ASes" << std::endl;
+    }
+}
+
+
+void ASGraph::setPropagationThreads(unsigned threads, bool numa) {
+    if (threads == 0) threads = defaultThreadCount();
+    if (threads != propagation_threads || numa != numa_aware) {
+        parallel_engine.reset();
+    }
+    propagation_threads = threads;
+    numa_aware = numa;
+}
+
+size_t ASGraph::propagateAnnouncements() {
+    if (route_selection != RouteSelection::STANDARD) {
+        std::cout << "Route selection: " << routeSelectionName(route_selection);
+        if (route_selection == RouteSelection::HASH_TIE_BREAK) {
+            std::cout << " (seed " << selection_seed << ")";
+        }
+        std::cout << std::endl;
+    }
+    return withRouteSelection(route_selection, selection_seed,
+                              [this](const auto& selection) { return propagateWith(selection); });
+}
+
+template <typename S>
+size_t ASGraph::propagateWith(const S& selection) {
+    if (leakers.empty()) {
+        return propagateValleyFree(selection);
+    }
+
+    // Leaks are resolved over complete RIBs, so retention is applied afterwards
+    std::unordered_set<ASN> retained;
+    retained.swap(vantage_points);
+    propagateValleyFree(selection);
+    vantage_points.swap(retained);
+    return propagateLeaks(selection);
+}
+
+template <typename S>
+size_t ASGraph::propagateValleyFree(const S& selection) {
+    bool both_families = seeded_ipv4 && seeded_ipv6;
+
+    if (propagation_threads > 1) {
+        std::cout << "Propagating announcements (" << propagation_threads << " threads"
+                  << (numa_aware ? ", NUMA-pinned" : "") << ")..." << std::endl;
+        if (!parallel_engine) {
+            parallel_engine.reset(new ParallelPropagator(*this, propagation_threads, numa_aware));
+        }
+
+        // Each family already uses every worker, so they run one after the other
+        size_t total = 0;
+        released_routes = 0;
+        if (seeded_ipv4 || !seeded_ipv6) {
+            if (both_families) std::cout << "  IPv4:" << std::endl;
+            size_t released = 0;
+            total += parallel_engine->propagate<IPv4Prefix>(released, selection);
+            released_routes += released;
+        }
+        if (seeded_ipv6) {
+            if (both_families) std::cout << "  IPv6:" << std::endl;
+            size_t released = 0;
+            total += parallel_engine->propagate<IPv6Prefix>(released, selection);
+            released_routes += released;
+        }
+
+        std::cout << "Propagation complete. Total announcements: " << total << std::endl;
+        if (!vantage_points.empty()) {
+            std::cout << "Retained " << (total - released_routes) << " routes at "
+                      << vantage_points.size() << " vantage points" << std::endl;
+        }
+        return total;
+    }
+
+    std::cout << "Propagating announcements..." << std::endl;
+
+    size_t total_propagated = 0;
+
+    if (both_families) {
+        // The families share no routing state: IPv6 runs on its own thread
+        std::cout << "  IPv4 and IPv6 engines running concurrently..." << std::endl;
+        size_t released6 = 0;
+        std::thread ipv6_engine([&] { released6 = propagateFamily<IPv6Prefix>(selection, false); });
+        released_routes = propagateFamily<IPv4Prefix>(selection, false);
+        ipv6_engine.join();
+        released_routes += released6;
+    } else if (seeded_ipv6) {
+        released_routes = propagateFamily<IPv6Prefix>(selection, true);
+    } else {
+        released_routes = propagateFamily<IPv4Prefix>(selection, true);
+    }
+
+    // Count total announcements
+    for (const auto& pair : nodes) {
+        total_propagated += pair.second.policy->getLocalRIBSize();
+    }
+    total_propagated += released_routes;
+
+    std::cout << "Propagation complete. Total announcements: " << total_propagated << std::endl;
+    if (!vantage_points.empty()) {
+        std::cout << "Retained " << (total_propagated - released_routes) << " routes at "
+                  << vantage_points.size() << " vantage points" << std::endl;
+    }
+    return total_propagated;
+}
+
+template <typename S>
+size_t ASGraph::propagateLeaks(const S& selection) {
+    std::cout << "Propagating route leaks (" << leakers.size() << " leakers)..." << std::endl;
+
+    LeakPropagator engine(*this);
+    leak_stats = LeakStats();
+    auto add = [this](const LeakStats& stats) {
+        leak_stats.rounds = std::max(leak_stats.rounds, stats.rounds);
+        leak_stats.evaluations += stats.evaluations;
+        leak_stats.updates += stats.updates;
+        leak_stats.converged = leak_stats.converged && stats.converged;
+    };
+    if (seeded_ipv4 || !seeded_ipv6) {
+        add(engine.propagate<IPv4Prefix>(selection, leak_round_limit));
+    }
+    if (seeded_ipv6) {
+        add(engine.propagate<IPv6Prefix>(selection, leak_round_limit));
+    }
+
+    if (leak_stats.converged) {
+        std::cout << "Route leaks converged after " << leak_stats.rounds << " rounds: "
+                  << leak_stats.updates << " routes changed, " << leak_stats.evaluations
+                  << " re-selected" << std::endl;
+    } else {
+        std::cerr << "Warning: Route leaks did not converge within " << leak_round_limit
+                  << " rounds; routes are those of the last round" << std::endl;
+    }
+
+    size_t total = 0;
+    released_routes = 0;
+    for (auto& pair : nodes) {
+        if (!pair.second.policy) continue;
+        total += pair.second.policy->getLocalRIBSize();
+        if (!retainsRIB(pair.first)) {
+            released_routes += pair.second.policy->releaseLocalRIB<IPv4Prefix>();
+            released_routes += pair.second.policy->releaseLocalRIB<IPv6Prefix>();
+        }
+    }
+
+    std::cout << "Total announcements after leaks: " << total << std::endl;
+    if (!vantage_points.empty()) {
+        std::cout << "Retained " << (total - released_routes) << " routes at "
+                  << vantage_points.size() << " vantage points" << std::endl;
+    }
+    return total;
+}
+
+template <typename P, typename S>
+size_t ASGraph::propagateFamily(const S& selection, bool verbose) {
+    // Phase 1: UP (to providers)
+    propagateUp<P>(selection, verbose);
+
+    // Phase 2: ACROSS (to peers, one hop only)
+    propagateAcross<P>(selection, verbose);
+
+    // Phase 3: DOWN (to customers)
+    return propagateDown<P>(selection, verbose);
+}
+
+template <typename P, typename S>
+void ASGraph::propagateUp(const S& selection, bool verbose) {
+    if (verbose) std::cout << "  Phase 1: Propagating UP (to providers)..." << std::endl;
+
+    // Go from rank 0 upwards
+    for (size_t rank = 0; rank < ranked_ases.size(); rank++) {
+        // Send announcements from this rank
+        for (ASN asn : ranked_ases[rank]) {
+            auto node_it = nodes.find(asn);
+            if (node_it == nodes.end() || !node_it->second.policy) continue;
+
+            ASNode& node = node_it->second;
+            if (node.providers.empty()) continue;
+
+            const auto& local_rib = node.policy->getLocalRIB<P>();
+            if (local_rib.empty()) continue;
+
+            // Send to providers (only announcements from customers or origin)
+            for (const auto& rib_pair : local_rib) {
+                const Announcement& ann = rib_pair.second;
+
+                // Valley-free routing: only send to providers if learned from customer or origin
+                if (ann.received_from != RelationshipType::CUSTOMER &&
+                    ann.received_from != RelationshipType::ORIGIN) {
+                    continue;
+                }
+
+                for (auto& provider_ref : node.providers) {
+                    ASNode& provider = provider_ref.get();
+
+                    // Don't send if provider is in AS path (loop prevention)
+                    if (ann.containsAS(provider.asn)) continue;
+                    if (!provider.policy) continue;
+
+                    Announcement new_ann = ann.copy_with_new_hop(asn, RelationshipType::CUSTOMER);
+                    provider.policy->receiveAnnouncement(rib_pair.first, std::move(new_ann));
+                }
+            }
+        }
+
+        // Process received queue for next rank
+        if (rank + 1 < ranked_ases.size()) {
+            for (ASN asn : ranked_ases[rank + 1]) {
+                auto node_it = nodes.find(asn);
+                if (node_it != nodes.end() && node_it->second.policy) {
+                    node_it->second.policy->processReceivedQueue<P>(asn, selection);
+                    node_it->second.policy->clearReceivedQueue<P>();
+                }
+            }
+        }
+    }
+}
+
+template <typename P, typename S>
+void ASGraph::propagateAcross(const S& selection, bool verbose) {
+    if (verbose) std::cout << "  Phase 2: Propagating ACROSS (to peers)..." << std::endl;
+
+    // Send from ALL ASes - optimize by avoiding repeated lookups
+    for (auto& pair : nodes) {
+        ASNode& node = pair.second;
+        if (!node.policy || node.peers.empty()) continue;
+
+        const auto& local_rib = node.policy->getLocalRIB<P>();
+        if (local_rib.empty()) continue;
+
+        for (const auto& rib_pair : local_rib) {
+            const Announcement& ann = rib_pair.second;
+
+            // Valley-free routing: only send to peers if learned from customer or origin
+            if (ann.received_from != RelationshipType::CUSTOMER &&
+                ann.received_from != RelationshipType::ORIGIN) {
+                continue;
+            }
+
+            // Cache to avoid redundant containsAS checks for same peer
+            for (auto& peer_ref : node.peers) {
+                ASNode& peer = peer_ref.get();
+
+                // Don't send if peer is in AS path (loop prevention)
+                if (ann.containsAS(peer.asn)) continue;
+                if (!peer.policy) continue;
+
+                Announcement new_ann = ann.copy_with_new_hop(node.asn, RelationshipType::PEER);
+                peer.policy->receiveAnnouncement(rib_pair.first, std::move(new_ann));
+            }
+        }
+    }
+
+    // Process ALL at once (to prevent multiple hops)
+    for (auto& pair : nodes) {
+        if (pair.second.policy) {
+            pair.second.policy->processReceivedQueue<P>(pair.second.asn, selection);
+            pair.second.policy->clearReceivedQueue<P>();
+        }
+    }
+}
+
+template <typename P, typename S>
+size_t ASGraph::propagateDown(const S& selection, bool verbose) {
+    if (verbose) std::cout << "  Phase 3: Propagating DOWN (to customers)..." << std::endl;
+    size_t released = 0;
+
+    // With retention, a stub (no customers) is processed and freed right after its
+    // lowest-ranked provider has sent, instead of queueing routes until rank 0
+    std::vector<std::vector<ASNode*>> stubs_ready(ranked_ases.size());
+    if (!vantage_points.empty() && !ranked_ases.empty()) {
+        for (ASN asn : ranked_ases[0]) {
+            ASNode* node = getNode(asn);
+            if (!node || !node->policy || node->providers.empty() || retainsRIB(asn)) continue;
+
+            int last_sender = static_cast<int>(ranked_ases.size()) - 1;
+            for (const auto& provider_ref : node->providers) {
+                last_sender = std::min(last_sender, provider_ref.get().propagation_rank);
+            }
+            stubs_ready[std::max(last_sender, 0)].push_back(node);
+        }
+    }
+
+    // Go from highest rank downwards
+    for (int rank = ranked_ases.size() - 1; rank >= 0; rank--) {
+        // Send announcements
+        for (ASN asn : ranked_ases[rank]) {
+            auto node_it = nodes.find(asn);
+            if (node_it == nodes.end() || !node_it->second.policy) continue;
+
+            ASNode& node = node_it->second;
+            if (node.customers.empty()) continue;
+
+            const auto& local_rib = node.policy->getLocalRIB<P>();
+            if (local_rib.empty()) continue;
+
+            // Send all announcements to customers
+            for (const auto& rib_pair : local_rib) {
+                const Announcement& ann = rib_pair.second;
+
+                for (auto& customer_ref : node.customers) {
+                    ASNode& customer = customer_ref.get();
+
+                    // Don't send if customer is in AS path
+                    if (ann.containsAS(customer.asn)) continue;
+                    if (!customer.policy) continue;
+
+                    Announcement new_ann = ann.copy_with_new_hop(asn, RelationshipType::PROVIDER);
+                    customer.policy->receiveAnnouncement(rib_pair.first, std::move(new_ann));
+                }
+            }
+
+            // Nothing reads this RIB any more
+            if (!retainsRIB(asn)) {
+                released += node.policy->releaseLocalRIB<P>();
+            }
+        }
+
+        for (ASNode* stub : stubs_ready[rank]) {
+            stub->policy->processReceivedQueue<P>(stub->asn, selection);
+            released += stub->policy->releaseLocalRIB<P>();
+        }
+
+        // Process received queue for next rank down
+        if (rank - 1 >= 0) {
+            for (ASN asn : ranked_ases[rank - 1]) {
+                auto node_it = nodes.find(asn);
+                if (node_it != nodes.end() && node_it->second.policy) {
+                    ASNode& node = node_it->second;
+                    node.policy->processReceivedQueue<P>(asn, selection);
+                    node.policy->clearReceivedQueue<P>();
+
+                    // Without customers the RIB is final and unread once processed
+                    if (node.customers.empty() && !retainsRIB(asn)) {
+                        released += node.policy->releaseLocalRIB<P>();
+                    }
+                }
+            }
+        }
+    }
+
+    // Leftovers: ASes the rank loops never reached after their last update
+    if (!vantage_points.empty()) {
+        for (auto& pair : nodes) {
+            if (pair.second.policy && !retainsRIB(pair.first)) {
+                released += pair.second.policy->releaseLocalRIB<P>();
+            }
+        }
+    }
+    return released;
+}
+
+bool ASGraph::exportToCSV(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open file " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    // Write header
+    file << "asn,prefix,as_path\n";
+
+    // Write all announcements
+    size_t count = 0;
+    for (const auto& node_pair : nodes) {
+        const ASNode& node = node_pair.second;
+        if (!node.policy) continue;
+
+        node.policy->forEachRoute([&](const Prefix& prefix, const Announcement& ann) {
+            // Format: asn,prefix,"as1 as2 as3"
+            file << node.asn << "," << prefix.toString() << ",\"";
+
+            for (size_t i = 0; i < ann.as_path.size(); i++) {
+                if (i > 0) file << " ";
+                file << ann.as_path[i];
+            }
+
+            file << "\"\n";
+            count++;
+        });
+    }
+
+    file.close();
+    std::cout << "Exported " << count << " announcements to " << filename << std::endl;
+    return true;
+}
+
+// ROV Functionality Implementation
+
+void ASGraph::seedAnnouncement(ASN origin_asn, const std::string& prefix_str, bool rov_invalid) {
+    ASNode* node = getNode(origin_asn);
+    if (!node || !node->policy) {
+        std::cerr << "Error: Cannot seed announcement at AS" << origin_asn << std::endl;
+        return;
+    }
+
+    Prefix prefix = Prefix::parse(prefix_str);
+    Announcement ann(origin_asn, RelationshipType::ORIGIN, rov_invalid);
+
+    node->policy->seedAnnouncement(prefix, ann);
+    (prefix.is_ipv6 ? seeded_ipv6 : seeded_ipv4) = true;
+    seeds.push_back({origin_asn, prefix.toString(), rov_invalid});
+
+    if (rov_invalid) {
+        std::cout << "Seeded ROV INVALID announcement " << prefix_str << " at AS" << origin_asn << std::endl;
+    } else {
+        std::cout << "Seeded announcement " << prefix_str << " at AS" << origin_asn << std::endl;
+    }
+}
+
+bool ASGraph::loadROVASNs(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open ROV ASN file " << filename << std::endl;
+        return false;
+    }
+
+    std::cout << "Loading ROV ASNs from " << filename << "..." << std::endl;
+
+    std::string line;
+    size_t loaded = 0;
+    size_t upgraded = 0;
+
+    while (std::getline(file, line)) {
+        // Skip empty lines and comments
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        // Parse ASN
+        ASN asn = static_cast<ASN>(std::strtoul(line.c_str(), nullptr, 10));
+        
+        if (asn == 0) {
+            continue; // Invalid ASN
+        }
+
+        rov_asns.insert(asn);
+        loaded++;
+
+        // Upgrade policy to ROV if AS exists
+        ASNode* node = getNode(asn);
+        if (node && node->policy) {
+            // Replace BGP with ROV (or ASPA with ROV filtering)
+            delete node->policy;
+            node->policy = createPolicy(asn);
+            upgraded++;
+        }
+    }
+
+    file.close();
+
+    std::cout << "Loaded " << loaded << " ROV ASNs" << std::endl;
+    std::cout << "Upgraded " << upgraded << " ASes to ROV policy" << std::endl;
+
+    return true;
+}
+
+BGPPolicy* ASGraph::createPolicy(ASN asn) const {
+    bool rov = rov_asns.count(asn) > 0;
+    if (aspa_asns.count(asn)) {
+        return new ASPA(aspa_table, rov);
+    }
+    if (pathend_asns.count(asn)) {
+        return new PathEnd(pathend_table, rov);
+    }
+    if (rov) {
+        return new ROV();
+    }
+    return new BGP();
+}
+
+namespace {
+    // One ASN per line; '#' comments and blank lines are skipped
+    bool readASNSetFile(const std::string& filename, std::unordered_set<ASN>& asns) {
+        std::ifstream file(filename);
+        if (!file.is_open()) {
+            return false;
+        }
+
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.empty() || line[0] == '#') {
+                continue;
+            }
+            ASN asn = static_cast<ASN>(std::strtoul(line.c_str(), nullptr, 10));
+            if (asn != 0) {
+                asns.insert(asn);
+            }
+        }
+        return true;
+    }
+}
+
+bool ASGraph::loadASPAASNs(const std::string& filename) {
+    std::unordered_set<ASN> asns;
+    if (!readASNSetFile(filename, asns)) {
+        std::cerr << "Error: Cannot open ASPA ASN file " << filename << std::endl;
+        return false;
+    }
+
+    std::cout << "Loading ASPA ASNs from " << filename << "..." << std::endl;
+    setASPAASNs(asns);
+    std::cout << "Loaded " << aspa_asns.size() << " ASPA ASNs" << std::endl;
+    return true;
+}
+
+void ASGraph::setASPAASNs(const std::unordered_set<ASN>& asns) {
+    updateDeployers(aspa_asns, asns);
+}
+
+bool ASGraph::loadPathEndASNs(const std::string& filename) {
+    std::unordered_set<ASN> asns;
+    if (!readASNSetFile(filename, asns)) {
+        std::cerr << "Error: Cannot open path-end ASN file " << filename << std::endl;
+        return false;
+    }
+
+    std::cout << "Loading path-end ASNs from " << filename << "..." << std::endl;
+    setPathEndASNs(asns);
+    std::cout << "Loaded " << pathend_asns.size() << " path-end ASNs" << std::endl;
+    return true;
+}
+
+void ASGraph::setPathEndASNs(const std::unordered_set<ASN>& asns) {
+    updateDeployers(pathend_asns, asns);
+}
+
+void ASGraph::updateDeployers(std::unordered_set<ASN>& deployers, const std::unordered_set<ASN>& asns) {
+    // Only ASes that join or leave the set get a new policy
+    std::vector<ASN> changed;
+    for (ASN asn : deployers) {
+        if (!asns.count(asn)) changed.push_back(asn);
+    }
+    for (ASN asn : asns) {
+        if (!deployers.count(asn)) changed.push_back(asn);
+    }
+
+    deployers = asns;
+    for (ASN asn : changed) {
+        ASNode* node = getNode(asn);
+        if (node && node->policy) {
+            delete node->policy;
+            node->policy = createPolicy(asn);
+        }
+    }
+}
+
+void ASGraph::resetRoutingState() {
+    for (auto& pair : nodes) {
+        if (pair.second.policy) {
+            pair.second.policy->reset();
+        }
+    }
+    seeds.clear();
+    seeded_ipv4 = seeded_ipv6 = false;
+}
+
+size_t ASGraph::getROVASNCount() const {
+    return rov_asns.size();
+}
+
+bool ASGraph::loadVantagePoints(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open vantage point file " << filename << std::endl;
+        return false;
+    }
+
+    std::unordered_set<ASN> loaded;
+    size_t missing = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        ASN asn = static_cast<ASN>(std::strtoul(line.c_str(), nullptr, 10));
+        if (asn == 0) {
+            continue;
+        }
+        if (!hasNode(asn)) {
+            missing++;
+        }
+        loaded.insert(asn);
+    }
+
+    if (loaded.empty()) {
+        std::cerr << "Error: No vantage point ASNs in " << filename << std::endl;
+        return false;
+    }
+
+    vantage_points.swap(loaded);
+    std::cout << "Loaded " << vantage_points.size() << " vantage points";
+    if (missing > 0) {
+        std::cout << " (" << missing << " not in the graph)";
+    }
+    std::cout << std::endl;
+    return true;
+}
+
+bool ASGraph::loadLeakers(const std::string& filename, LeakPolicy default_policy) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open leaker file " << filename << std::endl;
+        return false;
+    }
+
+    std::cout << "Loading route leakers from " << filename << "..." << std::endl;
+
+    // One AS per line, optionally followed by its policy ("64500,providers")
+    std::unordered_map<ASN, LeakPolicy> loaded;
+    size_t skipped = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        char* end = nullptr;
+        ASN asn = static_cast<ASN>(std::strtoul(line.c_str(), &end, 10));
+        if (asn == 0) {
+            continue;
+        }
+
+        std::string rest(end);
+        rest.erase(0, rest.find_first_not_of(",| \t"));
+        rest.erase(rest.find_last_not_of(" \t\r") + 1);
+
+        LeakPolicy policy = default_policy;
+        if (!rest.empty() && !parseLeakPolicy(rest, policy)) {
+            skipped++;
+            continue;
+        }
+        loaded[asn] = policy;
+    }
+
+    if (skipped > 0) {
+        std::cerr << "Warning: Skipped " << skipped << " lines with an unknown leak policy in "
+                  << filename << std::endl;
+    }
+
+    leakers.swap(loaded);
+    std::cout << "Loaded " << leakers.size() << " route leakers" << std::endl;
+    return true;
+}
@@ -0,0 +1,234 @@
+#include "aspa.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+const char* aspaStateName(AspaState state) {
+    switch (state) {
+        case AspaState::VALID: return "valid";
+        case AspaState::INVALID: return "invalid";
+        case AspaState::UNKNOWN:
+        default: return "unknown";
+    }
+}
+
+namespace {
+    std::atomic<uint64_t> next_generation{1};
+
+    // Per-thread, direct-mapped cache of path-suffix ramps
+    // Suffixes are stored in full and compared on lookup, so a hit is exact;
+    // longer suffixes are not cached (their shorter suffixes still are).
+    constexpr size_t CACHE_SLOTS = 4096;
+    constexpr size_t CACHED_PATH_MAX = 8;
+
+    struct CacheSlot {
+        uint64_t generation = 0;
+        uint32_t length = 0;
+        ASN path[CACHED_PATH_MAX];
+        AspaRamps ramps;
+    };
+
+    thread_local std::vector<CacheSlot> ramp_cache;
+
+    inline uint64_t mixHash(uint64_t hash, ASN asn) {
+        hash = (hash ^ asn) * 0x9E3779B97F4A7C15ULL;
+        return hash ^ (hash >> 29);
+    }
+}
+
+void AspaTable::assign(std::vector<std::pair<ASN, ASN>> pairs) {
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    customers.clear();
+    offsets.clear();
+    providers.clear();
+
+    for (const auto& pair : pairs) {
+        if (customers.empty() || customers.back() != pair.first) {
+            customers.push_back(pair.first);
+            offsets.push_back(static_cast<uint32_t>(providers.size()));
+        }
+        if (pair.second != 0) {
+            providers.push_back(pair.second);
+        }
+    }
+    offsets.push_back(static_cast<uint32_t>(providers.size()));
+
+    customers.shrink_to_fit();
+    offsets.shrink_to_fit();
+    providers.shrink_to_fit();
+    generation = next_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool readASNRecordFile(const std::string& filename, std::vector<std::pair<ASN, ASN>>& pairs,
+                       size_t& skipped) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::vector<ASN> fields;
+    std::string line;
+    bool first_line = true;
+    skipped = 0;
+
+    while (std::getline(file, line)) {
+        bool header = first_line;
+        first_line = false;
+        if (line.empty() || line[0] == '#') continue;
+
+        // Split on anything that is not part of an ASN
+        fields.clear();
+        bool malformed = false;
+        for (size_t i = 0; i < line.size();) {
+            if (line[i] == ',' || line[i] == '|' || std::isspace(static_cast<unsigned char>(line[i]))) {
+                i++;
+                continue;
+            }
+            size_t start = i;
+            if ((line[i] == 'A' || line[i] == 'a') && i + 1 < line.size() && (line[i + 1] == 'S' || line[i + 1] == 's')) {
+                start = i += 2;
+            }
+            while (i < line.size() && std::isdigit(static_cast<unsigned char>(line[i]))) i++;
+            if (i == start || (i < line.size() && line[i] != ',' && line[i] != '|' &&
+                               !std::isspace(static_cast<unsigned char>(line[i])))) {
+                malformed = true;
+                break;
+            }
+            fields.push_back(static_cast<ASN>(std::strtoul(line.c_str() + start, nullptr, 10)));
+        }
+
+        if (malformed || fields.empty() || fields[0] == 0) {
+            if (!header) skipped++;
+            continue;
+        }
+
+        if (fields.size() == 1) {
+            pairs.push_back({fields[0], 0});
+        }
+        for (size_t i = 1; i < fields.size(); i++) {
+            pairs.push_back({fields[0], fields[i]});
+        }
+    }
+    return true;
+}
+
+bool AspaTable::loadFromFile(const std::string& filename) {
+    std::cout << "Loading ASPA records from " << filename << "..." << std::endl;
+
+    std::vector<std::pair<ASN, ASN>> pairs;
+    size_t skipped = 0;
+    if (!readASNRecordFile(filename, pairs, skipped)) {
+        std::cerr << "Error: Cannot open ASPA file " << filename << std::endl;
+        return false;
+    }
+    assign(std::move(pairs));
+
+    if (skipped > 0) {
+        std::cerr << "Warning: Skipped " << skipped << " malformed lines in " << filename << std::endl;
+    }
+    std::cout << "Loaded ASPA records of " << customers.size() << " customer ASes ("
+              << providers.size() << " providers)" << std::endl;
+    return true;
+}
+
+AspaHop AspaTable::hop(ASN customer, ASN provider) const {
+    auto it = std::lower_bound(customers.begin(), customers.end(), customer);
+    if (it == customers.end() || *it != customer) {
+        return AspaHop::NO_ATTESTATION;
+    }
+
+    size_t id = it - customers.begin();
+    auto first = providers.begin() + offsets[id];
+    auto last = providers.begin() + offsets[id + 1];
+    return std::binary_search(first, last, provider) ? AspaHop::PROVIDER : AspaHop::NOT_PROVIDER;
+}
+
+// Ramps of [new_front, old_front, ...] from those of [old_front, ...] (length ASes)
+AspaRamps AspaTable::extend(const AspaRamps& ramps, uint32_t length, ASN old_front, ASN new_front) const {
+    AspaRamps result = ramps;
+
+    // Up ramps grow only while they still span the whole path
+    if (ramps.max_up == length) {
+        AspaHop up = hop(old_front, new_front);
+        if (up != AspaHop::NOT_PROVIDER) result.max_up++;
+        if (ramps.min_up == length && up == AspaHop::PROVIDER) result.min_up++;
+    }
+
+    // Down ramps restart at the new front unless old_front is its provider
+    AspaHop down = hop(new_front, old_front);
+    result.max_down = down != AspaHop::NOT_PROVIDER ? ramps.max_down + 1 : 1;
+    result.min_down = down == AspaHop::PROVIDER ? ramps.min_down + 1 : 1;
+    return result;
+}
+
+AspaRamps AspaTable::ramps(const ASN* path, size_t length) const {
+    if (length <= 1) {
+        return AspaRamps();
+    }
+
+    if (ramp_cache.empty()) {
+        ramp_cache.resize(CACHE_SLOTS);
+    }
+
+    // Hashes of the cacheable suffixes, shortest first
+    size_t cacheable = std::min(length, CACHED_PATH_MAX);
+    uint64_t hashes[CACHED_PATH_MAX];
+    uint64_t hash = 0;
+    for (size_t n = 1; n <= cacheable; n++) {
+        hash = mixHash(hash, path[length - n]);
+        hashes[n - 1] = hash;
+    }
+
+    auto slotOf = [](uint64_t h) -> CacheSlot& { return ramp_cache[h & (CACHE_SLOTS - 1)]; };
+
+    // Longest cached suffix of two or more ASes
+    size_t known = 1;
+    AspaRamps result;
+    for (size_t n = cacheable; n >= 2; n--) {
+        const CacheSlot& slot = slotOf(hashes[n - 1]);
+        if (slot.generation == generation && slot.length == n &&
+            std::equal(slot.path, slot.path + n, path + (length - n))) {
+            known = n;
+            result = slot.ramps;
+            break;
+        }
+    }
+
+    // Extend one hop at a time toward the front, caching short suffixes
+    for (size_t n = known + 1; n <= length; n++) {
+        const ASN* suffix = path + (length - n);
+        result = extend(result, static_cast<uint32_t>(n - 1), suffix[1], suffix[0]);
+
+        if (n <= CACHED_PATH_MAX) {
+            CacheSlot& slot = slotOf(hashes[n - 1]);
+            slot.generation = generation;
+            slot.length = static_cast<uint32_t>(n);
+            std::copy(suffix, suffix + n, slot.path);
+            slot.ramps = result;
+        }
+    }
+    return result;
+}
+
+AspaState AspaTable::verify(const ASN* path, size_t length, RelationshipType received_from) const {
+    if (length <= 1) {
+        return AspaState::VALID;
+    }
+
+    AspaRamps r = ramps(path, length);
+    if (received_from == RelationshipType::PROVIDER) {
+        if (r.max_up + r.max_down < length) return AspaState::INVALID;
+        if (r.min_up + r.min_down < length) return AspaState::UNKNOWN;
+        return AspaState::VALID;
+    }
+
+    // From a customer or peer: the whole path must be an up ramp
+    if (r.max_up < length) return AspaState::INVALID;
+    if (r.min_up < length) return AspaState::UNKNOWN;
+    return AspaState::VALID;
+}
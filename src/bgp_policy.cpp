@@ -1,78 +1,106 @@
-#include "bgp_policy.h"
-
-void BGPPolicy::receiveAnnouncement(const Announcement& ann) {
-    received_queue[ann.prefix].push_back(ann);
-}
-
-const Announcement* BGPPolicy::getAnnouncement(const Prefix& prefix) const {
-    auto it = local_rib.find(prefix);
-    return (it != local_rib.end()) ? &(it->second) : nullptr;
-}
-
-void BGPPolicy::clearReceivedQueue() {
-    received_queue.clear();
-}
-
-void BGPPolicy::seedAnnouncement(const Announcement& ann) {
-    local_rib[ann.prefix] = ann;
-}
-
-bool BGPPolicy::processReceivedQueue(ASN current_asn) {
-    // Base implementation - should be overridden
-    (void)current_asn; // Unused
-    return false;
-}
-
-bool BGP::processReceivedQueue(ASN current_asn) {
-    bool changed = false;
-
-    for (auto& pair : received_queue) {
-        const Prefix& prefix = pair.first;
-        std::vector<Announcement>& candidates = pair.second;
-
-        if (candidates.empty()) {
-            continue;
-        }
-
-        // Find best announcement among candidates
-        const Announcement* best = &candidates[0];
-        for (size_t i = 1; i < candidates.size(); i++) {
-            if (candidates[i].isBetterThan(*best)) {
-                best = &candidates[i];
-            }
-        }
-
-        // IMPORTANT: Prepend current ASN to the path when storing
-        Announcement stored_ann = *best;
-        stored_ann.as_path.insert(stored_ann.as_path.begin(), current_asn);
-
-        // Check if we need to update local RIB
-        auto rib_it = local_rib.find(prefix);
-
-        if (rib_it == local_rib.end()) {
-            // No existing announcement, add the best one (with prepended ASN)
-            local_rib[prefix] = stored_ann;
-            changed = true;
-        } else {
-            // Compare with existing announcement
-            if (stored_ann.isBetterThan(rib_it->second)) {
-                rib_it->second = stored_ann;
-                changed = true;
-            }
-        }
-    }
-
-    return changed;
-}
-
-// ROV Implementation
-void ROV::receiveAnnouncement(const Announcement& ann) {
-    // Drop announcements with rov_invalid = true
-    if (ann.rov_invalid) {
-        dropped_count++;
-        return; // Do not add to received queue
-    }
-
-    // Otherwise, use standard BGP behavior
-    BGP::receiveAnnouncement(ann);
-}
+#include "bgp_policy.h"
+
+const Announcement* BGPPolicy::getAnnouncement(const Prefix& prefix) const {
+    if (prefix.is_ipv6) {
+        auto it = table6.local_rib.find(prefix.v6);
+        return (it != table6.local_rib.end()) ? &(it->second) : nullptr;
+    }
+    auto it = table4.local_rib.find(prefix.v4);
+    return (it != table4.local_rib.end()) ? &(it->second) : nullptr;
+}
+
+void BGPPolicy::reset() {
+    table4.local_rib.clear();
+    table4.received_queue.clear();
+    table6.local_rib.clear();
+    table6.received_queue.clear();
+}
+
+void BGPPolicy::seedAnnouncement(const Prefix& prefix, const Announcement& ann) {
+    if (prefix.is_ipv6) {
+        table6.local_rib[prefix.v6] = ann;
+    } else {
+        table4.local_rib[prefix.v4] = ann;
+    }
+}
+
+// ROV Implementation
+bool ROV::acceptAnnouncement(Announcement& ann) {
+    // Drop announcements with rov_invalid = true
+    if (!ROV::admits(ann)) {
+        dropped_count.fetch_add(1, std::memory_order_relaxed);
+        return false; // Do not add to received queue
+    }
+
+    // Otherwise, use standard BGP behavior
+    return true;
+}
+
+void ROV::reset() {
+    BGP::reset();
+    dropped_count.store(0, std::memory_order_relaxed);
+}
+
+// ASPA Implementation
+bool ASPA::admits(Announcement& ann) const {
+    if (filter_rov && ann.rov_invalid) {
+        return false;
+    }
+    return table.verify(ann.as_path.data(), ann.as_path.size(), ann.received_from) != AspaState::INVALID;
+}
+
+bool ASPA::acceptAnnouncement(Announcement& ann) {
+    if (ASPA::admits(ann)) {
+        return true;
+    }
+    if (filter_rov && ann.rov_invalid) {
+        rov_dropped_count.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        dropped_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    return false;
+}
+
+void ASPA::reset() {
+    BGP::reset();
+    dropped_count.store(0, std::memory_order_relaxed);
+    rov_dropped_count.store(0, std::memory_order_relaxed);
+}
+
+// Path-end Implementation
+bool PathEnd::admits(Announcement& ann) const {
+    if (filter_rov && ann.rov_invalid) {
+        return false;
+    }
+
+    // Straight from the origin: valid here, but not cached, since the
+    // receiver becomes the hop that downstream ASes check
+    if (ann.as_path.size() < 2) {
+        return true;
+    }
+
+    // The hop before the origin never changes as the path grows, so the
+    // verdict is computed by the first checker and copied along with the route
+    if (ann.path_end == PathEndState::UNCHECKED) {
+        ann.path_end = table.check(ann.as_path.data(), ann.as_path.size());
+    }
+    return ann.path_end != PathEndState::INVALID;
+}
+
+bool PathEnd::acceptAnnouncement(Announcement& ann) {
+    if (PathEnd::admits(ann)) {
+        return true;
+    }
+    if (filter_rov && ann.rov_invalid) {
+        rov_dropped_count.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        dropped_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    return false;
+}
+
+void PathEnd::reset() {
+    BGP::reset();
+    dropped_count.store(0, std::memory_order_relaxed);
+    rov_dropped_count.store(0, std::memory_order_relaxed);
+}
@@ -1,280 +1,1025 @@
-#include "as_graph.h"
-#include "announcement.h"
-#include "bgp_policy.h"
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <chrono>
-#include <getopt.h>
-
-struct Config {
-    std::string relationships_file;
-    std::string announcements_file;
-    std::string rov_asns_file;
-    std::string output_file = "ribs.csv";
-};
-
-void print_usage(const char* prog_name) {
-    std::cout << "Usage: " << prog_name << " [options]\n"
-              << "Options:\n"
-              << "  --relationships <file>   AS relationships file (required)\n"
-              << "  --announcements <file>   Announcements CSV file (required)\n"
-              << "  --rov-asns <file>       ROV ASNs file (optional)\n"
-              << "  --output <file>         Output CSV file (default: ribs.csv)\n"
-              << "  -h, --help              Show this help\n";
-}
-
-bool parse_args(int argc, char* argv[], Config& config) {
-    static struct option long_options[] = {
-        {"relationships", required_argument, 0, 'r'},
-        {"announcements", required_argument, 0, 'a'},
-        {"rov-asns", required_argument, 0, 'v'},
-        {"output", required_argument, 0, 'o'},
-        {"help", no_argument, 0, 'h'},
-        {0, 0, 0, 0}
-    };
-
-    int opt;
-    int option_index = 0;
-
-    while ((opt = getopt_long(argc, argv, "r:a:v:o:h", long_options, &option_index)) != -1) {
-        switch (opt) {
-            case 'r':
-                config.relationships_file = optarg;
-                break;
-            case 'a':
-                config.announcements_file = optarg;
-                break;
-            case 'v':
-                config.rov_asns_file = optarg;
-                break;
-            case 'o':
-                config.output_file = optarg;
-                break;
-            case 'h':
-                print_usage(argv[0]);
-                exit(0);
-            default:
-                print_usage(argv[0]);
-                return false;
-        }
-    }
-
-    if (config.relationships_file.empty() || config.announcements_file.empty()) {
-        std::cerr << "Error: --relationships and --announcements are required\n\n";
-        print_usage(argv[0]);
-        return false;
-    }
-
-    return true;
-}
-
-bool load_announcements(ASGraph& graph, const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Cannot open announcements file " << filename << std::endl;
-        return false;
-    }
-
-    std::cout << "Loading announcements from " << filename << "..." << std::endl;
-
-    std::string line;
-    size_t count = 0;
-
-    // Skip header
-    std::getline(file, line);
-
-    while (std::getline(file, line)) {
-        if (line.empty() || line[0] == '#') continue;
-
-        std::istringstream iss(line);
-        std::string asn_str, prefix, rov_str;
-
-        // Parse CSV: seed_asn,prefix,rov_invalid
-        if (std::getline(iss, asn_str, ',') &&
-            std::getline(iss, prefix, ',') &&
-            std::getline(iss, rov_str)) {
-
-            ASN seed_asn = std::stoul(asn_str);
-
-            // Trim whitespace and carriage returns from rov_str
-            rov_str.erase(rov_str.find_last_not_of(" \t\r\n") + 1);
-
-            bool rov_invalid = (rov_str == "True" || rov_str == "true" || rov_str == "TRUE");
-
-            graph.seedAnnouncement(seed_asn, prefix, rov_invalid);
-            count++;
-        }
-    }
-
-    file.close();
-    std::cout << "Loaded " << count << " announcements" << std::endl;
-    return true;
-}
-
-bool export_to_csv_tuples(const ASGraph& graph, const std::string& filename) {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Cannot open file " << filename << " for writing" << std::endl;
-        return false;
-    }
-
-    // Write header
-    file << "asn,prefix,as_path\n";
-
-    // Write all announcements
-    size_t count = 0;
-    for (const auto& node_pair : graph.getNodes()) {
-        const ASNode& node = node_pair.second;
-        if (!node.policy) continue;
-
-        for (const auto& rib_pair : node.policy->getLocalRIB()) {
-            const Prefix& prefix = rib_pair.first;
-            const Announcement& ann = rib_pair.second;
-
-            // Format: asn,prefix,"(as1, as2, as3)" or "(as1,)" for single element
-            file << node.asn << "," << prefix.toString() << ",\"(";
-
-            for (size_t i = 0; i < ann.as_path.size(); i++) {
-                if (i > 0) file << ", ";
-                file << ann.as_path[i];
-            }
-
-            // Add trailing comma for single-element paths
-            if (ann.as_path.size() == 1) {
-                file << ",";
-            }
-
-            file << ")\"\n";
-            count++;
-        }
-    }
-
-    file.close();
-    std::cout << "Exported " << count << " announcements to " << filename << std::endl;
-    return true;
-}
-
-int main(int argc, char* argv[]) {
-    Config config;
-
-    if (!parse_args(argc, argv, config)) {
-        return 1;
-    }
-
-    std::cout << "======================================" << std::endl;
-    std::cout << "BGP Simulator" << std::endl;
-    std::cout << "======================================\n" << std::endl;
-
-    auto total_start = std::chrono::high_resolution_clock::now();
-
-    // Step 1: Build AS Graph
-    std::cout << "Step 1: Building AS Graph..." << std::endl;
-    auto start = std::chrono::high_resolution_clock::now();
-
-    ASGraph graph;
-    if (!graph.buildFromFile(config.relationships_file)) {
-        std::cerr << "Failed to build AS graph" << std::endl;
-        return 1;
-    }
-
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    std::cout << "  Time: " << duration.count() << " ms\n" << std::endl;
-
-    // Step 2: Detect Cycles
-    std::cout << "Step 2: Detecting cycles..." << std::endl;
-    start = std::chrono::high_resolution_clock::now();
-
-    if (graph.detectCycles()) {
-        std::cerr << "ERROR: Graph contains cycles!" << std::endl;
-        return 1;
-    }
-
-    end = std::chrono::high_resolution_clock::now();
-    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    std::cout << "  Time: " << duration.count() << " ms\n" << std::endl;
-
-    // Step 3: Initialize BGP
-    std::cout << "Step 3: Initializing BGP..." << std::endl;
-    start = std::chrono::high_resolution_clock::now();
-
-    graph.initializeBGP();
-
-    end = std::chrono::high_resolution_clock::now();
-    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    std::cout << "  Time: " << duration.count() << " ms\n" << std::endl;
-
-    // Step 4: Load ROV ASNs (if provided)
-    if (!config.rov_asns_file.empty()) {
-        std::cout << "Step 4: Loading ROV ASNs..." << std::endl;
-        start = std::chrono::high_resolution_clock::now();
-
-        if (!graph.loadROVASNs(config.rov_asns_file)) {
-            std::cerr << "Warning: Failed to load ROV ASNs" << std::endl;
-        }
-
-        end = std::chrono::high_resolution_clock::now();
-        duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-        std::cout << "  Time: " << duration.count() << " ms\n" << std::endl;
-    }
-
-    // Step 5: Flatten Graph
-    std::cout << "Step 5: Flattening graph..." << std::endl;
-    start = std::chrono::high_resolution_clock::now();
-
-    graph.flattenGraph();
-
-    end = std::chrono::high_resolution_clock::now();
-    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    std::cout << "  Time: " << duration.count() << " ms\n" << std::endl;
-
-    // Step 6: Load and Seed Announcements
-    std::cout << "Step 6: Loading announcements..." << std::endl;
-    start = std::chrono::high_resolution_clock::now();
-
-    if (!load_announcements(graph, config.announcements_file)) {
-        std::cerr << "Failed to load announcements" << std::endl;
-        return 1;
-    }
-
-    end = std::chrono::high_resolution_clock::now();
-    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    std::cout << "  Time: " << duration.count() << " ms\n" << std::endl;
-
-    // Step 7: Propagate
-    std::cout << "Step 7: Propagating announcements..." << std::endl;
-    start = std::chrono::high_resolution_clock::now();
-
-    size_t total_announcements = graph.propagateAnnouncements();
-
-    end = std::chrono::high_resolution_clock::now();
-    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    std::cout << "  Time: " << duration.count() << " ms" << std::endl;
-    std::cout << "  Total announcements: " << total_announcements << "\n" << std::endl;
-
-    // Step 8: Export to CSV
-    std::cout << "Step 8: Exporting to CSV..." << std::endl;
-    start = std::chrono::high_resolution_clock::now();
-
-    if (!export_to_csv_tuples(graph, config.output_file)) {
-        std::cerr << "Failed to export to CSV" << std::endl;
-        return 1;
-    }
-
-    end = std::chrono::high_resolution_clock::now();
-    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    std::cout << "  Time: " << duration.count() << " ms\n" << std::endl;
-
-    // Total time
-    auto total_end = std::chrono::high_resolution_clock::now();
-    auto total_duration = std::chrono::duration_cast<std::chrono::milliseconds>(total_end - total_start);
-
-    std::cout << "======================================" << std::endl;
-    std::cout << "SUCCESS!" << std::endl;
-    std::cout << "Total time: " << total_duration.count() << " ms" << std::endl;
-    std::cout << "Output file: " << config.output_file << std::endl;
-    std::cout << "======================================" << std::endl;
-
-    return 0;
-}
+#include "as_graph.h"
+#include "announcement.h"
+#include "bgp_policy.h"
+#include "result_cache.h"
+#include "topology_archive.h"
+#include "time_series.h"
+#include "huge_pages.h"
+#include "option_parse.h"
+#include "rib_export.h"
+#include "rib_summary.h"
+#include "rpki.h"
+#include "route_resolver.h"
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <memory>
+#include <getopt.h>
+
+struct Config {
+    std::string relationships_file;
+    std::string announcements_file;
+    std::string rov_asns_file;
+    std::string output_file = "ribs.csv";
+    bool output_set = false;
+    std::string cache_dir;            // Result cache disabled when empty
+    uint64_t cache_max_mb = 1024;
+    std::string save_snapshot_file;   // Write a binary graph snapshot when set
+    std::string archive_dir;          // Topology archive written by caida_downloader --archive
+    std::string month;                // YYYYMM; selects the archived topology for that month
+    std::string timeseries_file;      // List of topologies to run in sequence
+    std::string summary_file = "timeseries.csv";
+    unsigned threads = 1;             // Propagation threads (1 = serial engine, 0 = all cores)
+    bool numa = false;                // Pin propagation workers per NUMA node
+    HugePageMode huge_pages = HugePageMode::OFF;
+    bool direct_io = false;           // Write the output with O_DIRECT
+    bool io_uring = true;             // io_uring output backend (else a pwrite thread)
+    unsigned output_shards = 0;       // Write N shard files plus a manifest instead of one CSV
+    ShardKey shard_key = ShardKey::ASN_RANGE;
+    bool compress_shards = false;
+    bool sorted = false;              // Rows ordered by (ASN, prefix)
+    std::string save_route_state_file; // Write route keys of this run (baseline for --delta-from)
+    std::string delta_from_file;      // Export only routes that differ from this route state
+    bool summary_output = false;      // Write aggregate JSON instead of per-AS rows
+    std::string vantage_points_file;  // Keep only these ASes' RIBs
+    RibFilter filter;                 // Exported rows (--export-*)
+    RouteSelection route_selection = RouteSelection::STANDARD;
+    uint32_t selection_seed = 0;      // For --route-selection hash-tie-break
+    std::string vrps_file;            // Derive rov_invalid of the seeds from these VRPs
+    std::string aspa_file;            // ASPA records (customer, providers)
+    std::string aspa_asns_file;       // ASes verifying paths against them
+    std::string pathend_file;         // Path-end records (origin, neighbors)
+    std::string pathend_asns_file;    // ASes checking the last hop against them
+    std::string leakers_file;         // Route leakers (ASN[,policy] per line)
+    LeakPolicy leak_policy = LeakPolicy::ALL;  // Policy of leakers listed without one
+    size_t leak_rounds = 1000;        // Worklist round limit
+    std::string query_file;           // Resolve only these (ASN, prefix) routes, without propagating
+};
+
+// Long-only options
+enum {
+    OPT_CACHE_DIR = 256,
+    OPT_CACHE_MAX_MB,
+    OPT_SAVE_SNAPSHOT,
+    OPT_ARCHIVE,
+    OPT_MONTH,
+    OPT_TIMESERIES,
+    OPT_SUMMARY_OUTPUT,
+    OPT_NUMA,
+    OPT_HUGE_PAGES,
+    OPT_DIRECT_IO,
+    OPT_NO_IO_URING,
+    OPT_OUTPUT_SHARDS,
+    OPT_SHARD_BY,
+    OPT_SHARD_COMPRESSION,
+    OPT_SORTED,
+    OPT_SAVE_ROUTE_STATE,
+    OPT_DELTA_FROM,
+    OPT_OUTPUT_FORMAT,
+    OPT_VANTAGE_POINTS,
+    OPT_EXPORT_ASNS,
+    OPT_EXPORT_PREFIXES,
+    OPT_EXPORT_ORIGINS,
+    OPT_EXPORT_ROV_INVALID,
+    OPT_ROUTE_SELECTION,
+    OPT_SELECTION_SEED,
+    OPT_VRPS,
+    OPT_ASPA,
+    OPT_ASPA_ASNS,
+    OPT_PATH_END,
+    OPT_PATH_END_ASNS,
+    OPT_LEAKERS,
+    OPT_LEAK_POLICY,
+    OPT_LEAK_ROUNDS,
+    OPT_QUERY
+};
+
+// Output format tag used in result cache keys
+static const char* const OUTPUT_FORMAT_CSV_TUPLES = "csv_tuples";
+static const char* const OUTPUT_FORMAT_CSV_TUPLES_SORTED = "csv_tuples_sorted";
+static const char* const OUTPUT_FORMAT_SUMMARY_JSON = "summary_json";
+
+// Cache format tag of a filtered export: the base tag plus a hash of the filter
+std::string filtered_format(const std::string& format, const RibFilter& filter) {
+    if (!filter.active()) {
+        return format;
+    }
+
+    std::vector<ASN> asns = filter.asns;
+    std::vector<ASN> origins = filter.origins;
+    std::vector<std::string> prefixes;
+    for (const Prefix& prefix : filter.prefixes) {
+        prefixes.push_back(prefix.toString());
+    }
+    std::sort(asns.begin(), asns.end());
+    asns.erase(std::unique(asns.begin(), asns.end()), asns.end());
+    std::sort(origins.begin(), origins.end());
+    origins.erase(std::unique(origins.begin(), origins.end()), origins.end());
+    std::sort(prefixes.begin(), prefixes.end());
+    prefixes.erase(std::unique(prefixes.begin(), prefixes.end()), prefixes.end());
+
+    ContentHasher hasher;
+    hasher.updateU64(asns.size());
+    for (ASN asn : asns) hasher.updateU64(asn);
+    hasher.updateU64(origins.size());
+    for (ASN asn : origins) hasher.updateU64(asn);
+    hasher.updateU64(prefixes.size());
+    for (const std::string& prefix : prefixes) {
+        hasher.updateU64(prefix.size());
+        hasher.update(prefix);
+    }
+    hasher.updateU64(filter.rov_invalid_only ? 1 : 0);
+    return format + "+filter:" + hasher.digest().toHex();
+}
+
+void print_usage(const char* prog_name) {
+    std::cout << "Usage: " << prog_name << " [options]\n"
+              << "Options:\n"
+              << "  --relationships <file>   AS relationships file (required unless --month)\n"
+              << "  --announcements <file>   Announcements CSV file (required)\n"
+              << "  --rov-asns <file>       ROV ASNs file (optional)\n"
+              << "  --vrps <file>           RPKI VRP CSV (prefix,maxLength,ASN); replaces the\n"
+              << "                          rov_invalid column with origin validation\n"
+              << "  --aspa <file>           ASPA records: customer ASN, then its provider ASNs\n"
+              << "  --aspa-asns <file>      ASes that verify paths against them (one per line)\n"
+              << "  --path-end <file>       Path-end records: origin ASN, then its authorized neighbor ASNs\n"
+              << "  --path-end-asns <file>  ASes that check the last hop against them (one per line)\n"
+              << "  --leakers <file>        Route leakers: ASN[,providers|peers|all] per line\n"
+              << "  --leak-policy <p>       Policy of leakers listed without one (default: all)\n"
+              << "  --leak-rounds <n>       Give up on leak convergence after n rounds (default: 1000)\n"
+              << "  --query <file>          Resolve only these routes on demand: ASN,prefix per line\n"
+              << "                          (no global propagation)\n"
+              << "  --output <file>         Output file (default: ribs.csv, or summary.json)\n"
+              << "  --output-format <f>     csv (per-AS rows, default) or summary (aggregate JSON)\n"
+              << "  --cache-dir <dir>       Reuse results of identical earlier runs (optional)\n"
+              << "  --cache-max-mb <n>      Result cache size limit in MB (default: 1024)\n"
+              << "  --save-snapshot <file>  Write the loaded graph as a binary snapshot\n"
+              << "  --archive <dir>         Topology archive directory (default: caida_archive)\n"
+              << "  --month <YYYYMM>        Use the archived topology of this month\n"
+              << "  --timeseries <file>     Run the same seeds over a list of topologies\n"
+              << "                          (one per line: YYYYMM, <file>, or <label> <file>)\n"
+              << "  --summary-output <file> Per-month summary CSV (default: timeseries.csv)\n"
+              << "  --threads <n>           Propagation threads (default: 1, 0 = all cores)\n"
+              << "  --numa                  Pin propagation workers per NUMA node\n"
+              << "  --huge-pages <mode>     Back graph and RIB storage with huge pages\n"
+              << "                          (off, thp, explicit; default: off)\n"
+              << "  --direct-io             Write the output with O_DIRECT (bypass page cache)\n"
+              << "  --no-io-uring           Write the output from a pwrite thread\n"
+              << "  --output-shards <n>     Write n shard files and a manifest instead of --output\n"
+              << "  --shard-by <key>        asn (ASN ranges, default) or prefix (prefix hash)\n"
+              << "  --shard-compression <c> none (default) or bz2\n"
+              << "  --sorted                Order rows by ASN, then prefix (reproducible bytes)\n"
+              << "  --save-route-state <f>  Also save compact route keys of this run\n"
+              << "  --delta-from <f>        Export only routes that differ from a saved route state\n"
+              << "  --vantage-points <f>    Keep and export only the RIBs of these ASes (one per line)\n"
+              << "  --export-asns <file>    Export only the RIBs of these ASes (one per line)\n"
+              << "  --export-prefixes <f>   Export only these prefixes (one per line)\n"
+              << "  --export-origins <list> Export only routes originated by these ASes (comma-separated)\n"
+              << "  --export-rov-invalid    Export only ROV-invalid routes\n"
+              << "  --route-selection <p>   standard (default), ignore-path-length, hash-tie-break\n"
+              << "                          or lowest-origin\n"
+              << "  --selection-seed <n>    Seed of hash-tie-break (default: 0)\n"
+              << "  -h, --help              Show this help\n";
+}
+
+// Point relationships_file at the snapshot archived for config.month
+bool resolve_archived_month(Config& config) {
+    if (!TopologyArchive::isValidMonth(config.month)) {
+        std::cerr << "Error: --month expects YYYYMM, got " << config.month << std::endl;
+        return false;
+    }
+    if (config.archive_dir.empty()) {
+        config.archive_dir = "caida_archive";
+    }
+
+    TopologyArchive archive(config.archive_dir);
+    if (!archive.load() || !archive.hasMonth(config.month)) {
+        std::cerr << "Error: Month " << config.month << " is not in archive " << config.archive_dir
+                  << " (run: caida_downloader --archive " << config.archive_dir
+                  << " --month " << config.month << ")" << std::endl;
+        return false;
+    }
+
+    config.relationships_file = archive.getSnapshotPath(config.month);
+    std::cout << "Using archived topology " << config.month << ": "
+              << config.relationships_file << std::endl;
+    return true;
+}
+
+bool parse_args(int argc, char* argv[], Config& config) {
+    static struct option long_options[] = {
+        {"relationships", required_argument, 0, 'r'},
+        {"announcements", required_argument, 0, 'a'},
+        {"rov-asns", required_argument, 0, 'v'},
+        {"output", required_argument, 0, 'o'},
+        {"cache-dir", required_argument, 0, OPT_CACHE_DIR},
+        {"cache-max-mb", required_argument, 0, OPT_CACHE_MAX_MB},
+        {"save-snapshot", required_argument, 0, OPT_SAVE_SNAPSHOT},
+        {"archive", required_argument, 0, OPT_ARCHIVE},
+        {"month", required_argument, 0, OPT_MONTH},
+        {"timeseries", required_argument, 0, OPT_TIMESERIES},
+        {"summary-output", required_argument, 0, OPT_SUMMARY_OUTPUT},
+        {"threads", required_argument, 0, 't'},
+        {"numa", no_argument, 0, OPT_NUMA},
+        {"huge-pages", required_argument, 0, OPT_HUGE_PAGES},
+        {"direct-io", no_argument, 0, OPT_DIRECT_IO},
+        {"no-io-uring", no_argument, 0, OPT_NO_IO_URING},
+        {"output-shards", required_argument, 0, OPT_OUTPUT_SHARDS},
+        {"shard-by", required_argument, 0, OPT_SHARD_BY},
+        {"shard-compression", required_argument, 0, OPT_SHARD_COMPRESSION},
+        {"sorted", no_argument, 0, OPT_SORTED},
+        {"save-route-state", required_argument, 0, OPT_SAVE_ROUTE_STATE},
+        {"delta-from", required_argument, 0, OPT_DELTA_FROM},
+        {"output-format", required_argument, 0, OPT_OUTPUT_FORMAT},
+        {"vantage-points", required_argument, 0, OPT_VANTAGE_POINTS},
+        {"export-asns", required_argument, 0, OPT_EXPORT_ASNS},
+        {"export-prefixes", required_argument, 0, OPT_EXPORT_PREFIXES},
+        {"export-origins", required_argument, 0, OPT_EXPORT_ORIGINS},
+        {"export-rov-invalid", no_argument, 0, OPT_EXPORT_ROV_INVALID},
+        {"route-selection", required_argument, 0, OPT_ROUTE_SELECTION},
+        {"selection-seed", required_argument, 0, OPT_SELECTION_SEED},
+        {"vrps", required_argument, 0, OPT_VRPS},
+        {"aspa", required_argument, 0, OPT_ASPA},
+        {"aspa-asns", required_argument, 0, OPT_ASPA_ASNS},
+        {"path-end", required_argument, 0, OPT_PATH_END},
+        {"path-end-asns", required_argument, 0, OPT_PATH_END_ASNS},
+        {"leakers", required_argument, 0, OPT_LEAKERS},
+        {"leak-policy", required_argument, 0, OPT_LEAK_POLICY},
+        {"leak-rounds", required_argument, 0, OPT_LEAK_ROUNDS},
+        {"query", required_argument, 0, OPT_QUERY},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    int option_index = 0;
+
+    while ((opt = getopt_long(argc, argv, "r:a:v:o:t:h", long_options, &option_index)) != -1) {
+        switch (opt) {
+            case 'r':
+                config.relationships_file = optarg;
+                break;
+            case 'a':
+                config.announcements_file = optarg;
+                break;
+            case 'v':
+                config.rov_asns_file = optarg;
+                break;
+            case 'o':
+                config.output_file = optarg;
+                config.output_set = true;
+                break;
+            case OPT_CACHE_DIR:
+                config.cache_dir = optarg;
+                break;
+            case OPT_CACHE_MAX_MB:
+                if (!parseUnsigned(optarg, config.cache_max_mb)) {
+                    std::cerr << "Error: --cache-max-mb expects a size in MB\n\n";
+                    print_usage(argv[0]);
+                    return false;
+                }
+                break;
+            case OPT_SAVE_SNAPSHOT:
+                config.save_snapshot_file = optarg;
+                break;
+            case OPT_ARCHIVE:
+                config.archive_dir = optarg;
+                break;
+            case OPT_MONTH:
+                config.month = optarg;
+                break;
+            case OPT_TIMESERIES:
+                config.timeseries_file = optarg;
+                break;
+            case OPT_SUMMARY_OUTPUT:
+                config.summary_file = optarg;
+                break;
+            case 't':
+                if (!parseUnsigned(optarg, config.threads)) {
+                    std::cerr << "Error: --threads expects a number of threads\n\n";
+                    print_usage(argv[0]);
+                    return false;
+                }
+                break;
+            case OPT_NUMA:
+                config.numa = true;
+                break;
+            case OPT_HUGE_PAGES:
+                if (!parseHugePageMode(optarg, config.huge_pages)) {
+                    std::cerr << "Error: --huge-pages expects off, thp or explicit\n\n";
+                    print_usage(argv[0]);
+                    return false;
+                }
+                break;
+            case OPT_DIRECT_IO:
+                config.direct_io = true;
+                break;
+            case OPT_NO_IO_URING:
+                config.io_uring = false;
+                break;
+            case OPT_OUTPUT_SHARDS:
+                if (!parseUnsigned(optarg, config.output_shards)) {
+                    std::cerr << "Error: --output-shards expects a number of shards\n\n";
+                    print_usage(argv[0]);
+                    return false;
+                }
+                break;
+            case OPT_SHARD_BY:
+                if (std::string(optarg) == "asn") {
+                    config.shard_key = ShardKey::ASN_RANGE;
+                } else if (std::string(optarg) == "prefix") {
+                    config.shard_key = ShardKey::PREFIX_HASH;
+                } else {
+                    std::cerr << "Error: --shard-by expects asn or prefix\n\n";
+                    print_usage(argv[0]);
+                    return false;
+                }
+                break;
+            case OPT_SHARD_COMPRESSION:
+                if (std::string(optarg) == "bz2") {
+                    config.compress_shards = true;
+                } else if (std::string(optarg) == "none") {
+                    config.compress_shards = false;
+                } else {
+                    std::cerr << "Error: --shard-compression expects none or bz2\n\n";
+                    print_usage(argv[0]);
+                    return false;
+                }
+                break;
+            case OPT_SORTED:
+                config.sorted = true;
+                break;
+            case OPT_SAVE_ROUTE_STATE:
+                config.save_route_state_file = optarg;
+                break;
+            case OPT_DELTA_FROM:
+                config.delta_from_file = optarg;
+                break;
+            case OPT_VANTAGE_POINTS:
+                config.vantage_points_file = optarg;
+                break;
+            case OPT_EXPORT_ASNS:
+                if (!readAsnList(optarg, config.filter.asns)) {
+                    return false;
+                }
+                break;
+            case OPT_EXPORT_PREFIXES:
+                if (!readPrefixList(optarg, config.filter.prefixes)) {
+                    return false;
+                }
+                break;
+            case OPT_EXPORT_ORIGINS: {
+                std::istringstream list(optarg);
+                std::string item;
+                while (std::getline(list, item, ',')) {
+                    ASN asn = 0;
+                    if (!parseUnsigned(item.c_str(), asn) || asn == 0) {
+                        std::cerr << "Error: --export-origins expects comma-separated ASNs (1-4294967295)\n\n";
+                        print_usage(argv[0]);
+                        return false;
+                    }
+                    config.filter.origins.push_back(asn);
+                }
+                break;
+            }
+            case OPT_EXPORT_ROV_INVALID:
+                config.filter.rov_invalid_only = true;
+                break;
+            case OPT_ROUTE_SELECTION:
+                if (!parseRouteSelection(optarg, config.route_selection)) {
+                    std::cerr << "Error: --route-selection expects standard, ignore-path-length, "
+                              << "hash-tie-break or lowest-origin\n\n";
+                    print_usage(argv[0]);
+                    return false;
+                }
+                break;
+            case OPT_SELECTION_SEED:
+                if (!parseUnsigned(optarg, config.selection_seed)) {
+                    std::cerr << "Error: --selection-seed expects a number from 0 to 4294967295\n\n";
+                    print_usage(argv[0]);
+                    return false;
+                }
+                break;
+            case OPT_VRPS:
+                config.vrps_file = optarg;
+                break;
+            case OPT_ASPA:
+                config.aspa_file = optarg;
+                break;
+            case OPT_ASPA_ASNS:
+                config.aspa_asns_file = optarg;
+                break;
+            case OPT_PATH_END:
+                config.pathend_file = optarg;
+                break;
+            case OPT_PATH_END_ASNS:
+                config.pathend_asns_file = optarg;
+                break;
+            case OPT_LEAKERS:
+                config.leakers_file = optarg;
+                break;
+            case OPT_LEAK_POLICY:
+                if (!parseLeakPolicy(optarg, config.leak_policy)) {
+                    std::cerr << "Error: --leak-policy expects providers, peers or all\n\n";
+                    print_usage(argv[0]);
+                    return false;
+                }
+                break;
+            case OPT_LEAK_ROUNDS:
+                if (!parseUnsigned(optarg, config.leak_rounds) || config.leak_rounds == 0) {
+                    std::cerr << "Error: --leak-rounds expects a round limit of at least 1\n\n";
+                    print_usage(argv[0]);
+                    return false;
+                }
+                break;
+            case OPT_QUERY:
+                config.query_file = optarg;
+                break;
+            case OPT_OUTPUT_FORMAT:
+                if (std::string(optarg) == "summary") {
+                    config.summary_output = true;
+                } else if (std::string(optarg) == "csv") {
+                    config.summary_output = false;
+                } else {
+                    std::cerr << "Error: --output-format expects csv or summary\n\n";
+                    print_usage(argv[0]);
+                    return false;
+                }
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                exit(0);
+            default:
+                print_usage(argv[0]);
+                return false;
+        }
+    }
+
+    if (config.output_shards > 0 && !config.delta_from_file.empty()) {
+        std::cerr << "Error: --delta-from cannot be combined with --output-shards\n\n";
+        print_usage(argv[0]);
+        return false;
+    }
+
+    if (config.filter.active() && (config.summary_output || !config.delta_from_file.empty())) {
+        std::cerr << "Error: --export-* filters cannot be combined with --delta-from "
+                  << "or --output-format summary\n\n";
+        print_usage(argv[0]);
+        return false;
+    }
+
+    if (config.summary_output) {
+        // Vantage points drop the other RIBs during propagation, so a summary
+        // would silently cover only those ASes
+        if (config.output_shards > 0 || !config.delta_from_file.empty() ||
+            !config.vantage_points_file.empty()) {
+            std::cerr << "Error: --output-format summary cannot be combined with "
+                      << "--output-shards, --delta-from or --vantage-points\n\n";
+            print_usage(argv[0]);
+            return false;
+        }
+        if (!config.output_set) {
+            config.output_file = "summary.json";
+        }
+    }
+
+    if (!config.query_file.empty() &&
+        (!config.leakers_file.empty() || config.summary_output || config.filter.active() ||
+         config.output_shards > 0 || !config.delta_from_file.empty() ||
+         !config.save_route_state_file.empty() || !config.timeseries_file.empty())) {
+        std::cerr << "Error: --query cannot be combined with --leakers, --output-format summary, "
+                  << "--export-*, --output-shards, --delta-from, --save-route-state or --timeseries\n\n";
+        print_usage(argv[0]);
+        return false;
+    }
+
+    bool extra_outputs = config.output_shards > 0 || !config.delta_from_file.empty() ||
+                         !config.save_route_state_file.empty();
+    if (extra_outputs && !config.cache_dir.empty()) {
+        // The cache stores one complete output file per run
+        std::cerr << "Warning: --cache-dir is ignored with --output-shards, --delta-from "
+                  << "and --save-route-state" << std::endl;
+        config.cache_dir.clear();
+    }
+
+    if (!config.month.empty()) {
+        if (!config.relationships_file.empty()) {
+            std::cerr << "Error: --month and --relationships are mutually exclusive\n\n";
+            print_usage(argv[0]);
+            return false;
+        }
+        if (!resolve_archived_month(config)) {
+            return false;
+        }
+    }
+
+    if (!config.timeseries_file.empty()) {
+        // Each month writes only its summary row, so per-run outputs would be ignored
+        if (!config.vantage_points_file.empty() || config.filter.active() ||
+            !config.aspa_asns_file.empty() || !config.pathend_asns_file.empty() ||
+            !config.leakers_file.empty() || config.output_set || config.summary_output ||
+            config.output_shards > 0 || !config.save_route_state_file.empty() ||
+            !config.delta_from_file.empty() || config.sorted || !config.cache_dir.empty() ||
+            !config.save_snapshot_file.empty()) {
+            std::cerr << "Error: --vantage-points, --aspa-asns, --path-end-asns, --leakers, --export-*, "
+                      << "--output, --output-format summary, --output-shards, --save-route-state, "
+                      << "--delta-from, --sorted, --cache-dir and --save-snapshot cannot be combined "
+                      << "with --timeseries\n\n";
+            print_usage(argv[0]);
+            return false;
+        }
+        if (config.announcements_file.empty()) {
+            std::cerr << "Error: --announcements is required\n\n";
+            print_usage(argv[0]);
+            return false;
+        }
+        return true;
+    }
+
+    if (config.relationships_file.empty() || config.announcements_file.empty()) {
+        std::cerr << "Error: --relationships and --announcements are required\n\n";
+        print_usage(argv[0]);
+        return false;
+    }
+
+    return true;
+}
+
+bool read_announcements(const std::string& filename, std::vector<SeedAnnouncement>& seeds) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open announcements file " << filename << std::endl;
+        return false;
+    }
+
+    std::cout << "Loading announcements from " << filename << "..." << std::endl;
+
+    std::string line;
+
+    // Skip header
+    std::getline(file, line);
+
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream iss(line);
+        std::string asn_str, prefix, rov_str;
+
+        // Parse CSV: seed_asn,prefix,rov_invalid
+        if (std::getline(iss, asn_str, ',') &&
+            std::getline(iss, prefix, ',') &&
+            std::getline(iss, rov_str)) {
+
+            ASN seed_asn = std::stoul(asn_str);
+
+            // Trim whitespace and carriage returns from rov_str
+            rov_str.erase(rov_str.find_last_not_of(" \t\r\n") + 1);
+
+            bool rov_invalid = (rov_str == "True" || rov_str == "true" || rov_str == "TRUE");
+
+            seeds.push_back({seed_asn, prefix, rov_invalid});
+        }
+    }
+
+    file.close();
+    return true;
+}
+
+// Recompute rov_invalid of every seed by origin validation against config.vrps_file
+bool validate_seeds(const Config& config, std::vector<SeedAnnouncement>& seeds) {
+    auto start = std::chrono::high_resolution_clock::now();
+
+    RpkiIndex index;
+    if (!index.loadFromFile(config.vrps_file, config.threads)) {
+        return false;
+    }
+    RpkiSeedCounts counts = index.validateSeeds(seeds, config.threads);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    std::cout << "Origin validation: " << counts.valid << " valid, " << counts.invalid << " invalid, "
+              << counts.not_found << " not found (" << counts.changed
+              << " differ from the rov_invalid column, " << duration.count() << " ms)" << std::endl;
+    return true;
+}
+
+bool load_announcements(ASGraph& graph, const Config& config) {
+    std::vector<SeedAnnouncement> seeds;
+    if (!read_announcements(config.announcements_file, seeds)) {
+        return false;
+    }
+    if (!config.vrps_file.empty() && !validate_seeds(config, seeds)) {
+        return false;
+    }
+
+    for (const SeedAnnouncement& seed : seeds) {
+        graph.seedAnnouncement(seed.origin_asn, seed.prefix, seed.rov_invalid);
+    }
+
+    std::cout << "Loaded " << seeds.size() << " announcements" << std::endl;
+    return true;
+}
+
+// Steps 7-8: propagate and export (skipped on a result cache hit)
+bool propagate_and_export(ASGraph& graph, const Config& config) {
+    // Step 7: Propagate
+    std::cout << "Step 7: Propagating announcements..." << std::endl;
+    auto start = std::chrono::high_resolution_clock::now();
+
+    size_t total_announcements = graph.propagateAnnouncements();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    std::cout << "  Time: " << duration.count() << " ms" << std::endl;
+    std::cout << "  Total announcements: " << total_announcements << "\n" << std::endl;
+
+    if (config.summary_output) {
+        std::cout << "Step 8: Summarizing RIBs..." << std::endl;
+        start = std::chrono::high_resolution_clock::now();
+
+        RibSummary summary = summarizeRibs(graph, config.threads);
+        bool written = writeRibSummaryJson(summary, config.output_file);
+        if (written && !config.save_route_state_file.empty()) {
+            RouteState state;
+            written = buildRouteState(graph, state, config.threads) &&
+                      saveRouteState(state, config.save_route_state_file);
+        }
+        if (!written) {
+            std::cerr << "Failed to write summary" << std::endl;
+            return false;
+        }
+
+        end = std::chrono::high_resolution_clock::now();
+        duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        std::cout << "  Routes: " << summary.routes << " across " << summary.prefixes.size()
+                  << " prefixes" << std::endl;
+        std::cout << "  Time: " << duration.count() << " ms\n" << std::endl;
+        return true;
+    }
+
+    // Step 8: Export to CSV
+    std::cout << "Step 8: Exporting to CSV..." << std::endl;
+    start = std::chrono::high_resolution_clock::now();
+
+    RibExportOptions export_options;
+    export_options.threads = config.threads;
+    export_options.writer.direct_io = config.direct_io;
+    export_options.writer.use_io_uring = config.io_uring;
+    export_options.shards = config.output_shards;
+    export_options.shard_key = config.shard_key;
+    export_options.compress_shards = config.compress_shards;
+    export_options.sorted = config.sorted;
+    export_options.filter = config.filter;
+
+    bool exported;
+    if (!config.delta_from_file.empty()) {
+        RouteState baseline;
+        exported = loadRouteState(config.delta_from_file, baseline) &&
+                   exportRibsDelta(graph, config.output_file, baseline, export_options);
+    } else if (config.output_shards > 0) {
+        exported = exportRibShards(graph, config.output_file, export_options);
+    } else {
+        exported = exportRibsCsv(graph, config.output_file, export_options);
+    }
+
+    if (exported && !config.save_route_state_file.empty()) {
+        RouteState state;
+        exported = buildRouteState(graph, state, config.threads) &&
+                   saveRouteState(state, config.save_route_state_file);
+    }
+    if (!exported) {
+        std::cerr << "Failed to export to CSV" << std::endl;
+        return false;
+    }
+
+    end = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    std::cout << "  Time: " << duration.count() << " ms\n" << std::endl;
+
+    return true;
+}
+
+// Query mode: resolve the requested routes on demand instead of propagating
+// Queries are "ASN,prefix" (or "ASN prefix") lines; rows are those of the CSV
+// export, for the queries that have a route
+bool resolve_queries(const ASGraph& graph, const Config& config) {
+    std::ifstream input(config.query_file);
+    if (!input.is_open()) {
+        std::cerr << "Error: Cannot open query file " << config.query_file << std::endl;
+        return false;
+    }
+
+    std::vector<std::pair<ASN, Prefix>> queries;
+    size_t skipped = 0;
+    std::string line;
+    while (std::getline(input, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        if (queries.empty() && skipped == 0 && !std::isdigit(static_cast<unsigned char>(line[0]))) {
+            continue;  // Header
+        }
+        std::replace(line.begin(), line.end(), ',', ' ');
+
+        std::istringstream iss(line);
+        unsigned long asn;
+        std::string prefix;
+        if (iss >> asn >> prefix) {
+            queries.push_back({static_cast<ASN>(asn), Prefix::parse(prefix)});
+        } else {
+            skipped++;
+        }
+    }
+    if (skipped > 0) {
+        std::cerr << "Warning: Skipped " << skipped << " malformed lines in " << config.query_file << std::endl;
+    }
+
+    std::ofstream out(config.output_file);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot open file " << config.output_file << " for writing" << std::endl;
+        return false;
+    }
+
+    std::cout << "Step 7: Resolving " << queries.size() << " routes on demand..." << std::endl;
+    auto start = std::chrono::high_resolution_clock::now();
+
+    RouteResolver resolver(graph);
+    std::vector<const Announcement*> routes;
+    routes.reserve(queries.size());
+    for (const auto& query : queries) {
+        routes.push_back(resolver.resolve(query.first, query.second));
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+    std::string rows = "asn,prefix,as_path\n";
+    size_t found = 0;
+    for (size_t i = 0; i < queries.size(); i++) {
+        if (!routes[i]) continue;
+        appendRibRow(rows, queries[i].first, queries[i].second.toString(), *routes[i]);
+        found++;
+    }
+    out << rows;
+
+    std::cout << "  Routes: " << found << " of " << queries.size() << " queries ("
+              << resolver.getComputedRouteCount() << " routes computed)" << std::endl;
+    std::cout << "  Time: " << duration.count() << " us";
+    if (!queries.empty()) {
+        std::cout << " (" << duration.count() / queries.size() << " us per query)";
+    }
+    std::cout << "\n" << std::endl;
+    return true;
+}
+
+// Time-series mode: one process, one graph, updated month to month by diffs
+int run_timeseries(const Config& config) {
+    std::ifstream list(config.timeseries_file);
+    if (!list.is_open()) {
+        std::cerr << "Error: Cannot open topology list " << config.timeseries_file << std::endl;
+        return 1;
+    }
+
+    // Entries: YYYYMM (from the archive), a file, or "<label> <file>"
+    std::vector<std::pair<std::string, std::string>> entries;
+    std::string line;
+    while (std::getline(list, line)) {
+        std::istringstream iss(line);
+        std::string first, second;
+        if (!(iss >> first) || first[0] == '#') continue;
+
+        if (iss >> second) {
+            entries.push_back({first, second});
+        } else if (TopologyArchive::isValidMonth(first)) {
+            Config month_config = config;
+            month_config.month = first;
+            if (!resolve_archived_month(month_config)) {
+                return 1;
+            }
+            entries.push_back({first, month_config.relationships_file});
+        } else {
+            entries.push_back({first, first});
+        }
+    }
+
+    std::vector<SeedAnnouncement> seeds;
+    if (!read_announcements(config.announcements_file, seeds)) {
+        return 1;
+    }
+    if (!config.vrps_file.empty() && !validate_seeds(config, seeds)) {
+        return 1;
+    }
+
+    std::ofstream summary_out(config.summary_file);
+    if (!summary_out.is_open()) {
+        std::cerr << "Error: Cannot open file " << config.summary_file << " for writing" << std::endl;
+        return 1;
+    }
+    writeMonthSummaryHeader(summary_out);
+
+    auto total_start = std::chrono::high_resolution_clock::now();
+
+    TimeSeriesRunner runner(seeds, config.rov_asns_file);
+    runner.setPropagationThreads(config.threads, config.numa);
+    runner.setRouteSelection(config.route_selection, config.selection_seed);
+    for (const auto& entry : entries) {
+        MonthSummary summary;
+        if (!runner.runMonth(entry.first, entry.second, summary)) {
+            return 1;
+        }
+        writeMonthSummaryRow(summary_out, summary);
+        summary_out.flush();
+
+        std::cout << "  " << summary.label << ": " << summary.nodes << " ASes, "
+                  << summary.rib_entries << " RIB entries, update " << summary.update_ms
+                  << " ms, propagate " << summary.propagate_ms << " ms\n" << std::endl;
+    }
+
+    auto total_end = std::chrono::high_resolution_clock::now();
+    auto total_duration = std::chrono::duration_cast<std::chrono::milliseconds>(total_end - total_start);
+
+    std::cout << "======================================" << std::endl;
+    std::cout << "SUCCESS!" << std::endl;
+    std::cout << "Months: " << entries.size() << std::endl;
+    std::cout << "Total time: " << total_duration.count() << " ms" << std::endl;
+    std::cout << "Summary file: " << config.summary_file << std::endl;
+    std::cout << "======================================" << std::endl;
+
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    Config config;
+
+    if (!parse_args(argc, argv, config)) {
+        return 1;
+    }
+
+    // Before any graph or RIB allocation
+    setHugePageMode(config.huge_pages);
+
+    if (!config.timeseries_file.empty()) {
+        return run_timeseries(config);
+    }
+
+    std::cout << "======================================" << std::endl;
+    std::cout << "BGP Simulator" << std::endl;
+    std::cout << "======================================\n" << std::endl;
+
+    auto total_start = std::chrono::high_resolution_clock::now();
+
+    // Step 1: Build AS Graph
+    std::cout << "Step 1: Building AS Graph..." << std::endl;
+    auto start = std::chrono::high_resolution_clock::now();
+
+    ASGraph graph;
+    graph.setPropagationThreads(config.threads, config.numa);
+    graph.setRouteSelection(config.route_selection, config.selection_seed);
+    if (!graph.buildFromFile(config.relationships_file)) {
+        std::cerr << "Failed to build AS graph" << std::endl;
+        return 1;
+    }
+
+    if (!config.save_snapshot_file.empty() && !graph.saveSnapshot(config.save_snapshot_file)) {
+        return 1;
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    std::cout << "  Time: " << duration.count() << " ms\n" << std::endl;
+
+    // Step 2: Detect Cycles
+    std::cout << "Step 2: Detecting cycles..." << std::endl;
+    start = std::chrono::high_resolution_clock::now();
+
+    if (graph.detectCycles()) {
+        std::cerr << "ERROR: Graph contains cycles!" << std::endl;
+        return 1;
+    }
+
+    end = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    std::cout << "  Time: " << duration.count() << " ms\n" << std::endl;
+
+    // Step 3: Initialize BGP
+    std::cout << "Step 3: Initializing BGP..." << std::endl;
+    start = std::chrono::high_resolution_clock::now();
+
+    graph.initializeBGP();
+
+    end = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    std::cout << "  Time: " << duration.count() << " ms\n" << std::endl;
+
+    // Step 4: Load ROV ASNs (if provided)
+    if (!config.rov_asns_file.empty()) {
+        std::cout << "Step 4: Loading ROV ASNs..." << std::endl;
+        start = std::chrono::high_resolution_clock::now();
+
+        if (!graph.loadROVASNs(config.rov_asns_file)) {
+            std::cerr << "Warning: Failed to load ROV ASNs" << std::endl;
+        }
+
+        end = std::chrono::high_resolution_clock::now();
+        duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        std::cout << "  Time: " << duration.count() << " ms\n" << std::endl;
+    }
+
+    if (!config.aspa_file.empty() && !graph.loadASPA(config.aspa_file)) {
+        return 1;
+    }
+    if (!config.aspa_asns_file.empty() && !graph.loadASPAASNs(config.aspa_asns_file)) {
+        return 1;
+    }
+    if (!config.pathend_file.empty() && !graph.loadPathEnd(config.pathend_file)) {
+        return 1;
+    }
+    if (!config.pathend_asns_file.empty() && !graph.loadPathEndASNs(config.pathend_asns_file)) {
+        return 1;
+    }
+    if (!config.leakers_file.empty() && !graph.loadLeakers(config.leakers_file, config.leak_policy)) {
+        return 1;
+    }
+    graph.setLeakRoundLimit(config.leak_rounds);
+
+    if (!config.vantage_points_file.empty() && !graph.loadVantagePoints(config.vantage_points_file)) {
+        return 1;
+    }
+
+    // Step 5: Flatten Graph
+    std::cout << "Step 5: Flattening graph..." << std::endl;
+    start = std::chrono::high_resolution_clock::now();
+
+    graph.flattenGraph();
+
+    end = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    std::cout << "  Time: " << duration.count() << " ms\n" << std::endl;
+
+    // Step 6: Load and Seed Announcements
+    std::cout << "Step 6: Loading announcements..." << std::endl;
+    start = std::chrono::high_resolution_clock::now();
+
+    if (!load_announcements(graph, config)) {
+        std::cerr << "Failed to load announcements" << std::endl;
+        return 1;
+    }
+
+    end = std::chrono::high_resolution_clock::now();
+    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    std::cout << "  Time: " << duration.count() << " ms\n" << std::endl;
+
+    if (!config.query_file.empty()) {
+        if (!resolve_queries(graph, config)) {
+            return 1;
+        }
+    } else {
+        // Result cache lookup and propagation: identical inputs produce identical output
+        std::unique_ptr<ResultCache> cache;
+        std::string cache_key;
+        bool cache_hit = false;
+
+        if (!config.cache_dir.empty()) {
+            cache.reset(new ResultCache(config.cache_dir, config.cache_max_mb * 1024 * 1024));
+            std::string format = config.summary_output ? OUTPUT_FORMAT_SUMMARY_JSON
+                                 : config.sorted ? OUTPUT_FORMAT_CSV_TUPLES_SORTED
+                                                 : OUTPUT_FORMAT_CSV_TUPLES;
+            cache_key = ResultCache::makeKey(graph, graph.fingerprint().toHex(),
+                                             filtered_format(format, config.filter));
+            cache_hit = cache->lookup(cache_key, config.output_file);
+
+            std::cout << (cache_hit ? "[CACHE HIT] " : "[CACHE MISS] ")
+                      << "Result " << cache_key << " in " << config.cache_dir << "\n" << std::endl;
+        }
+
+        if (!cache_hit) {
+            if (!propagate_and_export(graph, config)) {
+                return 1;
+            }
+
+            if (cache) {
+                cache->store(cache_key, config.output_file);
+            }
+        }
+    }
+
+    // Total time
+    auto total_end = std::chrono::high_resolution_clock::now();
+    auto total_duration = std::chrono::duration_cast<std::chrono::milliseconds>(total_end - total_start);
+
+    std::cout << "======================================" << std::endl;
+    std::cout << "SUCCESS!" << std::endl;
+    std::cout << "Total time: " << total_duration.count() << " ms" << std::endl;
+    std::cout << "Output file: " << config.output_file << std::endl;
+    if (config.huge_pages != HugePageMode::OFF) {
+        HugePageStats stats = getHugePageStats();
+        std::cout << "Huge pages (" << hugePageModeName(config.huge_pages) << "): "
+                  << (stats.explicit_bytes >> 20) << " MB explicit, "
+                  << (stats.transparent_bytes >> 20) << " MB THP-advised, "
+                  << (stats.anon_huge_bytes >> 20) << " MB THP-backed" << std::endl;
+    }
+    std::cout << "======================================" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,417 @@
+#include "bz2_decoder.h"
+#include "parallel.h"
+#include <bzlib.h>
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+struct Bz2StreamDecoder::State {
+    bz_stream strm;
+    bool active = false;       // Inside a stream (BZ2_bzDecompressInit called)
+    bool saw_stream = false;   // At least one stream started
+
+    void begin() {
+        std::memset(&strm, 0, sizeof(strm));
+        active = (BZ2_bzDecompressInit(&strm, 0, 0) == BZ_OK);
+        saw_stream = true;
+    }
+
+    void end() {
+        if (active) {
+            BZ2_bzDecompressEnd(&strm);
+            active = false;
+        }
+    }
+};
+
+Bz2StreamDecoder::Bz2StreamDecoder(size_t buffer_size)
+    : state(new State()), out_buffer(buffer_size) {}
+
+Bz2StreamDecoder::~Bz2StreamDecoder() {
+    state->end();
+}
+
+bool Bz2StreamDecoder::feed(const char* data, size_t len, const Bz2Sink& sink) {
+    if (!error.empty()) {
+        return false;
+    }
+
+    bz_stream& strm = state->strm;
+    const char* input = data;
+    size_t remaining = len;
+
+    while (remaining > 0) {
+        // Start the next stream (first one, or one concatenated after BZ_STREAM_END)
+        if (!state->active) {
+            state->begin();
+            if (!state->active) {
+                error = "bzip2 decoder initialization failed";
+                return false;
+            }
+        }
+
+        strm.next_in = const_cast<char*>(input);
+        strm.avail_in = static_cast<unsigned>(remaining);
+
+        int ret = BZ_OK;
+        while (strm.avail_in > 0 && ret == BZ_OK) {
+            strm.next_out = out_buffer.data();
+            strm.avail_out = static_cast<unsigned>(out_buffer.size());
+
+            ret = BZ2_bzDecompress(&strm);
+            if (ret != BZ_OK && ret != BZ_STREAM_END) {
+                error = "bzip2 data error (code " + std::to_string(ret) + ")";
+                return false;
+            }
+
+            size_t produced = out_buffer.size() - strm.avail_out;
+            if (produced > 0 && !sink(out_buffer.data(), produced)) {
+                error = "decoding aborted by consumer";
+                return false;
+            }
+        }
+
+        // Output may still be pending after the input is consumed
+        while (ret == BZ_OK && strm.avail_out == 0) {
+            strm.next_out = out_buffer.data();
+            strm.avail_out = static_cast<unsigned>(out_buffer.size());
+            ret = BZ2_bzDecompress(&strm);
+            if (ret != BZ_OK && ret != BZ_STREAM_END) {
+                error = "bzip2 data error (code " + std::to_string(ret) + ")";
+                return false;
+            }
+            size_t produced = out_buffer.size() - strm.avail_out;
+            if (produced > 0 && !sink(out_buffer.data(), produced)) {
+                error = "decoding aborted by consumer";
+                return false;
+            }
+        }
+
+        size_t consumed = remaining - strm.avail_in;
+        input += consumed;
+        remaining -= consumed;
+
+        if (ret == BZ_STREAM_END) {
+            state->end();
+        }
+    }
+
+    return true;
+}
+
+bool Bz2StreamDecoder::finish() {
+    if (!error.empty()) {
+        return false;
+    }
+    if (state->active || !state->saw_stream) {
+        error = "truncated bzip2 stream";
+        return false;
+    }
+    return true;
+}
+
+// Parallel Block Decoding
+
+namespace {
+    constexpr uint64_t BLOCK_MAGIC = 0x314159265359ULL;        // pi
+    constexpr uint64_t END_OF_STREAM_MAGIC = 0x177245385090ULL;  // sqrt(pi)
+    constexpr uint64_t MAGIC_MASK = 0xFFFFFFFFFFFFULL;
+
+    // Bit-aligned position of a block or end-of-stream marker
+    struct Marker {
+        uint64_t bit_offset;
+        bool is_block;
+    };
+
+    // Read 64 bits starting at byte index (big-endian, zero padded past the end)
+    inline uint64_t loadWindow(const uint8_t* data, size_t len, size_t index) {
+        uint64_t w = 0;
+        for (size_t k = 0; k < 8; k++) {
+            w = (w << 8) | (index + k < len ? data[index + k] : 0);
+        }
+        return w;
+    }
+
+    // Find all block and end-of-stream magics in [begin, end) byte starts
+    void scanMarkers(const uint8_t* data, size_t len, size_t begin, size_t end,
+                     std::vector<Marker>& out) {
+        if (end <= begin) return;
+
+        // For every shift, the window's second byte lies fully inside the
+        // magic; a 256-entry table of possible values rejects most positions
+        bool possible[256] = {};
+        for (unsigned shift = 0; shift < 8; shift++) {
+            possible[(BLOCK_MAGIC >> (32 + shift)) & 0xFF] = true;
+            possible[(END_OF_STREAM_MAGIC >> (32 + shift)) & 0xFF] = true;
+        }
+
+        uint64_t window = loadWindow(data, len, begin);
+        for (size_t i = begin; i < end; i++) {
+            if (!possible[(window >> 48) & 0xFF]) {
+                window = (window << 8) | (i + 8 < len ? data[i + 8] : 0);
+                continue;
+            }
+
+            // A 48-bit value starting at bit s of byte i fits in this 64-bit window for s < 8
+            for (unsigned shift = 0; shift < 8; shift++) {
+                uint64_t candidate = (window >> (16 - shift)) & MAGIC_MASK;
+                if (candidate == BLOCK_MAGIC || candidate == END_OF_STREAM_MAGIC) {
+                    out.push_back({static_cast<uint64_t>(i) * 8 + shift, candidate == BLOCK_MAGIC});
+                }
+            }
+            window = (window << 8) | (i + 8 < len ? data[i + 8] : 0);
+        }
+    }
+
+    // Append-only bit buffer (MSB first, as bzip2 writes)
+    class BitWriter {
+    public:
+        std::vector<char> bytes;
+        uint64_t bit_count = 0;
+
+        void putBits(uint64_t value, unsigned nbits) {
+            for (unsigned k = nbits; k-- > 0;) {
+                if (bit_count % 8 == 0) bytes.push_back(0);
+                if ((value >> k) & 1) {
+                    bytes.back() = static_cast<char>(bytes.back() | (0x80 >> (bit_count % 8)));
+                }
+                bit_count++;
+            }
+        }
+
+        // Copy [bit_begin, bit_end) from src; requires the writer to be byte-aligned
+        void copyBits(const uint8_t* src, size_t src_len, uint64_t bit_begin, uint64_t bit_end) {
+            uint64_t nbits = bit_end - bit_begin;
+            size_t first = static_cast<size_t>(bit_begin / 8);
+            unsigned shift = static_cast<unsigned>(bit_begin % 8);
+            size_t whole = static_cast<size_t>(nbits / 8);
+
+            for (size_t j = 0; j < whole; j++) {
+                unsigned hi = src[first + j];
+                unsigned lo = (first + j + 1 < src_len) ? src[first + j + 1] : 0;
+                bytes.push_back(static_cast<char>(((hi << shift) | (lo >> (8 - shift))) & 0xFF));
+            }
+            bit_count += static_cast<uint64_t>(whole) * 8;
+
+            for (uint64_t b = bit_begin + whole * 8; b < bit_end; b++) {
+                putBits((src[b / 8] >> (7 - b % 8)) & 1, 1);
+            }
+        }
+    };
+
+    inline uint64_t readBits(const uint8_t* data, size_t len, uint64_t bit_offset, unsigned nbits) {
+        uint64_t value = 0;
+        for (unsigned k = 0; k < nbits; k++) {
+            uint64_t b = bit_offset + k;
+            unsigned bit = (b / 8 < len) ? (data[b / 8] >> (7 - b % 8)) & 1 : 0;
+            value = (value << 1) | bit;
+        }
+        return value;
+    }
+
+    // Wrap one block as a complete stream: header, block bits, end-of-stream
+    // marker and a combined CRC (for a single block it equals the block CRC)
+    std::vector<char> wrapBlock(const uint8_t* data, size_t len, uint64_t bit_begin, uint64_t bit_end) {
+        BitWriter writer;
+        writer.bytes.reserve(static_cast<size_t>((bit_end - bit_begin) / 8 + 16));
+        writer.putBits('B', 8);
+        writer.putBits('Z', 8);
+        writer.putBits('h', 8);
+        writer.putBits('9', 8);  // Largest block size: accepts blocks from any level
+
+        writer.copyBits(data, len, bit_begin, bit_end);
+
+        uint64_t block_crc = readBits(data, len, bit_begin + 48, 32);
+        writer.putBits(END_OF_STREAM_MAGIC, 48);
+        writer.putBits(block_crc, 32);
+        return writer.bytes;
+    }
+
+    bool decodeWholeStream(const char* data, size_t len, std::string& out) {
+        Bz2StreamDecoder decoder;
+        bool ok = decoder.feed(data, len, [&out](const char* chunk, size_t n) {
+            out.append(chunk, n);
+            return true;
+        });
+        return ok && decoder.finish();
+    }
+}
+
+bool isBz2Data(const char* data, size_t len) {
+    return len >= 4 && data[0] == 'B' && data[1] == 'Z' && data[2] == 'h' &&
+           data[3] >= '1' && data[3] <= '9';
+}
+
+bool decompressBz2Parallel(const char* data, size_t len, const Bz2Sink& sink,
+                           unsigned threads, std::string* error) {
+    // Decode from the start, dropping the first skip output bytes (already
+    // passed to the sink by the parallel path)
+    auto serial = [&](uint64_t skip) {
+        Bz2StreamDecoder decoder;
+        auto resume = [&](const char* chunk, size_t n) {
+            if (skip >= n) {
+                skip -= n;
+                return true;
+            }
+            chunk += skip;
+            n -= static_cast<size_t>(skip);
+            skip = 0;
+            return sink(chunk, n);
+        };
+        bool ok = decoder.feed(data, len, resume) && decoder.finish();
+        if (!ok && error) *error = decoder.getError();
+        return ok;
+    };
+
+    if (threads == 0) threads = defaultThreadCount();
+    if (threads <= 1 || !isBz2Data(data, len)) {
+        return serial(0);
+    }
+
+    // 1. Locate markers, scanning byte ranges in parallel
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    std::vector<std::vector<Marker>> found(threads);
+    parallelFor(len, threads, [&](size_t begin, size_t end, unsigned worker) {
+        scanMarkers(bytes, len, begin, end, found[worker]);
+    }, 1 << 20);
+
+    std::vector<Marker> markers;
+    for (auto& part : found) {
+        markers.insert(markers.end(), part.begin(), part.end());
+    }
+    std::sort(markers.begin(), markers.end(),
+              [](const Marker& a, const Marker& b) { return a.bit_offset < b.bit_offset; });
+
+    // The input must end with an end-of-stream marker, its 32-bit CRC and
+    // padding; a truncated file (or trailing data) is left to the serial
+    // decoder, which reports it
+    if (markers.empty() || markers.back().is_block || (markers.back().bit_offset + 48 + 32 + 7) / 8 != len) {
+        return serial(0);
+    }
+
+    // 2. A block extends to the next marker of either kind
+    std::vector<std::pair<uint64_t, uint64_t>> blocks;
+    for (size_t i = 0; i + 1 < markers.size(); i++) {
+        if (markers[i].is_block) {
+            blocks.push_back({markers[i].bit_offset, markers[i + 1].bit_offset});
+        }
+    }
+    if (blocks.size() <= 1) {
+        return serial(0);
+    }
+
+    // 3. Decode blocks on workers; emit in order from this thread
+    enum : char { PENDING = 0, DECODED = 1, BAD = 2 };
+    const size_t window = static_cast<size_t>(threads) * 2;
+    std::vector<std::string> outputs(blocks.size());
+    std::vector<char> status(blocks.size(), PENDING);
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t next_block = 0;
+    size_t emitted = 0;
+    bool stop = false;
+
+    auto worker = [&]() {
+        for (;;) {
+            size_t index;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] {
+                    return stop || next_block >= blocks.size() || next_block < emitted + window;
+                });
+                if (stop || next_block >= blocks.size()) return;
+                index = next_block++;
+            }
+
+            std::vector<char> stream = wrapBlock(bytes, len, blocks[index].first, blocks[index].second);
+            std::string out;
+            bool ok = decodeWholeStream(stream.data(), stream.size(), out);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                outputs[index].swap(out);
+                status[index] = ok ? DECODED : BAD;
+            }
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    unsigned workers = static_cast<unsigned>(std::min<size_t>(threads, blocks.size()));
+    for (unsigned t = 0; t < workers; t++) {
+        pool.emplace_back(worker);
+    }
+
+    // A block magic occurring by chance inside compressed data splits one
+    // block into pieces that fail to decode; rejoin them with the following
+    // pieces until the combined range decodes. Anything else that fails to
+    // decode (a chance end-of-stream magic, or damaged data) is left to the
+    // serial decoder.
+    const size_t max_rejoin = 8;
+    std::string failure;
+    bool fall_back = false;
+    uint64_t emitted_bytes = 0;
+
+    while (emitted < blocks.size() && failure.empty()) {
+        std::string out;
+        size_t consumed = 1;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&] { return status[emitted] != PENDING; });
+            out.swap(outputs[emitted]);
+        }
+
+        if (status[emitted] == BAD) {
+            bool rejoined = false;
+            for (size_t last = emitted + 1; last < blocks.size() && last <= emitted + max_rejoin; last++) {
+                std::vector<char> stream = wrapBlock(bytes, len, blocks[emitted].first, blocks[last].second);
+                out.clear();
+                if (decodeWholeStream(stream.data(), stream.size(), out)) {
+                    consumed = last - emitted + 1;
+                    rejoined = true;
+                    break;
+                }
+            }
+            if (!rejoined) {
+                fall_back = true;
+                break;
+            }
+        }
+
+        if (!sink(out.data(), out.size())) {
+            failure = "decoding aborted by consumer";
+            break;
+        }
+        emitted_bytes += out.size();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t k = 1; k < consumed; k++) {
+                outputs[emitted + k].clear();
+            }
+            emitted += consumed;
+        }
+        cv.notify_all();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    cv.notify_all();
+    for (auto& t : pool) {
+        t.join();
+    }
+
+    if (fall_back) {
+        return serial(emitted_bytes);
+    }
+    if (!failure.empty()) {
+        if (error) *error = failure;
+        return false;
+    }
+    return true;
+}
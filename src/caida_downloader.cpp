@@ -1,295 +1,735 @@
-#include <iostream>
-#include <fstream>
-#include <string>
-#include <curl/curl.h>
-#include <ctime>
-#include <sstream>
-#include <iomanip>
-#include <sys/stat.h>
-
-class CAIDADownloader {
-private:
-    std::string base_url = "https://publicdata.caida.org/datasets/as-relationships/serial-2/";
-    std::string output_filename;
-    std::string cache_metadata_file;
-
-    // Callback function for writing data received from curl
-    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
-        size_t total_size = size * nmemb;
-        std::ofstream* out = static_cast<std::ofstream*>(userp);
-        out->write(static_cast<char*>(contents), total_size);
-        return total_size;
-    }
-
-    // Callback for reading headers
-    static size_t HeaderCallback(char* buffer, size_t size, size_t nitems, void* userdata) {
-        size_t total_size = size * nitems;
-        std::string* headers = static_cast<std::string*>(userdata);
-        headers->append(buffer, total_size);
-        return total_size;
-    }
-
-    // Get the previous month's year and month in YYYYMM format
-    std::string getPreviousMonthString() {
-        time_t now = time(nullptr);
-        tm* current_time = localtime(&now);
-
-        // Go back one month
-        current_time->tm_mon -= 1;
-        if (current_time->tm_mon < 0) {
-            current_time->tm_mon = 11;
-            current_time->tm_year -= 1;
-        }
-
-        mktime(current_time);  // Normalize the time structure
-
-        std::ostringstream oss;
-        oss << std::setfill('0')
-            << (current_time->tm_year + 1900)
-            << std::setw(2) << (current_time->tm_mon + 1);
-        return oss.str();
-    }
-
-    // Get file size in bytes
-    long getFileSize(const std::string& filename) {
-        struct stat file_stat;
-        if (stat(filename.c_str(), &file_stat) == 0) {
-            return file_stat.st_size;
-        }
-        return -1;
-    }
-
-    // Get file modification time
-    time_t getFileModTime(const std::string& filename) {
-        struct stat file_stat;
-        if (stat(filename.c_str(), &file_stat) == 0) {
-            return file_stat.st_mtime;
-        }
-        return 0;
-    }
-
-    // Check if file already exists and is recent (from current month's data)
-    bool isFileRecentlyDownloaded(const std::string& filename) {
-        struct stat file_stat;
-        if (stat(filename.c_str(), &file_stat) != 0) {
-            return false;  // File doesn't exist
-        }
-
-        // Check if file has content
-        if (file_stat.st_size == 0) {
-            return false;
-        }
-
-        time_t now = time(nullptr);
-        tm* current_time = localtime(&now);
-
-        // Get file modification time
-        tm* file_time = localtime(&file_stat.st_mtime);
-
-        // Check if file is from the same month OR from last month
-        // (Since we download previous month's data, it should be valid for current month)
-        if (file_time->tm_year == current_time->tm_year) {
-            // Same year - check if from current or previous month
-            if (file_time->tm_mon == current_time->tm_mon ||
-                file_time->tm_mon == current_time->tm_mon - 1) {
-                return true;
-            }
-        } else if (file_time->tm_year == current_time->tm_year - 1) {
-            // Previous year - only valid if it's December and we're in January
-            if (file_time->tm_mon == 11 && current_time->tm_mon == 0) {
-                return true;
-            }
-        }
-
-        return false;
-    }
-
-    // Save cache metadata for optimization
-    void saveCacheMetadata(const std::string& etag, const std::string& last_modified) {
-        std::ofstream meta(cache_metadata_file);
-        if (meta.is_open()) {
-            meta << "ETag: " << etag << "\n";
-            meta << "Last-Modified: " << last_modified << "\n";
-            meta.close();
-        }
-    }
-
-    // Load cache metadata
-    bool loadCacheMetadata(std::string& etag, std::string& last_modified) {
-        std::ifstream meta(cache_metadata_file);
-        if (!meta.is_open()) {
-            return false;
-        }
-
-        std::string line;
-        while (std::getline(meta, line)) {
-            if (line.find("ETag: ") == 0) {
-                etag = line.substr(6);
-            } else if (line.find("Last-Modified: ") == 0) {
-                last_modified = line.substr(15);
-            }
-        }
-        meta.close();
-        return !etag.empty() || !last_modified.empty();
-    }
-
-    // Try to download with fallback to earlier months
-    bool tryDownloadWithFallback(const std::string& base_filename, int months_to_try = 6) {
-        time_t now = time(nullptr);
-        tm* current_time = localtime(&now);
-
-        for (int i = 1; i <= months_to_try; i++) {
-            tm try_time = *current_time;
-            try_time.tm_mon -= i;
-            if (try_time.tm_mon < 0) {
-                try_time.tm_mon += 12;
-                try_time.tm_year -= 1;
-            }
-            mktime(&try_time);
-
-            std::ostringstream oss;
-            oss << std::setfill('0')
-                << (try_time.tm_year + 1900)
-                << std::setw(2) << (try_time.tm_mon + 1)
-                << "01." << base_filename;
-
-            std::string filename = oss.str();
-            std::string full_url = base_url + filename;
-
-            std::cout << "Trying: " << full_url << std::endl;
-
-            if (attemptDownload(full_url, filename)) {
-                return true;
-            }
-
-            std::cout << "Not available, trying earlier month..." << std::endl;
-        }
-
-        return false;
-    }
-
-    // Attempt to download from a specific URL
-    bool attemptDownload(const std::string& full_url, const std::string& remote_filename) {
-        CURL* curl = curl_easy_init();
-        if (!curl) {
-            std::cerr << "Error: Failed to initialize CURL" << std::endl;
-            return false;
-        }
-
-        // Quick HEAD request to check availability
-        curl_easy_setopt(curl, CURLOPT_URL, full_url.c_str());
-        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
-        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
-
-        CURLcode res = curl_easy_perform(curl);
-        long http_code = 0;
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
-        curl_easy_reset(curl);
-
-        if (res != CURLE_OK || http_code != 200) {
-            curl_easy_cleanup(curl);
-            return false;
-        }
-
-        // File is available, proceed with download
-        std::string compressed_filename = remote_filename;
-
-        std::ofstream output_file(compressed_filename, std::ios::binary);
-        if (!output_file.is_open()) {
-            std::cerr << "Error: Could not open output file" << std::endl;
-            curl_easy_cleanup(curl);
-            return false;
-        }
-
-        curl_easy_setopt(curl, CURLOPT_URL, full_url.c_str());
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &output_file);
-        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 600L);
-
-        std::cout << "Downloading..." << std::endl;
-        res = curl_easy_perform(curl);
-        output_file.close();
-
-        if (res != CURLE_OK) {
-            std::cerr << "Error: Download failed - " << curl_easy_strerror(res) << std::endl;
-            curl_easy_cleanup(curl);
-            remove(compressed_filename.c_str());
-            return false;
-        }
-
-        curl_easy_cleanup(curl);
-
-        // Decompress
-        std::cout << "Decompressing..." << std::endl;
-        std::string decompress_cmd = "bzip2 -d -f " + compressed_filename;
-        if (system(decompress_cmd.c_str()) != 0) {
-            std::cerr << "Error: Failed to decompress" << std::endl;
-            return false;
-        }
-
-        // Rename to standard filename
-        std::string decompressed = compressed_filename.substr(0, compressed_filename.length() - 4);
-        if (rename(decompressed.c_str(), output_filename.c_str()) != 0) {
-            // If rename fails, file might already have correct name
-            if (decompressed != output_filename) {
-                std::cerr << "Warning: Could not rename file" << std::endl;
-            }
-        }
-
-        std::cout << "Success! File: " << output_filename
-                  << " (" << getFileSize(output_filename) << " bytes)" << std::endl;
-        return true;
-    }
-
-public:
-    CAIDADownloader() {
-        output_filename = "as-rel.txt";
-        cache_metadata_file = ".caida_cache_metadata";
-    }
-
-    // Download the CAIDA AS relationship file with optimized caching
-    bool downloadASRelationships() {
-        // OPTIMIZATION 1: Check if we already have a recent download based on month
-        if (isFileRecentlyDownloaded(output_filename)) {
-            long file_size = getFileSize(output_filename);
-            std::cout << "[CACHE HIT] File " << output_filename
-                      << " is up-to-date (size: " << file_size << " bytes). Skipping download."
-                      << std::endl;
-            return true;
-        }
-
-        std::cout << "Searching for latest available CAIDA AS relationship data..." << std::endl;
-
-        // Try to download with fallback (tries up to 6 months back)
-        // Note: CAIDA filenames are "as-rel2.txt" not "as-rel.txt"
-        if (tryDownloadWithFallback("as-rel2.txt.bz2", 6)) {
-            return true;
-        }
-
-        std::cerr << "Error: Could not find any available CAIDA data in the last 6 months" << std::endl;
-        return false;
-    }
-
-    std::string getOutputFilename() const {
-        return output_filename;
-    }
-};
-
-int main() {
-    std::cout << "CAIDA AS Relationship Downloader" << std::endl;
-    std::cout << "=================================" << std::endl;
-
-    CAIDADownloader downloader;
-
-    if (!downloader.downloadASRelationships()) {
-        std::cerr << "Failed to download AS relationships" << std::endl;
-        return 1;
-    }
-
-    std::cout << "Download complete. File available at: "
-              << downloader.getOutputFilename() << std::endl;
-
-    return 0;
-}
+#include "as_graph.h"
+#include "bz2_decoder.h"
+#include "option_parse.h"
+#include "topology_archive.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <curl/curl.h>
+#include <ctime>
+#include <sstream>
+#include <iomanip>
+#include <cctype>
+#include <cstdio>
+#include <getopt.h>
+#include <iterator>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <filesystem>
+#include <system_error>
+#include <sys/stat.h>
+
+class CAIDADownloader {
+private:
+    std::string base_url = "https://publicdata.caida.org/datasets/as-relationships/serial-2/";
+    std::string output_filename;
+    std::string cache_metadata_file;
+    bool stream_to_snapshot = false;
+    std::unique_ptr<TopologyArchive> archive;  // Set in archive mode
+
+    // Outcome of one month's download
+    enum class FetchResult {
+        OK,             // Downloaded, or the local copy is current
+        NOT_PUBLISHED,  // 404: the caller may try an earlier month
+        FAILED          // Transfer or local error, already reported
+    };
+
+    // Per-transfer state for the write callback
+    // The file is opened lazily on the first body chunk, once the status is known:
+    // 206 appends to the partial file, 200 restarts it, anything else is discarded
+    struct TransferState {
+        CURL* curl;
+        std::string part_filename;
+        std::ofstream out;
+        long response_code = 0;
+        curl_off_t bytes_written = 0;
+    };
+
+    // Callback function for writing data received from curl
+    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
+        size_t total_size = size * nmemb;
+        TransferState* state = static_cast<TransferState*>(userp);
+
+        if (!state->out.is_open()) {
+            curl_easy_getinfo(state->curl, CURLINFO_RESPONSE_CODE, &state->response_code);
+            if (state->response_code == 206) {
+                state->out.open(state->part_filename, std::ios::binary | std::ios::app);
+            } else if (state->response_code == 200) {
+                state->out.open(state->part_filename, std::ios::binary | std::ios::trunc);
+            } else {
+                return total_size;  // Error page body: drop it
+            }
+            if (!state->out.is_open()) {
+                return 0;  // Aborts the transfer
+            }
+        }
+
+        state->out.write(static_cast<char*>(contents), total_size);
+        state->bytes_written += total_size;
+        return state->out ? total_size : 0;
+    }
+
+    // Callback for reading headers
+    // Keeps only the latest response block (redirects produce several)
+    static size_t HeaderCallback(char* buffer, size_t size, size_t nitems, void* userdata) {
+        size_t total_size = size * nitems;
+        std::string* headers = static_cast<std::string*>(userdata);
+        if (total_size >= 5 && std::string(buffer, 5) == "HTTP/") {
+            headers->clear();
+        }
+        headers->append(buffer, total_size);
+        return total_size;
+    }
+
+    // Streaming pipeline state: network -> bzip2 -> parser -> graph
+    // Only the decoder's output buffer and one partial line are held in memory
+    struct StreamingState {
+        CURL* curl;
+        long response_code = 0;
+        bool checked_status = false;
+        curl_off_t bytes_received = 0;
+        Bz2StreamDecoder decoder;
+        ASGraph graph;
+        RelationshipStreamParser parser;
+
+        explicit StreamingState(CURL* handle) : curl(handle), parser(graph) {}
+    };
+
+    static size_t StreamingWriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
+        size_t total_size = size * nmemb;
+        StreamingState* state = static_cast<StreamingState*>(userp);
+
+        if (!state->checked_status) {
+            curl_easy_getinfo(state->curl, CURLINFO_RESPONSE_CODE, &state->response_code);
+            state->checked_status = true;
+        }
+        if (state->response_code != 200) {
+            return total_size;  // Error page body: drop it
+        }
+
+        state->bytes_received += total_size;
+        RelationshipStreamParser& parser = state->parser;
+        bool ok = state->decoder.feed(static_cast<const char*>(contents), total_size,
+                                      [&parser](const char* data, size_t len) {
+                                          parser.feed(data, len);
+                                          return true;
+                                      });
+        return ok ? total_size : 0;  // 0 aborts the transfer
+    }
+
+    // Year and month in YYYYMM format, months_back months before the current one
+    std::string getMonthString(int months_back) {
+        time_t now = time(nullptr);
+        tm month_time = *localtime(&now);
+
+        month_time.tm_mday = 1;  // Avoid day overflow when stepping back (e.g. the 31st)
+        month_time.tm_mon -= months_back;
+        mktime(&month_time);     // Normalize the time structure
+
+        std::ostringstream oss;
+        oss << std::setfill('0')
+            << (month_time.tm_year + 1900)
+            << std::setw(2) << (month_time.tm_mon + 1);
+        return oss.str();
+    }
+
+    // Get file size in bytes
+    long getFileSize(const std::string& filename) {
+        struct stat file_stat;
+        if (stat(filename.c_str(), &file_stat) == 0) {
+            return file_stat.st_size;
+        }
+        return -1;
+    }
+
+    // Get file modification time
+    time_t getFileModTime(const std::string& filename) {
+        struct stat file_stat;
+        if (stat(filename.c_str(), &file_stat) == 0) {
+            return file_stat.st_mtime;
+        }
+        return 0;
+    }
+
+    // Validators returned by the server for a file we hold locally
+    struct CacheMetadata {
+        std::string url;
+        std::string etag;
+        std::string last_modified;
+    };
+
+    // Save cache metadata for conditional requests
+    void saveCacheMetadata(const std::string& meta_file, const CacheMetadata& meta_data) {
+        std::ofstream meta(meta_file);
+        if (meta.is_open()) {
+            meta << "URL: " << meta_data.url << "\n";
+            meta << "ETag: " << meta_data.etag << "\n";
+            meta << "Last-Modified: " << meta_data.last_modified << "\n";
+            meta.close();
+        }
+    }
+
+    // Load cache metadata
+    bool loadCacheMetadata(const std::string& meta_file, CacheMetadata& meta_data) {
+        std::ifstream meta(meta_file);
+        if (!meta.is_open()) {
+            return false;
+        }
+
+        std::string line;
+        while (std::getline(meta, line)) {
+            if (line.find("URL: ") == 0) {
+                meta_data.url = line.substr(5);
+            } else if (line.find("ETag: ") == 0) {
+                meta_data.etag = line.substr(6);
+            } else if (line.find("Last-Modified: ") == 0) {
+                meta_data.last_modified = line.substr(15);
+            }
+        }
+        meta.close();
+        return !meta_data.etag.empty() || !meta_data.last_modified.empty();
+    }
+
+    // Extract a header value from the last response block (case-insensitive name)
+    static std::string findHeader(const std::string& headers, const std::string& name) {
+        std::istringstream stream(headers);
+        std::string line;
+        std::string value;
+
+        while (std::getline(stream, line)) {
+            if (line.size() <= name.size() || line[name.size()] != ':') continue;
+
+            bool match = true;
+            for (size_t i = 0; i < name.size(); i++) {
+                if (std::tolower(static_cast<unsigned char>(line[i])) !=
+                    std::tolower(static_cast<unsigned char>(name[i]))) {
+                    match = false;
+                    break;
+                }
+            }
+            if (!match) continue;
+
+            value = line.substr(name.size() + 1);
+            value.erase(0, value.find_first_not_of(" \t"));
+            value.erase(value.find_last_not_of(" \t\r\n") + 1);
+        }
+        return value;
+    }
+
+    // Try to download with fallback to earlier months
+    // Only a month that is not published falls back; a failed transfer stops
+    // the search so the next run resumes the same month
+    FetchResult tryDownloadWithFallback(const std::string& base_filename, int months_to_try = 6) {
+        for (int i = 1; i <= months_to_try; i++) {
+            FetchResult result = tryDownloadMonth(getMonthString(i), base_filename);
+            if (result != FetchResult::NOT_PUBLISHED) {
+                return result;
+            }
+
+            std::cout << "Not available, trying earlier month..." << std::endl;
+        }
+
+        return FetchResult::NOT_PUBLISHED;
+    }
+
+    // Download one month's file (YYYYMM)
+    FetchResult tryDownloadMonth(const std::string& month, const std::string& base_filename) {
+        std::string filename = month + "01." + base_filename;
+        std::string full_url = base_url + filename;
+
+        std::cout << "Trying: " << full_url << std::endl;
+        return attemptDownload(full_url, filename);
+    }
+
+    // Decompress a .bz2 file with the parallel block decoder
+    bool decompressFile(const std::string& compressed_filename, const std::string& target_filename) {
+        std::ifstream in(compressed_filename, std::ios::binary);
+        if (!in.is_open()) {
+            std::cerr << "Error: Cannot open " << compressed_filename << std::endl;
+            return false;
+        }
+        std::vector<char> compressed((std::istreambuf_iterator<char>(in)),
+                                     std::istreambuf_iterator<char>());
+        in.close();
+
+        std::string tmp_filename = target_filename + ".tmp";
+        std::ofstream out(tmp_filename, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            std::cerr << "Error: Cannot open " << tmp_filename << " for writing" << std::endl;
+            return false;
+        }
+
+        std::string error;
+        bool ok = decompressBz2Parallel(compressed.data(), compressed.size(),
+                                        [&out](const char* data, size_t len) {
+                                            out.write(data, len);
+                                            return static_cast<bool>(out);
+                                        }, 0, &error);
+        out.close();
+
+        if (!ok || !out || rename(tmp_filename.c_str(), target_filename.c_str()) != 0) {
+            std::cerr << "Error: Failed to decompress " << compressed_filename
+                      << (error.empty() ? "" : ": " + error) << std::endl;
+            remove(tmp_filename.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // If-None-Match/If-Modified-Since for a local copy that came from this URL
+    struct curl_slist* addConditionalHeaders(struct curl_slist* headers, const std::string& full_url) {
+        CacheMetadata cached;
+        if (getFileSize(output_filename) > 0 &&
+            loadCacheMetadata(cache_metadata_file, cached) && cached.url == full_url) {
+            if (!cached.etag.empty()) {
+                headers = curl_slist_append(headers, ("If-None-Match: " + cached.etag).c_str());
+            }
+            if (!cached.last_modified.empty()) {
+                headers = curl_slist_append(headers, ("If-Modified-Since: " + cached.last_modified).c_str());
+            }
+        }
+        return headers;
+    }
+
+    // Classify a finished transfer that was neither a 304 nor a complete 200/206
+    static FetchResult failedTransfer(CURLcode res, long http_code) {
+        if (http_code == 404) {
+            return FetchResult::NOT_PUBLISHED;
+        }
+        if (res != CURLE_OK) {
+            std::cerr << "Error: Download failed - " << curl_easy_strerror(res) << std::endl;
+        } else {
+            std::cerr << "Error: Server answered HTTP " << http_code << std::endl;
+        }
+        return FetchResult::FAILED;
+    }
+
+    // Download, decompress and parse in one pass, then write a graph snapshot
+    // No intermediate .bz2 or text file touches the disk
+    FetchResult attemptStreamingDownload(const std::string& full_url) {
+        CURL* curl = curl_easy_init();
+        if (!curl) {
+            std::cerr << "Error: Failed to initialize CURL" << std::endl;
+            return FetchResult::FAILED;
+        }
+
+        struct curl_slist* request_headers = addConditionalHeaders(nullptr, full_url);
+        std::unique_ptr<StreamingState> state(new StreamingState(curl));
+        std::string response_headers;
+
+        curl_easy_setopt(curl, CURLOPT_URL, full_url.c_str());
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, request_headers);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, StreamingWriteCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, state.get());
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, HeaderCallback);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response_headers);
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 600L);
+
+        auto start = std::chrono::steady_clock::now();
+        CURLcode res = curl_easy_perform(curl);
+        long http_code = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+        curl_slist_free_all(request_headers);
+        curl_easy_cleanup(curl);
+
+        if (res == CURLE_OK && http_code == 304) {
+            std::cout << "[CACHE HIT] " << output_filename << " is up-to-date (HTTP 304). "
+                      << "Skipping download." << std::endl;
+            return FetchResult::OK;
+        }
+
+        if (http_code == 200 && res != CURLE_OK) {
+            // The stream is not resumable: nothing is kept
+            std::cerr << "Error: Download failed - " << curl_easy_strerror(res);
+            if (!state->decoder.getError().empty()) {
+                std::cerr << " (" << state->decoder.getError() << ")";
+            }
+            std::cerr << std::endl;
+            return FetchResult::FAILED;
+        }
+        if (http_code != 200) {
+            return failedTransfer(res, http_code);
+        }
+
+        state->parser.finish();
+        if (!state->decoder.finish()) {
+            std::cerr << "Error: " << state->decoder.getError() << std::endl;
+            return FetchResult::FAILED;
+        }
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        std::cout << "Streamed " << state->bytes_received << " compressed bytes in "
+                  << elapsed.count() << " ms" << std::endl;
+        state->graph.printLoadSummary(state->parser.getLineCount(), state->parser.getParsedCount());
+
+        // Write to a temporary name so readers never see a partial snapshot
+        std::string tmp_filename = output_filename + ".tmp";
+        if (!state->graph.saveSnapshot(tmp_filename) ||
+            rename(tmp_filename.c_str(), output_filename.c_str()) != 0) {
+            std::cerr << "Error: Could not write snapshot " << output_filename << std::endl;
+            remove(tmp_filename.c_str());
+            return FetchResult::FAILED;
+        }
+
+        CacheMetadata received;
+        received.url = full_url;
+        received.etag = findHeader(response_headers, "ETag");
+        received.last_modified = findHeader(response_headers, "Last-Modified");
+        saveCacheMetadata(cache_metadata_file, received);
+
+        std::cout << "Success! Snapshot: " << output_filename
+                  << " (" << getFileSize(output_filename) << " bytes)" << std::endl;
+        return FetchResult::OK;
+    }
+
+    // Attempt to download from a specific URL
+    // One conditional GET, no HEAD round trip:
+    // - If we hold this URL's data, send If-None-Match/If-Modified-Since; 304 means done
+    // - If a partial download of it exists, resume with Range + If-Range
+    // A transfer cut off mid-body keeps the .part file and its validators
+    FetchResult attemptDownload(const std::string& full_url, const std::string& remote_filename) {
+        if (stream_to_snapshot && !archive) {
+            return attemptStreamingDownload(full_url);
+        }
+
+        CURL* curl = curl_easy_init();
+        if (!curl) {
+            std::cerr << "Error: Failed to initialize CURL" << std::endl;
+            return FetchResult::FAILED;
+        }
+
+        // Archive mode keeps in-progress downloads inside the archive directory
+        std::string local_filename = archive ? archive->getRoot() + "/" + remote_filename : remote_filename;
+        std::string part_filename = local_filename + ".part";
+        std::string part_metadata_file = part_filename + ".meta";
+
+        // Archived months are immutable, so only the single-file modes revalidate
+        struct curl_slist* request_headers = archive ? nullptr : addConditionalHeaders(nullptr, full_url);
+
+        // Resume only when the partial data can be validated against the server copy
+        long partial_size = getFileSize(part_filename);
+        CacheMetadata partial;
+        if (partial_size > 0 && loadCacheMetadata(part_metadata_file, partial) && partial.url == full_url) {
+            std::string validator = partial.etag.empty() ? partial.last_modified : partial.etag;
+            request_headers = curl_slist_append(request_headers, ("If-Range: " + validator).c_str());
+            // A plain Range header rather than CURLOPT_RESUME_FROM_LARGE: on an If-Range
+            // mismatch the server sends the full body (200), which libcurl's resume
+            // option rejects; WriteCallback restarts the partial file instead
+            std::string range = std::to_string(partial_size) + "-";
+            curl_easy_setopt(curl, CURLOPT_RANGE, range.c_str());
+            std::cout << "Resuming partial download at byte " << partial_size << std::endl;
+        } else if (partial_size >= 0) {
+            remove(part_filename.c_str());
+            remove(part_metadata_file.c_str());
+        }
+
+        TransferState state;
+        state.curl = curl;
+        state.part_filename = part_filename;
+        std::string response_headers;
+
+        curl_easy_setopt(curl, CURLOPT_URL, full_url.c_str());
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, request_headers);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &state);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, HeaderCallback);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response_headers);
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 10L);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 600L);
+
+        CURLcode res = curl_easy_perform(curl);
+        long http_code = 0;
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &http_code);
+        curl_slist_free_all(request_headers);
+        curl_easy_cleanup(curl);
+        if (state.out.is_open()) {
+            state.out.close();
+        }
+
+        CacheMetadata received;
+        received.url = full_url;
+        received.etag = findHeader(response_headers, "ETag");
+        received.last_modified = findHeader(response_headers, "Last-Modified");
+
+        if (res == CURLE_OK && http_code == 304) {
+            std::cout << "[CACHE HIT] " << output_filename << " is up-to-date (HTTP 304, size: "
+                      << getFileSize(output_filename) << " bytes). Skipping download." << std::endl;
+            return FetchResult::OK;
+        }
+
+        if (http_code != 200 && http_code != 206) {
+            return failedTransfer(res, http_code);
+        }
+
+        if (res != CURLE_OK) {
+            std::cerr << "Error: Download failed - " << curl_easy_strerror(res) << std::endl;
+            // Keep what we have for a ranged retry if the server gave us a validator
+            if (getFileSize(part_filename) > 0 &&
+                (!received.etag.empty() || !received.last_modified.empty())) {
+                saveCacheMetadata(part_metadata_file, received);
+                std::cerr << "Partial download kept (" << getFileSize(part_filename)
+                          << " bytes); rerun to resume" << std::endl;
+            } else {
+                remove(part_filename.c_str());
+            }
+            return FetchResult::FAILED;
+        }
+
+        std::cout << "Downloaded " << state.bytes_written << " bytes"
+                  << (http_code == 206 ? " (resumed)" : "") << std::endl;
+        remove(part_metadata_file.c_str());
+
+        std::string compressed_filename = local_filename;
+        if (rename(part_filename.c_str(), compressed_filename.c_str()) != 0) {
+            std::cerr << "Error: Could not rename " << part_filename << std::endl;
+            return FetchResult::FAILED;
+        }
+
+        if (archive) {
+            // The archive stores the .bz2 and converts it to a snapshot once
+            bool added = archive->addMonth(remote_filename.substr(0, 6), compressed_filename);
+            return added ? FetchResult::OK : FetchResult::FAILED;
+        }
+
+        // Decompress
+        std::cout << "Decompressing..." << std::endl;
+        if (!decompressFile(compressed_filename, output_filename)) {
+            return FetchResult::FAILED;
+        }
+        remove(compressed_filename.c_str());
+
+        // Validators for the next run's conditional request
+        saveCacheMetadata(cache_metadata_file, received);
+
+        std::cout << "Success! File: " << output_filename
+                  << " (" << getFileSize(output_filename) << " bytes)" << std::endl;
+        return FetchResult::OK;
+    }
+
+    // Archive a single month unless it is archived already
+    FetchResult fetchArchiveMonth(const std::string& month) {
+        if (archive->hasMonth(month)) {
+            std::cout << "[ARCHIVED] " << month << " -> " << archive->getSnapshotPath(month) << std::endl;
+            return FetchResult::OK;
+        }
+        return tryDownloadMonth(month, "as-rel2.txt.bz2");
+    }
+
+public:
+    CAIDADownloader() {
+        output_filename = "as-rel.txt";
+        cache_metadata_file = ".caida_cache_metadata";
+    }
+
+    void setBaseUrl(const std::string& url) {
+        base_url = url;
+        if (!base_url.empty() && base_url.back() != '/') {
+            base_url += '/';
+        }
+    }
+
+    void setOutputFilename(const std::string& filename) {
+        output_filename = filename;
+    }
+
+    // Streaming mode: write a binary graph snapshot instead of as-rel.txt
+    // Validators are kept next to the snapshot so both modes can coexist
+    void setSnapshotFilename(const std::string& filename) {
+        output_filename = filename;
+        cache_metadata_file = filename + ".meta";
+        stream_to_snapshot = true;
+    }
+
+    // Download the CAIDA AS relationship file
+    // Freshness is decided by the server through conditional requests
+    bool downloadASRelationships(int months_to_try = 6) {
+        std::cout << "Searching for latest available CAIDA AS relationship data..." << std::endl;
+
+        // Try to download with fallback (tries up to months_to_try months back)
+        // Note: CAIDA filenames are "as-rel2.txt" not "as-rel.txt"
+        FetchResult result = tryDownloadWithFallback("as-rel2.txt.bz2", months_to_try);
+        if (result == FetchResult::NOT_PUBLISHED) {
+            std::cerr << "Error: Could not find any available CAIDA data in the last "
+                      << months_to_try << " months" << std::endl;
+        }
+        return result == FetchResult::OK;
+    }
+
+    // Archive mode: keep every month under directory instead of overwriting one file
+    bool setArchiveDirectory(const std::string& directory) {
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        if (ec) {
+            std::cerr << "Error: Cannot create archive directory " << directory
+                      << ": " << ec.message() << std::endl;
+            return false;
+        }
+        archive.reset(new TopologyArchive(directory));
+        return archive->load();
+    }
+
+    // Archive every published month in the search window that is not archived yet
+    // Stops at the first failed transfer
+    bool archiveRecentMonths(int months_to_try = 6) {
+        int available = 0;
+        for (int i = 1; i <= months_to_try; i++) {
+            FetchResult result = fetchArchiveMonth(getMonthString(i));
+            if (result == FetchResult::FAILED) {
+                return false;
+            }
+            if (result == FetchResult::OK) {
+                available++;
+            }
+        }
+
+        std::cout << available << " of the last " << months_to_try
+                  << " months available in " << archive->getRoot() << std::endl;
+        return available > 0;
+    }
+
+    // Archive a single month (YYYYMM); already archived months are not downloaded again
+    bool archiveMonth(const std::string& month) {
+        FetchResult result = fetchArchiveMonth(month);
+        if (result == FetchResult::NOT_PUBLISHED) {
+            std::cerr << "Error: " << month << " is not published" << std::endl;
+        }
+        return result == FetchResult::OK;
+    }
+
+    void listArchive() const {
+        for (const auto& pair : archive->getEntries()) {
+            std::cout << pair.first << "  " << pair.second.fingerprint << "  "
+                      << archive->getSnapshotPath(pair.first) << std::endl;
+        }
+    }
+
+    std::string getOutputFilename() const {
+        return output_filename;
+    }
+};
+
+void print_usage(const char* prog_name) {
+    std::cout << "Usage: " << prog_name << " [options]\n"
+              << "Options:\n"
+              << "  --base-url <url>        Dataset directory URL (default: CAIDA serial-2)\n"
+              << "  --output <file>         Output file (default: as-rel.txt)\n"
+              << "  --snapshot <file>       Stream download -> bunzip2 -> parse into a binary\n"
+              << "                          graph snapshot in one pass (no text file written)\n"
+              << "  --months <n>            Months to search back (default: 6)\n"
+              << "  --archive <dir>         Keep every month in a local archive; each month is\n"
+              << "                          downloaded and converted to a snapshot once\n"
+              << "  --month <YYYYMM>        With --archive: fetch only this month\n"
+              << "  --list                  With --archive: list archived months and exit\n"
+              << "  -h, --help              Show this help\n";
+}
+
+int main(int argc, char* argv[]) {
+    static struct option long_options[] = {
+        {"base-url", required_argument, 0, 'b'},
+        {"output", required_argument, 0, 'o'},
+        {"snapshot", required_argument, 0, 's'},
+        {"months", required_argument, 0, 'm'},
+        {"archive", required_argument, 0, 'a'},
+        {"month", required_argument, 0, 'M'},
+        {"list", no_argument, 0, 'l'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    CAIDADownloader downloader;
+    int months_to_try = 6;
+    std::string archive_dir;
+    std::string month;
+    bool list_archive = false;
+
+    int opt;
+    int option_index = 0;
+    while ((opt = getopt_long(argc, argv, "b:o:s:m:a:M:lh", long_options, &option_index)) != -1) {
+        switch (opt) {
+            case 'b':
+                downloader.setBaseUrl(optarg);
+                break;
+            case 'o':
+                downloader.setOutputFilename(optarg);
+                break;
+            case 's':
+                downloader.setSnapshotFilename(optarg);
+                break;
+            case 'm':
+                if (!parseUnsigned(optarg, months_to_try) || months_to_try == 0) {
+                    std::cerr << "Error: --months expects a positive number of months\n\n";
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'a':
+                archive_dir = optarg;
+                break;
+            case 'M':
+                month = optarg;
+                break;
+            case 'l':
+                list_archive = true;
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    std::cout << "CAIDA AS Relationship Downloader" << std::endl;
+    std::cout << "=================================" << std::endl;
+
+    if ((!month.empty() || list_archive) && archive_dir.empty()) {
+        std::cerr << "Error: --month and --list require --archive" << std::endl;
+        return 1;
+    }
+    if (!month.empty() && !TopologyArchive::isValidMonth(month)) {
+        std::cerr << "Error: --month expects YYYYMM, got " << month << std::endl;
+        return 1;
+    }
+
+    if (!archive_dir.empty()) {
+        if (!downloader.setArchiveDirectory(archive_dir)) {
+            return 1;
+        }
+        if (list_archive) {
+            downloader.listArchive();
+            return 0;
+        }
+
+        curl_global_init(CURL_GLOBAL_DEFAULT);
+        bool ok = month.empty() ? downloader.archiveRecentMonths(months_to_try)
+                                : downloader.archiveMonth(month);
+        curl_global_cleanup();
+
+        if (!ok) {
+            std::cerr << "Failed to archive AS relationships" << std::endl;
+            return 1;
+        }
+        std::cout << "Archive up to date: " << archive_dir << std::endl;
+        return 0;
+    }
+
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    bool ok = downloader.downloadASRelationships(months_to_try);
+    curl_global_cleanup();
+
+    if (!ok) {
+        std::cerr << "Failed to download AS relationships" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Download complete. File available at: "
+              << downloader.getOutputFilename() << std::endl;
+
+    return 0;
+}
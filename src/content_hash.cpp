@@ -0,0 +1,110 @@
+#include "content_hash.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace {
+    constexpr uint64_t LANE1_SEED = 0x9e3779b97f4a7c15ULL;
+    constexpr uint64_t LANE2_SEED = 0xc2b2ae3d27d4eb4fULL;
+    constexpr uint64_t K1 = 0x87c37b91114253d5ULL;
+    constexpr uint64_t K2 = 0x4cf5ad432745937fULL;
+
+    inline uint64_t rotl64(uint64_t x, int r) {
+        return (x << r) | (x >> (64 - r));
+    }
+}
+
+std::string Hash128::toHex() const {
+    static const char digits[] = "0123456789abcdef";
+    std::string out(32, '0');
+    for (int i = 0; i < 16; i++) {
+        out[15 - i] = digits[(high >> (i * 4)) & 0xF];
+        out[31 - i] = digits[(low >> (i * 4)) & 0xF];
+    }
+    return out;
+}
+
+ContentHasher::ContentHasher() : lane1(LANE1_SEED), lane2(LANE2_SEED) {
+    std::memset(tail, 0, sizeof(tail));
+}
+
+void ContentHasher::mixWord(uint64_t word) {
+    lane1 = rotl64(lane1 ^ mix64(word + LANE1_SEED), 27) * K1 + lane2;
+    lane2 = rotl64(lane2 ^ mix64(word + LANE2_SEED), 31) * K2 + lane1;
+}
+
+void ContentHasher::update(const void* data, size_t len) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    total_bytes += len;
+
+    // Complete a pending partial word first
+    if (tail_len > 0) {
+        size_t take = std::min(len, sizeof(tail) - tail_len);
+        std::memcpy(tail + tail_len, bytes, take);
+        tail_len += take;
+        bytes += take;
+        len -= take;
+
+        if (tail_len < sizeof(tail)) {
+            return;
+        }
+
+        uint64_t word;
+        std::memcpy(&word, tail, sizeof(word));
+        mixWord(word);
+        tail_len = 0;
+    }
+
+    // Fast path: whole words straight from the input
+    while (len >= sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, bytes, sizeof(word));
+        mixWord(word);
+        bytes += sizeof(word);
+        len -= sizeof(word);
+    }
+
+    std::memcpy(tail, bytes, len);
+    tail_len = len;
+}
+
+Hash128 ContentHasher::digest() const {
+    uint64_t h1 = lane1;
+    uint64_t h2 = lane2;
+
+    // Fold in the trailing bytes and total length so that prefixes differ
+    uint64_t last = 0;
+    std::memcpy(&last, tail, tail_len);
+    h1 ^= mix64(last ^ total_bytes);
+    h2 ^= mix64(last + K1) ^ total_bytes;
+
+    h1 += h2;
+    h2 += h1;
+    h1 = mix64(h1);
+    h2 = mix64(h2);
+    h1 += h2;
+    h2 += h1;
+
+    return Hash128(h1, h2);
+}
+
+bool hashFile(const std::string& filename, Hash128& out) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    ContentHasher hasher;
+    std::vector<char> buffer(1 << 20);
+    while (file) {
+        file.read(buffer.data(), buffer.size());
+        std::streamsize got = file.gcount();
+        if (got > 0) {
+            hasher.update(buffer.data(), static_cast<size_t>(got));
+        }
+    }
+
+    out = hasher.digest();
+    return true;
+}
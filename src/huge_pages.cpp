@@ -0,0 +1,312 @@
+#include "huge_pages.h"
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <sys/mman.h>
+
+namespace {
+    constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    constexpr size_t CHUNK_SIZE = 16 * HUGE_PAGE_SIZE;   // Central pool refill
+    constexpr size_t SIZE_CLASS = 16;
+    constexpr size_t SMALL_LIMIT = 1024;                 // Largest pooled object
+    constexpr size_t NUM_CLASSES = SMALL_LIMIT / SIZE_CLASS;
+    constexpr size_t LARGE_LIMIT = 256 * 1024;           // Own region from here on
+
+    std::atomic<int> current_mode(static_cast<int>(HugePageMode::OFF));
+    std::atomic<bool> allocation_started(false);
+    std::atomic<uint64_t> explicit_bytes(0);
+    std::atomic<uint64_t> transparent_bytes(0);
+
+    std::mutex explicit_warning_mutex;
+    bool explicit_warned = false;
+
+    inline size_t roundUp(size_t value, size_t to) {
+        return (value + to - 1) / to * to;
+    }
+
+    // 2 MB-aligned anonymous region of rounded-up size
+    void* mapRegion(size_t bytes) {
+        bytes = roundUp(bytes, HUGE_PAGE_SIZE);
+
+        if (getHugePageMode() == HugePageMode::EXPLICIT) {
+            void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                explicit_bytes += bytes;
+                return p;
+            }
+
+            std::lock_guard<std::mutex> lock(explicit_warning_mutex);
+            if (!explicit_warned) {
+                explicit_warned = true;
+                std::cerr << "Warning: No reserved huge pages (vm.nr_hugepages); "
+                          << "falling back to transparent huge pages" << std::endl;
+            }
+        }
+
+        // Over-map, then trim to a 2 MB boundary so THP can back whole pages
+        size_t span = bytes + HUGE_PAGE_SIZE;
+        void* raw = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+
+        uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = roundUp(start, HUGE_PAGE_SIZE);
+        if (aligned > start) {
+            munmap(raw, aligned - start);
+        }
+        size_t tail = (start + span) - (aligned + bytes);
+        if (tail > 0) {
+            munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+        }
+
+        void* p = reinterpret_cast<void*>(aligned);
+        madvise(p, bytes, MADV_HUGEPAGE);
+        transparent_bytes += bytes;
+        return p;
+    }
+
+    void unmapRegion(void* ptr, size_t bytes) {
+        // Explicit regions are also multiples of 2 MB, so the same length applies
+        munmap(ptr, roundUp(bytes, HUGE_PAGE_SIZE));
+    }
+
+    // Process-wide pool: size-class free lists and the chunk objects are carved
+    // from, behind one lock. Threads move objects in batches through their
+    // caches, so the lock is taken once per BATCH allocations or frees; regions
+    // are never returned to the system while the process runs.
+    constexpr size_t BATCH = 64;
+
+    struct CentralPool {
+        std::mutex mutex;
+        void* free_lists[NUM_CLASSES] = {};
+        char* bump = nullptr;
+        char* bump_end = nullptr;
+
+        // Up to BATCH objects of class cls, linked; returns the count
+        size_t take(size_t cls, void*& head) {
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t count = 0;
+            void*& list = free_lists[cls];
+            while (list && count < BATCH) {
+                void* p = list;
+                list = *static_cast<void**>(p);
+                *static_cast<void**>(p) = head;
+                head = p;
+                count++;
+            }
+            if (count > 0) return count;
+
+            size_t size = (cls + 1) * SIZE_CLASS;
+            for (; count < BATCH; count++) {
+                if (bump + size > bump_end) {
+                    bump = static_cast<char*>(mapRegion(CHUNK_SIZE));
+                    bump_end = bump + CHUNK_SIZE;
+                }
+                *reinterpret_cast<void**>(bump) = head;
+                head = bump;
+                bump += size;
+            }
+            return count;
+        }
+
+        // Splice the list head..tail of class cls in
+        void give(size_t cls, void* head, void* tail) {
+            std::lock_guard<std::mutex> lock(mutex);
+            *static_cast<void**>(tail) = free_lists[cls];
+            free_lists[cls] = head;
+        }
+    };
+
+    // Never destroyed: threads may flush their caches during static destruction
+    CentralPool& centralPool() {
+        static CentralPool* pool = new CentralPool();
+        return *pool;
+    }
+
+    // Per-thread cache in front of the central pool: no locking on the hot path
+    // Trivially destructible, so it stays usable after its thread's flusher ran;
+    // from then on the thread bypasses it.
+    struct ThreadCache {
+        void* free_lists[NUM_CLASSES];
+        size_t counts[NUM_CLASSES];
+        bool registered;  // Flusher constructed
+        bool retired;     // Flusher ran
+
+        void* allocate(size_t cls) {
+            void*& head = free_lists[cls];
+            if (!head) {
+                counts[cls] = centralPool().take(cls, head);
+            }
+            void* p = head;
+            head = *static_cast<void**>(p);
+            counts[cls]--;
+            return p;
+        }
+
+        void release(void* p, size_t cls) {
+            *static_cast<void**>(p) = free_lists[cls];
+            free_lists[cls] = p;
+            if (++counts[cls] >= 2 * BATCH) {
+                flush(cls, BATCH);
+            }
+        }
+
+        // Return up to count objects of class cls to the central pool
+        void flush(size_t cls, size_t count) {
+            void* head = free_lists[cls];
+            if (!head) return;
+            void* tail = head;
+            size_t moved = 1;
+            while (moved < count && *static_cast<void**>(tail)) {
+                tail = *static_cast<void**>(tail);
+                moved++;
+            }
+            free_lists[cls] = *static_cast<void**>(tail);
+            counts[cls] -= moved;
+            centralPool().give(cls, head, tail);
+        }
+
+        void flushAll() {
+            for (size_t cls = 0; cls < NUM_CLASSES; cls++) {
+                flush(cls, counts[cls]);
+            }
+        }
+    };
+
+    thread_local ThreadCache thread_cache = {};
+
+    // Hands a finishing thread's cached objects back for other threads to reuse
+    struct ThreadCacheFlusher {
+        ThreadCacheFlusher() { thread_cache.registered = true; }
+        ~ThreadCacheFlusher() {
+            thread_cache.flushAll();
+            thread_cache.retired = true;
+        }
+    };
+
+    // On a thread's first pool access
+    void registerThreadCache() {
+        static thread_local ThreadCacheFlusher flusher;
+    }
+
+    void* poolAllocate(size_t cls) {
+        if (thread_cache.retired) {
+            void* p = nullptr;
+            CentralPool& pool = centralPool();
+            pool.take(cls, p);
+            // Keep one, return the rest of the batch
+            void* rest = *static_cast<void**>(p);
+            if (rest) {
+                void* tail = rest;
+                while (*static_cast<void**>(tail)) tail = *static_cast<void**>(tail);
+                pool.give(cls, rest, tail);
+            }
+            return p;
+        }
+        if (!thread_cache.registered) registerThreadCache();
+        return thread_cache.allocate(cls);
+    }
+
+    void poolRelease(void* p, size_t cls) {
+        if (thread_cache.retired) {
+            *static_cast<void**>(p) = nullptr;
+            centralPool().give(cls, p, p);
+            return;
+        }
+        if (!thread_cache.registered) registerThreadCache();
+        thread_cache.release(p, cls);
+    }
+}
+
+bool setHugePageMode(HugePageMode mode) {
+    if (allocation_started.load(std::memory_order_relaxed) && mode != getHugePageMode()) {
+        std::cerr << "Warning: Huge page mode must be chosen before the graph is created" << std::endl;
+        return false;
+    }
+    current_mode.store(static_cast<int>(mode), std::memory_order_relaxed);
+    return true;
+}
+
+HugePageMode getHugePageMode() {
+    return static_cast<HugePageMode>(current_mode.load(std::memory_order_relaxed));
+}
+
+bool parseHugePageMode(const std::string& text, HugePageMode& mode) {
+    if (text == "off") {
+        mode = HugePageMode::OFF;
+    } else if (text == "thp" || text == "transparent") {
+        mode = HugePageMode::TRANSPARENT;
+    } else if (text == "explicit" || text == "hugetlb") {
+        mode = HugePageMode::EXPLICIT;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* hugePageModeName(HugePageMode mode) {
+    switch (mode) {
+        case HugePageMode::TRANSPARENT: return "thp";
+        case HugePageMode::EXPLICIT: return "explicit";
+        default: return "off";
+    }
+}
+
+HugePageStats getHugePageStats() {
+    HugePageStats stats;
+    stats.explicit_bytes = explicit_bytes.load();
+    stats.transparent_bytes = transparent_bytes.load();
+
+    std::ifstream smaps("/proc/self/smaps_rollup");
+    std::string key;
+    uint64_t kb;
+    while (smaps >> key) {
+        if (key == "AnonHugePages:" && smaps >> kb) {
+            stats.anon_huge_bytes = kb * 1024;
+            break;
+        }
+        smaps.ignore(256, '\n');
+    }
+    return stats;
+}
+
+void* hugePageAllocate(size_t bytes) {
+    if (!allocation_started.load(std::memory_order_relaxed)) {
+        allocation_started.store(true, std::memory_order_relaxed);
+    }
+
+    if (getHugePageMode() == HugePageMode::OFF) {
+        return ::operator new(bytes);
+    }
+
+    if (bytes == 0) bytes = 1;
+    if (bytes <= SMALL_LIMIT) {
+        return poolAllocate((bytes - 1) / SIZE_CLASS);
+    }
+    if (bytes >= LARGE_LIMIT) {
+        return mapRegion(bytes);
+    }
+    return ::operator new(bytes);
+}
+
+void hugePageFree(void* ptr, size_t bytes) noexcept {
+    if (!ptr) return;
+
+    if (getHugePageMode() == HugePageMode::OFF) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    if (bytes == 0) bytes = 1;
+    if (bytes <= SMALL_LIMIT) {
+        poolRelease(ptr, (bytes - 1) / SIZE_CLASS);
+    } else if (bytes >= LARGE_LIMIT) {
+        unmapRegion(ptr, bytes);
+    } else {
+        ::operator delete(ptr);
+    }
+}
@@ -0,0 +1,400 @@
+#include "output_writer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define OUTPUT_WRITER_IO_URING 1
+#endif
+#endif
+
+namespace {
+    constexpr size_t DIRECT_ALIGNMENT = 4096;
+
+    inline size_t roundUp(size_t value, size_t to) {
+        return (value + to - 1) / to * to;
+    }
+}
+
+// Minimal io_uring: one SQE per buffer write, completions reaped one at a time
+class OutputWriter::Ring {
+public:
+#ifdef OUTPUT_WRITER_IO_URING
+    int ring_fd = -1;
+    void* sq_ring = MAP_FAILED;
+    void* cq_ring = MAP_FAILED;
+    size_t sq_ring_size = 0;
+    size_t cq_ring_size = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqes_size = 0;
+
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_mask = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned* cq_mask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    bool setup(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) {
+            return false;  // ENOSYS, or disabled by seccomp / sysctl
+        }
+        ring_fd = fd;
+
+        sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+        }
+
+        sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring_fd, IORING_OFF_SQ_RING);
+        if (sq_ring == MAP_FAILED) {
+            return false;
+        }
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            cq_ring = sq_ring;
+        } else {
+            cq_ring = mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           ring_fd, IORING_OFF_CQ_RING);
+            if (cq_ring == MAP_FAILED) {
+                return false;
+            }
+        }
+
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE,
+                                               MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+
+        char* sq = static_cast<char*>(sq_ring);
+        char* cq = static_cast<char*>(cq_ring);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    ~Ring() {
+        if (sqes != MAP_FAILED) munmap(sqes, sqes_size);
+        if (cq_ring != MAP_FAILED && cq_ring != sq_ring) munmap(cq_ring, cq_ring_size);
+        if (sq_ring != MAP_FAILED) munmap(sq_ring, sq_ring_size);
+        if (ring_fd >= 0) ::close(ring_fd);
+    }
+
+    // Never more writes in flight than SQ entries, so a slot is always free
+    bool submitWrite(int fd, const char* data, size_t length, uint64_t offset, uint64_t tag) {
+        unsigned tail = *sq_tail;
+        unsigned index = tail & *sq_mask;
+
+        io_uring_sqe& sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_WRITE;
+        sqe.fd = fd;
+        sqe.addr = reinterpret_cast<uint64_t>(data);
+        sqe.len = static_cast<uint32_t>(length);
+        sqe.off = offset;
+        sqe.user_data = tag;
+
+        sq_array[index] = index;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+        int ret;
+        do {
+            ret = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, 1, 0, 0, nullptr, 0));
+        } while (ret < 0 && errno == EINTR);
+        return ret == 1;
+    }
+
+    // Block until one write completes
+    bool reap(uint64_t& tag, int& result) {
+        while (true) {
+            unsigned head = *cq_head;
+            if (head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+                const io_uring_cqe& cqe = cqes[head & *cq_mask];
+                tag = cqe.user_data;
+                result = cqe.res;
+                __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+
+            int ret = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, 0, 1,
+                                               IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (ret < 0 && errno != EINTR) {
+                return false;
+            }
+        }
+    }
+#else
+    bool setup(unsigned) { return false; }
+    bool submitWrite(int, const char*, size_t, uint64_t, uint64_t) { return false; }
+    bool reap(uint64_t&, int&) { return false; }
+#endif
+};
+
+OutputWriter::OutputWriter() : failed(false) {}
+
+OutputWriter::~OutputWriter() {
+    if (fd >= 0) {
+        close();
+    }
+    release();
+}
+
+bool OutputWriter::open(const std::string& file, const OutputWriterOptions& opts) {
+    if (fd >= 0) {
+        close();
+    }
+
+    filename = file;
+    options = opts;
+    options.buffer_size = roundUp(std::max<size_t>(options.buffer_size, DIRECT_ALIGNMENT), DIRECT_ALIGNMENT);
+    options.queue_depth = std::max(2u, options.queue_depth);
+    failed = false;
+    direct = false;
+    offset = 0;
+    total_bytes = 0;
+    current = 0;
+
+    int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    if (options.direct_io) {
+        fd = ::open(filename.c_str(), flags | O_DIRECT, 0644);
+        if (fd >= 0) {
+            direct = true;
+        } else if (errno == EINVAL) {
+            std::cerr << "Warning: " << filename << " does not support O_DIRECT; "
+                      << "using buffered writes" << std::endl;
+        }
+    }
+    if (fd < 0) {
+        fd = ::open(filename.c_str(), flags, 0644);
+    }
+    if (fd < 0) {
+        std::cerr << "Error: Cannot open file " << filename << " for writing: "
+                  << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    buffers.resize(options.queue_depth);
+    for (Buffer& buf : buffers) {
+        void* mem = nullptr;
+        if (posix_memalign(&mem, DIRECT_ALIGNMENT, options.buffer_size) != 0) {
+            std::cerr << "Error: Cannot allocate output buffers" << std::endl;
+            release();
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+        buf.data = static_cast<char*>(mem);
+        buf.fill = 0;
+        buf.busy = false;
+    }
+
+    if (options.use_io_uring) {
+        ring.reset(new Ring());
+        if (!ring->setup(options.queue_depth)) {
+            ring.reset();
+        }
+    }
+    if (!ring) {
+        stopping = false;
+        writer_thread = std::thread(&OutputWriter::writerLoop, this);
+    }
+    return true;
+}
+
+bool OutputWriter::writeFully(const char* data, size_t length, uint64_t at) {
+    while (length > 0) {
+        ssize_t n = pwrite(fd, data, length, static_cast<off_t>(at));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EINVAL && direct) {
+                // Filesystem accepted O_DIRECT at open but not for this write
+                int flags = fcntl(fd, F_GETFL);
+                if (flags >= 0 && (flags & O_DIRECT) && fcntl(fd, F_SETFL, flags & ~O_DIRECT) == 0) {
+                    continue;
+                }
+            }
+            std::cerr << "Error: Write to " << filename << " failed: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+        at += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+void OutputWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        submit_cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty()) {
+            return;
+        }
+
+        Buffer& buf = buffers[jobs.front()];
+        jobs.pop_front();
+        lock.unlock();
+
+        bool ok = writeFully(buf.data, buf.length, buf.at);
+
+        lock.lock();
+        if (!ok) failed = true;
+        buf.busy = false;
+        done_cv.notify_all();
+    }
+}
+
+void OutputWriter::submit(size_t index, size_t length) {
+    Buffer& buf = buffers[index];
+    buf.length = length;
+    buf.at = offset;
+
+    if (ring) {
+        buf.busy = true;
+        if (!ring->submitWrite(fd, buf.data, length, offset, index)) {
+            // Submission refused: write this buffer synchronously
+            buf.busy = false;
+            if (!writeFully(buf.data, length, offset)) failed = true;
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    buf.busy = true;
+    jobs.push_back(index);
+    submit_cv.notify_one();
+}
+
+void OutputWriter::waitForBuffer(size_t index) {
+    if (!ring) {
+        std::unique_lock<std::mutex> lock(mutex);
+        done_cv.wait(lock, [&] { return !buffers[index].busy; });
+        return;
+    }
+
+    while (buffers[index].busy) {
+        uint64_t tag;
+        int result;
+        if (!ring->reap(tag, result)) {
+            // Ring broken: nothing more will complete, so stop waiting
+            std::cerr << "Error: io_uring wait failed: " << std::strerror(errno) << std::endl;
+            failed = true;
+            for (Buffer& buf : buffers) buf.busy = false;
+            return;
+        }
+
+        Buffer& done = buffers[tag];
+        if (result < 0) {
+            // Old kernels reject IORING_OP_WRITE (EINVAL); retry the same write with pwrite
+            if (!writeFully(done.data, done.length, done.at)) failed = true;
+        } else if (static_cast<size_t>(result) < done.length) {
+            if (!writeFully(done.data + result, done.length - result, done.at + result)) failed = true;
+        }
+        done.busy = false;
+    }
+}
+
+void OutputWriter::waitForAll() {
+    for (size_t i = 0; i < buffers.size(); i++) {
+        waitForBuffer(i);
+    }
+}
+
+bool OutputWriter::write(const char* data, size_t length) {
+    if (fd < 0 || failed) {
+        return false;
+    }
+
+    while (length > 0) {
+        Buffer& buf = buffers[current];
+        size_t take = std::min(length, options.buffer_size - buf.fill);
+        std::memcpy(buf.data + buf.fill, data, take);
+        buf.fill += take;
+        data += take;
+        length -= take;
+        total_bytes += take;
+
+        if (buf.fill == options.buffer_size) {
+            submit(current, buf.fill);
+            offset += buf.fill;
+            current = (current + 1) % buffers.size();
+            waitForBuffer(current);
+            buffers[current].fill = 0;
+        }
+    }
+    return !failed;
+}
+
+bool OutputWriter::close() {
+    if (fd < 0) {
+        return false;
+    }
+
+    Buffer& buf = buffers[current];
+    if (buf.fill > 0) {
+        size_t length = buf.fill;
+        if (direct) {
+            // O_DIRECT needs whole blocks: pad with zeros, truncate afterwards
+            length = roundUp(length, DIRECT_ALIGNMENT);
+            std::memset(buf.data + buf.fill, 0, length - buf.fill);
+        }
+        submit(current, length);
+    }
+    waitForAll();
+
+    if (writer_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        submit_cv.notify_all();
+        writer_thread.join();
+    }
+
+    if (direct && ftruncate(fd, static_cast<off_t>(total_bytes)) != 0) {
+        std::cerr << "Error: Cannot truncate " << filename << ": " << std::strerror(errno) << std::endl;
+        failed = true;
+    }
+    if (::close(fd) != 0) {
+        std::cerr << "Error: Cannot close " << filename << ": " << std::strerror(errno) << std::endl;
+        failed = true;
+    }
+    fd = -1;
+
+    release();
+    return !failed;
+}
+
+void OutputWriter::release() {
+    ring.reset();
+    for (Buffer& buf : buffers) {
+        std::free(buf.data);
+    }
+    buffers.clear();
+}
+
+std::string OutputWriter::getBackendName() const {
+    std::string name = ring ? "io_uring" : "pwrite";
+    if (direct) name += "+O_DIRECT";
+    return name;
+}
@@ -0,0 +1,54 @@
+#include "path_end.h"
+#include "aspa.h"
+#include <algorithm>
+#include <iostream>
+
+const char* pathEndStateName(PathEndState state) {
+    switch (state) {
+        case PathEndState::VALID: return "valid";
+        case PathEndState::UNKNOWN: return "unknown";
+        case PathEndState::INVALID: return "invalid";
+        case PathEndState::UNCHECKED:
+        default: return "unchecked";
+    }
+}
+
+void PathEndTable::assign(const std::vector<std::pair<ASN, ASN>>& pairs) {
+    keys.clear();
+    keys.reserve(pairs.size() * 2);
+    origin_count = 0;
+
+    for (const auto& pair : pairs) {
+        if (keys.insert(key(pair.first, 0)).second) {
+            origin_count++;
+        }
+        if (pair.second != 0) {
+            keys.insert(key(pair.first, pair.second));
+        }
+    }
+}
+
+bool PathEndTable::loadFromFile(const std::string& filename) {
+    std::cout << "Loading path-end records from " << filename << "..." << std::endl;
+
+    std::vector<std::pair<ASN, ASN>> pairs;
+    size_t skipped = 0;
+    if (!readASNRecordFile(filename, pairs, skipped)) {
+        std::cerr << "Error: Cannot open path-end file " << filename << std::endl;
+        return false;
+    }
+    assign(pairs);
+
+    if (skipped > 0) {
+        std::cerr << "Warning: Skipped " << skipped << " malformed lines in " << filename << std::endl;
+    }
+    std::cout << "Loaded path-end records of " << getOriginCount() << " origin ASes ("
+              << getNeighborCount() << " neighbors)" << std::endl;
+    return true;
+}
+
+std::vector<uint64_t> PathEndTable::getSortedKeys() const {
+    std::vector<uint64_t> sorted(keys.begin(), keys.end());
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
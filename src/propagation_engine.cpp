@@ -0,0 +1,351 @@
+#include "propagation_engine.h"
+#include "bgp_policy.h"
+#include <algorithm>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <sched.h>
+#include <string>
+
+namespace {
+    // Parse a sysfs CPU list such as "0-3,8-11"
+    std::vector<int> parseCpuList(const std::string& text) {
+        std::vector<int> cpus;
+        size_t pos = 0;
+        while (pos < text.size()) {
+            size_t comma = text.find(',', pos);
+            std::string item = text.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+            size_t dash = item.find('-');
+            try {
+                int first = std::stoi(item.substr(0, dash));
+                int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+                for (int cpu = first; cpu <= last; cpu++) {
+                    cpus.push_back(cpu);
+                }
+            } catch (const std::exception&) {
+                // Blank or malformed item: skip
+            }
+            if (comma == std::string::npos) break;
+            pos = comma + 1;
+        }
+        return cpus;
+    }
+
+    std::vector<int> allowedCpus() {
+        std::vector<int> cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    // Send filter shared with the serial engine: only customer-learned and
+    // originated routes go up and across (valley-free)
+    inline bool exportableUpOrAcross(const Announcement& ann) {
+        return ann.received_from == RelationshipType::CUSTOMER ||
+               ann.received_from == RelationshipType::ORIGIN;
+    }
+
+    // Collect what each sender would have sent to node into node's own queue
+    template <typename P>
+    void pullRoutes(ASNode& node, const NeighborList& senders,
+                    RelationshipType received_from, bool customer_routes_only) {
+        for (const auto& sender_ref : senders) {
+            const ASNode& sender = sender_ref.get();
+            if (!sender.policy) continue;
+
+            for (const auto& rib_pair : sender.policy->getLocalRIB<P>()) {
+                const Announcement& ann = rib_pair.second;
+                if (customer_routes_only && !exportableUpOrAcross(ann)) continue;
+
+                // Loop prevention
+                if (ann.containsAS(node.asn)) continue;
+
+                node.policy->receiveAnnouncement(rib_pair.first, ann.copy_with_new_hop(sender.asn, received_from));
+            }
+        }
+    }
+
+    template <typename P, typename S>
+    inline void processQueue(ASNode& node, const S& selection) {
+        node.policy->processReceivedQueue<P>(node.asn, selection);
+        node.policy->clearReceivedQueue<P>();
+    }
+}
+
+std::vector<std::vector<int>> detectNumaNodes() {
+    std::vector<int> allowed = allowedCpus();
+    std::vector<std::vector<int>> nodes;
+
+    DIR* dir = opendir("/sys/devices/system/node");
+    if (dir) {
+        std::vector<int> node_ids;
+        while (struct dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.size() > 4 && name.compare(0, 4, "node") == 0 &&
+                name.find_first_not_of("0123456789", 4) == std::string::npos) {
+                node_ids.push_back(std::stoi(name.substr(4)));
+            }
+        }
+        closedir(dir);
+        std::sort(node_ids.begin(), node_ids.end());
+
+        for (int id : node_ids) {
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+            std::string text;
+            std::getline(file, text);
+
+            std::vector<int> cpus;
+            for (int cpu : parseCpuList(text)) {
+                if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end()) {
+                    cpus.push_back(cpu);
+                }
+            }
+            if (!cpus.empty()) {
+                nodes.push_back(cpus);
+            }
+        }
+    }
+
+    if (nodes.empty() && !allowed.empty()) {
+        nodes.push_back(allowed);
+    }
+    return nodes;
+}
+
+WorkerPool::WorkerPool(unsigned count, bool pin_numa) {
+    if (count == 0) count = 1;
+
+    std::vector<std::vector<int>> numa_nodes;
+    if (pin_numa) {
+        numa_nodes = detectNumaNodes();
+    }
+
+    worker_node.assign(count, -1);
+    threads.reserve(count);
+    for (unsigned w = 0; w < count; w++) {
+        int cpu = -1;
+        if (!numa_nodes.empty()) {
+            size_t node = w % numa_nodes.size();
+            const std::vector<int>& cpus = numa_nodes[node];
+            cpu = cpus[(w / numa_nodes.size()) % cpus.size()];
+            worker_node[w] = static_cast<int>(node);
+        }
+        threads.emplace_back(&WorkerPool::workerLoop, this, w, cpu);
+    }
+
+    if (pin_numa) {
+        std::cout << "Worker pool: " << count << " threads pinned across "
+                  << numa_nodes.size() << " NUMA node(s)" << std::endl;
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    start_cv.notify_all();
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+void WorkerPool::workerLoop(unsigned worker, int cpu) {
+    // Pin before the first allocation so that this worker's arena is node-local
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+            std::cerr << "Warning: Cannot pin worker " << worker << " to CPU " << cpu << std::endl;
+        }
+    }
+
+    uint64_t seen = 0;
+    while (true) {
+        std::function<void(unsigned)> current;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start_cv.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            current = task;
+        }
+
+        current(worker);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0) {
+            done_cv.notify_one();
+        }
+    }
+}
+
+void WorkerPool::run(const std::function<void(unsigned)>& fn) {
+    std::unique_lock<std::mutex> lock(mutex);
+    task = fn;
+    pending = size();
+    generation++;
+    start_cv.notify_all();
+    done_cv.wait(lock, [&] { return pending == 0; });
+}
+
+ParallelPropagator::ParallelPropagator(ASGraph& target, unsigned threads, bool numa_aware)
+    : graph(target), pool(threads, numa_aware) {}
+
+void ParallelPropagator::partition() {
+    const auto& ranked = graph.getRankedASes();
+    unsigned workers = pool.size();
+
+    owned.assign(ranked.size(), std::vector<std::vector<ASNode*>>(workers));
+    releasable.clear();
+    bool retention = !graph.getVantagePoints().empty();
+    if (retention) {
+        releasable.assign(ranked.size(), std::vector<std::vector<ASNode*>>(workers));
+    }
+
+    // Split each rank into contiguous runs of roughly equal neighbor count,
+    // the per-AS cost of pulling routes
+    for (size_t rank = 0; rank < ranked.size(); rank++) {
+        std::vector<ASNode*> rank_nodes;
+        std::vector<size_t> weights;
+        size_t total = 0;
+        for (ASN asn : ranked[rank]) {
+            ASNode* node = graph.getNode(asn);
+            if (!node || !node->policy) continue;
+            size_t weight = 1 + node->providers.size() + node->customers.size() + node->peers.size();
+            rank_nodes.push_back(node);
+            weights.push_back(weight);
+            total += weight;
+        }
+
+        size_t running = 0;
+        for (size_t i = 0; i < rank_nodes.size(); i++) {
+            unsigned worker = static_cast<unsigned>(std::min<size_t>(workers - 1, running * workers / std::max<size_t>(1, total)));
+            owned[rank][worker].push_back(rank_nodes[i]);
+            running += weights[i];
+
+            ASNode* node = rank_nodes[i];
+            if (retention && !node->customers.empty() && !graph.retainsRIB(node->asn)) {
+                int last_reader = node->propagation_rank;
+                for (const auto& customer_ref : node->customers) {
+                    last_reader = std::min(last_reader, customer_ref.get().propagation_rank);
+                }
+                releasable[std::max(last_reader, 0)][worker].push_back(node);
+            }
+        }
+    }
+}
+
+template <typename P, typename S>
+void ParallelPropagator::propagateUp(const S& selection) {
+    // Rank r pulls from customers (all of lower rank, already final)
+    for (size_t rank = 1; rank < owned.size(); rank++) {
+        pool.run([&](unsigned worker) {
+            for (ASNode* node : owned[rank][worker]) {
+                if (node->customers.empty()) continue;
+                pullRoutes<P>(*node, node->customers, RelationshipType::CUSTOMER, true);
+                processQueue<P>(*node, selection);
+            }
+        });
+    }
+}
+
+template <typename P, typename S>
+void ParallelPropagator::propagateAcross(const S& selection) {
+    // Gather everything first so that no AS reads a RIB a peer is updating
+    pool.run([&](unsigned worker) {
+        for (const auto& rank_nodes : owned) {
+            for (ASNode* node : rank_nodes[worker]) {
+                pullRoutes<P>(*node, node->peers, RelationshipType::PEER, true);
+            }
+        }
+    });
+    pool.run([&](unsigned worker) {
+        for (const auto& rank_nodes : owned) {
+            for (ASNode* node : rank_nodes[worker]) {
+                processQueue<P>(*node, selection);
+            }
+        }
+    });
+}
+
+template <typename P, typename S>
+void ParallelPropagator::propagateDown(const S& selection) {
+    bool retention = !releasable.empty();
+
+    // Rank r pulls from providers (all of higher rank, already final)
+    for (size_t rank = owned.size(); rank-- > 0;) {
+        pool.run([&](unsigned worker) {
+            // No AS of this rank or below reads RIBs whose last customer was at rank + 1
+            if (retention && rank + 1 < releasable.size()) {
+                for (ASNode* node : releasable[rank + 1][worker]) {
+                    released[worker] += node->policy->releaseLocalRIB<P>();
+                }
+            }
+
+            for (ASNode* node : owned[rank][worker]) {
+                if (!node->providers.empty()) {
+                    pullRoutes<P>(*node, node->providers, RelationshipType::PROVIDER, false);
+                    processQueue<P>(*node, selection);
+                }
+
+                // Without customers the RIB is final and unread
+                if (retention && node->customers.empty() && !graph.retainsRIB(node->asn)) {
+                    released[worker] += node->policy->releaseLocalRIB<P>();
+                }
+            }
+        });
+    }
+
+    if (retention) {
+        pool.run([&](unsigned worker) {
+            for (ASNode* node : releasable[0][worker]) {
+                released[worker] += node->policy->releaseLocalRIB<P>();
+            }
+        });
+    }
+}
+
+template <typename P, typename S>
+size_t ParallelPropagator::propagate(size_t& released_routes, const S& selection) {
+    partition();
+    released.assign(pool.size(), 0);
+
+    std::cout << "  Phase 1: Propagating UP (to providers)..." << std::endl;
+    propagateUp<P>(selection);
+    std::cout << "  Phase 2: Propagating ACROSS (to peers)..." << std::endl;
+    propagateAcross<P>(selection);
+    std::cout << "  Phase 3: Propagating DOWN (to customers)..." << std::endl;
+    propagateDown<P>(selection);
+
+    size_t total = 0;
+    for (const auto& pair : graph.getNodes()) {
+        if (pair.second.policy) {
+            total += pair.second.policy->getLocalRIB<P>().size();
+        }
+    }
+
+    released_routes = 0;
+    for (size_t count : released) {
+        released_routes += count;
+    }
+    return total + released_routes;
+}
+
+#define INSTANTIATE_PROPAGATE(P, S) \
+    template size_t ParallelPropagator::propagate<P, S>(size_t& released_routes, const S& selection);
+INSTANTIATE_PROPAGATE(IPv4Prefix, StandardSelection)
+INSTANTIATE_PROPAGATE(IPv6Prefix, StandardSelection)
+INSTANTIATE_PROPAGATE(IPv4Prefix, IgnorePathLengthSelection)
+INSTANTIATE_PROPAGATE(IPv6Prefix, IgnorePathLengthSelection)
+INSTANTIATE_PROPAGATE(IPv4Prefix, HashTieBreakSelection)
+INSTANTIATE_PROPAGATE(IPv6Prefix, HashTieBreakSelection)
+INSTANTIATE_PROPAGATE(IPv4Prefix, LowestOriginSelection)
+INSTANTIATE_PROPAGATE(IPv6Prefix, LowestOriginSelection)
+#undef INSTANTIATE_PROPAGATE
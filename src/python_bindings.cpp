@@ -1,283 +1,667 @@
-#include <pybind11/pybind11.h>
-#include <pybind11/stl.h>
-#include <pybind11/functional.h>
-#include "as_graph.h"
-#include "announcement.h"
-#include "bgp_policy.h"
-
-namespace py = pybind11;
-
-// Helper to convert Announcement to dict for Python
-py::dict announcement_to_dict(const Announcement& ann) {
-    py::dict result;
-    result["prefix"] = ann.prefix.toString();
-    result["next_hop_asn"] = ann.next_hop_asn;
-    result["received_from"] = static_cast<int>(ann.received_from);
-    result["rov_invalid"] = ann.rov_invalid;
-
-    py::list path;
-    for (ASN asn : ann.as_path) {
-        path.append(asn);
-    }
-    result["as_path"] = path;
-
-    return result;
-}
-
-// Helper to get node information
-py::dict get_node_info(const ASNode* node) {
-    if (!node) {
-        return py::dict();
-    }
-
-    py::dict result;
-    result["asn"] = node->asn;
-    result["propagation_rank"] = node->propagation_rank;
-
-    py::list providers, customers, peers;
-    for (const auto& p : node->providers) {
-        providers.append(p.get().asn);
-    }
-    for (const auto& c : node->customers) {
-        customers.append(c.get().asn);
-    }
-    for (const auto& p : node->peers) {
-        peers.append(p.get().asn);
-    }
-
-    result["providers"] = providers;
-    result["customers"] = customers;
-    result["peers"] = peers;
-
-    // Get RIB info if policy exists
-    if (node->policy) {
-        result["rib_size"] = node->policy->getLocalRIBSize();
-
-        py::dict rib;
-        for (const auto& pair : node->policy->getLocalRIB()) {
-            rib[pair.first.toString().c_str()] = announcement_to_dict(pair.second);
-        }
-        result["rib"] = rib;
-    } else {
-        result["rib_size"] = 0;
-        result["rib"] = py::dict();
-    }
-
-    return result;
-}
-
-PYBIND11_MODULE(bgp_simulator, m) {
-    m.doc() = "BGP Simulator Python Bindings - Simulate BGP route propagation with ROV support";
-
-    // Enums
-    py::enum_<RelationType>(m, "RelationType")
-        .value("CUSTOMER", RelationType::CUSTOMER, "AS1 is provider, AS2 is customer")
-        .value("PEER", RelationType::PEER, "Peer-to-peer relationship")
-        .value("PROVIDER", RelationType::PROVIDER, "AS1 is customer, AS2 is provider")
-        .export_values();
-
-    py::enum_<RelationshipType>(m, "RelationshipType")
-        .value("ORIGIN", RelationshipType::ORIGIN, "Initial announcement (highest priority)")
-        .value("CUSTOMER", RelationshipType::CUSTOMER, "From customer")
-        .value("PEER", RelationshipType::PEER, "From peer")
-        .value("PROVIDER", RelationshipType::PROVIDER, "From provider")
-        .export_values();
-
-    // IPv4Prefix
-    py::class_<IPv4Prefix>(m, "IPv4Prefix")
-        .def(py::init<>())
-        .def(py::init<uint32_t, uint8_t>())
-        .def_readwrite("address", &IPv4Prefix::address)
-        .def_readwrite("prefix_len", &IPv4Prefix::prefix_len)
-        .def_static("parse", &IPv4Prefix::parse, "Parse IPv4 prefix from string (e.g., '1.2.0.0/16')")
-        .def("to_string", &IPv4Prefix::toString, "Convert to string representation")
-        .def("__str__", &IPv4Prefix::toString)
-        .def("__repr__", [](const IPv4Prefix& p) {
-            return "IPv4Prefix('" + p.toString() + "')";
-        })
-        .def("__eq__", &IPv4Prefix::operator==);
-
-    // IPv6Prefix
-    py::class_<IPv6Prefix>(m, "IPv6Prefix")
-        .def(py::init<>())
-        .def(py::init<uint64_t, uint64_t, uint8_t>())
-        .def_readwrite("high", &IPv6Prefix::high)
-        .def_readwrite("low", &IPv6Prefix::low)
-        .def_readwrite("prefix_len", &IPv6Prefix::prefix_len)
-        .def_static("parse", &IPv6Prefix::parse, "Parse IPv6 prefix from string")
-        .def("to_string", &IPv6Prefix::toString, "Convert to string representation")
-        .def("__str__", &IPv6Prefix::toString)
-        .def("__repr__", [](const IPv6Prefix& p) {
-            return "IPv6Prefix('" + p.toString() + "')";
-        })
-        .def("__eq__", &IPv6Prefix::operator==);
-
-    // Prefix
-    py::class_<Prefix>(m, "Prefix")
-        .def(py::init<>())
-        .def(py::init<const IPv4Prefix&>())
-        .def(py::init<const IPv6Prefix&>())
-        .def_readonly("is_ipv6", &Prefix::is_ipv6)
-        .def_static("parse", &Prefix::parse, "Parse prefix from string (auto-detect IPv4/IPv6)")
-        .def("to_string", &Prefix::toString, "Convert to string representation")
-        .def("__str__", &Prefix::toString)
-        .def("__repr__", [](const Prefix& p) {
-            return "Prefix('" + p.toString() + "')";
-        })
-        .def("__eq__", &Prefix::operator==);
-
-    // Announcement
-    py::class_<Announcement>(m, "Announcement")
-        .def(py::init<>())
-        .def(py::init<const Prefix&, ASN, RelationshipType, bool>(),
-             py::arg("prefix"), py::arg("origin"),
-             py::arg("rel") = RelationshipType::ORIGIN,
-             py::arg("rov_invalid") = false)
-        .def_readonly("prefix", &Announcement::prefix)
-        .def_readonly("next_hop_asn", &Announcement::next_hop_asn)
-        .def_readonly("received_from", &Announcement::received_from)
-        .def_readonly("rov_invalid", &Announcement::rov_invalid)
-        .def_property_readonly("as_path", [](const Announcement& ann) {
-            py::list path;
-            for (ASN asn : ann.as_path) {
-                path.append(asn);
-            }
-            return path;
-        })
-        .def("get_path_length", &Announcement::getPathLength, "Get AS path length")
-        .def("contains_as", &Announcement::containsAS, "Check if AS is in path")
-        .def("is_better_than", &Announcement::isBetterThan, "Compare announcements for route selection")
-        .def("to_dict", &announcement_to_dict, "Convert announcement to dictionary")
-        .def("__repr__", [](const Announcement& ann) {
-            return "Announcement(prefix='" + ann.prefix.toString() +
-                   "', origin=" + std::to_string(ann.next_hop_asn) +
-                   ", path_len=" + std::to_string(ann.as_path.size()) + ")";
-        });
-
-    // ASGraph
-    py::class_<ASGraph>(m, "ASGraph")
-        .def(py::init<>(), "Create a new AS graph")
-        .def("build_from_file", &ASGraph::buildFromFile,
-             py::arg("filename"),
-             "Build graph from CAIDA AS relationships file")
-        .def("add_relationship", &ASGraph::addRelationship,
-             py::arg("as1"), py::arg("as2"), py::arg("rel_type"),
-             "Add a relationship between two ASes")
-        .def("detect_cycles", &ASGraph::detectCycles,
-             "Check for cycles in provider-customer relationships")
-        .def("has_node", &ASGraph::hasNode,
-             py::arg("asn"),
-             "Check if ASN exists in graph")
-        .def("get_node_count", &ASGraph::getNodeCount, "Get number of nodes")
-        .def("get_edge_count", &ASGraph::getEdgeCount, "Get number of edges")
-        .def("get_provider_customer_edges", &ASGraph::getProviderCustomerEdges,
-             "Get number of provider-customer edges")
-        .def("get_peer_edges", &ASGraph::getPeerEdges, "Get number of peer edges")
-        .def("reserve_nodes", &ASGraph::reserveNodes,
-             py::arg("count"),
-             "Reserve space for nodes to avoid rehashing")
-        .def("initialize_bgp", &ASGraph::initializeBGP,
-             "Initialize BGP policies for all nodes")
-        .def("flatten_graph", &ASGraph::flattenGraph,
-             "Assign propagation ranks to nodes")
-        .def("get_ranked_ases", &ASGraph::getRankedASes,
-             "Get flattened graph as vector of vectors by rank")
-        .def("seed_announcement", &ASGraph::seedAnnouncement,
-             py::arg("origin_asn"), py::arg("prefix_str"),
-             py::arg("rov_invalid") = false,
-             "Seed an announcement at a specific AS")
-        .def("propagate_announcements", &ASGraph::propagateAnnouncements,
-             "Propagate announcements through the entire graph")
-        .def("export_to_csv", &ASGraph::exportToCSV,
-             py::arg("filename"),
-             "Export local RIBs to CSV file")
-        .def("load_rov_asns", &ASGraph::loadROVASNs,
-             py::arg("filename"),
-             "Load ROV ASNs from file and upgrade their policies")
-        .def("get_rov_asn_count", &ASGraph::getROVASNCount,
-             "Get count of ASes deploying ROV")
-        .def("get_node_info", [](ASGraph& graph, ASN asn) {
-            return get_node_info(graph.getNode(asn));
-        }, py::arg("asn"), "Get detailed information about a node")
-        .def("get_all_nodes_info", [](ASGraph& graph) {
-            py::dict result;
-            for (const auto& pair : graph.getNodes()) {
-                result[std::to_string(pair.first).c_str()] = get_node_info(&pair.second);
-            }
-            return result;
-        }, "Get information about all nodes in the graph")
-        .def("get_rib", [](ASGraph& graph, ASN asn) {
-            const ASNode* node = graph.getNode(asn);
-            if (!node || !node->policy) {
-                return py::dict();
-            }
-
-            py::dict rib;
-            for (const auto& pair : node->policy->getLocalRIB()) {
-                rib[pair.first.toString().c_str()] = announcement_to_dict(pair.second);
-            }
-            return rib;
-        }, py::arg("asn"), "Get the local RIB for a specific AS")
-        .def("get_announcement", [](ASGraph& graph, ASN asn, const std::string& prefix_str) -> py::object {
-            const ASNode* node = graph.getNode(asn);
-            if (!node || !node->policy) {
-                return py::none();
-            }
-
-            Prefix prefix = Prefix::parse(prefix_str);
-            const Announcement* ann = node->policy->getAnnouncement(prefix);
-            if (!ann) {
-                return py::none();
-            }
-
-            py::dict result = announcement_to_dict(*ann);
-            return result;
-        }, py::arg("asn"), py::arg("prefix"),
-           "Get specific announcement from AS's RIB")
-        .def("__repr__", [](const ASGraph& graph) {
-            return "ASGraph(nodes=" + std::to_string(graph.getNodeCount()) +
-                   ", edges=" + std::to_string(graph.getEdgeCount()) + ")";
-        });
-
-    // Utility functions
-    m.def("parse_prefix", &Prefix::parse,
-          py::arg("prefix_str"),
-          "Parse a prefix string (auto-detect IPv4/IPv6)");
-
-    // Statistics helper
-    m.def("get_graph_statistics", [](const ASGraph& graph) {
-        py::dict stats;
-        stats["total_nodes"] = graph.getNodeCount();
-        stats["total_edges"] = graph.getEdgeCount();
-        stats["provider_customer_edges"] = graph.getProviderCustomerEdges();
-        stats["peer_edges"] = graph.getPeerEdges();
-        stats["rov_deploying_ases"] = graph.getROVASNCount();
-
-        // Calculate degree statistics
-        size_t total_providers = 0;
-        size_t total_customers = 0;
-        size_t total_peers = 0;
-        size_t stub_count = 0;
-
-        for (const auto& pair : graph.getNodes()) {
-            const ASNode& node = pair.second;
-            total_providers += node.providers.size();
-            total_customers += node.customers.size();
-            total_peers += node.peers.size();
-
-            if (node.customers.empty() && node.peers.empty()) {
-                stub_count++;
-            }
-        }
-
-        stats["avg_providers"] = static_cast<double>(total_providers) / graph.getNodeCount();
-        stats["avg_customers"] = static_cast<double>(total_customers) / graph.getNodeCount();
-        stats["avg_peers"] = static_cast<double>(total_peers) / graph.getNodeCount();
-        stats["stub_ases"] = stub_count;
-
-        return stats;
-    }, py::arg("graph"), "Get comprehensive graph statistics");
-
-    // Version info
-    m.attr("__version__") = "1.0.0";
-}
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/functional.h>
+#include <algorithm>
+#include <map>
+#include "as_graph.h"
+#include "announcement.h"
+#include "bgp_policy.h"
+#include "content_hash.h"
+#include "result_cache.h"
+#include "topology_diff.h"
+#include "huge_pages.h"
+#include "rib_export.h"
+#include "rib_summary.h"
+#include "rpki.h"
+#include "route_resolver.h"
+
+namespace py = pybind11;
+
+// Helper to convert Announcement to dict for Python
+py::dict announcement_to_dict(const Announcement& ann) {
+    py::dict result;
+    result["next_hop_asn"] = ann.next_hop_asn;
+    result["received_from"] = static_cast<int>(ann.received_from);
+    result["rov_invalid"] = ann.rov_invalid;
+
+    py::list path;
+    for (ASN asn : ann.as_path) {
+        path.append(asn);
+    }
+    result["as_path"] = path;
+
+    return result;
+}
+
+// RIB entry as a dict: the announcement plus the prefix it is stored under
+py::dict route_to_dict(const Prefix& prefix, const Announcement& ann) {
+    py::dict result = announcement_to_dict(ann);
+    result["prefix"] = prefix.toString();
+    return result;
+}
+
+// Local RIB of a policy as {prefix string: route dict}
+py::dict rib_to_dict(const BGPPolicy& policy) {
+    py::dict rib;
+    policy.forEachRoute([&](const Prefix& prefix, const Announcement& ann) {
+        rib[prefix.toString().c_str()] = route_to_dict(prefix, ann);
+    });
+    return rib;
+}
+
+// Helper to get node information
+py::dict get_node_info(const ASNode* node) {
+    if (!node) {
+        return py::dict();
+    }
+
+    py::dict result;
+    result["asn"] = node->asn;
+    result["propagation_rank"] = node->propagation_rank;
+
+    py::list providers, customers, peers;
+    for (const auto& p : node->providers) {
+        providers.append(p.get().asn);
+    }
+    for (const auto& c : node->customers) {
+        customers.append(c.get().asn);
+    }
+    for (const auto& p : node->peers) {
+        peers.append(p.get().asn);
+    }
+
+    result["providers"] = providers;
+    result["customers"] = customers;
+    result["peers"] = peers;
+
+    // Get RIB info if policy exists
+    if (node->policy) {
+        result["rib_size"] = node->policy->getLocalRIBSize();
+
+        result["rib"] = rib_to_dict(*node->policy);
+    } else {
+        result["rib_size"] = 0;
+        result["rib"] = py::dict();
+    }
+
+    return result;
+}
+
+PYBIND11_MODULE(bgp_simulator, m) {
+    m.doc() = "BGP Simulator Python Bindings - Simulate BGP route propagation with ROV support";
+
+    // Enums
+    py::enum_<RelationType>(m, "RelationType")
+        .value("CUSTOMER", RelationType::CUSTOMER, "AS1 is provider, AS2 is customer")
+        .value("PEER", RelationType::PEER, "Peer-to-peer relationship")
+        .value("PROVIDER", RelationType::PROVIDER, "AS1 is customer, AS2 is provider")
+        .export_values();
+
+    py::enum_<RelationshipType>(m, "RelationshipType")
+        .value("ORIGIN", RelationshipType::ORIGIN, "Initial announcement (highest priority)")
+        .value("CUSTOMER", RelationshipType::CUSTOMER, "From customer")
+        .value("PEER", RelationshipType::PEER, "From peer")
+        .value("PROVIDER", RelationshipType::PROVIDER, "From provider")
+        .export_values();
+
+    // IPv4Prefix
+    py::class_<IPv4Prefix>(m, "IPv4Prefix")
+        .def(py::init<>())
+        .def(py::init<uint32_t, uint8_t>())
+        .def_readwrite("address", &IPv4Prefix::address)
+        .def_readwrite("prefix_len", &IPv4Prefix::prefix_len)
+        .def_static("parse", &IPv4Prefix::parse, "Parse IPv4 prefix from string (e.g., '1.2.0.0/16')")
+        .def("to_string", &IPv4Prefix::toString, "Convert to string representation")
+        .def("__str__", &IPv4Prefix::toString)
+        .def("__repr__", [](const IPv4Prefix& p) {
+            return "IPv4Prefix('" + p.toString() + "')";
+        })
+        .def("__eq__", &IPv4Prefix::operator==);
+
+    // IPv6Prefix
+    py::class_<IPv6Prefix>(m, "IPv6Prefix")
+        .def(py::init<>())
+        .def(py::init<uint64_t, uint64_t, uint8_t>())
+        .def_readwrite("high", &IPv6Prefix::high)
+        .def_readwrite("low", &IPv6Prefix::low)
+        .def_readwrite("prefix_len", &IPv6Prefix::prefix_len)
+        .def_static("parse", &IPv6Prefix::parse, "Parse IPv6 prefix from string")
+        .def("to_string", &IPv6Prefix::toString, "Convert to string representation")
+        .def("__str__", &IPv6Prefix::toString)
+        .def("__repr__", [](const IPv6Prefix& p) {
+            return "IPv6Prefix('" + p.toString() + "')";
+        })
+        .def("__eq__", &IPv6Prefix::operator==);
+
+    // Prefix
+    py::class_<Prefix>(m, "Prefix")
+        .def(py::init<>())
+        .def(py::init<const IPv4Prefix&>())
+        .def(py::init<const IPv6Prefix&>())
+        .def_readonly("is_ipv6", &Prefix::is_ipv6)
+        .def_static("parse", &Prefix::parse, "Parse prefix from string (auto-detect IPv4/IPv6)")
+        .def("to_string", &Prefix::toString, "Convert to string representation")
+        .def("__str__", &Prefix::toString)
+        .def("__repr__", [](const Prefix& p) {
+            return "Prefix('" + p.toString() + "')";
+        })
+        .def("__eq__", &Prefix::operator==);
+
+    // Announcement
+    py::class_<Announcement>(m, "Announcement")
+        .def(py::init<>())
+        .def(py::init<ASN, RelationshipType, bool>(),
+             py::arg("origin"),
+             py::arg("rel") = RelationshipType::ORIGIN,
+             py::arg("rov_invalid") = false)
+        .def_readonly("next_hop_asn", &Announcement::next_hop_asn)
+        .def_readonly("received_from", &Announcement::received_from)
+        .def_readonly("rov_invalid", &Announcement::rov_invalid)
+        .def_property_readonly("as_path", [](const Announcement& ann) {
+            py::list path;
+            for (ASN asn : ann.as_path) {
+                path.append(asn);
+            }
+            return path;
+        })
+        .def("get_path_length", &Announcement::getPathLength, "Get AS path length")
+        .def("contains_as", &Announcement::containsAS, "Check if AS is in path")
+        .def("is_better_than", &Announcement::isBetterThan, "Compare announcements for route selection")
+        .def("to_dict", &announcement_to_dict, "Convert announcement to dictionary")
+        .def("__repr__", [](const Announcement& ann) {
+            return "Announcement(origin=" + std::to_string(ann.next_hop_asn) +
+                   ", path_len=" + std::to_string(ann.as_path.size()) + ")";
+        });
+
+    // ASGraph
+    py::class_<ASGraph>(m, "ASGraph")
+        .def(py::init<>(), "Create a new AS graph")
+        .def("build_from_file", &ASGraph::buildFromFile,
+             py::arg("filename"),
+             "Build graph from CAIDA AS relationships file")
+        .def("save_snapshot", &ASGraph::saveSnapshot,
+             py::arg("filename"),
+             "Write the graph as a binary snapshot (includes the fingerprint)")
+        .def("load_snapshot", &ASGraph::loadSnapshot,
+             py::arg("filename"),
+             "Load a binary graph snapshot")
+        .def_static("is_snapshot_file", &ASGraph::isSnapshotFile,
+             py::arg("filename"),
+             "Check whether a file is a binary graph snapshot")
+        .def("fingerprint", [](const ASGraph& graph, unsigned threads) {
+            return graph.fingerprint(threads).toHex();
+        }, py::arg("threads") = 0,
+           "Order-independent 128-bit topology hash as 32 hex characters")
+        .def("add_relationship", &ASGraph::addRelationship,
+             py::arg("as1"), py::arg("as2"), py::arg("rel_type"),
+             "Add a relationship between two ASes")
+        .def("remove_relationship", &ASGraph::removeRelationship,
+             py::arg("as1"), py::arg("as2"), py::arg("rel_type"),
+             "Remove a typed relationship; returns False if it was absent")
+        .def("apply_diff", &ASGraph::applyDiff,
+             py::arg("diff"),
+             "Update the topology in place from a TopologyDiff (call flatten_graph afterwards)")
+        .def("detect_cycles", &ASGraph::detectCycles,
+             "Check for cycles in provider-customer relationships")
+        .def("has_node", &ASGraph::hasNode,
+             py::arg("asn"),
+             "Check if ASN exists in graph")
+        .def("get_node_count", &ASGraph::getNodeCount, "Get number of nodes")
+        .def("get_edge_count", &ASGraph::getEdgeCount, "Get number of edges")
+        .def("get_provider_customer_edges", &ASGraph::getProviderCustomerEdges,
+             "Get number of provider-customer edges")
+        .def("get_peer_edges", &ASGraph::getPeerEdges, "Get number of peer edges")
+        .def("reserve_nodes", &ASGraph::reserveNodes,
+             py::arg("count"),
+             "Reserve space for nodes to avoid rehashing")
+        .def("initialize_bgp", &ASGraph::initializeBGP,
+             "Initialize BGP policies for all nodes")
+        .def("flatten_graph", &ASGraph::flattenGraph,
+             "Assign propagation ranks to nodes")
+        .def("get_ranked_ases", &ASGraph::getRankedASes,
+             "Get flattened graph as vector of vectors by rank")
+        .def("seed_announcement", &ASGraph::seedAnnouncement,
+             py::arg("origin_asn"), py::arg("prefix_str"),
+             py::arg("rov_invalid") = false,
+             "Seed an announcement at a specific AS")
+        .def("propagate_announcements", &ASGraph::propagateAnnouncements,
+             "Propagate announcements through the entire graph")
+        .def("set_propagation_threads", &ASGraph::setPropagationThreads,
+             py::arg("threads"), py::arg("numa_aware") = false,
+             "Use the parallel engine with this many workers (1 = serial, 0 = all cores)")
+        .def("set_route_selection", [](ASGraph& graph, const std::string& name, uint32_t seed) {
+            RouteSelection selection;
+            if (!parseRouteSelection(name, selection)) {
+                throw std::invalid_argument("route selection must be standard, ignore-path-length, "
+                                      "hash-tie-break or lowest-origin");
+            }
+            graph.setRouteSelection(selection, seed);
+        }, py::arg("name"), py::arg("seed") = 0,
+           "Route-selection policy of the next propagation (seed: hash-tie-break only)")
+        .def("get_route_selection", [](const ASGraph& graph) {
+            return std::string(routeSelectionName(graph.getRouteSelection()));
+        }, "Name of the route-selection policy")
+        .def("export_to_csv", &ASGraph::exportToCSV,
+             py::arg("filename"),
+             "Export local RIBs to CSV file")
+        .def("load_rov_asns", &ASGraph::loadROVASNs,
+             py::arg("filename"),
+             "Load ROV ASNs from file and upgrade their policies")
+        .def("get_rov_asn_count", &ASGraph::getROVASNCount,
+             "Get count of ASes deploying ROV")
+        .def("load_aspa", &ASGraph::loadASPA,
+             py::arg("filename"),
+             "Load ASPA records (customer ASN, then its provider ASNs, per line)")
+        .def("set_aspa", &ASGraph::setASPA,
+             py::arg("pairs"),
+             "Replace ASPA records with (customer, provider) pairs; provider 0 = no providers")
+        .def("load_aspa_asns", &ASGraph::loadASPAASNs,
+             py::arg("filename"),
+             "Load ASPA-verifying ASNs from file and switch their policies")
+        .def("set_aspa_asns", [](ASGraph& graph, const std::vector<ASN>& asns) {
+            graph.setASPAASNs(std::unordered_set<ASN>(asns.begin(), asns.end()));
+        }, py::arg("asns"),
+           "ASes verifying paths against the ASPA records (call before seeding)")
+        .def("get_aspa_asns", [](const ASGraph& graph) {
+            std::vector<ASN> asns(graph.getASPAASNs().begin(), graph.getASPAASNs().end());
+            std::sort(asns.begin(), asns.end());
+            return asns;
+        }, "Get sorted list of ASPA-verifying ASNs")
+        .def("verify_aspa_path", [](const ASGraph& graph, const std::vector<ASN>& path,
+                                    RelationshipType received_from) {
+            return std::string(aspaStateName(
+                graph.getASPATable().verify(path.data(), path.size(), received_from)));
+        }, py::arg("path"), py::arg("received_from"),
+           "ASPA state of path (most recent hop first): 'valid', 'unknown' or 'invalid'")
+        .def("load_path_end", &ASGraph::loadPathEnd,
+             py::arg("filename"),
+             "Load path-end records (origin ASN, then its authorized neighbor ASNs, per line)")
+        .def("set_path_end", &ASGraph::setPathEnd,
+             py::arg("pairs"),
+             "Replace path-end records with (origin, neighbor) pairs; neighbor 0 = no neighbors")
+        .def("load_path_end_asns", &ASGraph::loadPathEndASNs,
+             py::arg("filename"),
+             "Load path-end-checking ASNs from file and switch their policies")
+        .def("set_path_end_asns", [](ASGraph& graph, const std::vector<ASN>& asns) {
+            graph.setPathEndASNs(std::unordered_set<ASN>(asns.begin(), asns.end()));
+        }, py::arg("asns"),
+           "ASes checking the last hop against the path-end records (call before seeding)")
+        .def("get_path_end_asns", [](const ASGraph& graph) {
+            std::vector<ASN> asns(graph.getPathEndASNs().begin(), graph.getPathEndASNs().end());
+            std::sort(asns.begin(), asns.end());
+            return asns;
+        }, "Get sorted list of path-end-checking ASNs")
+        .def("check_path_end", [](const ASGraph& graph, const std::vector<ASN>& path) {
+            return std::string(pathEndStateName(graph.getPathEndTable().check(path.data(), path.size())));
+        }, py::arg("path"),
+           "Path-end state of path (origin last): 'valid', 'unknown' or 'invalid'")
+        .def("load_leakers", [](ASGraph& graph, const std::string& filename, const std::string& policy) {
+            LeakPolicy default_policy;
+            if (!parseLeakPolicy(policy, default_policy)) {
+                throw std::invalid_argument("leak policy must be providers, peers or all");
+            }
+            return graph.loadLeakers(filename, default_policy);
+        }, py::arg("filename"), py::arg("default_policy") = "all",
+           "Load route leakers (ASN[,providers|peers|all] per line)")
+        .def("set_leakers", [](ASGraph& graph, const std::map<ASN, std::string>& leakers) {
+            std::unordered_map<ASN, LeakPolicy> policies;
+            for (const auto& pair : leakers) {
+                if (!parseLeakPolicy(pair.second, policies[pair.first])) {
+                    throw std::invalid_argument("leak policy must be providers, peers or all");
+                }
+            }
+            graph.setLeakers(policies);
+        }, py::arg("leakers"),
+           "Route leakers as {asn: 'providers' | 'peers' | 'all'} (empty: valley-free only)")
+        .def("get_leakers", [](const ASGraph& graph) {
+            std::map<ASN, std::string> leakers;
+            for (const auto& pair : graph.getLeakers()) {
+                leakers[pair.first] = leakPolicyName(pair.second);
+            }
+            return leakers;
+        }, "Route leakers as {asn: policy}")
+        .def("set_leak_round_limit", &ASGraph::setLeakRoundLimit,
+             py::arg("round_limit"),
+             "Stop leak propagation after this many worklist rounds (default: 1000)")
+        .def("get_leak_round_limit", &ASGraph::getLeakRoundLimit,
+             "Worklist round limit of leak propagation")
+        .def("get_leak_stats", [](const ASGraph& graph) {
+            const LeakStats& stats = graph.getLeakStats();
+            py::dict result;
+            result["rounds"] = stats.rounds;
+            result["evaluations"] = stats.evaluations;
+            result["updates"] = stats.updates;
+            result["converged"] = stats.converged;
+            return result;
+        }, "Rounds, re-selected routes, changed routes and convergence of the last leak propagation")
+        .def("reset_routing_state", &ASGraph::resetRoutingState,
+             "Clear every RIB and the recorded seeds; topology and policies are kept")
+        .def("set_vantage_points", [](ASGraph& graph, const std::vector<ASN>& asns) {
+            graph.setVantagePoints(std::unordered_set<ASN>(asns.begin(), asns.end()));
+        }, py::arg("asns"),
+           "Keep only these ASes' RIBs after propagation (empty list: keep all)")
+        .def("load_vantage_points", &ASGraph::loadVantagePoints,
+             py::arg("filename"),
+             "Load vantage point ASNs from file (one per line)")
+        .def("get_vantage_points", [](const ASGraph& graph) {
+            std::vector<ASN> asns(graph.getVantagePoints().begin(), graph.getVantagePoints().end());
+            std::sort(asns.begin(), asns.end());
+            return asns;
+        }, "Sorted vantage point ASNs")
+        .def("get_released_route_count", &ASGraph::getReleasedRouteCount,
+             "Routes of the last propagation freed by vantage-point retention")
+        .def("get_rov_asns", [](const ASGraph& graph) {
+            std::vector<ASN> asns(graph.getROVASNs().begin(), graph.getROVASNs().end());
+            std::sort(asns.begin(), asns.end());
+            return asns;
+        }, "Get sorted list of ROV deploying ASNs")
+        .def("get_seeds", [](const ASGraph& graph) {
+            py::list result;
+            for (const SeedAnnouncement& seed : graph.getSeeds()) {
+                result.append(py::make_tuple(seed.origin_asn, seed.prefix, seed.rov_invalid));
+            }
+            return result;
+        }, "Get seeded announcements as (origin_asn, prefix, rov_invalid) tuples")
+        .def("get_node_info", [](ASGraph& graph, ASN asn) {
+            return get_node_info(graph.getNode(asn));
+        }, py::arg("asn"), "Get detailed information about a node")
+        .def("get_all_nodes_info", [](ASGraph& graph) {
+            py::dict result;
+            for (const auto& pair : graph.getNodes()) {
+                result[std::to_string(pair.first).c_str()] = get_node_info(&pair.second);
+            }
+            return result;
+        }, "Get information about all nodes in the graph")
+        .def("get_rib", [](ASGraph& graph, ASN asn) {
+            const ASNode* node = graph.getNode(asn);
+            if (!node || !node->policy) {
+                return py::dict();
+            }
+
+            return rib_to_dict(*node->policy);
+        }, py::arg("asn"), "Get the local RIB for a specific AS")
+        .def("get_announcement", [](ASGraph& graph, ASN asn, const std::string& prefix_str) -> py::object {
+            const ASNode* node = graph.getNode(asn);
+            if (!node || !node->policy) {
+                return py::none();
+            }
+
+            Prefix prefix = Prefix::parse(prefix_str);
+            const Announcement* ann = node->policy->getAnnouncement(prefix);
+            if (!ann) {
+                return py::none();
+            }
+
+            py::dict result = route_to_dict(prefix, *ann);
+            return result;
+        }, py::arg("asn"), py::arg("prefix"),
+           "Get specific announcement from AS's RIB")
+        .def("__repr__", [](const ASGraph& graph) {
+            return "ASGraph(nodes=" + std::to_string(graph.getNodeCount()) +
+                   ", edges=" + std::to_string(graph.getEdgeCount()) + ")";
+        });
+
+    // Result cache
+    py::class_<ResultCache>(m, "ResultCache")
+        .def(py::init<const std::string&, uint64_t>(),
+             py::arg("directory"), py::arg("max_bytes") = 1024ULL * 1024 * 1024,
+             "Open (or create) an on-disk result cache with a size limit")
+        .def_static("make_key", [](const ASGraph& graph, const std::string& graph_fingerprint,
+                                   const std::string& output_format) {
+            return ResultCache::makeKey(graph, graph_fingerprint, output_format);
+        }, py::arg("graph"), py::arg("graph_fingerprint"), py::arg("output_format") = "csv",
+           "Key a run by graph fingerprint, seeded announcements, ROV set and engine version")
+        .def("lookup", &ResultCache::lookup,
+             py::arg("key"), py::arg("output_filename"),
+             "Copy a cached result to output_filename; returns False on a miss")
+        .def("store", &ResultCache::store,
+             py::arg("key"), py::arg("output_filename"),
+             "Store output_filename under key and evict down to the size limit")
+        .def("evict", &ResultCache::evict, "Evict least-recently-used entries over the size limit")
+        .def("get_size_bytes", &ResultCache::getSizeBytes, "Total size of cached entries")
+        .def_property_readonly("directory", &ResultCache::getDirectory)
+        .def_property_readonly("max_bytes", &ResultCache::getMaxBytes)
+        .def_property_readonly_static("ENGINE_VERSION", [](py::object) {
+            return std::string(ResultCache::ENGINE_VERSION);
+        });
+
+    // Demand-driven route resolution
+    py::class_<RouteResolver>(m, "RouteResolver")
+        .def(py::init([](const ASGraph& graph) {
+            if (!graph.getLeakers().empty()) {
+                throw std::invalid_argument("RouteResolver does not model route leakers");
+            }
+            return new RouteResolver(graph);
+        }), py::arg("graph"), py::keep_alive<1, 2>(),
+           "Resolver over graph's seeds, policies and route selection (no propagation needed)")
+        .def("resolve", [](RouteResolver& resolver, ASN asn, const std::string& prefix_str) -> py::object {
+            Prefix prefix = Prefix::parse(prefix_str);
+            const Announcement* ann = resolver.resolve(asn, prefix);
+            if (!ann) {
+                return py::none();
+            }
+            return route_to_dict(prefix, *ann);
+        }, py::arg("asn"), py::arg("prefix"),
+           "Route asn selects for prefix, as get_announcement() after propagation (None if none)")
+        .def("clear", &RouteResolver::clear,
+             "Forget memoized routes and re-read seeds and route selection (after graph changes)")
+        .def("get_computed_route_count", &RouteResolver::getComputedRouteCount,
+             "Routes computed since the last clear()")
+        .def("__repr__", [](const RouteResolver& resolver) {
+            return "<RouteResolver computed=" + std::to_string(resolver.getComputedRouteCount()) + ">";
+        });
+
+    // RPKI origin validation
+    py::class_<RpkiIndex>(m, "RpkiIndex")
+        .def(py::init<>())
+        .def("load", &RpkiIndex::loadFromFile,
+             py::arg("filename"), py::arg("threads") = 0,
+             "Load a VRP CSV (prefix,maxLength,ASN); returns False if the file cannot be read")
+        .def("validate", [](const RpkiIndex& index, const std::string& prefix, ASN origin) {
+            return std::string(rpkiStateName(index.validate(Prefix::parse(prefix), origin)));
+        }, py::arg("prefix"), py::arg("origin"),
+           "Origin validation state: 'valid', 'invalid' or 'not-found'")
+        .def("validate_path", [](const RpkiIndex& index, const std::string& prefix,
+                                 const std::vector<ASN>& path) {
+            std::vector<RpkiState> states;
+            index.validatePath(Prefix::parse(prefix), path, states);
+            py::list result;
+            for (RpkiState state : states) {
+                result.append(rpkiStateName(state));
+            }
+            return result;
+        }, py::arg("prefix"), py::arg("path"),
+           "State of (prefix, AS) at every hop of path, origin last")
+        .def("size", &RpkiIndex::size, "Number of distinct VRPs")
+        .def("get_ipv4_count", &RpkiIndex::getIPv4Count)
+        .def("get_ipv6_count", &RpkiIndex::getIPv6Count)
+        .def("__repr__", [](const RpkiIndex& index) {
+            return "<RpkiIndex vrps=" + std::to_string(index.size()) + ">";
+        });
+
+    // Topology diff
+    auto edge_tuples = [](const std::vector<GraphEdge>& edges) {
+        py::list out;
+        for (const GraphEdge& e : edges) {
+            out.append(py::make_tuple(e.as1, e.as2, static_cast<int>(e.rel)));
+        }
+        return out;
+    };
+
+    py::class_<TopologyDiff>(m, "TopologyDiff")
+        .def(py::init<>())
+        .def_property_readonly("old_fingerprint", [](const TopologyDiff& d) { return d.old_fingerprint.toHex(); })
+        .def_property_readonly("new_fingerprint", [](const TopologyDiff& d) { return d.new_fingerprint.toHex(); })
+        .def_readonly("added_nodes", &TopologyDiff::added_nodes)
+        .def_readonly("removed_nodes", &TopologyDiff::removed_nodes)
+        .def_property_readonly("added_edges", [edge_tuples](const TopologyDiff& d) {
+            return edge_tuples(d.added_edges);
+        }, "List of (as1, as2, rel) with CAIDA relationship codes")
+        .def_property_readonly("removed_edges", [edge_tuples](const TopologyDiff& d) {
+            return edge_tuples(d.removed_edges);
+        }, "List of (as1, as2, rel) with CAIDA relationship codes")
+        .def_property_readonly("changed_edges", [](const TopologyDiff& d) {
+            py::list out;
+            for (const EdgeChange& c : d.changed_edges) {
+                out.append(py::make_tuple(c.as1, c.as2, static_cast<int>(c.old_rel),
+                                          static_cast<int>(c.new_rel)));
+            }
+            return out;
+        }, "List of (as1, as2, old_rel, new_rel)")
+        .def("empty", &TopologyDiff::empty)
+        .def("write", [](const TopologyDiff& d, const std::string& filename) {
+            return writeTopologyDiff(d, filename);
+        }, py::arg("filename"), "Write the diff in its text form")
+        .def("__repr__", [](const TopologyDiff& d) {
+            return "TopologyDiff(+nodes=" + std::to_string(d.added_nodes.size()) +
+                   ", -nodes=" + std::to_string(d.removed_nodes.size()) +
+                   ", +edges=" + std::to_string(d.added_edges.size()) +
+                   ", -edges=" + std::to_string(d.removed_edges.size()) +
+                   ", ~edges=" + std::to_string(d.changed_edges.size()) + ")";
+        });
+
+    m.def("diff_topologies", &diffTopologies,
+          py::arg("old_graph"), py::arg("new_graph"), py::arg("threads") = 0,
+          "Typed node and edge differences between two graphs");
+
+    m.def("diff_snapshot_files", [](const std::string& old_snapshot,
+                                    const std::string& new_snapshot, unsigned threads) -> py::object {
+        TopologyDiff diff;
+        if (!diffSnapshotFiles(old_snapshot, new_snapshot, diff, threads)) {
+            return py::none();
+        }
+        return py::cast(std::move(diff));
+    }, py::arg("old_snapshot"), py::arg("new_snapshot"), py::arg("threads") = 0,
+       "Diff two binary snapshots without building graphs (None on error)");
+
+    m.def("read_topology_diff", [](const std::string& filename) -> py::object {
+        TopologyDiff diff;
+        if (!readTopologyDiff(filename, diff)) {
+            return py::none();
+        }
+        return py::cast(std::move(diff));
+    }, py::arg("filename"), "Read a diff written by topology_diff (None on error)");
+
+    m.def("hash_file", [](const std::string& filename) -> py::object {
+        Hash128 hash;
+        if (!hashFile(filename, hash)) {
+            return py::none();
+        }
+        return py::str(hash.toHex());
+    }, py::arg("filename"), "128-bit content hash of a file as hex (None if unreadable)");
+
+    m.def("set_huge_page_mode", [](const std::string& mode) {
+        HugePageMode parsed;
+        if (!parseHugePageMode(mode, parsed)) {
+            throw std::invalid_argument("huge page mode must be off, thp or explicit");
+        }
+        return setHugePageMode(parsed);
+    }, py::arg("mode"),
+       "Back graph and RIB storage with huge pages; call before creating any ASGraph");
+
+    m.def("get_huge_page_stats", []() {
+        HugePageStats stats = getHugePageStats();
+        py::dict result;
+        result["mode"] = hugePageModeName(getHugePageMode());
+        result["explicit_bytes"] = stats.explicit_bytes;
+        result["transparent_bytes"] = stats.transparent_bytes;
+        result["anon_huge_bytes"] = stats.anon_huge_bytes;
+        return result;
+    }, "Bytes mapped with MAP_HUGETLB / MADV_HUGEPAGE and THP-backed bytes of this process");
+
+    m.def("export_ribs", [](const ASGraph& graph, const std::string& filename,
+                            const std::vector<ASN>& asns, const std::vector<std::string>& prefixes,
+                            const std::vector<ASN>& origins, bool rov_invalid_only,
+                            bool sorted, unsigned threads) {
+        RibExportOptions options;
+        options.threads = threads;
+        options.sorted = sorted;
+        options.filter.asns = asns;
+        options.filter.origins = origins;
+        options.filter.rov_invalid_only = rov_invalid_only;
+        for (const std::string& prefix : prefixes) {
+            options.filter.prefixes.push_back(Prefix::parse(prefix));
+        }
+        size_t rows = 0;
+        if (!exportRibsCsv(graph, filename, options, &rows)) {
+            throw std::runtime_error("cannot write " + filename);
+        }
+        return rows;
+    }, py::arg("graph"), py::arg("filename"),
+       py::arg("asns") = std::vector<ASN>(), py::arg("prefixes") = std::vector<std::string>(),
+       py::arg("origins") = std::vector<ASN>(), py::arg("rov_invalid_only") = false,
+       py::arg("sorted") = false, py::arg("threads") = 0,
+       "Write selected RIB rows in the bgp_simulator CSV format; returns the row count");
+
+    m.def("summarize_ribs", [](const ASGraph& graph, unsigned threads) {
+        RibSummary summary = summarizeRibs(graph, threads);
+        py::dict result;
+        result["ases"] = summary.ases;
+        result["routed_ases"] = summary.routed_ases;
+        result["routes"] = summary.routes;
+        result["rov_invalid_routes"] = summary.rov_invalid_routes;
+        result["relationships"] = py::make_tuple(summary.relationship_counts[0], summary.relationship_counts[1],
+                                                 summary.relationship_counts[2], summary.relationship_counts[3]);
+        result["path_length_histogram"] = summary.path_length_histogram;
+
+        py::list prefixes;
+        for (const PrefixRibSummary& prefix : summary.prefixes) {
+            py::dict entry;
+            entry["prefix"] = prefix.prefix.toString();
+            entry["reach"] = prefix.reach;
+            entry["path_length_total"] = prefix.path_length_total;
+            entry["origins"] = prefix.origins;
+            prefixes.append(entry);
+        }
+        result["prefixes"] = prefixes;
+        return result;
+    }, py::arg("graph"), py::arg("threads") = 0,
+       "Reach, origin counts, path length histogram and relationship mix of all local RIBs");
+
+    m.def("write_rib_summary", [](const ASGraph& graph, const std::string& filename, unsigned threads) {
+        return writeRibSummaryJson(summarizeRibs(graph, threads), filename);
+    }, py::arg("graph"), py::arg("filename"), py::arg("threads") = 0,
+       "Write the RIB summary as JSON (what bgp_simulator --output-format summary writes)");
+
+    // Utility functions
+    m.def("parse_prefix", &Prefix::parse,
+          py::arg("prefix_str"),
+          "Parse a prefix string (auto-detect IPv4/IPv6)");
+
+    // Statistics helper
+    m.def("get_graph_statistics", [](const ASGraph& graph) {
+        py::dict stats;
+        stats["total_nodes"] = graph.getNodeCount();
+        stats["total_edges"] = graph.getEdgeCount();
+        stats["provider_customer_edges"] = graph.getProviderCustomerEdges();
+        stats["peer_edges"] = graph.getPeerEdges();
+        stats["rov_deploying_ases"] = graph.getROVASNCount();
+
+        // Calculate degree statistics
+        size_t total_providers = 0;
+        size_t total_customers = 0;
+        size_t total_peers = 0;
+        size_t stub_count = 0;
+
+        for (const auto& pair : graph.getNodes()) {
+            const ASNode& node = pair.second;
+            total_providers += node.providers.size();
+            total_customers += node.customers.size();
+            total_peers += node.peers.size();
+
+            if (node.customers.empty() && node.peers.empty()) {
+                stub_count++;
+            }
+        }
+
+        stats["avg_providers"] = static_cast<double>(total_providers) / graph.getNodeCount();
+        stats["avg_customers"] = static_cast<double>(total_customers) / graph.getNodeCount();
+        stats["avg_peers"] = static_cast<double>(total_peers) / graph.getNodeCount();
+        stats["stub_ases"] = stub_count;
+
+        return stats;
+    }, py::arg("graph"), "Get comprehensive graph statistics");
+
+    // Version info
+    m.attr("__version__") = "1.0.0";
+}
@@ -0,0 +1,263 @@
+#include "result_cache.h"
+#include "content_hash.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char* const ENTRY_EXTENSION = ".out";
+
+    struct CacheEntry {
+        fs::path path;
+        uint64_t size;
+        fs::file_time_type last_used;
+    };
+
+    std::vector<CacheEntry> listEntries(const std::string& directory) {
+        std::vector<CacheEntry> entries;
+        std::error_code ec;
+
+        for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+            if (!it->is_regular_file(ec) || it->path().extension() != ENTRY_EXTENSION) {
+                continue;
+            }
+
+            CacheEntry entry;
+            entry.path = it->path();
+            entry.size = it->file_size(ec);
+            entry.last_used = it->last_write_time(ec);
+            if (!ec) {
+                entries.push_back(entry);
+            }
+        }
+        return entries;
+    }
+}
+
+ResultCache::ResultCache(const std::string& dir, uint64_t max_size)
+    : directory(dir), max_bytes(max_size) {
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    if (ec) {
+        std::cerr << "Warning: Cannot create cache directory " << directory
+                  << ": " << ec.message() << std::endl;
+    }
+}
+
+std::string ResultCache::entryPath(const std::string& key) const {
+    return (fs::path(directory) / (key + ENTRY_EXTENSION)).string();
+}
+
+std::string ResultCache::hashInputs(CacheInputs inputs) {
+    // Normalize: input order must not change the key
+    std::sort(inputs.seeds.begin(), inputs.seeds.end(),
+              [](const SeedAnnouncement& a, const SeedAnnouncement& b) {
+                  if (a.origin_asn != b.origin_asn) return a.origin_asn < b.origin_asn;
+                  if (a.prefix != b.prefix) return a.prefix < b.prefix;
+                  return a.rov_invalid < b.rov_invalid;
+              });
+    std::sort(inputs.rov_asns.begin(), inputs.rov_asns.end());
+    inputs.rov_asns.erase(std::unique(inputs.rov_asns.begin(), inputs.rov_asns.end()), inputs.rov_asns.end());
+    std::sort(inputs.vantage_points.begin(), inputs.vantage_points.end());
+    inputs.vantage_points.erase(std::unique(inputs.vantage_points.begin(), inputs.vantage_points.end()), inputs.vantage_points.end());
+    std::sort(inputs.aspa_asns.begin(), inputs.aspa_asns.end());
+    inputs.aspa_asns.erase(std::unique(inputs.aspa_asns.begin(), inputs.aspa_asns.end()), inputs.aspa_asns.end());
+    std::sort(inputs.pathend_asns.begin(), inputs.pathend_asns.end());
+    inputs.pathend_asns.erase(std::unique(inputs.pathend_asns.begin(), inputs.pathend_asns.end()), inputs.pathend_asns.end());
+    std::sort(inputs.leakers.begin(), inputs.leakers.end());
+
+    // Length-prefix every variable field so that concatenations cannot collide
+    ContentHasher hasher;
+    auto add_string = [&hasher](const std::string& str) {
+        hasher.updateU64(str.size());
+        hasher.update(str);
+    };
+
+    add_string(ENGINE_VERSION);
+    add_string(inputs.output_format);
+    add_string(inputs.graph_fingerprint);
+
+    hasher.updateU64(inputs.seeds.size());
+    for (const SeedAnnouncement& seed : inputs.seeds) {
+        hasher.updateU64(seed.origin_asn);
+        add_string(seed.prefix);
+        hasher.updateU64(seed.rov_invalid ? 1 : 0);
+    }
+
+    hasher.updateU64(inputs.rov_asns.size());
+    for (ASN asn : inputs.rov_asns) {
+        hasher.updateU64(asn);
+    }
+
+    // Only with retention on, so that keys of full runs stay unchanged
+    if (!inputs.vantage_points.empty()) {
+        add_string("vantage_points");
+        hasher.updateU64(inputs.vantage_points.size());
+        for (ASN asn : inputs.vantage_points) {
+            hasher.updateU64(asn);
+        }
+    }
+
+    // Likewise only for non-standard selection; the seed matters only when hashed
+    if (inputs.route_selection != RouteSelection::STANDARD) {
+        add_string("route_selection");
+        add_string(routeSelectionName(inputs.route_selection));
+        hasher.updateU64(inputs.route_selection == RouteSelection::HASH_TIE_BREAK ? inputs.selection_seed : 0);
+    }
+
+    // ASPA records matter only where someone verifies them
+    if (!inputs.aspa_asns.empty()) {
+        add_string("aspa");
+        hasher.updateU64(inputs.aspa_asns.size());
+        for (ASN asn : inputs.aspa_asns) {
+            hasher.updateU64(asn);
+        }
+        add_string(inputs.aspa_fingerprint);
+    }
+
+    if (!inputs.pathend_asns.empty()) {
+        add_string("path_end");
+        hasher.updateU64(inputs.pathend_asns.size());
+        for (ASN asn : inputs.pathend_asns) {
+            hasher.updateU64(asn);
+        }
+        add_string(inputs.pathend_fingerprint);
+    }
+
+    // Leakers and their policies; the round limit too, as it decides non-converging runs
+    if (!inputs.leakers.empty()) {
+        add_string("leakers");
+        hasher.updateU64(inputs.leakers.size());
+        for (const auto& leaker : inputs.leakers) {
+            hasher.updateU64(leaker.first);
+            hasher.updateU64(static_cast<uint64_t>(leaker.second));
+        }
+        hasher.updateU64(inputs.leak_round_limit);
+    }
+
+    return hasher.digest().toHex();
+}
+
+std::string ResultCache::makeKey(const ASGraph& graph,
+                                 const std::string& graph_fingerprint,
+                                 const std::string& output_format) {
+    CacheInputs inputs;
+    inputs.graph_fingerprint = graph_fingerprint;
+    inputs.output_format = output_format;
+    inputs.seeds = graph.getSeeds();
+    inputs.rov_asns.assign(graph.getROVASNs().begin(), graph.getROVASNs().end());
+    inputs.vantage_points.assign(graph.getVantagePoints().begin(), graph.getVantagePoints().end());
+    inputs.route_selection = graph.getRouteSelection();
+    inputs.selection_seed = graph.getSelectionSeed();
+    inputs.aspa_asns.assign(graph.getASPAASNs().begin(), graph.getASPAASNs().end());
+    inputs.pathend_asns.assign(graph.getPathEndASNs().begin(), graph.getPathEndASNs().end());
+    inputs.leakers.assign(graph.getLeakers().begin(), graph.getLeakers().end());
+    inputs.leak_round_limit = graph.getLeakRoundLimit();
+
+    // Records are stored sorted, so equal record sets hash equally
+    if (!inputs.aspa_asns.empty()) {
+        const AspaTable& table = graph.getASPATable();
+        ContentHasher hasher;
+        hasher.updateU64(table.getCustomerCount());
+        for (size_t i = 0; i < table.getCustomerCount(); i++) {
+            hasher.updateU64(table.getCustomers()[i]);
+            hasher.updateU64(table.getOffsets()[i + 1] - table.getOffsets()[i]);
+        }
+        for (ASN provider : table.getProviders()) {
+            hasher.updateU64(provider);
+        }
+        inputs.aspa_fingerprint = hasher.digest().toHex();
+    }
+
+    if (!inputs.pathend_asns.empty()) {
+        ContentHasher hasher;
+        std::vector<uint64_t> keys = graph.getPathEndTable().getSortedKeys();
+        hasher.updateU64(keys.size());
+        for (uint64_t key : keys) {
+            hasher.updateU64(key);
+        }
+        inputs.pathend_fingerprint = hasher.digest().toHex();
+    }
+
+    return hashInputs(std::move(inputs));
+}
+
+bool ResultCache::lookup(const std::string& key, const std::string& output_filename) {
+    std::string path = entryPath(key);
+    std::error_code ec;
+    if (!fs::is_regular_file(path, ec)) {
+        return false;
+    }
+
+    fs::copy_file(path, output_filename, fs::copy_options::overwrite_existing, ec);
+    if (ec) {
+        std::cerr << "Warning: Cannot copy cached result " << path
+                  << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    // Mark as recently used for eviction ordering
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    return true;
+}
+
+bool ResultCache::store(const std::string& key, const std::string& output_filename) {
+    std::string path = entryPath(key);
+    std::string tmp_path = path + ".tmp";
+    std::error_code ec;
+
+    // Copy then rename so that concurrent readers never see a partial entry
+    fs::copy_file(output_filename, tmp_path, fs::copy_options::overwrite_existing, ec);
+    if (!ec) {
+        fs::rename(tmp_path, path, ec);
+    }
+    if (ec) {
+        std::cerr << "Warning: Cannot store result in cache: " << ec.message() << std::endl;
+        fs::remove(tmp_path, ec);
+        return false;
+    }
+
+    evict();
+    return true;
+}
+
+void ResultCache::evict() {
+    std::vector<CacheEntry> entries = listEntries(directory);
+
+    uint64_t total = 0;
+    for (const CacheEntry& entry : entries) {
+        total += entry.size;
+    }
+    if (total <= max_bytes) {
+        return;
+    }
+
+    // Oldest first
+    std::sort(entries.begin(), entries.end(),
+              [](const CacheEntry& a, const CacheEntry& b) { return a.last_used < b.last_used; });
+
+    size_t evicted = 0;
+    for (const CacheEntry& entry : entries) {
+        if (total <= max_bytes) break;
+
+        std::error_code ec;
+        if (fs::remove(entry.path, ec)) {
+            total -= entry.size;
+            evicted++;
+        }
+    }
+
+    std::cout << "Result cache: evicted " << evicted << " entries ("
+              << total << " bytes remaining)" << std::endl;
+}
+
+uint64_t ResultCache::getSizeBytes() const {
+    uint64_t total = 0;
+    for (const CacheEntry& entry : listEntries(directory)) {
+        total += entry.size;
+    }
+    return total;
+}
@@ -0,0 +1,536 @@
+#include "rib_diff.h"
+#include "announcement.h"
+#include "output_writer.h"
+#include "parallel.h"
+#include "rib_export.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr size_t READ_BUFFER = 1 << 20;
+    constexpr size_t RANGES_PER_THREAD = 4;
+    constexpr size_t PREFIX_CACHE_LIMIT = 1 << 16;
+
+    // Logical position in an input: byte offset within one of its files
+    struct Position {
+        size_t file;
+        uint64_t offset;
+    };
+
+    class FileHandle {
+    private:
+        int fd = -1;
+
+    public:
+        explicit FileHandle(const std::string& path) : fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC)) {}
+        ~FileHandle() { if (fd >= 0) ::close(fd); }
+        FileHandle(const FileHandle&) = delete;
+        FileHandle& operator=(const FileHandle&) = delete;
+
+        bool isOpen() const { return fd >= 0; }
+
+        size_t readAt(char* buffer, size_t length, uint64_t offset) const {
+            ssize_t n;
+            do {
+                n = pread(fd, buffer, length, static_cast<off_t>(offset));
+            } while (n < 0 && errno == EINTR);
+            return n > 0 ? static_cast<size_t>(n) : 0;
+        }
+    };
+
+    // First line start at or after offset (the file size if there is none)
+    uint64_t lineStartAtOrAfter(const FileHandle& file, uint64_t offset, uint64_t data_start, uint64_t size) {
+        if (offset <= data_start) return data_start;
+
+        char buffer[4096];
+        uint64_t at = offset - 1;
+        while (at < size) {
+            size_t got = file.readAt(buffer, sizeof(buffer), at);
+            if (got == 0) break;
+            const char* newline = static_cast<const char*>(std::memchr(buffer, '\n', got));
+            if (newline) {
+                return at + (newline - buffer) + 1;
+            }
+            at += got;
+        }
+        return size;
+    }
+
+    ASN asnAt(const FileHandle& file, uint64_t offset) {
+        char buffer[16] = {};
+        size_t got = file.readAt(buffer, sizeof(buffer) - 1, offset);
+        ASN asn = 0;
+        for (size_t i = 0; i < got && buffer[i] >= '0' && buffer[i] <= '9'; i++) {
+            asn = asn * 10 + static_cast<ASN>(buffer[i] - '0');
+        }
+        return asn;
+    }
+
+    // Line start of the first row with ASN >= target (binary search over bytes)
+    uint64_t lowerBoundAsn(const FileHandle& file, ASN target, uint64_t data_start, uint64_t size) {
+        uint64_t lo = data_start;
+        uint64_t hi = size;
+        while (lo < hi) {
+            uint64_t mid = lo + (hi - lo) / 2;
+            uint64_t line = lineStartAtOrAfter(file, mid, data_start, size);
+            if (line >= size || asnAt(file, line) >= target) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+        return lineStartAtOrAfter(file, lo, data_start, size);
+    }
+
+    Position locateAsn(const SortedRibInput& input, ASN target) {
+        for (size_t f = 0; f < input.getFileCount(); f++) {
+            FileHandle file(input.getFile(f));
+            uint64_t line = lowerBoundAsn(file, target, input.getDataStart(f), input.getSize(f));
+            if (line < input.getSize(f)) {
+                return {f, line};
+            }
+        }
+        return {input.getFileCount(), 0};
+    }
+
+    // Split ASNs sampled at evenly spaced bytes of an input
+    void sampleSplits(const SortedRibInput& input, size_t ranges, std::vector<ASN>& splits) {
+        uint64_t total = input.getTotalBytes();
+        for (size_t r = 1; r < ranges; r++) {
+            uint64_t target = total * r / ranges;
+            for (size_t f = 0; f < input.getFileCount(); f++) {
+                if (target >= input.getSize(f)) {
+                    target -= input.getSize(f);
+                    continue;
+                }
+                FileHandle file(input.getFile(f));
+                uint64_t line = lineStartAtOrAfter(file, target, input.getDataStart(f), input.getSize(f));
+                if (line < input.getSize(f)) {
+                    splits.push_back(asnAt(file, line));
+                }
+                break;
+            }
+        }
+    }
+
+    struct RibRow {
+        ASN asn = 0;
+        Prefix prefix;
+        std::string line;
+        size_t prefix_begin = 0;     // Field offsets within line
+        size_t path_begin = 0;
+        ASN next_hop = 0;
+        ASN origin = 0;
+
+        std::string prefixText() const { return line.substr(prefix_begin, path_begin - 1 - prefix_begin); }
+        std::string pathText() const { return line.substr(path_begin); }
+        bool samePath(const RibRow& other) const {
+            return line.compare(path_begin, std::string::npos, other.line, other.path_begin, std::string::npos) == 0;
+        }
+    };
+
+    bool keyLess(const RibRow& a, const RibRow& b) {
+        if (a.asn != b.asn) return a.asn < b.asn;
+        return prefixLess(a.prefix, b.prefix);
+    }
+
+    // Sequential rows of one input between two positions
+    class RowReader {
+    private:
+        const SortedRibInput& input;
+        Position end;
+        size_t file_index;
+        uint64_t offset = 0;
+        uint64_t file_end = 0;
+        std::unique_ptr<FileHandle> file;
+
+        std::vector<char> buffer;
+        size_t buffer_pos = 0;
+        size_t buffer_len = 0;
+
+        std::unordered_map<std::string, Prefix> prefix_cache;
+
+        bool openFile(size_t index, uint64_t start) {
+            file_index = index;
+            if (file_index >= input.getFileCount() || file_index > end.file) {
+                file.reset();
+                return false;
+            }
+            file.reset(new FileHandle(input.getFile(file_index)));
+            offset = start;
+            file_end = file_index == end.file ? end.offset : input.getSize(file_index);
+            buffer_pos = buffer_len = 0;
+            return file->isOpen();
+        }
+
+        bool fill() {
+            while (true) {
+                if (!file) return false;
+                if (offset < file_end) {
+                    size_t want = static_cast<size_t>(std::min<uint64_t>(buffer.size(), file_end - offset));
+                    buffer_len = file->readAt(buffer.data(), want, offset);
+                    buffer_pos = 0;
+                    offset += buffer_len;
+                    if (buffer_len > 0) return true;
+                }
+                size_t next = file_index + 1;
+                if (next >= input.getFileCount() || !openFile(next, input.getDataStart(next))) {
+                    return false;
+                }
+            }
+        }
+
+        bool readLine(std::string& line) {
+            line.clear();
+            while (true) {
+                if (buffer_pos == buffer_len) {
+                    if (!fill()) return !line.empty();
+                }
+                const char* start = buffer.data() + buffer_pos;
+                size_t avail = buffer_len - buffer_pos;
+                const char* newline = static_cast<const char*>(std::memchr(start, '\n', avail));
+                if (newline) {
+                    line.append(start, newline - start);
+                    buffer_pos += (newline - start) + 1;
+                    return true;
+                }
+                line.append(start, avail);
+                buffer_pos = buffer_len;
+            }
+        }
+
+        bool parse(RibRow& row) {
+            const std::string& line = row.line;
+            size_t comma1 = line.find(',');
+            size_t comma2 = comma1 == std::string::npos ? comma1 : line.find(',', comma1 + 1);
+            if (comma2 == std::string::npos) return false;
+
+            row.asn = static_cast<ASN>(std::strtoul(line.c_str(), nullptr, 10));
+            row.prefix_begin = comma1 + 1;
+            row.path_begin = comma2 + 1;
+
+            std::string prefix_text = line.substr(comma1 + 1, comma2 - comma1 - 1);
+            auto it = prefix_cache.find(prefix_text);
+            if (it == prefix_cache.end()) {
+                if (prefix_cache.size() >= PREFIX_CACHE_LIMIT) prefix_cache.clear();
+                it = prefix_cache.emplace(prefix_text, Prefix::parse(prefix_text)).first;
+            }
+            row.prefix = it->second;
+
+            // Path "(self, next_hop, ..., origin)"
+            row.next_hop = 0;
+            row.origin = 0;
+            size_t index = 0;
+            for (size_t i = comma2 + 1; i < line.size(); i++) {
+                if (line[i] < '0' || line[i] > '9') continue;
+                ASN value = 0;
+                while (i < line.size() && line[i] >= '0' && line[i] <= '9') {
+                    value = value * 10 + static_cast<ASN>(line[i++] - '0');
+                }
+                if (index == 1) row.next_hop = value;
+                row.origin = value;
+                index++;
+            }
+            return true;
+        }
+
+    public:
+        std::string error;
+        uint64_t rows = 0;
+
+        RowReader(const SortedRibInput& in, Position begin, Position stop)
+            : input(in), end(stop), buffer(READ_BUFFER) {
+            openFile(begin.file, begin.offset);
+        }
+
+        // Next row, checking that keys strictly increase
+        bool next(RibRow& row, const RibRow* previous) {
+            while (readLine(row.line)) {
+                if (!row.line.empty() && row.line.back() == '\r') row.line.pop_back();
+                if (row.line.empty()) continue;
+                if (!parse(row)) {
+                    error = "malformed row in " + input.getFile(file_index) + ": " + row.line;
+                    return false;
+                }
+                if (previous && !keyLess(*previous, row)) {
+                    error = input.getFile(file_index) + " is not sorted by (asn, prefix); "
+                            "write it with bgp_simulator --sorted";
+                    return false;
+                }
+                rows++;
+                return true;
+            }
+            return false;
+        }
+    };
+
+    void appendChange(std::string& out, const char* change, const RibRow& row,
+                      const RibRow* old_row, const RibRow* new_row) {
+        out += change;
+        out += ',';
+        out += std::to_string(row.asn);
+        out += ',';
+        out += row.prefixText();
+        out += ',';
+        if (old_row) out += old_row->pathText();
+        out += ',';
+        if (new_row) out += new_row->pathText();
+        out += '\n';
+    }
+
+    // Merge one key range of both inputs
+    bool mergeRange(const SortedRibInput& old_input, const SortedRibInput& new_input,
+                    Position old_begin, Position old_end, Position new_begin, Position new_end,
+                    const std::string& part_file, bool write_rows,
+                    RibDiffCounts& counts, std::string& error) {
+        RowReader old_reader(old_input, old_begin, old_end);
+        RowReader new_reader(new_input, new_begin, new_end);
+
+        OutputWriter writer;
+        OutputWriterOptions writer_options;
+        writer_options.buffer_size = 256 << 10;
+        writer_options.queue_depth = 2;
+        if (write_rows && !writer.open(part_file, writer_options)) {
+            error = "cannot write " + part_file;
+            return false;
+        }
+
+        RibRow rows[4];
+        RibRow* old_row = &rows[0];
+        RibRow* old_prev = &rows[1];
+        RibRow* new_row = &rows[2];
+        RibRow* new_prev = &rows[3];
+        bool has_old = old_reader.next(*old_row, nullptr);
+        bool has_new = new_reader.next(*new_row, nullptr);
+        std::string out;
+
+        auto advance_old = [&]() {
+            std::swap(old_row, old_prev);
+            has_old = old_reader.next(*old_row, old_prev);
+        };
+        auto advance_new = [&]() {
+            std::swap(new_row, new_prev);
+            has_new = new_reader.next(*new_row, new_prev);
+        };
+
+        while (has_old || has_new) {
+            if (has_old && (!has_new || keyLess(*old_row, *new_row))) {
+                counts.removed++;
+                if (write_rows) appendChange(out, "removed", *old_row, old_row, nullptr);
+                advance_old();
+            } else if (has_new && (!has_old || keyLess(*new_row, *old_row))) {
+                counts.added++;
+                if (write_rows) appendChange(out, "added", *new_row, nullptr, new_row);
+                advance_new();
+            } else {
+                const char* change = nullptr;
+                if (old_row->samePath(*new_row)) {
+                    counts.unchanged++;
+                } else if (old_row->origin != new_row->origin) {
+                    counts.origin_changed++;
+                    change = "origin";
+                } else if (old_row->next_hop != new_row->next_hop) {
+                    counts.next_hop_changed++;
+                    change = "next_hop";
+                } else {
+                    counts.path_changed++;
+                    change = "path";
+                }
+                if (change && write_rows) appendChange(out, change, *old_row, old_row, new_row);
+                advance_old();
+                advance_new();
+            }
+
+            if (out.size() >= READ_BUFFER) {
+                writer.write(out);
+                out.clear();
+            }
+        }
+
+        counts.old_rows = old_reader.rows;
+        counts.new_rows = new_reader.rows;
+
+        if (!old_reader.error.empty() || !new_reader.error.empty()) {
+            error = !old_reader.error.empty() ? old_reader.error : new_reader.error;
+            return false;
+        }
+        if (write_rows) {
+            writer.write(out);
+            if (!writer.close()) {
+                error = "cannot write " + part_file;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool positionLess(const Position& a, const Position& b) {
+        return a.file != b.file ? a.file < b.file : a.offset < b.offset;
+    }
+}
+
+void RibDiffCounts::add(const RibDiffCounts& other) {
+    old_rows += other.old_rows;
+    new_rows += other.new_rows;
+    unchanged += other.unchanged;
+    added += other.added;
+    removed += other.removed;
+    origin_changed += other.origin_changed;
+    next_hop_changed += other.next_hop_changed;
+    path_changed += other.path_changed;
+}
+
+bool SortedRibInput::open(const std::string& path) {
+    files.clear();
+    sizes.clear();
+    data_start.clear();
+
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        std::cerr << "Error: Cannot open " << path << std::endl;
+        return false;
+    }
+
+    if (fs::path(path).extension() == ".json") {
+        // Shard manifest written by bgp_simulator --output-shards
+        std::stringstream text;
+        text << in.rdbuf();
+        std::string manifest = text.str();
+
+        if (manifest.find("\"shard_by\": \"asn_range\"") == std::string::npos ||
+            manifest.find("\"compression\": \"none\"") == std::string::npos) {
+            std::cerr << "Error: " << path << " must list uncompressed shards split by ASN range "
+                      << "(--shard-by asn --shard-compression none)" << std::endl;
+            return false;
+        }
+
+        fs::path dir = fs::path(path).parent_path();
+        const std::string key = "\"file\": \"";
+        for (size_t at = manifest.find(key); at != std::string::npos; at = manifest.find(key, at)) {
+            at += key.size();
+            size_t close = manifest.find('"', at);
+            files.push_back((dir / manifest.substr(at, close - at)).string());
+            at = close;
+        }
+    } else {
+        files.push_back(path);
+    }
+
+    for (const std::string& file : files) {
+        std::error_code ec;
+        uint64_t size = fs::file_size(file, ec);
+        std::ifstream check(file);
+        std::string header;
+        if (ec || !check.is_open() || !std::getline(check, header)) {
+            std::cerr << "Error: Cannot read " << file << std::endl;
+            return false;
+        }
+        if (header.rfind("asn,prefix,as_path", 0) != 0) {
+            std::cerr << "Error: " << file << " is not a bgp_simulator RIB CSV" << std::endl;
+            return false;
+        }
+        sizes.push_back(size);
+        data_start.push_back(std::min<uint64_t>(size, header.size() + 1));
+    }
+    return true;
+}
+
+uint64_t SortedRibInput::getTotalBytes() const {
+    uint64_t total = 0;
+    for (uint64_t size : sizes) total += size;
+    return total;
+}
+
+bool diffRibOutputs(const std::string& old_path, const std::string& new_path,
+                    const std::string& output, const RibDiffOptions& options,
+                    RibDiffCounts& counts) {
+    SortedRibInput old_input;
+    SortedRibInput new_input;
+    if (!old_input.open(old_path) || !new_input.open(new_path)) {
+        return false;
+    }
+
+    // Key ranges: split ASNs sampled from both inputs, located in each by binary search
+    unsigned threads = options.threads == 0 ? defaultThreadCount() : options.threads;
+    size_t ranges = threads > 1 ? threads * RANGES_PER_THREAD : 1;
+
+    std::vector<ASN> splits;
+    sampleSplits(old_input, ranges, splits);
+    sampleSplits(new_input, ranges, splits);
+    std::sort(splits.begin(), splits.end());
+    splits.erase(std::unique(splits.begin(), splits.end()), splits.end());
+    splits.erase(std::remove(splits.begin(), splits.end(), 0u), splits.end());
+
+    std::vector<Position> old_bounds{{0, old_input.getDataStart(0)}};
+    std::vector<Position> new_bounds{{0, new_input.getDataStart(0)}};
+    for (ASN split : splits) {
+        old_bounds.push_back(locateAsn(old_input, split));
+        new_bounds.push_back(locateAsn(new_input, split));
+    }
+    old_bounds.push_back({old_input.getFileCount(), 0});
+    new_bounds.push_back({new_input.getFileCount(), 0});
+    size_t range_count = old_bounds.size() - 1;
+
+    std::vector<RibDiffCounts> range_counts(range_count);
+    std::vector<std::string> errors(range_count);
+    std::vector<std::string> parts(range_count);
+    for (size_t r = 0; r < range_count; r++) {
+        parts[r] = output + ".part" + std::to_string(r);
+    }
+
+    parallelFor(range_count, threads, [&](size_t begin, size_t end, unsigned) {
+        for (size_t r = begin; r < end; r++) {
+            // A later split may land on an earlier position when an input lacks that ASN range
+            Position old_end = positionLess(old_bounds[r + 1], old_bounds[r]) ? old_bounds[r] : old_bounds[r + 1];
+            Position new_end = positionLess(new_bounds[r + 1], new_bounds[r]) ? new_bounds[r] : new_bounds[r + 1];
+            mergeRange(old_input, new_input, old_bounds[r], old_end, new_bounds[r], new_end,
+                       parts[r], options.write_rows, range_counts[r], errors[r]);
+        }
+    }, 1);
+
+    counts = RibDiffCounts();
+    bool ok = true;
+    for (size_t r = 0; r < range_count; r++) {
+        if (!errors[r].empty()) {
+            if (ok) std::cerr << "Error: " << errors[r] << std::endl;
+            ok = false;
+        }
+        counts.add(range_counts[r]);
+    }
+
+    if (options.write_rows) {
+        // Concatenate the per-range parts in key order
+        OutputWriter writer;
+        if (ok && writer.open(output)) {
+            writer.write(std::string("change,asn,prefix,old_as_path,new_as_path\n"));
+            std::vector<char> buffer(READ_BUFFER);
+            for (const std::string& part : parts) {
+                std::ifstream in(part, std::ios::binary);
+                while (in) {
+                    in.read(buffer.data(), buffer.size());
+                    writer.write(buffer.data(), static_cast<size_t>(in.gcount()));
+                }
+            }
+            ok = writer.close();
+        } else {
+            ok = false;
+        }
+
+        std::error_code ec;
+        for (const std::string& part : parts) {
+            fs::remove(part, ec);
+        }
+    }
+    return ok;
+}
@@ -0,0 +1,80 @@
+#include "option_parse.h"
+#include "rib_diff.h"
+#include <chrono>
+#include <iostream>
+#include <getopt.h>
+
+void print_usage(const char* prog_name) {
+    std::cout << "Usage: " << prog_name << " [options] <old output> <new output>\n"
+              << "Outputs are bgp_simulator --sorted CSVs or shard manifests (.manifest.json).\n"
+              << "Options:\n"
+              << "  --output <file>         Changed routes CSV (default: rib_diff.csv)\n"
+              << "  --threads <n>           Worker threads (default: all cores)\n"
+              << "  --summary               Print counts only, do not write the changed routes\n"
+              << "  -h, --help              Show this help\n";
+}
+
+int main(int argc, char* argv[]) {
+    static struct option long_options[] = {
+        {"output", required_argument, 0, 'o'},
+        {"threads", required_argument, 0, 't'},
+        {"summary", no_argument, 0, 's'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    std::string output_file = "rib_diff.csv";
+    RibDiffOptions options;
+
+    int opt;
+    int option_index = 0;
+    while ((opt = getopt_long(argc, argv, "o:t:sh", long_options, &option_index)) != -1) {
+        switch (opt) {
+            case 'o':
+                output_file = optarg;
+                break;
+            case 't':
+                if (!parseUnsigned(optarg, options.threads)) {
+                    std::cerr << "Error: --threads expects a number of threads\n\n";
+                    print_usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 's':
+                options.write_rows = false;
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (argc - optind != 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    RibDiffCounts counts;
+    if (!diffRibOutputs(argv[optind], argv[optind + 1], output_file, options, counts)) {
+        return 1;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+
+    std::cout << "RIB diff (" << duration.count() << " ms):" << std::endl;
+    std::cout << "  Rows: " << counts.old_rows << " old, " << counts.new_rows << " new" << std::endl;
+    std::cout << "  Unchanged: " << counts.unchanged << std::endl;
+    std::cout << "  Added: " << counts.added << ", removed: " << counts.removed << std::endl;
+    std::cout << "  Changed: " << counts.changed() << " (origin " << counts.origin_changed
+              << ", next hop " << counts.next_hop_changed
+              << ", path only " << counts.path_changed << ")" << std::endl;
+
+    if (options.write_rows) {
+        std::cout << "Changed routes written to " << output_file << std::endl;
+    }
+    return 0;
+}
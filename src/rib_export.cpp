@@ -0,0 +1,918 @@
+#include "rib_export.h"
+#include "bgp_policy.h"
+#include "content_hash.h"
+#include "option_parse.h"
+#include "parallel.h"
+#include <bzlib.h>
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr size_t BLOCK_NODES = 1024;        // Nodes formatted per task
+    constexpr size_t PREFIX_CACHE_LIMIT = 1 << 16;
+    constexpr size_t SHARD_FLUSH_BYTES = 1 << 20;     // Formatted text handed on per write
+    constexpr size_t SHARD_BUFFER_BYTES = 1 << 20;    // Writer buffers per shard
+
+    inline void appendNumber(std::string& out, uint32_t value) {
+        char digits[16];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        out.append(digits, result.ptr);
+    }
+
+    // Prefix text per worker; seeds use few prefixes, each printed once per AS
+    using PrefixCache = std::unordered_map<Prefix, std::string>;
+
+    const std::string& prefixText(PrefixCache& cache, const Prefix& prefix) {
+        auto it = cache.find(prefix);
+        if (it != cache.end()) {
+            return it->second;
+        }
+        if (cache.size() >= PREFIX_CACHE_LIMIT) {
+            cache.clear();
+        }
+        return cache.emplace(prefix, prefix.toString()).first->second;
+    }
+
+    // A RIB entry with its family-specific key widened to Prefix
+    struct RibEntry {
+        Prefix prefix;
+        const Announcement* ann;
+    };
+
+    // Per-worker buffers for PrefixOrder::sort
+    struct SortScratch {
+        std::vector<std::pair<uint32_t, const Announcement*>> keyed;
+        std::vector<std::pair<uint32_t, const Announcement*>> spare;
+        std::vector<RibEntry> sorted;
+    };
+
+    // Dense prefix ids numbered in prefix order
+    // Every RIB prefix was seeded, so the ids come from the seed list; a RIB
+    // entry outside it (seeded some other way) makes that AS fall back to a
+    // comparison sort.
+    class PrefixOrder {
+    private:
+        std::vector<Prefix> prefixes;  // By id
+        std::unordered_map<IPv4Prefix, uint32_t> ids4;
+        std::unordered_map<IPv6Prefix, uint32_t> ids6;
+        unsigned key_bytes = 1;  // Radix passes needed for the largest id
+
+        static constexpr size_t INSERTION_SORT_MAX = 32;
+
+        const std::unordered_map<IPv4Prefix, uint32_t>& ids(const IPv4Prefix*) const { return ids4; }
+        const std::unordered_map<IPv6Prefix, uint32_t>& ids(const IPv6Prefix*) const { return ids6; }
+
+        void radixSort(SortScratch& scratch) const {
+            auto& keyed = scratch.keyed;
+            auto& spare = scratch.spare;
+            spare.resize(keyed.size());
+
+            for (unsigned pass = 0; pass < key_bytes; pass++) {
+                unsigned shift = pass * 8;
+                size_t offsets[257] = {};
+                for (const auto& item : keyed) {
+                    offsets[((item.first >> shift) & 0xFF) + 1]++;
+                }
+                for (size_t d = 1; d < 257; d++) {
+                    offsets[d] += offsets[d - 1];
+                }
+                for (const auto& item : keyed) {
+                    spare[offsets[(item.first >> shift) & 0xFF]++] = item;
+                }
+                keyed.swap(spare);
+            }
+        }
+
+        // Append (id, route) for one family; false when some prefix has no id
+        template <typename P>
+        bool collect(const BasicLocalRIB<P>& rib, SortScratch& scratch) const {
+            const auto& family_ids = ids(static_cast<const P*>(nullptr));
+            for (const auto& entry : rib) {
+                auto it = family_ids.find(entry.first);
+                if (it == family_ids.end()) return false;
+                scratch.keyed.push_back({it->second, &entry.second});
+            }
+            return true;
+        }
+
+    public:
+        explicit PrefixOrder(const ASGraph& graph) {
+            prefixes.reserve(graph.getSeeds().size());
+            for (const SeedAnnouncement& seed : graph.getSeeds()) {
+                prefixes.push_back(Prefix::parse(seed.prefix));
+            }
+            std::sort(prefixes.begin(), prefixes.end(), prefixLess);
+            prefixes.erase(std::unique(prefixes.begin(), prefixes.end()), prefixes.end());
+
+            for (size_t i = 0; i < prefixes.size(); i++) {
+                if (prefixes[i].is_ipv6) {
+                    ids6.emplace(prefixes[i].v6, static_cast<uint32_t>(i));
+                } else {
+                    ids4.emplace(prefixes[i].v4, static_cast<uint32_t>(i));
+                }
+            }
+            while (key_bytes < 4 && (prefixes.size() >> (key_bytes * 8)) > 0) {
+                key_bytes++;
+            }
+        }
+
+        const std::vector<Prefix>& getPrefixes() const { return prefixes; }
+
+        bool findId(const Prefix& prefix, uint32_t& id) const {
+            if (prefix.is_ipv6) {
+                auto it = ids6.find(prefix.v6);
+                if (it == ids6.end()) return false;
+                id = it->second;
+                return true;
+            }
+            auto it = ids4.find(prefix.v4);
+            if (it == ids4.end()) return false;
+            id = it->second;
+            return true;
+        }
+
+        // scratch.sorted = the policy's RIB entries in prefix order
+        // Returns false when some prefix has no id (then scratch.keyed is incomplete)
+        bool sort(const BGPPolicy& policy, SortScratch& scratch) const {
+            auto& keyed = scratch.keyed;
+            auto& sorted = scratch.sorted;
+            keyed.clear();
+            sorted.clear();
+
+            if (!collect(policy.getLocalRIB<IPv4Prefix>(), scratch) ||
+                !collect(policy.getLocalRIB<IPv6Prefix>(), scratch)) {
+                policy.forEachRoute([&](const Prefix& prefix, const Announcement& ann) {
+                    sorted.push_back({prefix, &ann});
+                });
+                std::sort(sorted.begin(), sorted.end(), [](const RibEntry& a, const RibEntry& b) {
+                    return prefixLess(a.prefix, b.prefix);
+                });
+                return false;
+            }
+
+            if (keyed.size() <= INSERTION_SORT_MAX) {
+                for (size_t i = 1; i < keyed.size(); i++) {
+                    auto item = keyed[i];
+                    size_t j = i;
+                    for (; j > 0 && keyed[j - 1].first > item.first; j--) {
+                        keyed[j] = keyed[j - 1];
+                    }
+                    keyed[j] = item;
+                }
+            } else {
+                radixSort(scratch);
+            }
+
+            for (const auto& item : keyed) {
+                sorted.push_back({prefixes[item.first], item.second});
+            }
+            return true;
+        }
+    };
+
+    // Visit a node's RIB entries as fn(prefix, announcement), in prefix order when order is set
+    template <typename Fn>
+    void forEachEntry(const ASNode& node, const PrefixOrder* order, SortScratch& scratch, Fn fn) {
+        if (!order) {
+            node.policy->forEachRoute(fn);
+            return;
+        }
+        order->sort(*node.policy, scratch);
+        for (const RibEntry& entry : scratch.sorted) fn(entry.prefix, *entry.ann);
+    }
+
+    std::vector<const ASNode*> routedNodes(const ASGraph& graph, bool by_asn, unsigned threads) {
+        std::vector<const ASNode*> routed;
+        routed.reserve(graph.getNodeCount());
+        for (const auto& pair : graph.getNodes()) {
+            if (pair.second.policy && pair.second.policy->getLocalRIBSize() > 0) {
+                routed.push_back(&pair.second);
+            }
+        }
+        if (by_asn) {
+            parallelSort(routed, threads,
+                         [](const ASNode* a, const ASNode* b) { return a->asn < b->asn; });
+        }
+        return routed;
+    }
+
+    inline bool testBit(const std::vector<uint64_t>& bits, size_t index) {
+        return (bits[index >> 6] >> (index & 63)) & 1;
+    }
+
+    inline void setBit(std::vector<uint64_t>& bits, size_t index) {
+        bits[index >> 6] |= uint64_t(1) << (index & 63);
+    }
+
+    // RibFilter compiled against the graph's seeds
+    class CompiledFilter {
+    private:
+        const RibFilter& filter;
+        bool by_prefix = false;                   // Some rows are excluded by prefix
+        std::unique_ptr<PrefixOrder> prefix_ids;
+        std::vector<Prefix> selected_prefixes;    // Candidate prefixes, in prefix order
+        std::vector<uint64_t> prefix_bits;        // By prefix id
+        std::vector<ASN> seed_origins;            // Sorted; index = origin id
+        std::vector<uint64_t> origin_bits;        // By origin id
+
+        bool acceptsRoute(const Announcement& ann) const {
+            if (filter.rov_invalid_only && !ann.rov_invalid) return false;
+            if (!filter.origins.empty()) {
+                if (ann.as_path.empty()) return false;
+                auto it = std::lower_bound(seed_origins.begin(), seed_origins.end(), ann.as_path.back());
+                if (it == seed_origins.end() || *it != ann.as_path.back() ||
+                    !testBit(origin_bits, it - seed_origins.begin())) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool acceptsPrefix(const Prefix& prefix) const {
+            uint32_t id;
+            return prefix_ids->findId(prefix, id) && testBit(prefix_bits, id);
+        }
+
+    public:
+        CompiledFilter(const ASGraph& graph, const RibFilter& rib_filter)
+            : filter(rib_filter) {
+            if (!filter.origins.empty()) {
+                for (const SeedAnnouncement& seed : graph.getSeeds()) {
+                    seed_origins.push_back(seed.origin_asn);
+                }
+                std::sort(seed_origins.begin(), seed_origins.end());
+                seed_origins.erase(std::unique(seed_origins.begin(), seed_origins.end()), seed_origins.end());
+
+                origin_bits.assign(seed_origins.size() / 64 + 1, 0);
+                for (ASN asn : filter.origins) {
+                    auto it = std::lower_bound(seed_origins.begin(), seed_origins.end(), asn);
+                    if (it != seed_origins.end() && *it == asn) {
+                        setBit(origin_bits, it - seed_origins.begin());
+                    }
+                }
+            }
+
+            // Every route of a prefix comes from that prefix's seeds, so the origin
+            // and ROV filters also narrow the candidate prefixes
+            by_prefix = !filter.prefixes.empty() || !filter.origins.empty() || filter.rov_invalid_only;
+            if (!by_prefix) return;
+
+            prefix_ids.reset(new PrefixOrder(graph));
+            const std::vector<Prefix>& all = prefix_ids->getPrefixes();
+            size_t words = all.size() / 64 + 1;
+            uint32_t id;
+
+            prefix_bits.assign(words, filter.prefixes.empty() ? ~uint64_t(0) : 0);
+            for (const Prefix& prefix : filter.prefixes) {
+                if (prefix_ids->findId(prefix, id)) setBit(prefix_bits, id);
+            }
+
+            if (!filter.origins.empty() || filter.rov_invalid_only) {
+                std::vector<uint64_t> seeded(words, 0);
+                for (const SeedAnnouncement& seed : graph.getSeeds()) {
+                    if (filter.rov_invalid_only && !seed.rov_invalid) continue;
+                    if (!filter.origins.empty()) {
+                        auto it = std::lower_bound(seed_origins.begin(), seed_origins.end(), seed.origin_asn);
+                        if (!testBit(origin_bits, it - seed_origins.begin())) continue;
+                    }
+                    if (prefix_ids->findId(Prefix::parse(seed.prefix), id)) setBit(seeded, id);
+                }
+                for (size_t w = 0; w < words; w++) {
+                    prefix_bits[w] &= seeded[w];
+                }
+            }
+
+            for (size_t i = 0; i < all.size(); i++) {
+                if (testBit(prefix_bits, i)) selected_prefixes.push_back(all[i]);
+            }
+        }
+
+        // Routed ASes to export (by ASN when by_asn); a selected AS list is
+        // resolved directly instead of scanning the graph
+        std::vector<const ASNode*> nodes(const ASGraph& graph, bool by_asn, unsigned threads) const {
+            if (filter.asns.empty()) {
+                return routedNodes(graph, by_asn, threads);
+            }
+
+            std::vector<ASN> asns = filter.asns;
+            std::sort(asns.begin(), asns.end());
+            asns.erase(std::unique(asns.begin(), asns.end()), asns.end());
+
+            std::vector<const ASNode*> selected;
+            for (ASN asn : asns) {
+                const ASNode* node = graph.getNode(asn);
+                if (node && node->policy && node->policy->getLocalRIBSize() > 0) {
+                    selected.push_back(node);
+                }
+            }
+            return selected;
+        }
+
+        // forEachEntry restricted to selected rows
+        // With fewer candidate prefixes than RIB entries, the candidates are looked
+        // up instead of walking the RIB; they come out in prefix order either way.
+        template <typename Fn>
+        void forEach(const ASNode& node, const PrefixOrder* order, SortScratch& scratch, Fn fn) const {
+            if (!filter.active()) {
+                forEachEntry(node, order, scratch, fn);
+                return;
+            }
+
+            if (by_prefix && selected_prefixes.size() < node.policy->getLocalRIBSize()) {
+                for (const Prefix& prefix : selected_prefixes) {
+                    const Announcement* ann = node.policy->getAnnouncement(prefix);
+                    if (ann && acceptsRoute(*ann)) fn(prefix, *ann);
+                }
+                return;
+            }
+
+            forEachEntry(node, order, scratch, [&](const Prefix& prefix, const Announcement& ann) {
+                if (by_prefix && !acceptsPrefix(prefix)) return;
+                if (acceptsRoute(ann)) fn(prefix, ann);
+            });
+        }
+    };
+
+    // Stable across platforms and library versions, unlike std::hash
+    uint64_t prefixShardHash(const Prefix& prefix) {
+        if (prefix.is_ipv6) {
+            return mix64(prefix.v6.high ^ mix64(prefix.v6.low + prefix.v6.prefix_len));
+        }
+        return mix64((static_cast<uint64_t>(prefix.v4.address) << 8) | prefix.v4.prefix_len);
+    }
+
+    // One shard file: text -> optional bzip2 -> OutputWriter, hashing the file bytes on the way
+    class ShardSink {
+    private:
+        OutputWriter writer;
+        ContentHasher hasher;
+        bz_stream strm;
+        bool compress = false;
+        std::vector<char> compressed;
+        uint64_t bytes = 0;
+
+        bool emit(const char* data, size_t length) {
+            hasher.update(data, length);
+            bytes += length;
+            return writer.write(data, length);
+        }
+
+        // BZ_RUN: until all input is consumed; BZ_FINISH: until the stream end
+        bool pump(int action) {
+            while (true) {
+                strm.next_out = compressed.data();
+                strm.avail_out = static_cast<unsigned>(compressed.size());
+                int ret = BZ2_bzCompress(&strm, action);
+
+                size_t produced = compressed.size() - strm.avail_out;
+                if (produced > 0 && !emit(compressed.data(), produced)) {
+                    return false;
+                }
+
+                if (action == BZ_RUN) {
+                    if (ret != BZ_RUN_OK) return false;
+                    if (strm.avail_in == 0) return true;
+                } else {
+                    if (ret == BZ_STREAM_END) return true;
+                    if (ret != BZ_FINISH_OK) return false;
+                }
+            }
+        }
+
+    public:
+        ~ShardSink() {
+            if (compress) BZ2_bzCompressEnd(&strm);
+        }
+
+        bool open(const std::string& path, OutputWriterOptions options, bool use_bzip2) {
+            options.buffer_size = SHARD_BUFFER_BYTES;
+            if (!writer.open(path, options)) {
+                return false;
+            }
+
+            if (use_bzip2) {
+                std::memset(&strm, 0, sizeof(strm));
+                if (BZ2_bzCompressInit(&strm, 9, 0, 0) != BZ_OK) {
+                    std::cerr << "Error: Cannot initialize bzip2 for " << path << std::endl;
+                    return false;
+                }
+                compress = true;
+                compressed.resize(SHARD_BUFFER_BYTES);
+            }
+            return true;
+        }
+
+        bool write(std::string& text) {
+            if (!compress) {
+                return emit(text.data(), text.size());
+            }
+            strm.next_in = &text[0];
+            strm.avail_in = static_cast<unsigned>(text.size());
+            return pump(BZ_RUN);
+        }
+
+        bool close(RibShardInfo& info) {
+            bool ok = true;
+            if (compress) {
+                strm.next_in = nullptr;
+                strm.avail_in = 0;
+                ok = pump(BZ_FINISH);
+            }
+            ok = writer.close() && ok;
+            info.bytes = bytes;
+            info.checksum = hasher.digest().toHex();
+            return ok;
+        }
+    };
+
+    std::string shardFileName(const std::string& stem, const std::string& extension,
+                              unsigned index, unsigned count, bool compressed) {
+        char number[32];
+        std::snprintf(number, sizeof(number), "-%05u-of-%05u", index, count);
+        return stem + number + extension + (compressed ? ".bz2" : "");
+    }
+
+    std::string jsonString(const std::string& text) {
+        std::string out = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    bool writeShardManifest(const std::string& path, const RibExportOptions& options,
+                            const std::vector<RibShardInfo>& shards) {
+        std::string tmp_path = path + ".tmp";
+        std::ofstream out(tmp_path);
+        if (!out.is_open()) {
+            std::cerr << "Error: Cannot open file " << tmp_path << " for writing" << std::endl;
+            return false;
+        }
+
+        uint64_t total_rows = 0;
+        for (const RibShardInfo& shard : shards) {
+            total_rows += shard.rows;
+        }
+
+        bool by_asn = options.shard_key == ShardKey::ASN_RANGE;
+        out << "{\n"
+            << "  \"format\": \"csv_tuples\",\n"
+            << "  \"columns\": [\"asn\", \"prefix\", \"as_path\"],\n"
+            << "  \"shard_by\": \"" << (by_asn ? "asn_range" : "prefix_hash") << "\",\n"
+            << "  \"compression\": \"" << (options.compress_shards ? "bzip2" : "none") << "\",\n"
+            << "  \"checksum\": \"content_hash_128\",\n"
+            << "  \"total_rows\": " << total_rows << ",\n"
+            << "  \"shards\": [\n";
+
+        for (size_t i = 0; i < shards.size(); i++) {
+            const RibShardInfo& shard = shards[i];
+            out << "    {\"file\": " << jsonString(shard.file)
+                << ", \"rows\": " << shard.rows
+                << ", \"bytes\": " << shard.bytes
+                << ", \"checksum\": \"" << shard.checksum << "\"";
+            if (by_asn) {
+                out << ", \"first_asn\": " << shard.first_asn << ", \"last_asn\": " << shard.last_asn;
+            }
+            out << "}" << (i + 1 < shards.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        out.close();
+
+        std::error_code ec;
+        if (!out || (fs::rename(tmp_path, path, ec), ec)) {
+            std::cerr << "Error: Cannot write manifest " << path << std::endl;
+            fs::remove(tmp_path, ec);
+            return false;
+        }
+        return true;
+    }
+}
+
+bool readAsnList(const std::string& filename, std::vector<ASN>& asns) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open ASN list " << filename << std::endl;
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.empty() || line[0] == '#') continue;
+
+        ASN asn = 0;
+        if (!parseUnsigned(line.c_str(), asn) || asn == 0) {
+            std::cerr << "Warning: Skipping invalid ASN '" << line << "' in " << filename << std::endl;
+            continue;
+        }
+        asns.push_back(asn);
+    }
+    return true;
+}
+
+bool readPrefixList(const std::string& filename, std::vector<Prefix>& prefixes) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open prefix list " << filename << std::endl;
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.empty() || line[0] == '#') continue;
+
+        size_t slash = line.find('/');
+        if (slash == std::string::npos || slash + 1 == line.size() ||
+            line.find_first_not_of("0123456789", slash + 1) != std::string::npos) {
+            std::cerr << "Warning: Skipping invalid prefix '" << line << "' in " << filename << std::endl;
+            continue;
+        }
+        prefixes.push_back(Prefix::parse(line));
+    }
+    return true;
+}
+
+bool prefixLess(const Prefix& a, const Prefix& b) {
+    if (a.is_ipv6 != b.is_ipv6) return !a.is_ipv6;
+    if (a.is_ipv6) {
+        if (a.v6.high != b.v6.high) return a.v6.high < b.v6.high;
+        if (a.v6.low != b.v6.low) return a.v6.low < b.v6.low;
+        return a.v6.prefix_len < b.v6.prefix_len;
+    }
+    if (a.v4.address != b.v4.address) return a.v4.address < b.v4.address;
+    return a.v4.prefix_len < b.v4.prefix_len;
+}
+
+void appendRibRow(std::string& out, ASN asn, const std::string& prefix, const Announcement& ann) {
+    appendNumber(out, asn);
+    out += ',';
+    out += prefix;
+    out += ",\"(";
+
+    for (size_t i = 0; i < ann.as_path.size(); i++) {
+        if (i > 0) out += ", ";
+        appendNumber(out, ann.as_path[i]);
+    }
+
+    // Trailing comma for single-element paths (Python tuple syntax)
+    if (ann.as_path.size() == 1) {
+        out += ',';
+    }
+
+    out += ")\"\n";
+}
+
+bool exportRibsCsv(const ASGraph& graph, const std::string& filename,
+                   const RibExportOptions& options, size_t* rows) {
+    OutputWriter writer;
+    if (!writer.open(filename, options.writer)) {
+        return false;
+    }
+
+    unsigned threads = options.threads == 0 ? defaultThreadCount() : options.threads;
+    CompiledFilter filter(graph, options.filter);
+    std::vector<const ASNode*> routed = filter.nodes(graph, options.sorted, threads);
+
+    std::unique_ptr<PrefixOrder> order;
+    if (options.sorted) order.reset(new PrefixOrder(graph));
+
+    size_t block_count = (routed.size() + BLOCK_NODES - 1) / BLOCK_NODES;
+    size_t batch_size = threads * 2;  // Keep every worker busy without holding the whole output
+
+    std::vector<std::string> blocks(batch_size);
+    std::vector<size_t> block_rows(batch_size);
+    std::vector<PrefixCache> caches(threads);
+    std::vector<SortScratch> scratch(threads);
+
+    writer.write("asn,prefix,as_path\n");
+
+    size_t count = 0;
+    for (size_t first = 0; first < block_count; first += batch_size) {
+        size_t batch = std::min(batch_size, block_count - first);
+
+        parallelFor(batch, threads, [&](size_t begin, size_t end, unsigned worker) {
+            for (size_t b = begin; b < end; b++) {
+                std::string& out = blocks[b];
+                out.clear();
+                size_t n = 0;
+
+                size_t node_begin = (first + b) * BLOCK_NODES;
+                size_t node_end = std::min(routed.size(), node_begin + BLOCK_NODES);
+                for (size_t i = node_begin; i < node_end; i++) {
+                    const ASNode& node = *routed[i];
+                    filter.forEach(node, order.get(), scratch[worker], [&](const Prefix& prefix, const Announcement& ann) {
+                        appendRibRow(out, node.asn, prefixText(caches[worker], prefix), ann);
+                        n++;
+                    });
+                }
+                block_rows[b] = n;
+            }
+        }, 1);
+
+        for (size_t b = 0; b < batch; b++) {
+            writer.write(blocks[b]);
+            count += block_rows[b];
+        }
+    }
+
+    std::string backend = writer.getBackendName();
+    if (!writer.close()) {
+        std::cerr << "Error: Failed to write " << filename << std::endl;
+        return false;
+    }
+
+    std::cout << "Exported " << count << " announcements to " << filename
+              << " (" << backend << ")" << std::endl;
+    if (rows) *rows = count;
+    return true;
+}
+
+std::string shardManifestPath(const std::string& filename) {
+    fs::path path(filename);
+    return (path.parent_path() / (path.stem().string() + ".manifest.json")).string();
+}
+
+bool exportRibShards(const ASGraph& graph, const std::string& filename,
+                     const RibExportOptions& options, std::vector<RibShardInfo>* shards_out) {
+    unsigned shard_count = std::max(1u, options.shards);
+    bool by_asn = options.shard_key == ShardKey::ASN_RANGE;
+
+    unsigned threads = options.threads == 0 ? defaultThreadCount() : options.threads;
+
+    // Routed ASes in ASN order: ASN ranges are contiguous runs, and both modes
+    // produce the same shard contents on every run
+    CompiledFilter filter(graph, options.filter);
+    std::vector<const ASNode*> routed = filter.nodes(graph, true, threads);
+
+    std::unique_ptr<PrefixOrder> order;
+    if (options.sorted) order.reset(new PrefixOrder(graph));
+
+    // ASN_RANGE: cut where the running row count crosses i/N of the total
+    std::vector<size_t> bounds(shard_count + 1, routed.size());
+    bounds[0] = 0;
+    if (by_asn) {
+        uint64_t total = 0;
+        for (const ASNode* node : routed) {
+            total += node->policy->getLocalRIBSize();
+        }
+
+        uint64_t running = 0;
+        unsigned next = 1;
+        for (size_t i = 0; i < routed.size() && next < shard_count; i++) {
+            while (next < shard_count && running >= total * next / shard_count) {
+                bounds[next++] = i;
+            }
+            running += routed[i]->policy->getLocalRIBSize();
+        }
+    }
+
+    fs::path path(filename);
+    std::string extension = path.has_extension() ? path.extension().string() : ".csv";
+    std::string stem = path.stem().string();
+
+    std::vector<RibShardInfo> shards(shard_count);
+    std::vector<char> shard_ok(shard_count, 0);
+
+    // One thread per shard, bounded by options.threads
+    threads = std::min(shard_count, threads);
+
+    parallelFor(shard_count, threads, [&](size_t begin, size_t end, unsigned) {
+        PrefixCache cache;
+        SortScratch scratch;
+        std::string text;
+
+        for (size_t s = begin; s < end; s++) {
+            RibShardInfo& info = shards[s];
+            info.file = shardFileName(stem, extension, static_cast<unsigned>(s), shard_count,
+                                      options.compress_shards);
+
+            ShardSink sink;
+            if (!sink.open((path.parent_path() / info.file).string(), options.writer,
+                           options.compress_shards)) {
+                continue;
+            }
+
+            bool ok = true;
+            text = "asn,prefix,as_path\n";
+
+            size_t node_begin = by_asn ? bounds[s] : 0;
+            size_t node_end = by_asn ? bounds[s + 1] : routed.size();
+            for (size_t i = node_begin; i < node_end && ok; i++) {
+                const ASNode& node = *routed[i];
+                bool any = false;
+
+                filter.forEach(node, order.get(), scratch, [&](const Prefix& prefix, const Announcement& ann) {
+                    if (!by_asn && prefixShardHash(prefix) % shard_count != s) {
+                        return;
+                    }
+                    appendRibRow(text, node.asn, prefixText(cache, prefix), ann);
+                    info.rows++;
+                    any = true;
+                });
+
+                if (any && by_asn) {
+                    if (info.first_asn == 0) info.first_asn = node.asn;
+                    info.last_asn = node.asn;
+                }
+                if (text.size() >= SHARD_FLUSH_BYTES) {
+                    ok = sink.write(text);
+                    text.clear();
+                }
+            }
+
+            if (ok && !text.empty()) {
+                ok = sink.write(text);
+            }
+            shard_ok[s] = sink.close(info) && ok;
+        }
+    }, 1);
+
+    uint64_t rows = 0;
+    for (unsigned s = 0; s < shard_count; s++) {
+        if (!shard_ok[s]) {
+            std::cerr << "Error: Failed to write shard " << shards[s].file << std::endl;
+            return false;
+        }
+        rows += shards[s].rows;
+    }
+
+    std::string manifest = shardManifestPath(filename);
+    if (!writeShardManifest(manifest, options, shards)) {
+        return false;
+    }
+
+    std::cout << "Exported " << rows << " announcements to " << shard_count << " shards ("
+              << manifest << ")" << std::endl;
+    if (shards_out) *shards_out = std::move(shards);
+    return true;
+}
+
+bool buildRouteState(const ASGraph& graph, RouteState& state, unsigned threads) {
+    if (threads == 0) threads = defaultThreadCount();
+    std::vector<const ASNode*> routed = routedNodes(graph, true, threads);
+    PrefixOrder order(graph);
+
+    state.clear();
+    state.prefixes = order.getPrefixes();
+    for (const Prefix& prefix : state.prefixes) {
+        state.prefix_text.push_back(prefix.toString());
+    }
+
+    // Blocks of ASes in ASN order, concatenated afterwards
+    size_t block_count = (routed.size() + BLOCK_NODES - 1) / BLOCK_NODES;
+    std::vector<std::vector<RouteState::Entry>> blocks(block_count);
+    std::vector<char> complete(block_count, 1);
+
+    parallelFor(block_count, threads, [&](size_t begin, size_t end, unsigned) {
+        SortScratch scratch;
+        for (size_t b = begin; b < end; b++) {
+            size_t node_end = std::min(routed.size(), (b + 1) * BLOCK_NODES);
+            for (size_t i = b * BLOCK_NODES; i < node_end; i++) {
+                const ASNode& node = *routed[i];
+                if (!order.sort(*node.policy, scratch)) {
+                    complete[b] = 0;
+                    continue;
+                }
+                for (const auto& item : scratch.keyed) {
+                    blocks[b].push_back({node.asn, item.first, routeKey(*item.second)});
+                }
+            }
+        }
+    }, 1);
+
+    if (std::find(complete.begin(), complete.end(), 0) != complete.end()) {
+        std::cerr << "Error: Route state needs every RIB prefix to be a seeded prefix" << std::endl;
+        return false;
+    }
+
+    size_t total = 0;
+    for (const auto& block : blocks) total += block.size();
+    state.entries.reserve(total);
+    for (const auto& block : blocks) {
+        state.entries.insert(state.entries.end(), block.begin(), block.end());
+    }
+    return true;
+}
+
+bool exportRibsDelta(const ASGraph& graph, const std::string& filename, const RouteState& baseline,
+                     const RibExportOptions& options, size_t* rows) {
+    if (options.filter.active()) {
+        std::cerr << "Error: Export filters are not supported for delta output" << std::endl;
+        return false;
+    }
+
+    OutputWriter writer;
+    if (!writer.open(filename, options.writer)) {
+        return false;
+    }
+
+    unsigned threads = options.threads == 0 ? defaultThreadCount() : options.threads;
+    std::vector<const ASNode*> routed = routedNodes(graph, true, threads);
+    PrefixOrder order(graph);
+
+    const std::vector<RouteState::Entry>& base = baseline.entries;
+    auto base_lower_bound = [&](uint64_t asn) {
+        return static_cast<size_t>(std::lower_bound(base.begin(), base.end(), asn,
+            [](const RouteState::Entry& e, uint64_t value) { return e.asn < value; }) - base.begin());
+    };
+
+    size_t block_count = std::max<size_t>(1, (routed.size() + BLOCK_NODES - 1) / BLOCK_NODES);
+    size_t batch_size = threads * 2;
+    std::vector<std::string> blocks(batch_size);
+    std::vector<size_t> block_changed(batch_size);
+    std::vector<size_t> block_withdrawn(batch_size);
+    std::vector<PrefixCache> caches(threads);
+    std::vector<SortScratch> scratch(threads);
+
+    writer.write("asn,prefix,as_path\n");
+
+    size_t changed = 0;
+    size_t withdrawn = 0;
+    for (size_t first = 0; first < block_count; first += batch_size) {
+        size_t batch = std::min(batch_size, block_count - first);
+
+        parallelFor(batch, threads, [&](size_t begin, size_t end, unsigned worker) {
+            for (size_t b = begin; b < end; b++) {
+                std::string& out = blocks[b];
+                out.clear();
+                size_t n_changed = 0;
+                size_t n_withdrawn = 0;
+
+                // This block owns the baseline routes of ASNs from its first AS up
+                // to the next block's first AS (open-ended at both extremes)
+                size_t node_begin = (first + b) * BLOCK_NODES;
+                size_t node_end = std::min(routed.size(), node_begin + BLOCK_NODES);
+                uint64_t asn_lo = (first + b == 0) ? 0 : routed[node_begin]->asn;
+                uint64_t asn_hi = node_end < routed.size() ? routed[node_end]->asn : UINT64_MAX;
+                size_t bi = base_lower_bound(asn_lo);
+                size_t be = asn_hi == UINT64_MAX ? base.size() : base_lower_bound(asn_hi);
+
+                auto withdraw = [&](const RouteState::Entry& entry) {
+                    appendNumber(out, entry.asn);
+                    out += ',';
+                    out += baseline.prefix_text[entry.prefix];
+                    out += ",\n";
+                    n_withdrawn++;
+                };
+
+                for (size_t i = node_begin; i < node_end; i++) {
+                    const ASNode& node = *routed[i];
+                    while (bi < be && base[bi].asn < node.asn) withdraw(base[bi++]);
+
+                    forEachEntry(node, &order, scratch[worker], [&](const Prefix& prefix, const Announcement& ann) {
+                        while (bi < be && base[bi].asn == node.asn &&
+                               prefixLess(baseline.prefixes[base[bi].prefix], prefix)) {
+                            withdraw(base[bi++]);
+                        }
+
+                        if (bi < be && base[bi].asn == node.asn &&
+                            baseline.prefixes[base[bi].prefix] == prefix) {
+                            bool same = base[bi].route_key == routeKey(ann);
+                            bi++;
+                            if (same) return;
+                        }
+
+                        appendRibRow(out, node.asn, prefixText(caches[worker], prefix), ann);
+                        n_changed++;
+                    });
+
+                    while (bi < be && base[bi].asn == node.asn) withdraw(base[bi++]);
+                }
+                while (bi < be) withdraw(base[bi++]);
+
+                block_changed[b] = n_changed;
+                block_withdrawn[b] = n_withdrawn;
+            }
+        }, 1);
+
+        for (size_t b = 0; b < batch; b++) {
+            writer.write(blocks[b]);
+            changed += block_changed[b];
+            withdrawn += block_withdrawn[b];
+        }
+    }
+
+    if (!writer.close()) {
+        std::cerr << "Error: Failed to write " << filename << std::endl;
+        return false;
+    }
+
+    std::cout << "Exported " << changed << " new or changed and " << withdrawn
+              << " withdrawn routes to " << filename << " (delta against "
+              << base.size() << " baseline routes)" << std::endl;
+    if (rows) *rows = changed + withdrawn;
+    return true;
+}
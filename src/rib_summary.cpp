@@ -0,0 +1,313 @@
+#include "rib_summary.h"
+#include "bgp_policy.h"
+#include "parallel.h"
+#include "rib_export.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+    constexpr size_t BINS = RibSummary::MAX_PATH_BIN + 1;
+
+    // Consecutive routes count into different lanes, so increments of the same
+    // bin do not wait on each other; lanes are summed once at the end
+    constexpr size_t LANES = 4;
+
+    // Dense ids of the seeded prefixes (in prefix order) and, per prefix, a
+    // slot for each of its seed origins, so that routes count into flat arrays
+    // instead of a hash map per prefix. Routes whose prefix or origin was not
+    // seeded take the hashed fallback.
+    class SeedIds {
+    private:
+        std::unordered_map<IPv4Prefix, uint32_t> ids4;
+        std::unordered_map<IPv6Prefix, uint32_t> ids6;
+
+        const std::unordered_map<IPv4Prefix, uint32_t>& ids(const IPv4Prefix*) const { return ids4; }
+        const std::unordered_map<IPv6Prefix, uint32_t>& ids(const IPv6Prefix*) const { return ids6; }
+
+    public:
+        std::vector<Prefix> prefixes;        // By id
+        std::vector<uint32_t> origin_begin;  // Slots of prefix id: origin_begin[id] .. origin_begin[id + 1]
+        std::vector<ASN> origins;            // By slot
+
+        explicit SeedIds(const ASGraph& graph) {
+            std::vector<std::pair<Prefix, ASN>> seeds;
+            seeds.reserve(graph.getSeeds().size());
+            for (const SeedAnnouncement& seed : graph.getSeeds()) {
+                seeds.push_back({Prefix::parse(seed.prefix), seed.origin_asn});
+            }
+            std::sort(seeds.begin(), seeds.end(),
+                      [](const std::pair<Prefix, ASN>& a, const std::pair<Prefix, ASN>& b) {
+                          if (prefixLess(a.first, b.first)) return true;
+                          if (prefixLess(b.first, a.first)) return false;
+                          return a.second < b.second;
+                      });
+            seeds.erase(std::unique(seeds.begin(), seeds.end()), seeds.end());
+
+            for (const auto& seed : seeds) {
+                if (prefixes.empty() || !(prefixes.back() == seed.first)) {
+                    uint32_t id = static_cast<uint32_t>(prefixes.size());
+                    if (seed.first.is_ipv6) {
+                        ids6.emplace(seed.first.v6, id);
+                    } else {
+                        ids4.emplace(seed.first.v4, id);
+                    }
+                    prefixes.push_back(seed.first);
+                    origin_begin.push_back(static_cast<uint32_t>(origins.size()));
+                }
+                origins.push_back(seed.second);
+            }
+            origin_begin.push_back(static_cast<uint32_t>(origins.size()));
+        }
+
+        template <typename P>
+        bool findId(const P& prefix, uint32_t& id) const {
+            const auto& family_ids = ids(static_cast<const P*>(nullptr));
+            auto it = family_ids.find(prefix);
+            if (it == family_ids.end()) return false;
+            id = it->second;
+            return true;
+        }
+
+        bool findSlot(uint32_t id, ASN origin, uint32_t& slot) const {
+            for (slot = origin_begin[id]; slot < origin_begin[id + 1]; slot++) {
+                if (origins[slot] == origin) return true;
+            }
+            return false;
+        }
+    };
+
+    // Routes outside the seed ids
+    struct PrefixCounters {
+        uint64_t reach = 0;
+        uint64_t path_length_total = 0;
+        std::unordered_map<ASN, uint64_t> origins;
+    };
+
+    struct WorkerCounters {
+        uint64_t histogram[LANES][BINS] = {};
+        uint64_t relationship_counts[4] = {};
+        uint64_t routes = 0;
+        uint64_t routed_ases = 0;
+        uint64_t rov_invalid_routes = 0;
+        uint64_t path_length_total = 0;
+
+        std::vector<uint64_t> reach;              // By prefix id
+        std::vector<uint64_t> prefix_path_total;  // By prefix id
+        std::vector<uint64_t> origin_routes;      // By origin slot
+        std::unordered_map<Prefix, PrefixCounters> other;
+    };
+
+    const char* const RELATIONSHIP_NAMES[4] = {"origin", "customer", "peer", "provider"};
+
+    template <typename P>
+    void countRoutes(const BasicLocalRIB<P>& rib, const SeedIds& seed_ids, WorkerCounters& counters,
+                     size_t& lane) {
+        for (const auto& entry : rib) {
+            const Announcement& ann = entry.second;
+            size_t length = ann.as_path.size();
+
+            counters.histogram[lane][std::min(length, RibSummary::MAX_PATH_BIN)]++;
+            lane = (lane + 1) % LANES;
+            counters.relationship_counts[static_cast<size_t>(ann.received_from) & 3]++;
+            counters.path_length_total += length;
+            if (ann.rov_invalid) counters.rov_invalid_routes++;
+
+            uint32_t id, slot;
+            if (!ann.as_path.empty() && seed_ids.findId(entry.first, id) &&
+                seed_ids.findSlot(id, ann.as_path.back(), slot)) {
+                counters.reach[id]++;
+                counters.prefix_path_total[id] += length;
+                counters.origin_routes[slot]++;
+                continue;
+            }
+
+            PrefixCounters& prefix = counters.other[Prefix(entry.first)];
+            prefix.reach++;
+            prefix.path_length_total += length;
+            if (!ann.as_path.empty()) prefix.origins[ann.as_path.back()]++;
+        }
+    }
+}
+
+RibSummary summarizeRibs(const ASGraph& graph, unsigned threads) {
+    if (threads == 0) threads = defaultThreadCount();
+
+    std::vector<const ASNode*> nodes;
+    nodes.reserve(graph.getNodeCount());
+    for (const auto& pair : graph.getNodes()) {
+        if (pair.second.policy) nodes.push_back(&pair.second);
+    }
+
+    SeedIds seed_ids(graph);
+    std::vector<WorkerCounters> workers(threads);
+    for (WorkerCounters& counters : workers) {
+        counters.reach.assign(seed_ids.prefixes.size(), 0);
+        counters.prefix_path_total.assign(seed_ids.prefixes.size(), 0);
+        counters.origin_routes.assign(seed_ids.origins.size(), 0);
+    }
+
+    parallelFor(nodes.size(), threads, [&](size_t begin, size_t end, unsigned worker) {
+        WorkerCounters& counters = workers[worker];
+        size_t lane = 0;
+
+        for (size_t i = begin; i < end; i++) {
+            const BGPPolicy& policy = *nodes[i]->policy;
+            if (policy.getLocalRIBSize() == 0) continue;
+            counters.routed_ases++;
+            countRoutes(policy.getLocalRIB<IPv4Prefix>(), seed_ids, counters, lane);
+            countRoutes(policy.getLocalRIB<IPv6Prefix>(), seed_ids, counters, lane);
+            counters.routes += policy.getLocalRIBSize();
+        }
+    }, 1024);
+
+    // Merge worker counters
+    RibSummary summary;
+    summary.ases = graph.getNodeCount();
+    summary.path_length_histogram.assign(BINS, 0);
+
+    std::vector<uint64_t> reach(seed_ids.prefixes.size(), 0);
+    std::vector<uint64_t> prefix_path_total(seed_ids.prefixes.size(), 0);
+    std::vector<uint64_t> origin_routes(seed_ids.origins.size(), 0);
+    std::unordered_map<Prefix, PrefixCounters> other;
+    for (WorkerCounters& counters : workers) {
+        for (size_t lane = 0; lane < LANES; lane++) {
+            for (size_t bin = 0; bin < BINS; bin++) {
+                summary.path_length_histogram[bin] += counters.histogram[lane][bin];
+            }
+        }
+        for (size_t r = 0; r < 4; r++) {
+            summary.relationship_counts[r] += counters.relationship_counts[r];
+        }
+        summary.routes += counters.routes;
+        summary.routed_ases += counters.routed_ases;
+        summary.rov_invalid_routes += counters.rov_invalid_routes;
+        summary.path_length_total += counters.path_length_total;
+
+        for (size_t id = 0; id < reach.size(); id++) {
+            reach[id] += counters.reach[id];
+            prefix_path_total[id] += counters.prefix_path_total[id];
+        }
+        for (size_t slot = 0; slot < origin_routes.size(); slot++) {
+            origin_routes[slot] += counters.origin_routes[slot];
+        }
+        for (auto& pair : counters.other) {
+            PrefixCounters& merged = other[pair.first];
+            merged.reach += pair.second.reach;
+            merged.path_length_total += pair.second.path_length_total;
+            for (const auto& origin : pair.second.origins) {
+                merged.origins[origin.first] += origin.second;
+            }
+        }
+    }
+
+    while (summary.path_length_histogram.size() > 1 && summary.path_length_histogram.back() == 0) {
+        summary.path_length_histogram.pop_back();
+    }
+
+    // Fallback routes of a seeded prefix join its counters
+    for (size_t id = 0; id < seed_ids.prefixes.size(); id++) {
+        auto it = other.find(seed_ids.prefixes[id]);
+        if (reach[id] == 0 && it == other.end()) continue;
+
+        PrefixRibSummary prefix;
+        prefix.prefix = seed_ids.prefixes[id];
+        prefix.reach = reach[id];
+        prefix.path_length_total = prefix_path_total[id];
+        for (uint32_t slot = seed_ids.origin_begin[id]; slot < seed_ids.origin_begin[id + 1]; slot++) {
+            if (origin_routes[slot] > 0) {
+                prefix.origins.push_back({seed_ids.origins[slot], origin_routes[slot]});
+            }
+        }
+        if (it != other.end()) {
+            prefix.reach += it->second.reach;
+            prefix.path_length_total += it->second.path_length_total;
+            for (const auto& origin : it->second.origins) {
+                prefix.origins.push_back(origin);
+            }
+            other.erase(it);
+        }
+        summary.prefixes.push_back(std::move(prefix));
+    }
+    for (const auto& pair : other) {
+        PrefixRibSummary prefix;
+        prefix.prefix = pair.first;
+        prefix.reach = pair.second.reach;
+        prefix.path_length_total = pair.second.path_length_total;
+        prefix.origins.assign(pair.second.origins.begin(), pair.second.origins.end());
+        summary.prefixes.push_back(std::move(prefix));
+    }
+
+    for (PrefixRibSummary& prefix : summary.prefixes) {
+        std::sort(prefix.origins.begin(), prefix.origins.end(),
+                  [](const std::pair<ASN, uint64_t>& a, const std::pair<ASN, uint64_t>& b) {
+                      return a.second != b.second ? a.second > b.second : a.first < b.first;
+                  });
+    }
+    if (!other.empty()) {
+        std::sort(summary.prefixes.begin(), summary.prefixes.end(),
+                  [](const PrefixRibSummary& a, const PrefixRibSummary& b) {
+                      return prefixLess(a.prefix, b.prefix);
+                  });
+    }
+
+    return summary;
+}
+
+bool writeRibSummaryJson(const RibSummary& summary, const std::string& filename) {
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot open file " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    auto ratio = [](uint64_t part, uint64_t whole) {
+        return whole == 0 ? 0.0 : static_cast<double>(part) / static_cast<double>(whole);
+    };
+
+    out << std::setprecision(6);
+    out << "{\n"
+        << "  \"ases\": " << summary.ases << ",\n"
+        << "  \"routed_ases\": " << summary.routed_ases << ",\n"
+        << "  \"routes\": " << summary.routes << ",\n"
+        << "  \"rov_invalid_routes\": " << summary.rov_invalid_routes << ",\n"
+        << "  \"average_path_length\": " << ratio(summary.path_length_total, summary.routes) << ",\n";
+
+    out << "  \"relationships\": {";
+    for (size_t r = 0; r < 4; r++) {
+        out << (r ? ", " : "") << "\"" << RELATIONSHIP_NAMES[r] << "\": " << summary.relationship_counts[r];
+    }
+    out << "},\n";
+
+    out << "  \"path_length_histogram\": [";
+    for (size_t i = 0; i < summary.path_length_histogram.size(); i++) {
+        out << (i ? ", " : "") << summary.path_length_histogram[i];
+    }
+    out << "],\n";
+
+    out << "  \"prefixes\": [\n";
+    for (size_t p = 0; p < summary.prefixes.size(); p++) {
+        const PrefixRibSummary& prefix = summary.prefixes[p];
+        out << "    {\"prefix\": \"" << prefix.prefix.toString() << "\""
+            << ", \"reach\": " << prefix.reach
+            << ", \"reach_share\": " << ratio(prefix.reach, summary.ases)
+            << ", \"average_path_length\": " << ratio(prefix.path_length_total, prefix.reach)
+            << ", \"origins\": [";
+        for (size_t o = 0; o < prefix.origins.size(); o++) {
+            out << (o ? ", " : "") << "{\"asn\": " << prefix.origins[o].first
+                << ", \"ases\": " << prefix.origins[o].second
+                << ", \"share\": " << ratio(prefix.origins[o].second, prefix.reach) << "}";
+        }
+        out << "]}" << (p + 1 < summary.prefixes.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+
+    out.close();
+    if (!out) {
+        std::cerr << "Error: Failed writing " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
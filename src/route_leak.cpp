@@ -0,0 +1,250 @@
+#include "route_leak.h"
+#include "as_graph.h"
+#include "bgp_policy.h"
+#include "rib_export.h"
+#include <algorithm>
+#include <iostream>
+
+bool parseLeakPolicy(const std::string& text, LeakPolicy& policy) {
+    if (text == "providers") {
+        policy = LeakPolicy::PROVIDERS;
+    } else if (text == "peers") {
+        policy = LeakPolicy::PEERS;
+    } else if (text == "all") {
+        policy = LeakPolicy::ALL;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* leakPolicyName(LeakPolicy policy) {
+    switch (policy) {
+        case LeakPolicy::PROVIDERS: return "providers";
+        case LeakPolicy::PEERS: return "peers";
+        case LeakPolicy::ALL:
+        default: return "all";
+    }
+}
+
+namespace {
+    // Offer node sender's current route for prefix if sender exports it to node
+    template <typename P>
+    inline void pullExport(ASNode& node, const ASNode& sender, RelationshipType received_from,
+                           uint8_t leaks, const P& prefix) {
+        const auto& rib = sender.policy->getLocalRIB<P>();
+        auto it = rib.find(prefix);
+        if (it == rib.end()) return;
+
+        const Announcement& ann = it->second;
+        if (!exportsRoute(ann, received_from, leaks)) return;
+
+        // Loop prevention
+        if (ann.containsAS(node.asn)) return;
+
+        node.policy->receiveAnnouncement(prefix, ann.copy_with_new_hop(sender.asn, received_from));
+    }
+}
+
+LeakPropagator::LeakPropagator(ASGraph& target) : graph(target) {
+    for (const auto& pair : graph.getLeakers()) {
+        const ASNode* node = graph.getNode(pair.first);
+        if (node) {
+            leak_mask[node] = static_cast<uint8_t>(pair.second);
+        }
+    }
+}
+
+template <typename P, typename S>
+LeakPropagator::Effect LeakPropagator::effectOf(const ASNode& sender, const Announcement* offered,
+                                                const ASNode& receiver, RelationshipType received_from,
+                                                const P& prefix, const S& selection) const {
+    const auto& rib = receiver.policy->getLocalRIB<P>();
+    auto current = rib.find(prefix);
+    if (current != rib.end()) {
+        if (current->second.received_from == RelationshipType::ORIGIN) return Effect::NONE;
+        if (current->second.next_hop_asn == sender.asn) return Effect::RESELECT;
+    }
+
+    if (!offered || offered->containsAS(receiver.asn)) return Effect::NONE;
+    const Announcement& ann = *offered;
+    if (current == rib.end()) return Effect::OFFER;
+
+    // Every selection policy ranks the relationship first (route_selection.h)
+    if (received_from != current->second.received_from) {
+        return received_from < current->second.received_from ? Effect::OFFER : Effect::NONE;
+    }
+
+    // Compare as stored, with the receiver prepended
+    Announcement candidate = ann.copy_with_new_hop(sender.asn, received_from);
+    candidate.as_path.insert(candidate.as_path.begin(), receiver.asn);
+    return selection.key(candidate) < selection.key(current->second) ? Effect::OFFER : Effect::NONE;
+}
+
+template <typename P, typename S>
+void LeakPropagator::resolve(ASNode& node, const Work<P>& work, const S& selection,
+                             std::vector<P>& changed, LeakStats& stats) {
+    BGPPolicy& policy = *node.policy;
+    const auto& rib = policy.getLocalRIB<P>();
+
+    // Routes before the work, to detect changes: a re-selected route is
+    // withdrawn first, an offered one is only replaced by a better route
+    struct Previous {
+        P prefix;
+        bool present;
+        Announcement route;
+    };
+    std::vector<Previous> previous;
+    std::unordered_set<P> offered;
+
+    for (const P& prefix : work.reselect) {
+        auto it = rib.find(prefix);
+        if (it != rib.end() && it->second.received_from == RelationshipType::ORIGIN) continue;
+
+        previous.push_back({prefix, false, Announcement()});
+        previous.back().present = policy.withdrawRoute(prefix, &previous.back().route);
+
+        for (const auto& ref : node.customers) {
+            pullExport(node, ref.get(), RelationshipType::CUSTOMER, leaksOf(ref.get()), prefix);
+        }
+        for (const auto& ref : node.peers) {
+            pullExport(node, ref.get(), RelationshipType::PEER, leaksOf(ref.get()), prefix);
+        }
+        for (const auto& ref : node.providers) {
+            pullExport(node, ref.get(), RelationshipType::PROVIDER, leaksOf(ref.get()), prefix);
+        }
+    }
+
+    for (const Offer<P>& offer : work.offers) {
+        if (work.reselect.count(offer.prefix)) continue;
+        if (offered.insert(offer.prefix).second) {
+            auto it = rib.find(offer.prefix);
+            previous.push_back({offer.prefix, it != rib.end(), it != rib.end() ? it->second : Announcement()});
+        }
+        pullExport(node, *offer.sender, offer.received_from, leaksOf(*offer.sender), offer.prefix);
+    }
+
+    stats.evaluations += previous.size();
+    policy.processReceivedQueue<P>(node.asn, selection);
+    policy.clearReceivedQueue<P>();
+
+    for (const Previous& before : previous) {
+        auto it = rib.find(before.prefix);
+        const Announcement* now = it == rib.end() ? nullptr : &it->second;
+
+        if (!before.present && !now) continue;
+        if (before.present && now && now->received_from == before.route.received_from &&
+            now->as_path == before.route.as_path) {
+            continue;
+        }
+        changed.push_back(before.prefix);
+        stats.updates++;
+    }
+}
+
+template <typename P, typename S>
+LeakStats LeakPropagator::propagate(const S& selection, size_t round_limit) {
+    LeakStats stats;
+
+    // Work of each AS; an AS with work is queued
+    std::unordered_map<ASNode*, Work<P>> pending;
+    std::vector<ASNode*> round;
+    std::vector<ASNode*> next_round;
+
+    // Queue the receivers whose choice sender's route for prefix may change
+    auto offer = [&](const ASNode& sender, const NeighborList& receivers,
+                     RelationshipType received_from, const P& prefix) {
+        if (receivers.empty()) return;
+
+        const auto& sender_rib = sender.policy->getLocalRIB<P>();
+        auto it = sender_rib.find(prefix);
+        const Announcement* offered = nullptr;
+        if (it != sender_rib.end() && exportsRoute(it->second, received_from, leaksOf(sender))) {
+            offered = &it->second;
+        }
+
+        for (auto& receiver_ref : receivers) {
+            ASNode& receiver = receiver_ref.get();
+            if (!receiver.policy) continue;
+
+            Effect effect = effectOf(sender, offered, receiver, received_from, prefix, selection);
+            if (effect == Effect::NONE) continue;
+
+            Work<P>& work = pending[&receiver];
+            if (work.empty()) next_round.push_back(&receiver);
+            if (effect == Effect::RESELECT) {
+                work.reselect.insert(prefix);
+            } else {
+                work.offers.push_back({prefix, &sender, received_from});
+            }
+        }
+    };
+
+    // Prefixes are offered in a fixed order, not RIB order, so that the queue
+    // order (and with it the result, should leaks allow several stable states)
+    // does not depend on the engine that produced the RIBs
+    auto byPrefix = [](const P& a, const P& b) { return prefixLess(Prefix(a), Prefix(b)); };
+    std::vector<P> changed;
+
+    // What the three-phase run did not send: leakers' provider and peer routes
+    // to their providers and peers
+    for (const auto& pair : graph.getLeakers()) {
+        ASNode* leaker = graph.getNode(pair.first);
+        if (!leaker || !leaker->policy) continue;
+
+        changed.clear();
+        for (const auto& rib_pair : leaker->policy->getLocalRIB<P>()) {
+            if (!exportsRoute(rib_pair.second, RelationshipType::CUSTOMER, 0)) {  // Not sent yet
+                changed.push_back(rib_pair.first);
+            }
+        }
+        std::sort(changed.begin(), changed.end(), byPrefix);
+        for (const P& prefix : changed) {
+            offer(*leaker, leaker->providers, RelationshipType::CUSTOMER, prefix);
+            offer(*leaker, leaker->peers, RelationshipType::PEER, prefix);
+        }
+    }
+
+    // The first round in ASN order, later ones in queueing order
+    std::sort(next_round.begin(), next_round.end(),
+              [](const ASNode* a, const ASNode* b) { return a->asn < b->asn; });
+
+    while (!next_round.empty()) {
+        if (stats.rounds == round_limit) {
+            stats.converged = false;
+            break;
+        }
+        stats.rounds++;
+        round.swap(next_round);
+        next_round.clear();
+
+        for (ASNode* node : round) {
+            auto pending_it = pending.find(node);
+            Work<P> work = std::move(pending_it->second);
+            pending.erase(pending_it);
+
+            changed.clear();
+            resolve<P>(*node, work, selection, changed, stats);
+            std::sort(changed.begin(), changed.end(), byPrefix);
+
+            for (const P& prefix : changed) {
+                offer(*node, node->customers, RelationshipType::PROVIDER, prefix);
+                offer(*node, node->providers, RelationshipType::CUSTOMER, prefix);
+                offer(*node, node->peers, RelationshipType::PEER, prefix);
+            }
+        }
+    }
+    return stats;
+}
+
+#define INSTANTIATE_PROPAGATE(P, S) \
+    template LeakStats LeakPropagator::propagate<P, S>(const S& selection, size_t round_limit);
+INSTANTIATE_PROPAGATE(IPv4Prefix, StandardSelection)
+INSTANTIATE_PROPAGATE(IPv6Prefix, StandardSelection)
+INSTANTIATE_PROPAGATE(IPv4Prefix, IgnorePathLengthSelection)
+INSTANTIATE_PROPAGATE(IPv6Prefix, IgnorePathLengthSelection)
+INSTANTIATE_PROPAGATE(IPv4Prefix, HashTieBreakSelection)
+INSTANTIATE_PROPAGATE(IPv6Prefix, HashTieBreakSelection)
+INSTANTIATE_PROPAGATE(IPv4Prefix, LowestOriginSelection)
+INSTANTIATE_PROPAGATE(IPv6Prefix, LowestOriginSelection)
+#undef INSTANTIATE_PROPAGATE
@@ -0,0 +1,193 @@
+#include "route_resolver.h"
+#include "as_graph.h"
+#include "bgp_policy.h"
+#include <vector>
+
+namespace {
+    // Best route one AS receives from one class of neighbors, as the engines
+    // pick it in processReceivedQueue()
+    template <typename S>
+    struct BestCandidate {
+        bool found = false;
+        Announcement ann;
+        typename S::Key key{};
+
+        // sent: sender's selected route, before the engines copy it to receiver
+        void consider(const ASNode& receiver, ASN sender, const Announcement& sent,
+                      RelationshipType received_from, const S& selection) {
+            // Loop prevention
+            if (sent.containsAS(receiver.asn)) return;
+
+            Announcement candidate = sent.copy_with_new_hop(sender, received_from);
+            if (!receiver.policy->admits(candidate)) return;
+
+            auto candidate_key = selection.key(candidate);
+            if (!found || candidate_key < key) {
+                ann = std::move(candidate);
+                key = candidate_key;
+                found = true;
+            }
+        }
+    };
+}
+
+template <> std::unordered_map<IPv4Prefix, RouteResolver::PrefixRoutes<IPv4Prefix>>&
+RouteResolver::routesOf<IPv4Prefix>() { return routes4; }
+template <> std::unordered_map<IPv6Prefix, RouteResolver::PrefixRoutes<IPv6Prefix>>&
+RouteResolver::routesOf<IPv6Prefix>() { return routes6; }
+
+RouteResolver::RouteResolver(const ASGraph& target) : graph(target) {
+    clear();
+}
+
+void RouteResolver::clear() {
+    routes4.clear();
+    routes6.clear();
+    computed = 0;
+    route_selection = graph.getRouteSelection();
+    selection_seed = graph.getSelectionSeed();
+
+    // Same route as ASGraph::seedAnnouncement(); a later seed at the same AS replaces it
+    for (const SeedAnnouncement& seed : graph.getSeeds()) {
+        Prefix prefix = Prefix::parse(seed.prefix);
+        Announcement ann(seed.origin_asn, RelationshipType::ORIGIN, seed.rov_invalid);
+        if (prefix.is_ipv6) {
+            routes6[prefix.v6].origins[seed.origin_asn] = ann;
+        } else {
+            routes4[prefix.v4].origins[seed.origin_asn] = ann;
+        }
+    }
+}
+
+const Announcement* RouteResolver::resolve(ASN asn, const Prefix& prefix) {
+    return withRouteSelection(route_selection, selection_seed, [&](const auto& selection) {
+        return prefix.is_ipv6 ? resolveWith(asn, prefix.v6, selection)
+                              : resolveWith(asn, prefix.v4, selection);
+    });
+}
+
+template <typename P, typename S>
+const Announcement* RouteResolver::resolveWith(ASN asn, const P& prefix, const S& selection) {
+    const ASNode* node = graph.getNode(asn);
+    auto& all = routesOf<P>();
+    auto it = all.find(prefix);
+    if (!node || it == all.end()) {
+        return nullptr;  // Unknown AS or unseeded prefix
+    }
+    PrefixRoutes<P>& state = it->second;
+
+    // Customer routes can only climb from an origin through providers that
+    // take part in routing
+    if (!state.reach_built) {
+        std::vector<const ASNode*> stack;
+        for (const auto& origin : state.origins) {
+            const ASNode* origin_node = graph.getNode(origin.first);
+            if (origin_node && state.reach.insert(origin.first).second) {
+                stack.push_back(origin_node);
+            }
+        }
+        while (!stack.empty()) {
+            const ASNode* current = stack.back();
+            stack.pop_back();
+            for (const auto& provider_ref : current->providers) {
+                const ASNode& provider = provider_ref.get();
+                if (provider.policy && state.reach.insert(provider.asn).second) {
+                    stack.push_back(&provider);
+                }
+            }
+        }
+        state.reach_built = true;
+    }
+
+    const Route& route = bestRoute(*node, state, selection);
+    return route.present ? &route.ann : nullptr;
+}
+
+template <typename P, typename S>
+const RouteResolver::Route& RouteResolver::customerRoute(const ASNode& node, PrefixRoutes<P>& state,
+                                                         const S& selection) {
+    static const Route none;
+    if (!state.reach.count(node.asn)) {
+        return none;
+    }
+
+    // Map elements keep their address while the recursion below inserts
+    auto inserted = state.customer_routes.try_emplace(node.asn);
+    Route& route = inserted.first->second;
+    if (!inserted.second) {
+        return route;
+    }
+    computed++;
+
+    auto origin = state.origins.find(node.asn);
+    if (origin != state.origins.end()) {
+        route.present = true;
+        route.ann = origin->second;
+        return route;
+    }
+
+    BestCandidate<S> best;
+    for (const auto& customer_ref : node.customers) {
+        const ASNode& customer = customer_ref.get();
+        const Route& sent = customerRoute(customer, state, selection);
+        if (sent.present) {
+            best.consider(node, customer.asn, sent.ann, RelationshipType::CUSTOMER, selection);
+        }
+    }
+
+    if (best.found) {
+        route.present = true;
+        route.ann = std::move(best.ann);
+        route.ann.as_path.insert(route.ann.as_path.begin(), node.asn);
+    }
+    return route;
+}
+
+template <typename P, typename S>
+const RouteResolver::Route& RouteResolver::bestRoute(const ASNode& node, PrefixRoutes<P>& state,
+                                                     const S& selection) {
+    auto inserted = state.routes.try_emplace(node.asn);
+    Route& route = inserted.first->second;
+    if (!inserted.second) {
+        return route;
+    }
+    computed++;
+
+    if (!node.policy) {
+        return route;
+    }
+
+    // Every selection policy ranks the relationship first (route_selection.h),
+    // so a customer route ends the search, and a peer route skips the providers
+    const Route& own = customerRoute(node, state, selection);
+    if (own.present) {
+        route = own;
+        return route;
+    }
+
+    BestCandidate<S> best;
+    for (const auto& peer_ref : node.peers) {
+        const ASNode& peer = peer_ref.get();
+        const Route& sent = customerRoute(peer, state, selection);
+        if (sent.present) {
+            best.consider(node, peer.asn, sent.ann, RelationshipType::PEER, selection);
+        }
+    }
+
+    if (!best.found) {
+        for (const auto& provider_ref : node.providers) {
+            const ASNode& provider = provider_ref.get();
+            const Route& sent = bestRoute(provider, state, selection);
+            if (sent.present) {
+                best.consider(node, provider.asn, sent.ann, RelationshipType::PROVIDER, selection);
+            }
+        }
+    }
+
+    if (best.found) {
+        route.present = true;
+        route.ann = std::move(best.ann);
+        route.ann.as_path.insert(route.ann.as_path.begin(), node.asn);
+    }
+    return route;
+}
@@ -0,0 +1,26 @@
+#include "route_selection.h"
+
+bool parseRouteSelection(const std::string& text, RouteSelection& selection) {
+    if (text == "standard") {
+        selection = RouteSelection::STANDARD;
+    } else if (text == "ignore-path-length") {
+        selection = RouteSelection::IGNORE_PATH_LENGTH;
+    } else if (text == "hash-tie-break") {
+        selection = RouteSelection::HASH_TIE_BREAK;
+    } else if (text == "lowest-origin") {
+        selection = RouteSelection::LOWEST_ORIGIN;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* routeSelectionName(RouteSelection selection) {
+    switch (selection) {
+        case RouteSelection::IGNORE_PATH_LENGTH: return "ignore-path-length";
+        case RouteSelection::HASH_TIE_BREAK: return "hash-tie-break";
+        case RouteSelection::LOWEST_ORIGIN: return "lowest-origin";
+        case RouteSelection::STANDARD:
+        default: return "standard";
+    }
+}
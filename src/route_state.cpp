@@ -0,0 +1,158 @@
+#include "route_state.h"
+#include "rib_export.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    const char ROUTE_STATE_MAGIC[8] = {'B', 'G', 'P', 'R', 'O', 'U', 'T', 'E'};
+    constexpr uint32_t ROUTE_STATE_VERSION = 1;
+
+    // Fixed-size header; integers are stored in host byte order
+    struct RouteStateHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t prefix_count;
+        uint64_t entry_count;
+    };
+
+    // Whether text is a prefix as saved: "<address>/<length>" that prints back
+    // unchanged (so parsing cannot throw or silently yield another prefix)
+    bool isCanonicalPrefix(const std::string& text) {
+        size_t slash = text.find('/');
+        if (slash == std::string::npos || slash + 1 == text.size() || text.size() - slash > 4) {
+            return false;
+        }
+        for (size_t i = slash + 1; i < text.size(); i++) {
+            if (text[i] < '0' || text[i] > '9') return false;
+        }
+        return Prefix::parse(text).toString() == text;
+    }
+}
+
+void RouteState::clear() {
+    prefixes.clear();
+    prefix_text.clear();
+    entries.clear();
+}
+
+bool saveRouteState(const RouteState& state, const std::string& filename) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open file " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    RouteStateHeader header;
+    std::memcpy(header.magic, ROUTE_STATE_MAGIC, sizeof(header.magic));
+    header.version = ROUTE_STATE_VERSION;
+    header.prefix_count = static_cast<uint32_t>(state.prefix_text.size());
+    header.entry_count = state.entries.size();
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Prefixes as length-prefixed text: independent of the in-memory layout
+    for (const std::string& text : state.prefix_text) {
+        uint8_t length = static_cast<uint8_t>(text.size());
+        file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        file.write(text.data(), length);
+    }
+
+    static_assert(sizeof(RouteState::Entry) == 16, "route state entries are stored raw");
+    file.write(reinterpret_cast<const char*>(state.entries.data()),
+               state.entries.size() * sizeof(RouteState::Entry));
+    file.close();
+
+    if (!file) {
+        std::cerr << "Error: Failed writing route state " << filename << std::endl;
+        return false;
+    }
+
+    std::cout << "Saved route state " << filename << " (" << state.entries.size() << " routes, "
+              << state.prefixes.size() << " prefixes)" << std::endl;
+    return true;
+}
+
+bool loadRouteState(const std::string& filename, RouteState& state) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open file " << filename << std::endl;
+        return false;
+    }
+
+    RouteStateHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, ROUTE_STATE_MAGIC, sizeof(header.magic)) != 0) {
+        std::cerr << "Error: " << filename << " is not a route state file" << std::endl;
+        return false;
+    }
+    if (header.version != ROUTE_STATE_VERSION) {
+        std::cerr << "Error: Unsupported route state version " << header.version << std::endl;
+        return false;
+    }
+
+    // Check the counts against the file size before allocating for them: every
+    // prefix takes at least its length byte, every entry exactly 16 bytes
+    file.seekg(0, std::ios::end);
+    uint64_t payload = static_cast<uint64_t>(file.tellg()) - sizeof(header);
+    file.seekg(sizeof(header));
+    if (header.prefix_count > payload || header.entry_count > payload / sizeof(RouteState::Entry)) {
+        std::cerr << "Error: Route state " << filename << " is truncated or has a corrupt header" << std::endl;
+        return false;
+    }
+
+    auto corrupt = [&](const char* what) {
+        std::cerr << "Error: Corrupt route state " << filename << ": " << what << std::endl;
+        state.clear();
+        return false;
+    };
+
+    state.clear();
+    state.prefixes.reserve(header.prefix_count);
+    state.prefix_text.reserve(header.prefix_count);
+    for (uint32_t i = 0; i < header.prefix_count; i++) {
+        uint8_t length = 0;
+        char text[256];
+        if (!file.read(reinterpret_cast<char*>(&length), sizeof(length)) || !file.read(text, length)) {
+            return corrupt("prefix table ends early");
+        }
+        state.prefix_text.emplace_back(text, length);
+        if (!isCanonicalPrefix(state.prefix_text.back())) {
+            return corrupt("invalid prefix");
+        }
+        state.prefixes.push_back(Prefix::parse(state.prefix_text.back()));
+        if (i > 0 && !prefixLess(state.prefixes[i - 1], state.prefixes[i])) {
+            return corrupt("prefixes out of order");
+        }
+    }
+
+    uint64_t remaining = payload - (static_cast<uint64_t>(file.tellg()) - sizeof(header));
+    if (header.entry_count * sizeof(RouteState::Entry) != remaining) {
+        std::cerr << "Error: Route state " << filename << " is truncated or has a corrupt header" << std::endl;
+        state.clear();
+        return false;
+    }
+
+    state.entries.resize(header.entry_count);
+    file.read(reinterpret_cast<char*>(state.entries.data()),
+              state.entries.size() * sizeof(RouteState::Entry));
+    if (!file) {
+        std::cerr << "Error: Truncated route state " << filename << std::endl;
+        state.clear();
+        return false;
+    }
+
+    // Delta exports index prefix_text by entry and merge in (asn, prefix) order
+    for (size_t i = 0; i < state.entries.size(); i++) {
+        const RouteState::Entry& entry = state.entries[i];
+        if (entry.prefix >= header.prefix_count) {
+            return corrupt("prefix index out of range");
+        }
+        if (i > 0) {
+            const RouteState::Entry& prev = state.entries[i - 1];
+            if (prev.asn > entry.asn || (prev.asn == entry.asn && prev.prefix >= entry.prefix)) {
+                return corrupt("routes out of order");
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,289 @@
+#include "rpki.h"
+#include "parallel.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+const char* rpkiStateName(RpkiState state) {
+    switch (state) {
+        case RpkiState::VALID: return "valid";
+        case RpkiState::INVALID: return "invalid";
+        case RpkiState::NOT_FOUND:
+        default: return "not-found";
+    }
+}
+
+template <typename P>
+void VrpTable<P>::build(std::vector<Entry>& entries, unsigned threads) {
+    // Trie preorder: an enclosing prefix sorts before everything it covers
+    parallelSort(entries, threads, [](const Entry& a, const Entry& b) {
+        if (a.address != b.address) return a.address < b.address;
+        if (a.length != b.length) return a.length < b.length;
+        if (a.asn != b.asn) return a.asn < b.asn;
+        return a.max_length < b.max_length;
+    });
+
+    starts.clear();
+    nodes.clear();
+    authorizations.clear();
+
+    // Prefixes whose intervals are still open, innermost last
+    std::vector<uint32_t> enclosing;
+
+    for (size_t i = 0; i < entries.size(); i++) {
+        const Entry& entry = entries[i];
+        bool same_prefix = i > 0 && entry.address == entries[i - 1].address &&
+                           entry.length == entries[i - 1].length;
+
+        // Dumps list a VRP once per trust anchor; keep one copy
+        if (same_prefix && entry.asn == entries[i - 1].asn &&
+            entry.max_length == entries[i - 1].max_length) {
+            continue;
+        }
+
+        if (!same_prefix) {
+            while (!enclosing.empty()) {
+                uint32_t top = enclosing.back();
+                if (nodes[top].length < entry.length && mask(entry.address, nodes[top].length) == starts[top]) {
+                    break;
+                }
+                enclosing.pop_back();
+            }
+
+            uint32_t index = static_cast<uint32_t>(starts.size());
+            starts.push_back(entry.address);
+            nodes.push_back({enclosing.empty() ? NO_PARENT : enclosing.back(),
+                             static_cast<uint32_t>(authorizations.size()), entry.length});
+            enclosing.push_back(index);
+        }
+        authorizations.push_back({entry.asn, entry.max_length});
+    }
+    nodes.push_back({NO_PARENT, static_cast<uint32_t>(authorizations.size()), 0});
+
+    buckets.assign((size_t(1) << BUCKET_BITS) + 1, 0);
+    for (Address start : starts) {
+        buckets[bucketOf(start) + 1]++;
+    }
+    for (size_t b = 1; b < buckets.size(); b++) {
+        buckets[b] += buckets[b - 1];
+    }
+
+    starts.shrink_to_fit();
+    nodes.shrink_to_fit();
+    authorizations.shrink_to_fit();
+}
+
+template class VrpTable<IPv4Prefix>;
+template class VrpTable<IPv6Prefix>;
+
+namespace {
+    // VRPs parsed by one worker
+    struct ParsedChunk {
+        std::vector<VrpTable<IPv4Prefix>::Entry> entries4;
+        std::vector<VrpTable<IPv6Prefix>::Entry> entries6;
+        size_t skipped = 0;
+    };
+
+    std::string trimmed(const char* begin, const char* end) {
+        while (begin < end && (*begin == ' ' || *begin == '\t' || *begin == '"')) begin++;
+        while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '"')) end--;
+        return std::string(begin, end);
+    }
+
+    bool parseNumber(const std::string& text, unsigned long& value) {
+        if (text.empty() || text.size() > 10) return false;
+        for (char c : text) {
+            if (c < '0' || c > '9') return false;
+        }
+        value = std::strtoul(text.c_str(), nullptr, 10);
+        return true;
+    }
+
+    bool parseASN(std::string text, ASN& asn) {
+        if (text.size() > 2 && (text[0] == 'A' || text[0] == 'a') && (text[1] == 'S' || text[1] == 's')) {
+            text.erase(0, 2);
+        }
+        unsigned long value;
+        if (!parseNumber(text, value) || value > 0xFFFFFFFFUL) return false;
+        asn = static_cast<ASN>(value);
+        return true;
+    }
+
+    template <typename P>
+    bool makeEntry(const P& prefix, const std::string& max_length_text, ASN asn,
+                   typename VrpTable<P>::Entry& entry) {
+        using Family = typename VrpTable<P>::Family;
+        if (prefix.prefix_len > Family::BITS) return false;
+
+        unsigned long max_length = prefix.prefix_len;
+        if (!max_length_text.empty() &&
+            (!parseNumber(max_length_text, max_length) ||
+             max_length < prefix.prefix_len || max_length > Family::BITS)) {
+            return false;
+        }
+
+        entry.address = rpki_detail::maskAddress<typename Family::Address, Family::BITS>(
+            Family::address(prefix), prefix.prefix_len);
+        entry.length = prefix.prefix_len;
+        entry.max_length = static_cast<uint8_t>(max_length);
+        entry.asn = asn;
+        return true;
+    }
+
+    // One CSV row; false if it is not a VRP
+    bool parseVrpLine(const char* begin, const char* end, ParsedChunk& chunk) {
+        std::string fields[3];
+        size_t count = 0;
+        const char* field_start = begin;
+        for (const char* p = begin; p <= end && count < 3; p++) {
+            if (p == end || *p == ',') {
+                fields[count++] = trimmed(field_start, p);
+                field_start = p + 1;
+            }
+        }
+        if (count < 2) return false;
+
+        // prefix,maxLength,ASN or ASN,prefix,maxLength
+        bool prefix_first = fields[0].find('/') != std::string::npos;
+        const std::string& prefix_text = prefix_first ? fields[0] : fields[1];
+        const std::string& max_length_text = prefix_first ? fields[1] : fields[2];
+        const std::string& asn_text = prefix_first ? fields[2] : fields[0];
+
+        ASN asn;
+        size_t slash = prefix_text.find('/');
+        if (slash == std::string::npos || !parseASN(asn_text, asn)) return false;
+
+        Prefix prefix;
+        try {
+            prefix = Prefix::parse(prefix_text);
+        } catch (const std::exception&) {
+            return false;
+        }
+
+        // parse() yields ::/0 or 0.0.0.0/0 for an unparsable address
+        bool zero = prefix.is_ipv6 ? (prefix.v6.high == 0 && prefix.v6.low == 0 && prefix.v6.prefix_len == 0)
+                                   : (prefix.v4.address == 0 && prefix.v4.prefix_len == 0);
+        if (zero && prefix_text.compare(slash + 1, std::string::npos, "0") != 0) return false;
+
+        if (prefix.is_ipv6) {
+            VrpTable<IPv6Prefix>::Entry entry;
+            if (!makeEntry(prefix.v6, max_length_text, asn, entry)) return false;
+            chunk.entries6.push_back(entry);
+        } else {
+            VrpTable<IPv4Prefix>::Entry entry;
+            if (!makeEntry(prefix.v4, max_length_text, asn, entry)) return false;
+            chunk.entries4.push_back(entry);
+        }
+        return true;
+    }
+}
+
+bool RpkiIndex::loadFromFile(const std::string& filename, unsigned threads) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open VRP file " << filename << std::endl;
+        return false;
+    }
+
+    std::cout << "Loading VRPs from " << filename << "..." << std::endl;
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string text = buffer.str();
+    if (threads == 0) threads = defaultThreadCount();
+
+    // Chunk boundaries moved forward to the next line start
+    std::vector<size_t> bounds;
+    for (unsigned w = 0; w <= threads; w++) {
+        size_t pos = std::min(text.size(), text.size() / threads * w);
+        if (w == threads) {
+            pos = text.size();
+        } else if (pos > 0) {
+            size_t newline = text.find('\n', pos - 1);
+            pos = newline == std::string::npos ? text.size() : newline + 1;
+        }
+        bounds.push_back(std::max(pos, bounds.empty() ? size_t(0) : bounds.back()));
+    }
+
+    std::vector<ParsedChunk> chunks(threads);
+    parallelFor(threads, threads, [&](size_t begin, size_t end, unsigned) {
+        for (size_t c = begin; c < end; c++) {
+            const char* p = text.data() + bounds[c];
+            const char* chunk_end = text.data() + bounds[c + 1];
+            while (p < chunk_end) {
+                const char* line_end = p;
+                while (line_end < chunk_end && *line_end != '\n') line_end++;
+
+                bool blank = p == line_end || *p == '#' || *p == '\r';
+                if (!blank && !parseVrpLine(p, line_end, chunks[c])) {
+                    // The first line of the file may be a header
+                    if (p != text.data()) chunks[c].skipped++;
+                }
+                p = line_end + 1;
+            }
+        }
+    }, 1);
+
+    std::vector<VrpTable<IPv4Prefix>::Entry> entries4;
+    std::vector<VrpTable<IPv6Prefix>::Entry> entries6;
+    size_t skipped = 0;
+    for (ParsedChunk& chunk : chunks) {
+        entries4.insert(entries4.end(), chunk.entries4.begin(), chunk.entries4.end());
+        entries6.insert(entries6.end(), chunk.entries6.begin(), chunk.entries6.end());
+        skipped += chunk.skipped;
+        ParsedChunk().entries4.swap(chunk.entries4);
+        ParsedChunk().entries6.swap(chunk.entries6);
+    }
+
+    vrps4.build(entries4, threads);
+    vrps6.build(entries6, threads);
+
+    if (skipped > 0) {
+        std::cerr << "Warning: Skipped " << skipped << " malformed lines in " << filename << std::endl;
+    }
+    std::cout << "Loaded " << size() << " VRPs (" << vrps4.size() << " IPv4, "
+              << vrps6.size() << " IPv6)" << std::endl;
+    return true;
+}
+
+void RpkiIndex::validatePath(const Prefix& prefix, const std::vector<ASN>& path,
+                             std::vector<RpkiState>& states) const {
+    states.clear();
+    states.reserve(path.size());
+    for (ASN asn : path) {
+        states.push_back(validate(prefix, asn));
+    }
+}
+
+RpkiSeedCounts RpkiIndex::validateSeeds(std::vector<SeedAnnouncement>& seeds, unsigned threads) const {
+    if (threads == 0) threads = defaultThreadCount();
+    std::vector<RpkiSeedCounts> worker_counts(threads);
+
+    parallelFor(seeds.size(), threads, [&](size_t begin, size_t end, unsigned worker) {
+        RpkiSeedCounts& counts = worker_counts[worker];
+        for (size_t i = begin; i < end; i++) {
+            SeedAnnouncement& seed = seeds[i];
+            RpkiState state = validate(Prefix::parse(seed.prefix), seed.origin_asn);
+
+            if (state == RpkiState::VALID) counts.valid++;
+            else if (state == RpkiState::INVALID) counts.invalid++;
+            else counts.not_found++;
+
+            bool rov_invalid = state == RpkiState::INVALID;
+            if (seed.rov_invalid != rov_invalid) {
+                seed.rov_invalid = rov_invalid;
+                counts.changed++;
+            }
+        }
+    });
+
+    RpkiSeedCounts total;
+    for (const RpkiSeedCounts& counts : worker_counts) {
+        total.valid += counts.valid;
+        total.invalid += counts.invalid;
+        total.not_found += counts.not_found;
+        total.changed += counts.changed;
+    }
+    return total;
+}
@@ -0,0 +1,143 @@
+#include "time_series.h"
+#include "bgp_policy.h"
+#include "topology_diff.h"
+#include <chrono>
+#include <iostream>
+
+TimeSeriesRunner::TimeSeriesRunner(std::vector<SeedAnnouncement> seed_list, std::string rov_file)
+    : seeds(std::move(seed_list)), rov_asns_file(std::move(rov_file)) {}
+
+bool TimeSeriesRunner::advanceTopology(const std::string& topology_file, MonthSummary& summary) {
+    unchanged = false;
+    if (!started) {
+        if (!graph.buildFromFile(topology_file)) {
+            return false;
+        }
+        graph.initializeBGP();
+        if (!rov_asns_file.empty() && !graph.loadROVASNs(rov_asns_file)) {
+            std::cerr << "Warning: Failed to load ROV ASNs" << std::endl;
+        }
+        started = true;
+        return true;
+    }
+
+    TopologyDiff diff;
+    if (ASGraph::isSnapshotFile(previous_file) && ASGraph::isSnapshotFile(topology_file)) {
+        // Both sides stored sorted: no second graph is built
+        if (!diffSnapshotFiles(previous_file, topology_file, diff)) {
+            return false;
+        }
+    } else {
+        ASGraph next;
+        if (!next.buildFromFile(topology_file)) {
+            return false;
+        }
+        diff = diffTopologies(graph, next);
+    }
+
+    // Same topology as last month: the RIBs computed for it are still valid
+    if (diff.empty()) {
+        unchanged = true;
+        return true;
+    }
+
+    graph.applyDiff(diff);
+    graph.resetRoutingState();
+    graph.initializeBGP();  // Policies for added ASes only
+
+    summary.nodes_added = diff.added_nodes.size();
+    summary.nodes_removed = diff.removed_nodes.size();
+    summary.edges_added = diff.added_edges.size();
+    summary.edges_removed = diff.removed_edges.size();
+    summary.edges_changed = diff.changed_edges.size();
+    return true;
+}
+
+void TimeSeriesRunner::summarizeRIBs(MonthSummary& summary) const {
+    size_t path_length_total = 0;
+
+    for (const auto& pair : graph.getNodes()) {
+        const ASNode& node = pair.second;
+        if (!node.policy || node.policy->getLocalRIBSize() == 0) continue;
+
+        summary.ases_with_routes++;
+        node.policy->forEachRoute([&](const Prefix&, const Announcement& ann) {
+            summary.rib_entries++;
+            path_length_total += ann.as_path.size();
+            if (ann.rov_invalid) {
+                summary.rov_invalid_routes++;
+            }
+        });
+    }
+
+    if (summary.rib_entries > 0) {
+        summary.avg_path_length = static_cast<double>(path_length_total) / summary.rib_entries;
+    }
+}
+
+bool TimeSeriesRunner::runMonth(const std::string& label, const std::string& topology_file,
+                                MonthSummary& summary) {
+    summary = MonthSummary();
+    summary.label = label;
+
+    std::cout << "=== " << label << ": " << topology_file << " ===" << std::endl;
+    auto start = std::chrono::high_resolution_clock::now();
+
+    if (!advanceTopology(topology_file, summary)) {
+        std::cerr << "Failed to load topology for " << label << std::endl;
+        return false;
+    }
+    previous_file = topology_file;
+
+    auto end = std::chrono::high_resolution_clock::now();
+    summary.update_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    if (unchanged) {
+        std::cout << "Topology unchanged from the previous month; reusing its results" << std::endl;
+        MonthSummary reused = last_summary;
+        reused.label = label;
+        reused.update_ms = summary.update_ms;
+        reused.nodes_added = reused.nodes_removed = 0;
+        reused.edges_added = reused.edges_removed = reused.edges_changed = 0;
+        reused.propagate_ms = 0;
+        summary = reused;
+        return true;
+    }
+
+    if (graph.detectCycles()) {
+        std::cerr << "ERROR: Graph for " << label << " contains cycles!" << std::endl;
+        return false;
+    }
+
+    start = std::chrono::high_resolution_clock::now();
+
+    graph.flattenGraph();
+    for (const SeedAnnouncement& seed : seeds) {
+        graph.seedAnnouncement(seed.origin_asn, seed.prefix, seed.rov_invalid);
+    }
+    graph.propagateAnnouncements();
+
+    end = std::chrono::high_resolution_clock::now();
+    summary.propagate_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    summary.fingerprint = graph.fingerprint().toHex();
+    summary.nodes = graph.getNodeCount();
+    summary.edges = graph.getProviderCustomerEdges() + graph.getPeerEdges();
+    summarizeRIBs(summary);
+    last_summary = summary;
+    return true;
+}
+
+void writeMonthSummaryHeader(std::ostream& out) {
+    out << "month,fingerprint,nodes,edges,nodes_added,nodes_removed,edges_added,"
+        << "edges_removed,edges_changed,rib_entries,ases_with_routes,avg_path_length,"
+        << "rov_invalid_routes,update_ms,propagate_ms\n";
+}
+
+void writeMonthSummaryRow(std::ostream& out, const MonthSummary& s) {
+    out << s.label << "," << s.fingerprint << "," << s.nodes << "," << s.edges << ","
+        << s.nodes_added << "," << s.nodes_removed << "," << s.edges_added << ","
+        << s.edges_removed << "," << s.edges_changed << "," << s.rib_entries << ","
+        << s.ases_with_routes << "," << s.avg_path_length << "," << s.rov_invalid_routes << ","
+        << s.update_ms << "," << s.propagate_ms << "\n";
+}
@@ -0,0 +1,175 @@
+#include "topology_archive.h"
+#include "as_graph.h"
+#include "content_hash.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+TopologyArchive::TopologyArchive(const std::string& root_dir) : root(root_dir) {}
+
+bool TopologyArchive::isValidMonth(const std::string& month) {
+    if (month.size() != 6) return false;
+    for (char c : month) {
+        if (c < '0' || c > '9') return false;
+    }
+    int mm = std::stoi(month.substr(4, 2));
+    return mm >= 1 && mm <= 12;
+}
+
+std::string TopologyArchive::indexPath() const {
+    return (fs::path(root) / "index.txt").string();
+}
+
+bool TopologyArchive::load() {
+    months.clear();
+
+    std::ifstream index(indexPath());
+    if (!index.is_open()) {
+        return true;  // New archive
+    }
+
+    std::string line;
+    while (std::getline(index, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream iss(line);
+        std::string month;
+        MonthEntry entry;
+        if (iss >> month >> entry.fingerprint >> entry.content_hash && isValidMonth(month)) {
+            months[month] = entry;
+        }
+    }
+    return true;
+}
+
+bool TopologyArchive::saveIndex() const {
+    std::string tmp_path = indexPath() + ".tmp";
+    std::ofstream index(tmp_path);
+    if (!index.is_open()) {
+        std::cerr << "Error: Cannot write archive index " << tmp_path << std::endl;
+        return false;
+    }
+
+    index << "# month fingerprint content_hash\n";
+    for (const auto& pair : months) {
+        index << pair.first << " " << pair.second.fingerprint << " "
+              << pair.second.content_hash << "\n";
+    }
+    index.close();
+
+    std::error_code ec;
+    fs::rename(tmp_path, indexPath(), ec);
+    if (ec) {
+        std::cerr << "Error: Cannot update archive index: " << ec.message() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool TopologyArchive::addMonth(const std::string& month, const std::string& downloaded_file) {
+    std::error_code ec;
+    fs::create_directories(fs::path(root) / "raw", ec);
+    fs::create_directories(fs::path(root) / "objects", ec);
+    if (ec) {
+        std::cerr << "Error: Cannot create archive in " << root << ": " << ec.message() << std::endl;
+        return false;
+    }
+
+    Hash128 content;
+    if (!hashFile(downloaded_file, content)) {
+        std::cerr << "Error: Cannot read " << downloaded_file << std::endl;
+        return false;
+    }
+    std::string content_hash = content.toHex();
+
+    // Raw store: identical downloads are kept once
+    fs::path raw_path = fs::path(root) / "raw" / (content_hash + ".bz2");
+    if (fs::exists(raw_path, ec)) {
+        fs::remove(downloaded_file, ec);
+    } else {
+        fs::rename(downloaded_file, raw_path, ec);
+        if (ec) {
+            // Different filesystem: fall back to copy + remove
+            ec.clear();
+            fs::copy_file(downloaded_file, raw_path, ec);
+            if (ec) {
+                std::cerr << "Error: Cannot store " << downloaded_file << ": " << ec.message() << std::endl;
+                return false;
+            }
+            fs::remove(downloaded_file, ec);
+        }
+    }
+
+    // Same bytes as an archived month: reuse its conversion
+    std::string fingerprint;
+    for (const auto& pair : months) {
+        if (pair.second.content_hash == content_hash &&
+            fs::exists(getSnapshotPath(pair.first), ec)) {
+            fingerprint = pair.second.fingerprint;
+            break;
+        }
+    }
+
+    if (fingerprint.empty()) {
+        ASGraph graph;
+        if (!graph.buildFromFile(raw_path.string())) {
+            return false;
+        }
+        fingerprint = graph.fingerprint().toHex();
+
+        // Content-addressed snapshot: unchanged topologies convert to the same object
+        fs::path object_path = fs::path(root) / "objects" / (fingerprint + ".snap");
+        if (!fs::exists(object_path, ec)) {
+            std::string tmp_path = object_path.string() + ".tmp";
+            if (!graph.saveSnapshot(tmp_path)) {
+                return false;
+            }
+            fs::rename(tmp_path, object_path, ec);
+            if (ec) {
+                std::cerr << "Error: Cannot store snapshot: " << ec.message() << std::endl;
+                return false;
+            }
+        }
+    }
+
+    for (const auto& pair : months) {
+        if (pair.first != month && pair.second.fingerprint == fingerprint) {
+            std::cout << "[DEDUP] Topology for " << month << " is identical to " << pair.first
+                      << " (fingerprint " << fingerprint << ")" << std::endl;
+            break;
+        }
+    }
+
+    months[month] = {fingerprint, content_hash};
+    if (!saveIndex()) {
+        return false;
+    }
+
+    std::cout << "Archived " << month << " -> " << getSnapshotPath(month) << std::endl;
+    return true;
+}
+
+bool TopologyArchive::hasMonth(const std::string& month) const {
+    return months.find(month) != months.end();
+}
+
+std::string TopologyArchive::getSnapshotPath(const std::string& month) const {
+    auto it = months.find(month);
+    if (it == months.end()) {
+        return "";
+    }
+    return (fs::path(root) / "objects" / (it->second.fingerprint + ".snap")).string();
+}
+
+std::vector<std::string> TopologyArchive::getMonths() const {
+    std::vector<std::string> result;
+    result.reserve(months.size());
+    for (const auto& pair : months) {
+        result.push_back(pair.first);
+    }
+    return result;
+}
@@ -0,0 +1,271 @@
+#include "topology_diff.h"
+#include "parallel.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    // Edges are matched by AS pair; the relationship is compared afterwards
+    inline bool pairLess(const GraphEdge& a, const GraphEdge& b) {
+        if (a.as1 != b.as1) return a.as1 < b.as1;
+        return a.as2 < b.as2;
+    }
+
+    inline bool samePair(const GraphEdge& a, const GraphEdge& b) {
+        return a.as1 == b.as1 && a.as2 == b.as2;
+    }
+
+    // Half-open index ranges of both inputs covering the same key interval
+    struct MergeRange {
+        size_t a_begin, a_end;
+        size_t b_begin, b_end;
+    };
+
+    // Cut both sorted inputs at the same keys so each range merges independently
+    // Cuts are taken at lower_bound, so equal keys never straddle two ranges
+    template <typename T, typename Less>
+    std::vector<MergeRange> partitionSorted(const std::vector<T>& a, const std::vector<T>& b,
+                                            unsigned threads, Less less) {
+        if (threads == 0) threads = defaultThreadCount();
+        size_t parts = std::min<size_t>(threads, std::max<size_t>(1, (a.size() + b.size()) / 65536));
+        if (a.empty()) parts = 1;
+
+        std::vector<size_t> a_cuts = {0};
+        std::vector<size_t> b_cuts = {0};
+        for (size_t p = 1; p < parts; p++) {
+            const T& key = a[p * a.size() / parts];
+            a_cuts.push_back(std::lower_bound(a.begin(), a.end(), key, less) - a.begin());
+            b_cuts.push_back(std::lower_bound(b.begin(), b.end(), key, less) - b.begin());
+        }
+        a_cuts.push_back(a.size());
+        b_cuts.push_back(b.size());
+
+        std::vector<MergeRange> ranges;
+        for (size_t p = 0; p < parts; p++) {
+            ranges.push_back({a_cuts[p], a_cuts[p + 1], b_cuts[p], b_cuts[p + 1]});
+        }
+        return ranges;
+    }
+
+    template <typename T>
+    void appendAll(std::vector<T>& out, const std::vector<T>& part) {
+        out.insert(out.end(), part.begin(), part.end());
+    }
+
+    void diffNodeRange(const std::vector<ASN>& a, const std::vector<ASN>& b,
+                       const MergeRange& r, TopologyDiff& out) {
+        std::set_difference(a.begin() + r.a_begin, a.begin() + r.a_end,
+                            b.begin() + r.b_begin, b.begin() + r.b_end,
+                            std::back_inserter(out.removed_nodes));
+        std::set_difference(b.begin() + r.b_begin, b.begin() + r.b_end,
+                            a.begin() + r.a_begin, a.begin() + r.a_end,
+                            std::back_inserter(out.added_nodes));
+    }
+
+    void diffEdgeRange(const std::vector<GraphEdge>& a, const std::vector<GraphEdge>& b,
+                       const MergeRange& r, TopologyDiff& out) {
+        size_t i = r.a_begin;
+        size_t j = r.b_begin;
+
+        while (i < r.a_end || j < r.b_end) {
+            if (j == r.b_end || (i < r.a_end && pairLess(a[i], b[j]))) {
+                out.removed_edges.push_back(a[i++]);
+            } else if (i == r.a_end || pairLess(b[j], a[i])) {
+                out.added_edges.push_back(b[j++]);
+            } else {
+                // Same AS pair on both sides; normally one entry each
+                size_t i_end = i + 1;
+                while (i_end < r.a_end && samePair(a[i_end], a[i])) i_end++;
+                size_t j_end = j + 1;
+                while (j_end < r.b_end && samePair(b[j_end], b[j])) j_end++;
+
+                if (i_end - i == 1 && j_end - j == 1) {
+                    if (a[i].rel != b[j].rel) {
+                        out.changed_edges.push_back({a[i].as1, a[i].as2, a[i].rel, b[j].rel});
+                    }
+                } else {
+                    // Conflicting duplicate lines in an input: compare the typed sets
+                    std::set_difference(a.begin() + i, a.begin() + i_end, b.begin() + j, b.begin() + j_end,
+                                        std::back_inserter(out.removed_edges));
+                    std::set_difference(b.begin() + j, b.begin() + j_end, a.begin() + i, a.begin() + i_end,
+                                        std::back_inserter(out.added_edges));
+                }
+                i = i_end;
+                j = j_end;
+            }
+        }
+    }
+
+    void writeEdge(std::ostream& out, const char* tag, const GraphEdge& e) {
+        out << tag << " " << e.as1 << "|" << e.as2 << "|" << static_cast<int>(e.rel) << "\n";
+    }
+
+    bool parseEdgeFields(const std::string& text, std::vector<long long>& fields) {
+        fields.clear();
+        std::istringstream iss(text);
+        std::string field;
+        while (std::getline(iss, field, '|')) {
+            try {
+                fields.push_back(std::stoll(field));
+            } catch (const std::exception&) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool validRel(long long rel) {
+        return rel >= -1 && rel <= 1;
+    }
+}
+
+TopologyDiff diffEdgeLists(const std::vector<ASN>& old_nodes,
+                           const std::vector<GraphEdge>& old_edges,
+                           const std::vector<ASN>& new_nodes,
+                           const std::vector<GraphEdge>& new_edges,
+                           unsigned threads) {
+    std::vector<MergeRange> node_ranges = partitionSorted(old_nodes, new_nodes, threads, std::less<ASN>());
+    std::vector<MergeRange> edge_ranges = partitionSorted(old_edges, new_edges, threads, pairLess);
+
+    // One partial result per range, concatenated in key order afterwards
+    std::vector<TopologyDiff> node_parts(node_ranges.size());
+    std::vector<TopologyDiff> edge_parts(edge_ranges.size());
+
+    parallelFor(node_ranges.size(), threads, [&](size_t begin, size_t end, unsigned) {
+        for (size_t p = begin; p < end; p++) {
+            diffNodeRange(old_nodes, new_nodes, node_ranges[p], node_parts[p]);
+        }
+    }, 1);
+    parallelFor(edge_ranges.size(), threads, [&](size_t begin, size_t end, unsigned) {
+        for (size_t p = begin; p < end; p++) {
+            diffEdgeRange(old_edges, new_edges, edge_ranges[p], edge_parts[p]);
+        }
+    }, 1);
+
+    TopologyDiff diff;
+    for (const TopologyDiff& part : node_parts) {
+        appendAll(diff.added_nodes, part.added_nodes);
+        appendAll(diff.removed_nodes, part.removed_nodes);
+    }
+    for (const TopologyDiff& part : edge_parts) {
+        appendAll(diff.added_edges, part.added_edges);
+        appendAll(diff.removed_edges, part.removed_edges);
+        appendAll(diff.changed_edges, part.changed_edges);
+    }
+    return diff;
+}
+
+TopologyDiff diffTopologies(const ASGraph& old_graph, const ASGraph& new_graph, unsigned threads) {
+    auto sorted_asns = [threads](const ASGraph& graph) {
+        std::vector<ASN> asns;
+        asns.reserve(graph.getNodeCount());
+        for (const auto& pair : graph.getNodes()) {
+            asns.push_back(pair.first);
+        }
+        parallelSort(asns, threads, std::less<ASN>());
+        return asns;
+    };
+
+    TopologyDiff diff = diffEdgeLists(sorted_asns(old_graph), old_graph.getCanonicalEdges(threads),
+                                      sorted_asns(new_graph), new_graph.getCanonicalEdges(threads),
+                                      threads);
+    diff.old_fingerprint = old_graph.fingerprint(threads);
+    diff.new_fingerprint = new_graph.fingerprint(threads);
+    return diff;
+}
+
+bool diffSnapshotFiles(const std::string& old_snapshot, const std::string& new_snapshot,
+                       TopologyDiff& diff, unsigned threads) {
+    std::vector<ASN> old_nodes, new_nodes;
+    std::vector<GraphEdge> old_edges, new_edges;
+    Hash128 old_fingerprint, new_fingerprint;
+
+    if (!ASGraph::readSnapshot(old_snapshot, old_nodes, old_edges, old_fingerprint) ||
+        !ASGraph::readSnapshot(new_snapshot, new_nodes, new_edges, new_fingerprint)) {
+        return false;
+    }
+
+    diff = diffEdgeLists(old_nodes, old_edges, new_nodes, new_edges, threads);
+    diff.old_fingerprint = old_fingerprint;
+    diff.new_fingerprint = new_fingerprint;
+    return true;
+}
+
+bool writeTopologyDiff(const TopologyDiff& diff, const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open file " << filename << " for writing" << std::endl;
+        return false;
+    }
+
+    file << "# topology diff " << diff.old_fingerprint.toHex() << " "
+         << diff.new_fingerprint.toHex() << "\n";
+    for (ASN asn : diff.removed_nodes) file << "-node " << asn << "\n";
+    for (ASN asn : diff.added_nodes) file << "+node " << asn << "\n";
+    for (const GraphEdge& e : diff.removed_edges) writeEdge(file, "-edge", e);
+    for (const GraphEdge& e : diff.added_edges) writeEdge(file, "+edge", e);
+    for (const EdgeChange& c : diff.changed_edges) {
+        file << "~edge " << c.as1 << "|" << c.as2 << "|" << static_cast<int>(c.old_rel)
+             << "|" << static_cast<int>(c.new_rel) << "\n";
+    }
+
+    file.close();
+    if (!file) {
+        std::cerr << "Error: Failed writing " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool readTopologyDiff(const std::string& filename, TopologyDiff& diff) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open file " << filename << std::endl;
+        return false;
+    }
+
+    diff = TopologyDiff();
+    std::string line;
+    size_t line_number = 0;
+    std::vector<long long> fields;
+
+    while (std::getline(file, line)) {
+        line_number++;
+        if (line.empty()) continue;
+
+        std::istringstream iss(line);
+        std::string tag, value;
+        iss >> tag >> value;
+
+        if (tag == "#") {
+            std::string old_fp, new_fp;
+            if (value == "topology" && iss >> value >> old_fp >> new_fp &&
+                old_fp.size() == 32 && new_fp.size() == 32) {
+                diff.old_fingerprint = Hash128(std::stoull(old_fp.substr(0, 16), nullptr, 16),
+                                               std::stoull(old_fp.substr(16), nullptr, 16));
+                diff.new_fingerprint = Hash128(std::stoull(new_fp.substr(0, 16), nullptr, 16),
+                                               std::stoull(new_fp.substr(16), nullptr, 16));
+            }
+            continue;
+        }
+
+        bool ok = parseEdgeFields(value, fields);
+        if (ok && (tag == "+node" || tag == "-node") && fields.size() == 1) {
+            (tag == "+node" ? diff.added_nodes : diff.removed_nodes).push_back(static_cast<ASN>(fields[0]));
+        } else if (ok && (tag == "+edge" || tag == "-edge") && fields.size() == 3 && validRel(fields[2])) {
+            GraphEdge e{static_cast<ASN>(fields[0]), static_cast<ASN>(fields[1]),
+                        static_cast<RelationType>(fields[2])};
+            (tag == "+edge" ? diff.added_edges : diff.removed_edges).push_back(e);
+        } else if (ok && tag == "~edge" && fields.size() == 4 && validRel(fields[2]) && validRel(fields[3])) {
+            diff.changed_edges.push_back({static_cast<ASN>(fields[0]), static_cast<ASN>(fields[1]),
+                                          static_cast<RelationType>(fields[2]),
+                                          static_cast<RelationType>(fields[3])});
+        } else {
+            std::cerr << "Error: " << filename << ":" << line_number
+                      << ": malformed diff line" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,146 @@
+#include "aspa.h"
+#include "bgp_policy.h"
+#include "test_common.h"
+
+// ASPA path verification: verdicts, deployment during propagation
+
+namespace {
+    AspaState verify(const AspaTable& table, std::vector<ASN> path, RelationshipType received_from) {
+        return table.verify(path.data(), path.size(), received_from);
+    }
+
+    // Records: 10 -> {20}, 20 -> {30}, 40 -> {30}, 30 has none (AS0 record); 60 has no record
+    void testVerdicts() {
+        AspaTable table;
+        table.assign({{10, 20}, {20, 30}, {40, 30}, {30, 0}});
+        CHECK(table.getCustomerCount() == 4);  // The AS0 record counts
+
+        CHECK(table.hop(10, 20) == AspaHop::PROVIDER);
+        CHECK(table.hop(10, 40) == AspaHop::NOT_PROVIDER);
+        CHECK(table.hop(30, 20) == AspaHop::NOT_PROVIDER);
+        CHECK(table.hop(60, 20) == AspaHop::NO_ATTESTATION);
+
+        // Upstream: every hop from the origin climbs to an attested provider
+        CHECK(verify(table, {10}, RelationshipType::CUSTOMER) == AspaState::VALID);
+        CHECK(verify(table, {20, 10}, RelationshipType::CUSTOMER) == AspaState::VALID);
+        CHECK(verify(table, {30, 20, 10}, RelationshipType::PEER) == AspaState::VALID);
+        CHECK(verify(table, {40, 10}, RelationshipType::CUSTOMER) == AspaState::INVALID);
+        CHECK(verify(table, {20, 60}, RelationshipType::CUSTOMER) == AspaState::UNKNOWN);
+        // A route that already went down cannot come up from a customer
+        CHECK(verify(table, {40, 30, 20, 10}, RelationshipType::CUSTOMER) == AspaState::INVALID);
+
+        // Downstream: up 10 -> 20 -> 30, then down to 40
+        CHECK(verify(table, {40, 30, 20, 10}, RelationshipType::PROVIDER) == AspaState::VALID);
+        CHECK(verify(table, {20, 30, 40}, RelationshipType::PROVIDER) == AspaState::VALID);
+        // 10 -> 20 up, then 20 -> 40 may be a peer link at the top
+        CHECK(verify(table, {40, 20, 10}, RelationshipType::PROVIDER) == AspaState::VALID);
+        // Valley: 20 -> 10 down, then 10 -> 40 is not up
+        CHECK(verify(table, {40, 10, 20}, RelationshipType::PROVIDER) == AspaState::INVALID);
+        CHECK(verify(table, {20, 60, 5}, RelationshipType::PROVIDER) == AspaState::UNKNOWN);
+
+        CHECK(std::string(aspaStateName(AspaState::UNKNOWN)) == "unknown");
+    }
+
+    // Origin 5 attests only provider 20 but is a customer of 10. Deployer 100
+    // drops the route through 10, non-deployer 101 keeps it.
+    void testDeployment() {
+        ASGraph graph;
+        graph.addRelationship(10, 5, RelationType::CUSTOMER);
+        graph.addRelationship(100, 10, RelationType::CUSTOMER);
+        graph.addRelationship(101, 10, RelationType::CUSTOMER);
+        graph.setASPA({{5, 20}, {10, 100}, {10, 101}});
+        graph.setASPAASNs({100});
+        graph.initializeBGP();
+        graph.flattenGraph();
+        graph.seedAnnouncement(5, "10.5.0.0/16");
+        graph.propagateAnnouncements();
+
+        Prefix prefix = Prefix::parse("10.5.0.0/16");
+        CHECK(graph.getNode(10)->policy->getAnnouncement(prefix) != nullptr);
+        CHECK(graph.getNode(100)->policy->getAnnouncement(prefix) == nullptr);
+        CHECK(graph.getNode(101)->policy->getAnnouncement(prefix) != nullptr);
+    }
+
+    // ASPA records of every AS with providers, from the topology
+    std::vector<std::pair<ASN, ASN>> recordsOf(const std::vector<GraphEdge>& edges) {
+        std::vector<std::pair<ASN, ASN>> pairs;
+        for (const GraphEdge& e : edges) {
+            if (e.rel == RelationType::CUSTOMER) {
+                pairs.push_back({e.as2, e.as1});
+            }
+        }
+        return pairs;
+    }
+
+    std::unordered_set<ASN> everyThird(size_t as_count) {
+        std::unordered_set<ASN> asns;
+        for (ASN asn = 1; asn <= as_count; asn += 3) {
+            asns.insert(asn);
+        }
+        return asns;
+    }
+
+    void testPropagation(const test::TempDir& dir) {
+        const size_t as_count = 500;
+        std::vector<GraphEdge> edges = test::makeTopology(as_count, 71);
+        std::string anns = test::announcementsCsv(as_count, 60, 72);
+        RibExportOptions sorted;
+        sorted.sorted = true;
+
+        // Correct records for everyone: no valley-free route is dropped
+        ASGraph plain, attested;
+        test::buildGraph(plain, as_count, 71);
+        test::seedAnnouncements(plain, anns);
+        plain.propagateAnnouncements();
+        test::addEdges(attested, edges);
+        attested.setASPA(recordsOf(edges));
+        attested.setASPAASNs(everyThird(as_count));
+        attested.initializeBGP();
+        attested.flattenGraph();
+        test::seedAnnouncements(attested, anns);
+        attested.propagateAnnouncements();
+        CHECK(test::exportRibs(plain, dir.file("plain.csv"), sorted) ==
+              test::exportRibs(attested, dir.file("attested.csv"), sorted));
+
+        // Every fourth record attests a wrong provider: deployers hold no invalid
+        // route, and both engines agree
+        std::vector<std::pair<ASN, ASN>> records = recordsOf(edges);
+        for (size_t i = 0; i < records.size(); i += 4) {
+            records[i].second += 1;
+        }
+
+        std::vector<std::string> outputs;
+        for (unsigned threads : {1u, 4u}) {
+            ASGraph graph;
+            test::addEdges(graph, edges);
+            graph.setASPA(records);
+            graph.setASPAASNs(everyThird(as_count));
+            graph.initializeBGP();
+            graph.flattenGraph();
+            test::seedAnnouncements(graph, anns);
+            graph.setPropagationThreads(threads);
+            graph.propagateAnnouncements();
+            outputs.push_back(test::exportRibs(graph, dir.file("forged.csv"), sorted));
+
+            const AspaTable& table = graph.getASPATable();
+            for (ASN asn : everyThird(as_count)) {
+                graph.getNode(asn)->policy->forEachRoute([&](const Prefix&, const Announcement& ann) {
+                    if (ann.received_from == RelationshipType::ORIGIN) return;
+                    // The stored path starts with the AS itself
+                    CHECK(table.verify(ann.as_path.data() + 1, ann.as_path.size() - 1,
+                                       ann.received_from) != AspaState::INVALID);
+                });
+            }
+        }
+        CHECK(outputs[0] == outputs[1]);
+        CHECK(outputs[0] != test::readFile(dir.file("plain.csv")));
+    }
+}
+
+int main() {
+    test::TempDir dir("aspa_test");
+    testVerdicts();
+    testDeployment();
+    testPropagation(dir);
+    return test::finish("aspa_test");
+}
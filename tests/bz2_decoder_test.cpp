@@ -0,0 +1,160 @@
+#include "bz2_decoder.h"
+#include "test_common.h"
+#include <bzlib.h>
+
+// bzip2 decoding: the parallel block decoder matches the serial one, also
+// when an end-of-stream magic occurs inside a block, and reports bad input
+
+namespace {
+    const uint64_t END_OF_STREAM_MAGIC = 0x177245385090ULL;
+
+    // Compress with 100k blocks, so a few hundred KB span several blocks
+    std::string compress(const std::string& text) {
+        std::vector<char> out(text.size() + text.size() / 100 + 600);
+        unsigned int out_len = static_cast<unsigned int>(out.size());
+        int ret = BZ2_bzBuffToBuffCompress(out.data(), &out_len, const_cast<char*>(text.data()),
+                                           static_cast<unsigned int>(text.size()), 1, 0, 30);
+        CHECK(ret == BZ_OK);
+        return std::string(out.data(), out_len);
+    }
+
+    bool decode(const std::string& compressed, unsigned threads, std::string& text, std::string* error) {
+        text.clear();
+        return decompressBz2Parallel(compressed.data(), compressed.size(),
+                                     [&text](const char* data, size_t len) {
+                                         text.append(data, len);
+                                         return true;
+                                     },
+                                     threads, error);
+    }
+
+    // Occurrences of the end-of-stream magic at any bit offset
+    size_t countEndOfStreamMagics(const std::string& data) {
+        size_t count = 0;
+        uint64_t window = 0;
+        for (size_t bit = 0; bit < data.size() * 8; bit++) {
+            window = ((window << 1) | ((static_cast<uint8_t>(data[bit / 8]) >> (7 - bit % 8)) & 1)) &
+                     0xFFFFFFFFFFFFULL;
+            if (bit >= 47 && window == END_OF_STREAM_MAGIC) count++;
+        }
+        return count;
+    }
+
+    // CSV-like text that compresses like the simulator's outputs
+    std::string rowsText(size_t rows, uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::string text;
+        for (size_t i = 0; i < rows; i++) {
+            text += std::to_string(rng() % 70000) + ",10." + std::to_string(rng() % 250) + ".0.0/16,\"(" +
+                    std::to_string(rng() % 70000) + ", " + std::to_string(rng() % 70000) + ")\"\n";
+        }
+        return text;
+    }
+
+    // Text whose every block uses exactly the bytes below. A block's symbol
+    // map starts with a 16-bit mask of the used 16-byte ranges, followed by
+    // a 16-bit mask for each of them: ranges 3, 5, 6, 7, 9, 10, 11 and 14
+    // give 0x1772, range 3 gives 0x4538 and range 5 gives 0x5090, which
+    // together spell the end-of-stream magic a few bytes into every block.
+    std::string fakeMagicText(size_t size, uint32_t seed) {
+        const unsigned char alphabet[] = {0x31, 0x35, 0x37, 0x3A, 0x3B, 0x3C,  // Range 3
+                                          0x51, 0x53, 0x58, 0x5B,              // Range 5
+                                          0x61, 0x71, 0x91, 0xA1, 0xB1, 0xE1};
+        std::mt19937 rng(seed);
+        std::string text;
+        while (text.size() < size) {
+            char c = static_cast<char>(alphabet[rng() % sizeof(alphabet)]);
+            // Runs of four would add run-length bytes to the symbol map
+            size_t n = text.size();
+            if (n >= 3 && text[n - 1] == c && text[n - 2] == c && text[n - 3] == c) continue;
+            text += c;
+        }
+        return text;
+    }
+
+    void testRoundTrip() {
+        std::string text = rowsText(40000, 141);
+        std::string compressed = compress(text);
+        std::string two_streams = compressed + compress(text.substr(0, 250000));
+
+        for (unsigned threads : {1u, 2u, 4u}) {
+            std::string out;
+            CHECK(decode(compressed, threads, out, nullptr));
+            CHECK(out == text);
+            CHECK(decode(two_streams, threads, out, nullptr));
+            CHECK(out == text + text.substr(0, 250000));
+        }
+
+        // Input in small chunks
+        Bz2StreamDecoder decoder(4096);
+        std::string out;
+        for (size_t at = 0; at < two_streams.size(); at += 777) {
+            CHECK(decoder.feed(two_streams.data() + at, std::min<size_t>(777, two_streams.size() - at),
+                               [&out](const char* data, size_t len) {
+                                   out.append(data, len);
+                                   return true;
+                               }));
+        }
+        CHECK(decoder.finish());
+        CHECK(out == text + text.substr(0, 250000));
+    }
+
+    // The parallel decoder cuts blocks at the fake magic; it must still give
+    // the serial output, also after other blocks were already delivered
+    void testFakeEndOfStream() {
+        std::string fake = fakeMagicText(350000, 142);
+        std::string fake_compressed = compress(fake);
+        CHECK(countEndOfStreamMagics(fake_compressed) >= 4);  // One per block, plus the real one
+
+        std::string rows = rowsText(20000, 143);
+        std::string mixed = compress(rows) + fake_compressed;
+
+        for (unsigned threads : {1u, 2u, 4u}) {
+            std::string out, error;
+            CHECK(decode(fake_compressed, threads, out, &error));
+            CHECK(out == fake);
+            CHECK(decode(mixed, threads, out, &error));
+            CHECK(out == rows + fake);
+            CHECK(error.empty());
+        }
+    }
+
+    void testBadInput() {
+        std::string text = rowsText(40000, 144);
+        std::string compressed = compress(text);
+
+        std::string damaged = compressed;
+        damaged[damaged.size() / 2] ^= 0x10;
+        std::string truncated = compressed.substr(0, compressed.size() - 100);
+
+        for (unsigned threads : {1u, 4u}) {
+            std::string out, error;
+            CHECK(!decode(damaged, threads, out, &error));
+            CHECK(!error.empty());
+            error.clear();
+            CHECK(!decode(truncated, threads, out, &error));
+            CHECK(!error.empty());
+        }
+
+        // A consumer that stops is not retried
+        for (unsigned threads : {1u, 4u}) {
+            size_t calls = 0;
+            std::string error;
+            CHECK(!decompressBz2Parallel(compressed.data(), compressed.size(),
+                                         [&calls](const char*, size_t) {
+                                             calls++;
+                                             return false;
+                                         },
+                                         threads, &error));
+            CHECK(calls == 1);
+            CHECK(error == "decoding aborted by consumer");
+        }
+    }
+}
+
+int main() {
+    testRoundTrip();
+    testFakeEndOfStream();
+    testBadInput();
+    return test::finish("bz2_decoder_test");
+}
@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+"""
+End-to-end test of caida_downloader against tests/caida_standin_server.py.
+
+Checks, for one published month:
+- a transfer cut off by the server (--drop-after) fails without falling back
+  to an earlier month and keeps the .part file
+- the rerun resumes it with a 206 and the output matches the source byte for byte
+- the next run is answered with a 304
+- a partial download whose source changed meanwhile is restarted (If-Range
+  mismatch -> 200) instead of being resumed
+
+Usage:
+    python3 tests/caida_downloader_test.py <path to caida_downloader>
+"""
+
+import bz2
+import os
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+SERVER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "caida_standin_server.py")
+DROP_AFTER = 64 * 1024
+
+failures = 0
+
+
+def check(condition, message):
+    global failures
+    if not condition:
+        print("CHECK failed: " + message, file=sys.stderr)
+        failures += 1
+
+
+def previous_month():
+    # Same month the downloader tries first (local time)
+    now = time.localtime()
+    year, month = now.tm_year, now.tm_mon - 1
+    if month == 0:
+        year, month = year - 1, 12
+    return "%04d%02d" % (year, month)
+
+
+def relationships(seed, lines=60000):
+    # CAIDA text that does not compress well, so the body spans many chunks
+    rng = random.Random(seed)
+    out = ["# source: caida_downloader_test"]
+    for _ in range(lines):
+        a = rng.randint(1, 400000)
+        b = rng.randint(1, 400000)
+        if a != b:
+            out.append("%d|%d|%d|bgp" % (a, b, rng.choice((-1, 0))))
+    return ("\n".join(out) + "\n").encode()
+
+
+def publish(root, text):
+    path = os.path.join(root, previous_month() + "01.as-rel2.txt.bz2")
+    with open(path, "wb") as f:
+        f.write(bz2.compress(text))
+    return path
+
+
+class Server:
+    def __init__(self, root, drop_after=None, port=0):
+        cmd = [sys.executable, SERVER, "--root", root, "--port", str(port)]
+        if drop_after is not None:
+            cmd += ["--drop-after", str(drop_after)]
+        self.proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True)
+        banner = self.proc.stdout.readline()
+        self.url = banner.rsplit(" ", 1)[-1].strip()
+        self.port = int(self.url.rstrip("/").rsplit(":", 1)[-1])
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.proc.terminate()
+        self.proc.wait()
+
+
+def run(downloader, workdir, url):
+    result = subprocess.run([downloader, "--base-url", url, "--months", "2"], cwd=workdir,
+                            stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    return result.returncode, result.stdout
+
+
+def read(path):
+    with open(path, "rb") as f:
+        return f.read()
+
+
+def test_resume_and_revalidate(downloader, tmp):
+    root = os.path.join(tmp, "resume_root")
+    workdir = os.path.join(tmp, "resume_work")
+    os.makedirs(root)
+    os.makedirs(workdir)
+    text = relationships(1)
+    remote = os.path.basename(publish(root, text))
+    part = os.path.join(workdir, remote + ".part")
+    output = os.path.join(workdir, "as-rel.txt")
+
+    with Server(root, drop_after=DROP_AFTER) as server:
+        code, out = run(downloader, workdir, server.url)
+        check(code != 0, "interrupted download reports failure")
+        check("trying earlier month" not in out, "interrupted download does not fall back:\n" + out)
+        check(os.path.isfile(part) and os.path.isfile(part + ".meta"), "partial download is kept")
+        check(not os.path.exists(output), "no output after an interrupted download")
+
+        # Ranged requests are not dropped, so the rerun completes
+        code, out = run(downloader, workdir, server.url)
+        check(code == 0, "resumed download succeeds:\n" + out)
+        check("Resuming partial download at byte" in out and "(resumed)" in out,
+              "rerun resumes with a 206:\n" + out)
+        check(os.path.isfile(output) and read(output) == text, "output matches the source byte for byte")
+        check(not os.path.exists(part) and not os.path.exists(part + ".meta"), "partial files are removed")
+
+        code, out = run(downloader, workdir, server.url)
+        check(code == 0 and "HTTP 304" in out, "current copy is revalidated with a 304:\n" + out)
+        check(read(output) == text, "304 leaves the output untouched")
+
+
+def test_changed_source(downloader, tmp):
+    root = os.path.join(tmp, "changed_root")
+    workdir = os.path.join(tmp, "changed_work")
+    os.makedirs(root)
+    os.makedirs(workdir)
+    publish(root, relationships(2))
+    output = os.path.join(workdir, "as-rel.txt")
+
+    with Server(root, drop_after=DROP_AFTER) as server:
+        code, _ = run(downloader, workdir, server.url)
+        check(code != 0, "interrupted download reports failure")
+        port = server.port
+
+    # New content and a later mtime: both validators change
+    text = relationships(3)
+    path = publish(root, text)
+    later = time.time() + 60
+    os.utime(path, (later, later))
+
+    # Same URL, so the partial download is offered for resuming
+    with Server(root, port=port) as server:
+        code, out = run(downloader, workdir, server.url)
+        check(code == 0, "download after the source changed succeeds:\n" + out)
+        check("Resuming partial download" in out and "(resumed)" not in out,
+              "If-Range mismatch restarts with a 200:\n" + out)
+        check(os.path.isfile(output) and read(output) == text, "output matches the changed source")
+
+
+def main():
+    if len(sys.argv) != 2:
+        print(__doc__.strip().splitlines()[-1].strip(), file=sys.stderr)
+        return 2
+    downloader = os.path.abspath(sys.argv[1])
+
+    tmp = tempfile.mkdtemp(prefix="caida_downloader_test_")
+    try:
+        test_resume_and_revalidate(downloader, tmp)
+        test_changed_source(downloader, tmp)
+    finally:
+        shutil.rmtree(tmp, ignore_errors=True)
+
+    if failures:
+        print("caida_downloader_test: %d checks failed" % failures, file=sys.stderr)
+        return 1
+    print("caida_downloader_test: all checks passed")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+"""
+Local stand-in for the CAIDA dataset server, for testing caida_downloader.
+
+Serves files from a directory with the HTTP features the downloader relies on:
+- ETag / Last-Modified validators
+- If-None-Match / If-Modified-Since (304 Not Modified)
+- Range + If-Range (206 Partial Content)
+
+Usage:
+    python3 tests/caida_standin_server.py --root <dir> [--port 8000 (0: any free port)]
+        [--drop-after <bytes>] [--rate <bytes/sec>]
+
+    --drop-after closes the connection after sending that many body bytes
+    of a full (200) response, to exercise resumable downloads.
+    --rate throttles body bytes to emulate a slow network link.
+
+Example:
+    mkdir -p /tmp/caida && bzip2 -c tests/test_mini_graph.txt \\
+        > /tmp/caida/$(date -d "-1 month" +%Y%m)01.as-rel2.txt.bz2
+    python3 tests/caida_standin_server.py --root /tmp/caida &
+    ./caida_downloader --base-url http://127.0.0.1:8000/
+"""
+
+import argparse
+import email.utils
+import hashlib
+import os
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+
+class StandinHandler(BaseHTTPRequestHandler):
+    root = "."
+    drop_after = None
+    rate = None
+
+    def _resolve(self):
+        name = os.path.basename(self.path.split("?", 1)[0])
+        path = os.path.join(self.root, name)
+        return path if name and os.path.isfile(path) else None
+
+    def _validators(self, path):
+        stat = os.stat(path)
+        with open(path, "rb") as f:
+            etag = '"%s"' % hashlib.sha1(f.read()).hexdigest()
+        last_modified = email.utils.formatdate(stat.st_mtime, usegmt=True)
+        return etag, last_modified, stat.st_mtime
+
+    def _not_modified(self, etag, mtime):
+        if_none_match = self.headers.get("If-None-Match")
+        if if_none_match is not None:
+            return etag in [t.strip() for t in if_none_match.split(",")]
+        if_modified_since = self.headers.get("If-Modified-Since")
+        if if_modified_since:
+            since = email.utils.parsedate_to_datetime(if_modified_since).timestamp()
+            return int(mtime) <= int(since)
+        return False
+
+    def _range_start(self, etag, last_modified, size):
+        range_header = self.headers.get("Range", "")
+        if not range_header.startswith("bytes=") or not range_header.endswith("-"):
+            return None
+        if_range = self.headers.get("If-Range")
+        if if_range is not None and if_range not in (etag, last_modified):
+            return None  # Representation changed: send the full body
+        start = int(range_header[len("bytes="):-1])
+        return start if 0 <= start < size else None
+
+    def _send_body(self, data, allow_drop):
+        sent = 0
+        chunk = 16384
+        while sent < len(data):
+            if allow_drop and self.drop_after is not None and sent >= self.drop_after:
+                self.close_connection = True
+                return
+            piece = data[sent:sent + chunk]
+            self.wfile.write(piece)
+            sent += len(piece)
+            if self.rate:
+                time.sleep(len(piece) / self.rate)
+
+    def _handle(self, send_body):
+        path = self._resolve()
+        if path is None:
+            self.send_error(404)
+            return
+
+        etag, last_modified, mtime = self._validators(path)
+        if self._not_modified(etag, mtime):
+            self.send_response(304)
+            self.send_header("ETag", etag)
+            self.send_header("Last-Modified", last_modified)
+            self.end_headers()
+            return
+
+        with open(path, "rb") as f:
+            data = f.read()
+
+        start = self._range_start(etag, last_modified, len(data))
+        if start is not None:
+            body = data[start:]
+            self.send_response(206)
+            self.send_header("Content-Range", "bytes %d-%d/%d" % (start, len(data) - 1, len(data)))
+        else:
+            body = data
+            self.send_response(200)
+
+        self.send_header("Content-Length", str(len(body)))
+        self.send_header("ETag", etag)
+        self.send_header("Last-Modified", last_modified)
+        self.send_header("Accept-Ranges", "bytes")
+        self.end_headers()
+
+        if send_body:
+            self._send_body(body, allow_drop=(start is None))
+
+    def do_GET(self):
+        self._handle(send_body=True)
+
+    def do_HEAD(self):
+        self._handle(send_body=False)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("--root", required=True, help="Directory of files to serve")
+    parser.add_argument("--port", type=int, default=8000)
+    parser.add_argument("--drop-after", type=int, default=None)
+    parser.add_argument("--rate", type=float, default=None)
+    args = parser.parse_args()
+
+    StandinHandler.root = args.root
+    StandinHandler.drop_after = args.drop_after
+    StandinHandler.rate = args.rate
+
+    server = ThreadingHTTPServer(("127.0.0.1", args.port), StandinHandler)
+    port = server.server_address[1]  # --port 0 picks a free port
+    print("Serving %s on http://127.0.0.1:%d/" % (args.root, port), flush=True)
+    server.serve_forever()
+
+
+if __name__ == "__main__":
+    main()
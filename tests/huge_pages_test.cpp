@@ -0,0 +1,115 @@
+#include "huge_pages.h"
+#include "test_common.h"
+#include <thread>
+
+// Huge-page pool allocator: objects are distinct, freed memory is reused
+// across threads, and short-lived threads hand their caches back
+
+namespace {
+    const size_t OBJECT = 1000;     // In the largest pooled size class
+    const size_t SMALL = 40;
+
+    // Each object holds its own address, so overlapping objects are detected
+    std::vector<void*> allocateFilled(size_t count, size_t bytes) {
+        std::vector<void*> objects;
+        for (size_t i = 0; i < count; i++) {
+            void* p = hugePageAllocate(bytes);
+            std::memset(p, static_cast<int>(i & 0xFF), bytes);
+            *static_cast<void**>(p) = p;
+            objects.push_back(p);
+        }
+        return objects;
+    }
+
+    bool intact(const std::vector<void*>& objects) {
+        for (void* p : objects) {
+            if (*static_cast<void**>(p) != p) return false;
+        }
+        return true;
+    }
+
+    void freeAll(const std::vector<void*>& objects, size_t bytes) {
+        for (void* p : objects) {
+            hugePageFree(p, bytes);
+        }
+    }
+
+    // Threads that each allocate and free 32 MB, one after another, reuse
+    // the same memory instead of mapping a region each
+    void testSequentialThreads() {
+        const size_t count = 32 * 1024;
+        uint64_t before = getHugePageStats().transparent_bytes;
+        uint64_t after_first = 0;
+        for (int t = 0; t < 4; t++) {
+            std::thread worker([&] {
+                std::vector<void*> objects = allocateFilled(count, OBJECT);
+                CHECK(intact(objects));
+                freeAll(objects, OBJECT);
+            });
+            worker.join();
+            if (t == 0) after_first = getHugePageStats().transparent_bytes;
+        }
+        CHECK(after_first > before);
+        CHECK(getHugePageStats().transparent_bytes == after_first);
+    }
+
+    // A thread's cached objects go back to the shared pool when it exits
+    void testExitFlush() {
+        std::vector<void*> freed;
+        std::thread worker([&] {
+            freed = allocateFilled(10, SMALL);
+            freeAll(freed, SMALL);
+        });
+        worker.join();
+
+        // The worker's batch (64 objects) is the next one handed out
+        std::vector<void*> reused = allocateFilled(64, SMALL);
+        for (void* p : freed) {
+            CHECK(std::find(reused.begin(), reused.end(), p) != reused.end());
+        }
+        freeAll(reused, SMALL);
+    }
+
+    // Objects allocated on one thread and freed on another stay distinct and
+    // usable, and the memory is reused afterwards
+    void testCrossThread() {
+        const size_t per_thread = 20000;
+        std::vector<std::vector<void*>> objects(4);
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < objects.size(); t++) {
+            workers.emplace_back([&, t] { objects[t] = allocateFilled(per_thread, SMALL); });
+        }
+        for (std::thread& worker : workers) worker.join();
+
+        std::vector<void*> all;
+        for (const auto& list : objects) {
+            CHECK(intact(list));
+            all.insert(all.end(), list.begin(), list.end());
+        }
+        std::sort(all.begin(), all.end());
+        CHECK(std::adjacent_find(all.begin(), all.end()) == all.end());
+        for (size_t i = 1; i < all.size(); i++) {
+            CHECK(static_cast<char*>(all[i]) - static_cast<char*>(all[i - 1]) >= static_cast<ptrdiff_t>(SMALL));
+        }
+
+        workers.clear();
+        for (size_t t = 0; t < objects.size(); t++) {
+            workers.emplace_back([&, t] { freeAll(objects[(t + 1) % objects.size()], SMALL); });
+        }
+        for (std::thread& worker : workers) worker.join();
+
+        uint64_t mapped = getHugePageStats().transparent_bytes;
+        std::vector<void*> again = allocateFilled(objects.size() * per_thread, SMALL);
+        CHECK(intact(again));
+        CHECK(getHugePageStats().transparent_bytes == mapped);
+        freeAll(again, SMALL);
+    }
+}
+
+int main() {
+    CHECK(setHugePageMode(HugePageMode::TRANSPARENT));
+    testSequentialThreads();
+    testExitFlush();
+    testCrossThread();
+    return test::finish("huge_pages_test");
+}
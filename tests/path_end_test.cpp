@@ -0,0 +1,147 @@
+#include "bgp_policy.h"
+#include "path_end.h"
+#include "test_common.h"
+
+// Path-end validation: verdicts, deployment during propagation
+
+namespace {
+    PathEndState check(const PathEndTable& table, std::vector<ASN> path) {
+        return table.check(path.data(), path.size());
+    }
+
+    // Records: origin 5 -> {10, 20}, origin 6 with no neighbors (AS0 record)
+    void testVerdicts() {
+        PathEndTable table;
+        CHECK(check(table, {10, 5}) == PathEndState::UNKNOWN);  // No records at all
+
+        table.assign({{5, 10}, {5, 20}, {6, 0}});
+        CHECK(table.getOriginCount() == 2);
+        CHECK(table.getNeighborCount() == 2);
+
+        CHECK(check(table, {5}) == PathEndState::VALID);
+        CHECK(check(table, {10, 5}) == PathEndState::VALID);
+        CHECK(check(table, {40, 20, 5}) == PathEndState::VALID);   // Only the last hop counts
+        CHECK(check(table, {30, 5}) == PathEndState::INVALID);     // Forged origin
+        CHECK(check(table, {10, 30, 5}) == PathEndState::INVALID);
+        CHECK(check(table, {10, 6}) == PathEndState::INVALID);
+        CHECK(check(table, {10, 7}) == PathEndState::UNKNOWN);     // Origin without a record
+
+        CHECK(std::string(pathEndStateName(PathEndState::INVALID)) == "invalid");
+    }
+
+    Prefix prefixOf() { return Prefix::parse("10.5.0.0/16"); }
+
+    // Origin 5 lists only 40 but is also a customer of 30. 200 is a provider of
+    // both 30 and 40; 300 sits above 50, which sits above 30.
+    void buildScenario(ASGraph& graph, const std::unordered_set<ASN>& deployers) {
+        graph.addRelationship(40, 5, RelationType::CUSTOMER);
+        graph.addRelationship(30, 5, RelationType::CUSTOMER);
+        graph.addRelationship(200, 30, RelationType::CUSTOMER);
+        graph.addRelationship(200, 40, RelationType::CUSTOMER);
+        graph.addRelationship(50, 30, RelationType::CUSTOMER);
+        graph.addRelationship(300, 50, RelationType::CUSTOMER);
+        graph.setPathEnd({{5, 40}});
+        graph.setPathEndASNs(deployers);
+        graph.initializeBGP();
+        graph.flattenGraph();
+        graph.seedAnnouncement(5, "10.5.0.0/16");
+        graph.propagateAnnouncements();
+    }
+
+    void testDeployment() {
+        ASGraph plain;
+        buildScenario(plain, {});
+        CHECK(plain.getNode(200)->policy->getAnnouncement(prefixOf())->next_hop_asn == 30);
+        CHECK(plain.getNode(300)->policy->getAnnouncement(prefixOf()) != nullptr);
+
+        ASGraph deployed;
+        buildScenario(deployed, {200, 300});
+        // 200 prefers the valid route through 40 over the lower next hop 30
+        CHECK(deployed.getNode(200)->policy->getAnnouncement(prefixOf())->next_hop_asn == 40);
+        // 300 only hears [50, 30, 5] through a non-deployer and drops it
+        CHECK(deployed.getNode(300)->policy->getAnnouncement(prefixOf()) == nullptr);
+        CHECK(deployed.getNode(50)->policy->getAnnouncement(prefixOf()) != nullptr);
+    }
+
+    // Path-end records of every AS: all of its neighbors
+    std::vector<std::pair<ASN, ASN>> recordsOf(const std::vector<GraphEdge>& edges) {
+        std::vector<std::pair<ASN, ASN>> pairs;
+        for (const GraphEdge& e : edges) {
+            pairs.push_back({e.as1, e.as2});
+            pairs.push_back({e.as2, e.as1});
+        }
+        return pairs;
+    }
+
+    std::unordered_set<ASN> everyThird(size_t as_count) {
+        std::unordered_set<ASN> asns;
+        for (ASN asn = 2; asn <= as_count; asn += 3) {
+            asns.insert(asn);
+        }
+        return asns;
+    }
+
+    void runWithRecords(ASGraph& graph, const std::vector<GraphEdge>& edges,
+                        const std::vector<std::pair<ASN, ASN>>& records, const std::string& anns,
+                        unsigned threads) {
+        test::addEdges(graph, edges);
+        graph.setPathEnd(records);
+        graph.setPathEndASNs(everyThird(graph.getNodeCount()));
+        graph.initializeBGP();
+        graph.flattenGraph();
+        test::seedAnnouncements(graph, anns);
+        graph.setPropagationThreads(threads);
+        graph.propagateAnnouncements();
+    }
+
+    void testPropagation(const test::TempDir& dir) {
+        const size_t as_count = 500;
+        std::vector<GraphEdge> edges = test::makeTopology(as_count, 81);
+        std::string anns = test::announcementsCsv(as_count, 60, 82);
+        RibExportOptions sorted;
+        sorted.sorted = true;
+
+        // Complete records: nothing is dropped
+        ASGraph plain, complete;
+        test::buildGraph(plain, as_count, 81);
+        test::seedAnnouncements(plain, anns);
+        plain.propagateAnnouncements();
+        runWithRecords(complete, edges, recordsOf(edges), anns, 1);
+        std::string expected = test::exportRibs(plain, dir.file("plain.csv"), sorted);
+        CHECK(test::exportRibs(complete, dir.file("complete.csv"), sorted) == expected);
+
+        // Every fifth neighbor left out: deployers hold no invalid route, and
+        // both engines agree
+        std::vector<std::pair<ASN, ASN>> records = recordsOf(edges);
+        std::vector<std::pair<ASN, ASN>> partial;
+        for (size_t i = 0; i < records.size(); i++) {
+            if (i % 5 != 0) partial.push_back(records[i]);
+        }
+
+        std::vector<std::string> outputs;
+        for (unsigned threads : {1u, 4u}) {
+            ASGraph graph;
+            runWithRecords(graph, edges, partial, anns, threads);
+            outputs.push_back(test::exportRibs(graph, dir.file("partial.csv"), sorted));
+
+            const PathEndTable& table = graph.getPathEndTable();
+            for (ASN asn : everyThird(as_count)) {
+                graph.getNode(asn)->policy->forEachRoute([&](const Prefix&, const Announcement& ann) {
+                    // The stored path starts with the AS itself
+                    CHECK(table.check(ann.as_path.data() + 1, ann.as_path.size() - 1) !=
+                          PathEndState::INVALID);
+                });
+            }
+        }
+        CHECK(outputs[0] == outputs[1]);
+        CHECK(outputs[0] != expected);
+    }
+}
+
+int main() {
+    test::TempDir dir("path_end_test");
+    testVerdicts();
+    testDeployment();
+    testPropagation(dir);
+    return test::finish("path_end_test");
+}
@@ -0,0 +1,106 @@
+#include "test_common.h"
+
+// Propagation engines: every thread count yields the serial engine's RIBs
+
+namespace {
+    const size_t AS_COUNT = 600;
+
+    // Graph with ROV deployed at every tenth AS, seeded with IPv4 and IPv6 prefixes
+    void buildScenario(ASGraph& graph, const test::TempDir& dir) {
+        std::string rov_file = dir.file("rov.txt");
+        std::string rov;
+        for (size_t asn = 10; asn <= AS_COUNT; asn += 10) {
+            rov += std::to_string(asn) + "\n";
+        }
+        test::writeFile(rov_file, rov);
+
+        graph.loadROVASNs(rov_file);
+        test::buildGraph(graph, AS_COUNT, 21);
+        test::seedAnnouncements(graph, test::announcementsCsv(AS_COUNT, 60, 22));
+        test::seedAnnouncements(graph, test::announcementsCsv(AS_COUNT, 20, 23, true));
+    }
+
+    void testSerialMatchesParallel(const test::TempDir& dir) {
+        ASGraph serial;
+        buildScenario(serial, dir);
+        serial.setPropagationThreads(1);
+        size_t propagated = serial.propagateAnnouncements();
+        test::exportRibs(serial, dir.file("serial.csv"));
+        std::vector<std::string> expected = test::sortedLines(dir.file("serial.csv"));
+        CHECK(expected.size() > AS_COUNT);
+
+        for (unsigned threads : {2u, 4u, 0u}) {
+            ASGraph parallel;
+            buildScenario(parallel, dir);
+            parallel.setPropagationThreads(threads);
+            CHECK(parallel.propagateAnnouncements() == propagated);
+
+            std::string csv = dir.file("parallel_" + std::to_string(threads) + ".csv");
+            test::exportRibs(parallel, csv);
+            CHECK(test::sortedLines(csv) == expected);
+        }
+    }
+
+    // A reset graph propagates the same RIBs again
+    void testRepeatedRuns(const test::TempDir& dir) {
+        ASGraph graph;
+        buildScenario(graph, dir);
+        graph.setPropagationThreads(4);
+        graph.propagateAnnouncements();
+        test::exportRibs(graph, dir.file("first.csv"));
+
+        graph.resetRoutingState();
+        test::seedAnnouncements(graph, test::announcementsCsv(AS_COUNT, 60, 22));
+        test::seedAnnouncements(graph, test::announcementsCsv(AS_COUNT, 20, 23, true));
+        graph.setPropagationThreads(1);
+        graph.propagateAnnouncements();
+        test::exportRibs(graph, dir.file("second.csv"));
+
+        CHECK(test::sortedLines(dir.file("first.csv")) == test::sortedLines(dir.file("second.csv")));
+    }
+
+    // With vantage points, their RIBs match a full run and every other RIB is freed
+    void testVantagePoints(const test::TempDir& dir) {
+        std::unordered_set<ASN> vantage = {1, 2, AS_COUNT - 1, AS_COUNT};
+        for (ASN asn = 13; asn <= AS_COUNT; asn += 13) vantage.insert(asn);
+
+        ASGraph full;
+        buildScenario(full, dir);
+        full.setPropagationThreads(1);
+        full.propagateAnnouncements();
+        test::exportRibs(full, dir.file("full.csv"));
+        std::vector<std::string> all = test::sortedLines(dir.file("full.csv"));
+        all.pop_back();  // Header, which sorts last
+        std::vector<std::string> expected;
+        for (const std::string& row : all) {
+            if (vantage.count(static_cast<ASN>(std::stoul(row.substr(0, row.find(',')))))) {
+                expected.push_back(row);
+            }
+        }
+        CHECK(!expected.empty() && expected.size() < all.size());
+
+        for (unsigned threads : {1u, 3u}) {
+            ASGraph graph;
+            buildScenario(graph, dir);
+            graph.setVantagePoints(vantage);
+            graph.setPropagationThreads(threads);
+            graph.propagateAnnouncements();
+
+            std::string csv = dir.file("vantage_" + std::to_string(threads) + ".csv");
+            test::exportRibs(graph, csv);
+            std::vector<std::string> rows = test::sortedLines(csv);
+            rows.pop_back();
+            CHECK(rows == expected);
+            CHECK(graph.getReleasedRouteCount() > 0);
+            CHECK(graph.getReleasedRouteCount() == all.size() - expected.size());
+        }
+    }
+}
+
+int main() {
+    test::TempDir dir("propagation_test");
+    testSerialMatchesParallel(dir);
+    testRepeatedRuns(dir);
+    testVantagePoints(dir);
+    return test::finish("propagation_test");
+}
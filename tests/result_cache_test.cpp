@@ -0,0 +1,93 @@
+#include "result_cache.h"
+#include "test_common.h"
+
+// Result cache: key normalization and hit/miss behavior
+
+namespace {
+    // Graph over the same topology with the given seeds and ROV file
+    void buildSeeded(ASGraph& graph, const std::string& anns, const std::string& rov_file) {
+        test::buildGraph(graph, 200, 7);
+        if (!rov_file.empty()) {
+            graph.loadROVASNs(rov_file);
+        }
+        test::seedAnnouncements(graph, anns);
+    }
+
+    void testKeyNormalization(const test::TempDir& dir) {
+        std::string rov_a = dir.file("rov_a.txt");
+        std::string rov_b = dir.file("rov_b.txt");
+        test::writeFile(rov_a, "5\n17\n42\n");
+        test::writeFile(rov_b, "42\n5\n17\n5\n");
+
+        std::string header = "seed_asn,prefix,rov_invalid\n";
+        std::string anns = header + "10,10.1.0.0/16,False\n20,10.2.0.0/16,True\n";
+        std::string reordered = header + "20,10.2.0.0/16,True\n10,10.1.0.0/16,False\n";
+
+        ASGraph a, b, invalid, no_rov;
+        buildSeeded(a, anns, rov_a);
+        buildSeeded(b, reordered, rov_b);
+        buildSeeded(invalid, header + "10,10.1.0.0/16,True\n20,10.2.0.0/16,True\n", rov_a);
+        buildSeeded(no_rov, anns, "");
+
+        std::string fp = a.fingerprint().toHex();
+        CHECK(fp == b.fingerprint().toHex());
+
+        std::string key = ResultCache::makeKey(a, fp, "csv");
+        CHECK(key.size() == 32);
+        CHECK(key == ResultCache::makeKey(a, fp, "csv"));
+
+        // Seed and ROV order (and duplicates) do not matter
+        CHECK(key == ResultCache::makeKey(b, fp, "csv"));
+
+        // Every input does
+        CHECK(key != ResultCache::makeKey(invalid, fp, "csv"));
+        CHECK(key != ResultCache::makeKey(no_rov, fp, "csv"));
+        CHECK(key != ResultCache::makeKey(a, fp, "summary"));
+        CHECK(key != ResultCache::makeKey(a, std::string(32, '0'), "csv"));
+
+        a.setRouteSelection(RouteSelection::LOWEST_ORIGIN);
+        CHECK(key != ResultCache::makeKey(a, fp, "csv"));
+        a.setRouteSelection(RouteSelection::STANDARD);
+        CHECK(key == ResultCache::makeKey(a, fp, "csv"));
+
+        a.setVantagePoints({1, 2, 3});
+        CHECK(key != ResultCache::makeKey(a, fp, "csv"));
+    }
+
+    void testHitAndMiss(const test::TempDir& dir) {
+        ResultCache cache(dir.file("cache"), 1024);
+        std::string output = dir.file("out.csv");
+        std::string restored = dir.file("restored.csv");
+
+        CHECK(!cache.lookup("k1", restored));
+        CHECK(cache.getSizeBytes() == 0);
+
+        test::writeFile(output, std::string(400, 'a'));
+        CHECK(cache.store("k1", output));
+        CHECK(cache.lookup("k1", restored));
+        CHECK(test::readFile(restored) == std::string(400, 'a'));
+        CHECK(!cache.lookup("k2", restored));
+
+        // Over the limit the least recently used entry goes first
+        test::writeFile(output, std::string(400, 'b'));
+        CHECK(cache.store("k2", output));
+        std::filesystem::last_write_time(dir.file("cache/k1.out"),
+                                         std::filesystem::file_time_type::clock::now() -
+                                             std::chrono::hours(1));
+        test::writeFile(output, std::string(400, 'c'));
+        CHECK(cache.store("k3", output));
+
+        CHECK(!cache.lookup("k1", restored));
+        CHECK(cache.lookup("k2", restored));
+        CHECK(test::readFile(restored) == std::string(400, 'b'));
+        CHECK(cache.lookup("k3", restored));
+        CHECK(cache.getSizeBytes() <= 1024);
+    }
+}
+
+int main() {
+    test::TempDir dir("result_cache_test");
+    testKeyNormalization(dir);
+    testHitAndMiss(dir);
+    return test::finish("result_cache_test");
+}
@@ -0,0 +1,243 @@
+#include "rib_diff.h"
+#include "rib_export.h"
+#include "test_common.h"
+
+// RIB diff: every range split and thread count gives the changes of an
+// in-memory merge of the two sorted exports; unsorted input is rejected
+
+namespace {
+    const size_t AS_COUNT = 1500;
+    const std::string DIFF_HEADER = "change,asn,prefix,old_as_path,new_as_path";
+
+    struct Row {
+        ASN asn = 0;
+        Prefix prefix;
+        std::string prefix_text;
+        std::string path_text;
+        std::vector<ASN> path;
+    };
+
+    // The base topology with edges removed, relationships changed and ten
+    // new ASes added (providers stay below customers)
+    std::vector<GraphEdge> changedTopology(const std::vector<GraphEdge>& edges) {
+        std::vector<GraphEdge> next;
+        for (size_t i = 0; i < edges.size(); i++) {
+            GraphEdge e = edges[i];
+            if (i % 17 == 5) continue;
+            if (i % 23 == 7) {
+                e.rel = e.rel == RelationType::PEER ? RelationType::CUSTOMER : RelationType::PEER;
+            }
+            next.push_back(e);
+        }
+        for (ASN asn = AS_COUNT + 1; asn <= AS_COUNT + 10; asn++) {
+            next.push_back({asn - 1000, asn, RelationType::CUSTOMER});
+            next.push_back({asn - 500, asn, RelationType::CUSTOMER});
+        }
+        return next;
+    }
+
+    // Old run: 36 IPv4 and 6 IPv6 prefixes; new run: the changed topology,
+    // the same IPv4 seeds plus four more prefixes and no IPv6 prefixes
+    void buildRun(ASGraph& graph, bool changed) {
+        std::vector<GraphEdge> edges = test::makeTopology(AS_COUNT, 131);
+        test::addEdges(graph, changed ? changedTopology(edges) : edges);
+        graph.initializeBGP();
+        graph.flattenGraph();
+        test::seedAnnouncements(graph, test::announcementsCsv(AS_COUNT, changed ? 40 : 36, 132));
+        if (!changed) {
+            test::seedAnnouncements(graph, test::announcementsCsv(AS_COUNT, 6, 133, true));
+        }
+        graph.propagateAnnouncements();
+    }
+
+    std::vector<Row> readRows(const std::string& text) {
+        std::vector<Row> rows;
+        std::istringstream in(text);
+        std::string line;
+        std::getline(in, line);
+        while (std::getline(in, line)) {
+            size_t first = line.find(',');
+            size_t second = line.find(',', first + 1);
+            Row row;
+            row.asn = static_cast<ASN>(std::stoul(line.substr(0, first)));
+            row.prefix_text = line.substr(first + 1, second - first - 1);
+            row.prefix = Prefix::parse(row.prefix_text);
+            row.path_text = line.substr(second + 1);
+
+            std::string digits;
+            for (char c : row.path_text + ",") {
+                if (c >= '0' && c <= '9') {
+                    digits += c;
+                } else if (!digits.empty()) {
+                    row.path.push_back(static_cast<ASN>(std::stoul(digits)));
+                    digits.clear();
+                }
+            }
+            rows.push_back(row);
+        }
+        return rows;
+    }
+
+    bool keyLess(const Row& a, const Row& b) {
+        if (a.asn != b.asn) return a.asn < b.asn;
+        return prefixLess(a.prefix, b.prefix);
+    }
+
+    ASN nextHop(const Row& row) { return row.path.size() > 1 ? row.path[1] : 0; }
+
+    // Expected output and counts, by merging the sorted rows in memory
+    std::string expectedDiff(const std::vector<Row>& old_rows, const std::vector<Row>& new_rows,
+                             RibDiffCounts& counts) {
+        std::string out = DIFF_HEADER + "\n";
+        counts = RibDiffCounts();
+        counts.old_rows = old_rows.size();
+        counts.new_rows = new_rows.size();
+
+        auto append = [&out](const char* change, const Row& key, const Row* old_row, const Row* new_row) {
+            out += std::string(change) + "," + std::to_string(key.asn) + "," + key.prefix_text + "," +
+                   (old_row ? old_row->path_text : "") + "," + (new_row ? new_row->path_text : "") + "\n";
+        };
+
+        size_t o = 0, n = 0;
+        while (o < old_rows.size() || n < new_rows.size()) {
+            if (n == new_rows.size() || (o < old_rows.size() && keyLess(old_rows[o], new_rows[n]))) {
+                counts.removed++;
+                append("removed", old_rows[o], &old_rows[o], nullptr);
+                o++;
+            } else if (o == old_rows.size() || keyLess(new_rows[n], old_rows[o])) {
+                counts.added++;
+                append("added", new_rows[n], nullptr, &new_rows[n]);
+                n++;
+            } else {
+                const Row& a = old_rows[o++];
+                const Row& b = new_rows[n++];
+                if (a.path_text == b.path_text) {
+                    counts.unchanged++;
+                } else if (a.path.back() != b.path.back()) {
+                    counts.origin_changed++;
+                    append("origin", a, &a, &b);
+                } else if (nextHop(a) != nextHop(b)) {
+                    counts.next_hop_changed++;
+                    append("next_hop", a, &a, &b);
+                } else {
+                    counts.path_changed++;
+                    append("path", a, &a, &b);
+                }
+            }
+        }
+        return out;
+    }
+
+    bool sameCounts(const RibDiffCounts& a, const RibDiffCounts& b) {
+        return a.old_rows == b.old_rows && a.new_rows == b.new_rows && a.unchanged == b.unchanged &&
+               a.added == b.added && a.removed == b.removed && a.origin_changed == b.origin_changed &&
+               a.next_hop_changed == b.next_hop_changed && a.path_changed == b.path_changed;
+    }
+
+    // Single CSVs and a shard manifest, split into 1, 12 and 16 key ranges
+    void testDiff(const test::TempDir& dir) {
+        ASGraph old_graph, new_graph;
+        buildRun(old_graph, false);
+        buildRun(new_graph, true);
+
+        RibExportOptions sorted;
+        sorted.sorted = true;
+        std::string old_text = test::exportRibs(old_graph, dir.file("old.csv"), sorted);
+        std::string new_text = test::exportRibs(new_graph, dir.file("new.csv"), sorted);
+
+        RibExportOptions shards = sorted;
+        shards.shards = 4;
+        shards.shard_key = ShardKey::ASN_RANGE;
+        std::filesystem::create_directories(dir.path() / "shards");
+        CHECK(exportRibShards(new_graph, dir.file("shards/new.csv"), shards));
+        std::string manifest = shardManifestPath(dir.file("shards/new.csv"));
+
+        RibDiffCounts expected_counts;
+        std::string expected = expectedDiff(readRows(old_text), readRows(new_text), expected_counts);
+        CHECK(expected_counts.added > 0 && expected_counts.removed > 0);
+        CHECK(expected_counts.origin_changed > 0 && expected_counts.next_hop_changed > 0);
+        CHECK(expected_counts.path_changed > 0 && expected_counts.unchanged > 0);
+
+        for (const std::string& new_input : {dir.file("new.csv"), manifest}) {
+            for (unsigned threads : {1u, 3u, 4u}) {
+                RibDiffOptions options;
+                options.threads = threads;
+                RibDiffCounts counts;
+                CHECK(diffRibOutputs(dir.file("old.csv"), new_input, dir.file("diff.csv"), options, counts));
+                CHECK(sameCounts(counts, expected_counts));
+                CHECK(test::readFile(dir.file("diff.csv")) == expected);
+
+                // Counts only
+                options.write_rows = false;
+                RibDiffCounts summary;
+                CHECK(diffRibOutputs(dir.file("old.csv"), new_input, dir.file("summary.csv"), options, summary));
+                CHECK(sameCounts(summary, expected_counts));
+                CHECK(!std::filesystem::exists(dir.file("summary.csv")));
+            }
+        }
+
+        // Reversed inputs swap added and removed
+        RibDiffCounts reversed_counts;
+        std::string reversed = expectedDiff(readRows(new_text), readRows(old_text), reversed_counts);
+        RibDiffOptions options;
+        options.threads = 4;
+        RibDiffCounts counts;
+        CHECK(diffRibOutputs(manifest, dir.file("old.csv"), dir.file("diff.csv"), options, counts));
+        CHECK(sameCounts(counts, reversed_counts));
+        CHECK(counts.added == expected_counts.removed && counts.removed == expected_counts.added);
+        CHECK(test::readFile(dir.file("diff.csv")) == reversed);
+
+        // Identical inputs
+        CHECK(diffRibOutputs(dir.file("new.csv"), manifest, dir.file("diff.csv"), options, counts));
+        CHECK(counts.changed() == 0 && counts.added == 0 && counts.removed == 0);
+        CHECK(counts.unchanged == expected_counts.new_rows);
+        CHECK(test::readFile(dir.file("diff.csv")) == DIFF_HEADER + "\n");
+    }
+
+    // Two rows out of order, or an export without --sorted, fail the diff
+    void testUnsorted(const test::TempDir& dir) {
+        std::vector<std::string> lines;
+        std::istringstream in(test::readFile(dir.file("new.csv")));
+        std::string line;
+        while (std::getline(in, line)) lines.push_back(line);
+        std::swap(lines[lines.size() / 2], lines[lines.size() / 2 + 1]);
+        std::string swapped;
+        for (const std::string& l : lines) swapped += l + "\n";
+        test::writeFile(dir.file("swapped.csv"), swapped);
+
+        ASGraph graph;
+        buildRun(graph, true);
+        test::exportRibs(graph, dir.file("unsorted.csv"));
+        CHECK(test::readFile(dir.file("unsorted.csv")) != test::readFile(dir.file("new.csv")));
+
+        for (const std::string& input : {dir.file("swapped.csv"), dir.file("unsorted.csv")}) {
+            for (unsigned threads : {1u, 4u}) {
+                RibDiffOptions options;
+                options.threads = threads;
+                RibDiffCounts counts;
+                CHECK(!diffRibOutputs(dir.file("old.csv"), input, dir.file("diff.csv"), options, counts));
+                CHECK(!diffRibOutputs(input, dir.file("old.csv"), dir.file("diff.csv"), options, counts));
+            }
+        }
+
+        // Not a RIB CSV, and a manifest of prefix-hash shards
+        RibDiffOptions options;
+        RibDiffCounts counts;
+        CHECK(!diffRibOutputs(dir.file("old.csv"), dir.file("diff.csv"), dir.file("out.csv"), options, counts));
+        RibExportOptions hashed;
+        hashed.sorted = true;
+        hashed.shards = 2;
+        hashed.shard_key = ShardKey::PREFIX_HASH;
+        std::filesystem::create_directories(dir.path() / "hashed");
+        CHECK(exportRibShards(graph, dir.file("hashed/new.csv"), hashed));
+        CHECK(!diffRibOutputs(dir.file("old.csv"), shardManifestPath(dir.file("hashed/new.csv")),
+                              dir.file("out.csv"), options, counts));
+    }
+}
+
+int main() {
+    test::TempDir dir("rib_diff_test");
+    testDiff(dir);
+    testUnsorted(dir);
+    return test::finish("rib_diff_test");
+}
@@ -0,0 +1,363 @@
+#include "bgp_policy.h"
+#include "bz2_decoder.h"
+#include "test_common.h"
+#include <cstring>
+#include <map>
+
+// RIB export: shards, sorted output, deltas and filters
+
+namespace {
+    const size_t AS_COUNT = 400;
+    const std::string HEADER = "asn,prefix,as_path";
+
+    void buildPropagated(ASGraph& graph, unsigned threads = 1) {
+        test::buildGraph(graph, AS_COUNT, 31);
+        graph.setPropagationThreads(threads);
+        test::seedAnnouncements(graph, test::announcementsCsv(AS_COUNT, 60, 32));
+        test::seedAnnouncements(graph, test::announcementsCsv(AS_COUNT, 20, 33, true));
+        graph.propagateAnnouncements();
+    }
+
+    // Lines of CSV text without the trailing newline
+    std::vector<std::string> splitLines(const std::string& text) {
+        std::vector<std::string> lines;
+        std::istringstream in(text);
+        std::string line;
+        while (std::getline(in, line)) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    std::string readShard(const std::string& path, bool compressed) {
+        std::string content = test::readFile(path);
+        if (!compressed) {
+            return content;
+        }
+        std::string text;
+        bool ok = decompressBz2Parallel(content.data(), content.size(),
+                                        [&text](const char* data, size_t len) {
+                                            text.append(data, len);
+                                            return true;
+                                        });
+        CHECK(ok);
+        return text;
+    }
+
+    ASN rowAsn(const std::string& row) {
+        return static_cast<ASN>(std::stoul(row.substr(0, row.find(','))));
+    }
+
+    std::string rowPrefix(const std::string& row) {
+        size_t start = row.find(',') + 1;
+        return row.substr(start, row.find(',', start) - start);
+    }
+
+    // The shards of every key and compression together hold exactly the single CSV's rows
+    void testShardUnion(const ASGraph& graph, const test::TempDir& dir) {
+        std::vector<std::string> expected = splitLines(test::exportRibs(graph, dir.file("single.csv")));
+        CHECK(!expected.empty() && expected.front() == HEADER);
+        expected.erase(expected.begin());
+        std::sort(expected.begin(), expected.end());
+
+        for (ShardKey key : {ShardKey::ASN_RANGE, ShardKey::PREFIX_HASH}) {
+            for (bool compress : {false, true}) {
+                std::string name = std::string(key == ShardKey::ASN_RANGE ? "asn" : "prefix") +
+                                   (compress ? "_bz2" : "");
+                std::filesystem::create_directories(dir.path() / name);
+
+                RibExportOptions options;
+                options.threads = 2;
+                options.shards = 4;
+                options.shard_key = key;
+                options.compress_shards = compress;
+                std::vector<RibShardInfo> shards;
+                CHECK(exportRibShards(graph, dir.file(name + "/ribs.csv"), options, &shards));
+                CHECK(shards.size() == 4);
+                CHECK(std::filesystem::exists(shardManifestPath(dir.file(name + "/ribs.csv"))));
+
+                std::vector<std::string> rows;
+                std::map<std::string, size_t> prefix_shard;
+                ASN previous_last = 0;
+                for (size_t s = 0; s < shards.size(); s++) {
+                    std::vector<std::string> lines =
+                        splitLines(readShard(dir.file(name + "/" + shards[s].file), compress));
+                    CHECK(!lines.empty() && lines.front() == HEADER);
+                    CHECK(lines.size() == shards[s].rows + 1);
+
+                    for (size_t i = 1; i < lines.size(); i++) {
+                        const std::string& row = lines[i];
+                        rows.push_back(row);
+                        if (key == ShardKey::ASN_RANGE) {
+                            CHECK(rowAsn(row) >= shards[s].first_asn && rowAsn(row) <= shards[s].last_asn);
+                        } else {
+                            // A prefix lives in exactly one shard
+                            auto inserted = prefix_shard.insert({rowPrefix(row), s});
+                            CHECK(inserted.first->second == s);
+                        }
+                    }
+                    if (key == ShardKey::ASN_RANGE && shards[s].rows > 0) {
+                        CHECK(shards[s].first_asn > previous_last);
+                        previous_last = shards[s].last_asn;
+                    }
+                }
+
+                std::sort(rows.begin(), rows.end());
+                CHECK(rows == expected);
+            }
+        }
+    }
+
+    // --sorted output is the same bytes for every propagation and export thread count
+    void testSortedAcrossThreads(const test::TempDir& dir) {
+        RibExportOptions options;
+        options.sorted = true;
+
+        ASGraph serial;
+        buildPropagated(serial);
+        std::string expected = test::exportRibs(serial, dir.file("sorted_1.csv"), options);
+        CHECK(!expected.empty());
+
+        // Rows are ordered by ASN, then prefix
+        std::vector<std::string> lines = splitLines(expected);
+        for (size_t i = 2; i < lines.size(); i++) {
+            ASN prev_asn = rowAsn(lines[i - 1]);
+            ASN asn = rowAsn(lines[i]);
+            CHECK(prev_asn < asn || (prev_asn == asn && prefixLess(Prefix::parse(rowPrefix(lines[i - 1])),
+                                                                    Prefix::parse(rowPrefix(lines[i])))));
+        }
+
+        for (unsigned threads : {2u, 4u, 0u}) {
+            ASGraph graph;
+            buildPropagated(graph, threads);
+            options.threads = threads;
+            std::string csv = dir.file("sorted_" + std::to_string(threads) + ".csv");
+            CHECK(test::exportRibs(graph, csv, options) == expected);
+        }
+    }
+}
+
+namespace {
+    // (asn,prefix) -> as_path column of an exported CSV
+    std::map<std::string, std::string> routesOf(const std::string& csv) {
+        std::map<std::string, std::string> routes;
+        std::vector<std::string> lines = splitLines(csv);
+        for (size_t i = 1; i < lines.size(); i++) {
+            size_t split = lines[i].find(',', lines[i].find(',') + 1);
+            routes[lines[i].substr(0, split)] = lines[i].substr(split + 1);
+        }
+        return routes;
+    }
+
+    // A delta against a baseline holds exactly the changed, new and withdrawn routes
+    void testDelta(const ASGraph& baseline_graph, const test::TempDir& dir) {
+        RouteState built;
+        CHECK(buildRouteState(baseline_graph, built, 2));
+        CHECK(saveRouteState(built, dir.file("baseline.state")));
+        RouteState baseline;
+        CHECK(loadRouteState(dir.file("baseline.state"), baseline));
+        CHECK(baseline.entries.size() == built.entries.size());
+
+        // Against itself the delta is empty
+        std::string same = dir.file("delta_same.csv");
+        size_t rows = 1;
+        CHECK(exportRibsDelta(baseline_graph, same, baseline, RibExportOptions(), &rows));
+        CHECK(rows == 0);
+        CHECK(splitLines(test::readFile(same)) == std::vector<std::string>{HEADER});
+
+        // New origins for most prefixes; the last 10 IPv4 prefixes are no longer seeded
+        ASGraph changed;
+        test::buildGraph(changed, AS_COUNT, 31);
+        test::seedAnnouncements(changed, test::announcementsCsv(AS_COUNT, 50, 34));
+        test::seedAnnouncements(changed, test::announcementsCsv(AS_COUNT, 20, 33, true));
+        changed.propagateAnnouncements();
+
+        std::map<std::string, std::string> before =
+            routesOf(test::exportRibs(baseline_graph, dir.file("before.csv")));
+        std::map<std::string, std::string> after = routesOf(test::exportRibs(changed, dir.file("after.csv")));
+        std::vector<std::string> expected;
+        for (const auto& route : after) {
+            auto old = before.find(route.first);
+            if (old == before.end() || old->second != route.second) {
+                expected.push_back(route.first + "," + route.second);
+            }
+        }
+        for (const auto& route : before) {
+            if (after.find(route.first) == after.end()) {
+                expected.push_back(route.first + ",");
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+
+        for (unsigned threads : {1u, 4u}) {
+            RibExportOptions options;
+            options.threads = threads;
+            std::string delta = dir.file("delta_" + std::to_string(threads) + ".csv");
+            CHECK(exportRibsDelta(changed, delta, baseline, options, &rows));
+
+            std::vector<std::string> lines = splitLines(test::readFile(delta));
+            CHECK(!lines.empty() && lines.front() == HEADER);
+            lines.erase(lines.begin());
+            CHECK(rows == lines.size());
+            std::sort(lines.begin(), lines.end());
+            CHECK(lines == expected);
+        }
+        CHECK(std::any_of(expected.begin(), expected.end(),
+                          [](const std::string& row) { return row.back() == ','; }));
+        CHECK(std::any_of(expected.begin(), expected.end(),
+                          [](const std::string& row) { return row.back() != ','; }));
+    }
+
+    // A damaged route state file is rejected, never trusted (header: magic,
+    // version, prefix_count at 12, entry_count at 16; then prefixes, then entries)
+    void testCorruptState(const test::TempDir& dir) {
+        const std::string good = test::readFile(dir.file("baseline.state"));
+        uint32_t prefix_count;
+        uint64_t entry_count;
+        std::memcpy(&prefix_count, good.data() + 12, sizeof(prefix_count));
+        std::memcpy(&entry_count, good.data() + 16, sizeof(entry_count));
+        CHECK(entry_count > 2);
+        const size_t entries_at = good.size() - entry_count * sizeof(RouteState::Entry);
+
+        auto rejected = [&](const std::string& content) {
+            test::writeFile(dir.file("corrupt.state"), content);
+            RouteState state;
+            bool loaded = loadRouteState(dir.file("corrupt.state"), state);
+            return !loaded && state.entries.empty() && state.prefixes.empty();
+        };
+
+        std::string huge_entries = good;
+        uint64_t huge = uint64_t(1) << 60;
+        std::memcpy(&huge_entries[16], &huge, sizeof(huge));
+        CHECK(rejected(huge_entries));
+
+        std::string huge_prefixes = good;
+        uint32_t many = 0xFFFFFFFFu;
+        std::memcpy(&huge_prefixes[12], &many, sizeof(many));
+        CHECK(rejected(huge_prefixes));
+
+        std::string short_table = good.substr(0, 24 + (entries_at - 24) / 2);
+        uint64_t none = 0;
+        std::memcpy(&short_table[16], &none, sizeof(none));
+        CHECK(rejected(short_table));                      // Prefix table ends early
+        CHECK(rejected(good.substr(0, good.size() - 8)));  // Last entry cut short
+
+        std::string out_of_range = good;
+        std::memcpy(&out_of_range[good.size() - 12], &prefix_count, sizeof(prefix_count));
+        CHECK(rejected(out_of_range));
+
+        std::string unsorted = good;
+        std::swap_ranges(unsorted.begin() + entries_at, unsorted.begin() + entries_at + 16,
+                         unsorted.begin() + entries_at + 16);
+        CHECK(rejected(unsorted));
+
+        std::string bad_prefix = good;
+        bad_prefix[24 + 1] = 'x';  // First character of the first prefix
+        CHECK(rejected(bad_prefix));
+    }
+}
+
+namespace {
+    // Rows a filter selects, computed straight from the RIBs
+    std::vector<std::string> filteredRows(const ASGraph& graph, const RibFilter& filter) {
+        auto contains = [](const auto& list, const auto& value) {
+            return std::find(list.begin(), list.end(), value) != list.end();
+        };
+
+        std::vector<std::string> rows;
+        for (const auto& pair : graph.getNodes()) {
+            const ASNode& node = pair.second;
+            if (!filter.asns.empty() && !contains(filter.asns, node.asn)) continue;
+            node.policy->forEachRoute([&](const Prefix& prefix, const Announcement& ann) {
+                if (!filter.prefixes.empty() && !contains(filter.prefixes, prefix)) return;
+                if (!filter.origins.empty() && !contains(filter.origins, ann.as_path.back())) return;
+                if (filter.rov_invalid_only && !ann.rov_invalid) return;
+                std::string row;
+                appendRibRow(row, node.asn, prefix.toString(), ann);
+                row.pop_back();
+                rows.push_back(row);
+            });
+        }
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+
+    // Each filter kind alone and combined selects exactly the matching rows,
+    // for plain, sorted and sharded output
+    void testFilters(const ASGraph& graph, const test::TempDir& dir) {
+        std::vector<RibFilter> filters(6);
+        filters[0].asns = {1, 2, 3, 50, 51, 399, 100000};
+        filters[1].prefixes = {Prefix::parse("10.3.0.0/16"), Prefix::parse("2001:db8:4::/48"),
+                               Prefix::parse("192.0.2.0/24")};
+        filters[2].origins = {9, 10, 11, 12, 13, 14, 15, 16, 200, 300};
+        filters[3].rov_invalid_only = true;
+        filters[4].asns = {1, 2, 3, 4, 5, 6, 7, 8};
+        filters[4].prefixes = {Prefix::parse("10.1.0.0/16"), Prefix::parse("10.2.0.0/16"),
+                               Prefix::parse("10.5.0.0/16"), Prefix::parse("2001:db8:1::/48")};
+        filters[5].prefixes = {Prefix::parse("192.0.2.0/24")};  // Never seeded
+
+        for (size_t f = 0; f < filters.size(); f++) {
+            std::vector<std::string> expected = filteredRows(graph, filters[f]);
+            CHECK(f == 5 ? expected.empty() : !expected.empty());
+
+            for (bool sorted : {false, true}) {
+                RibExportOptions options;
+                options.threads = 4;
+                options.sorted = sorted;
+                options.filter = filters[f];
+                std::string csv = dir.file("filter_" + std::to_string(f) + ".csv");
+                size_t rows = 0;
+                CHECK(exportRibsCsv(graph, csv, options, &rows));
+
+                std::vector<std::string> lines = splitLines(test::readFile(csv));
+                CHECK(!lines.empty() && lines.front() == HEADER);
+                lines.erase(lines.begin());
+                CHECK(rows == lines.size());
+                std::sort(lines.begin(), lines.end());
+                CHECK(lines == expected);
+            }
+
+            RibExportOptions options;
+            options.shards = 3;
+            options.filter = filters[f];
+            std::filesystem::create_directories(dir.path() / ("filter_shards_" + std::to_string(f)));
+            std::vector<RibShardInfo> shards;
+            CHECK(exportRibShards(graph, dir.file("filter_shards_" + std::to_string(f) + "/ribs.csv"),
+                                  options, &shards));
+            uint64_t shard_rows = 0;
+            for (const RibShardInfo& shard : shards) {
+                shard_rows += shard.rows;
+            }
+            CHECK(shard_rows == expected.size());
+        }
+    }
+
+    // Only whole ASNs in range are kept; numbers with trailing text or past
+    // 32 bits are skipped instead of being cut short or wrapped
+    void testFilterLists(const test::TempDir& dir) {
+        test::writeFile(dir.file("asns.txt"),
+                        "# ASNs\n7\n12abc\n4294967296\n4294967297\n-5\n0\n 9\n4294967295\n15 \r\n\n");
+        std::vector<ASN> asns;
+        CHECK(readAsnList(dir.file("asns.txt"), asns));
+        CHECK(asns == std::vector<ASN>({7, 4294967295u, 15}));
+        CHECK(!readAsnList(dir.file("missing.txt"), asns));
+
+        test::writeFile(dir.file("prefixes.txt"), "10.1.0.0/16\n10.2.0.0\n2001:db8:1::/48\r\n");
+        std::vector<Prefix> prefixes;
+        CHECK(readPrefixList(dir.file("prefixes.txt"), prefixes));
+        CHECK(prefixes.size() == 2);
+    }
+}
+
+int main() {
+    test::TempDir dir("rib_export_test");
+    ASGraph graph;
+    buildPropagated(graph);
+    testShardUnion(graph, dir);
+    testSortedAcrossThreads(dir);
+    testDelta(graph, dir);
+    testCorruptState(dir);
+    testFilters(graph, dir);
+    testFilterLists(dir);
+    return test::finish("rib_export_test");
+}
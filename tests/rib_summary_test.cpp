@@ -0,0 +1,194 @@
+#include "bgp_policy.h"
+#include "rib_summary.h"
+#include "test_common.h"
+#include <map>
+
+// RIB summary: counts match an aggregation of the CSV export, whatever the
+// thread count, and the JSON document carries them
+
+namespace {
+    // Enough ASes for summarizeRibs to split them over three workers
+    const size_t AS_COUNT = 4000;
+
+    struct ExpectedPrefix {
+        uint64_t reach = 0;
+        uint64_t path_length_total = 0;
+        std::map<ASN, uint64_t> origins;
+    };
+
+    struct Expected {
+        uint64_t routes = 0;
+        uint64_t routed_ases = 0;
+        uint64_t rov_invalid_routes = 0;
+        uint64_t relationship_counts[4] = {};
+        std::vector<uint64_t> histogram;
+        uint64_t path_length_total = 0;
+        std::map<std::string, ExpectedPrefix> prefixes;
+    };
+
+    // ASNs of a CSV path column: "(as1, as2, as3)" or "(as1,)"
+    std::vector<ASN> parsePath(const std::string& column) {
+        std::vector<ASN> path;
+        std::string digits;
+        for (char c : column + ",") {
+            if (c >= '0' && c <= '9') {
+                digits += c;
+            } else if (c == ',' && !digits.empty()) {
+                path.push_back(static_cast<ASN>(std::stoul(digits)));
+                digits.clear();
+            }
+        }
+        return path;
+    }
+
+    Expected aggregate(const ASGraph& graph, const test::TempDir& dir) {
+        Expected expected;
+        expected.histogram.assign(RibSummary::MAX_PATH_BIN + 1, 0);
+
+        std::istringstream csv(test::exportRibs(graph, dir.file("ribs.csv")));
+        std::string line;
+        std::getline(csv, line);
+        std::set<ASN> routed;
+        while (std::getline(csv, line)) {
+            size_t first = line.find(',');
+            size_t second = line.find(',', first + 1);
+            std::vector<ASN> path = parsePath(line.substr(second + 1));
+            CHECK(!path.empty());
+
+            ExpectedPrefix& prefix = expected.prefixes[line.substr(first + 1, second - first - 1)];
+            prefix.reach++;
+            prefix.path_length_total += path.size();
+            prefix.origins[path.back()]++;
+
+            expected.routes++;
+            expected.path_length_total += path.size();
+            expected.histogram[std::min(path.size(), RibSummary::MAX_PATH_BIN)]++;
+            routed.insert(static_cast<ASN>(std::stoul(line.substr(0, first))));
+        }
+        expected.routed_ases = routed.size();
+        while (expected.histogram.size() > 1 && expected.histogram.back() == 0) {
+            expected.histogram.pop_back();
+        }
+
+        // Not in the CSV
+        for (const auto& pair : graph.getNodes()) {
+            pair.second.policy->forEachRoute([&](const Prefix&, const Announcement& ann) {
+                expected.relationship_counts[static_cast<size_t>(ann.received_from)]++;
+                if (ann.rov_invalid) expected.rov_invalid_routes++;
+            });
+        }
+        return expected;
+    }
+
+    // Origins as the summary orders them: most ASes first, then lowest ASN
+    std::vector<std::pair<ASN, uint64_t>> orderedOrigins(const std::map<ASN, uint64_t>& origins) {
+        std::vector<std::pair<ASN, uint64_t>> ordered(origins.begin(), origins.end());
+        std::stable_sort(ordered.begin(), ordered.end(),
+                         [](const std::pair<ASN, uint64_t>& a, const std::pair<ASN, uint64_t>& b) {
+                             return a.second > b.second;
+                         });
+        return ordered;
+    }
+
+    void checkSummary(const RibSummary& summary, const Expected& expected, size_t as_count) {
+        CHECK(summary.ases == as_count);
+        CHECK(summary.routes == expected.routes);
+        CHECK(summary.routed_ases == expected.routed_ases);
+        CHECK(summary.rov_invalid_routes == expected.rov_invalid_routes);
+        CHECK(summary.path_length_total == expected.path_length_total);
+        CHECK(summary.path_length_histogram == expected.histogram);
+        for (size_t r = 0; r < 4; r++) {
+            CHECK(summary.relationship_counts[r] == expected.relationship_counts[r]);
+        }
+
+        CHECK(summary.prefixes.size() == expected.prefixes.size());
+        for (size_t p = 0; p < summary.prefixes.size(); p++) {
+            const PrefixRibSummary& prefix = summary.prefixes[p];
+            if (p > 0) CHECK(prefixLess(summary.prefixes[p - 1].prefix, prefix.prefix));
+
+            auto it = expected.prefixes.find(prefix.prefix.toString());
+            CHECK(it != expected.prefixes.end());
+            if (it == expected.prefixes.end()) continue;
+            CHECK(prefix.reach == it->second.reach);
+            CHECK(prefix.path_length_total == it->second.path_length_total);
+            CHECK(prefix.origins == orderedOrigins(it->second.origins));
+        }
+    }
+
+    // Each prefix's line holds its reach and its origins in summary order
+    void checkJson(const RibSummary& summary, const Expected& expected, const test::TempDir& dir) {
+        std::string path = dir.file("summary.json");
+        CHECK(writeRibSummaryJson(summary, path));
+        std::string json = test::readFile(path);
+
+        CHECK(json.find("\"routes\": " + std::to_string(expected.routes) + ",") != std::string::npos);
+        CHECK(json.find("\"routed_ases\": " + std::to_string(expected.routed_ases) + ",") != std::string::npos);
+        CHECK(json.find("\"rov_invalid_routes\": " + std::to_string(expected.rov_invalid_routes) + ",") !=
+              std::string::npos);
+        CHECK(json.find("\"relationships\": {\"origin\": " + std::to_string(expected.relationship_counts[0]) +
+                        ", \"customer\": " + std::to_string(expected.relationship_counts[1]) +
+                        ", \"peer\": " + std::to_string(expected.relationship_counts[2]) +
+                        ", \"provider\": " + std::to_string(expected.relationship_counts[3]) + "}") !=
+              std::string::npos);
+
+        std::string histogram = "\"path_length_histogram\": [";
+        for (size_t i = 0; i < expected.histogram.size(); i++) {
+            histogram += (i ? ", " : "") + std::to_string(expected.histogram[i]);
+        }
+        CHECK(json.find(histogram + "]") != std::string::npos);
+
+        size_t lines = 0;
+        for (const auto& pair : expected.prefixes) {
+            size_t start = json.find("{\"prefix\": \"" + pair.first + "\", \"reach\": " +
+                                     std::to_string(pair.second.reach) + ",");
+            CHECK(start != std::string::npos);
+            if (start == std::string::npos) continue;
+            lines++;
+
+            std::string line = json.substr(start, json.find('\n', start) - start);
+            size_t at = 0;
+            for (const auto& origin : orderedOrigins(pair.second.origins)) {
+                at = line.find("{\"asn\": " + std::to_string(origin.first) + ", \"ases\": " +
+                               std::to_string(origin.second) + ",", at);
+                CHECK(at != std::string::npos);
+            }
+        }
+        CHECK(lines == expected.prefixes.size());
+
+        CHECK(!writeRibSummaryJson(summary, dir.file("missing/summary.json")));
+    }
+
+    void testSummary(const test::TempDir& dir) {
+        ASGraph graph;
+        test::buildGraph(graph, AS_COUNT, 121);
+        test::seedAnnouncements(graph, test::announcementsCsv(AS_COUNT, 40, 122));
+        test::seedAnnouncements(graph, test::announcementsCsv(AS_COUNT, 10, 123, true));
+        graph.propagateAnnouncements();
+
+        // Routes that no seed announced: a new prefix, and a seeded prefix
+        // from an origin that did not seed it
+        const SeedAnnouncement& seed = graph.getSeeds().front();
+        ASN other = 1;
+        for (const SeedAnnouncement& s : graph.getSeeds()) {
+            if (s.prefix == seed.prefix && s.origin_asn == other) other++;
+        }
+        graph.getNode(other)->policy->seedAnnouncement(Prefix::parse(seed.prefix), Announcement(other));
+        graph.getNode(3)->policy->seedAnnouncement(Prefix::parse("192.0.2.0/24"), Announcement(3));
+
+        Expected expected = aggregate(graph, dir);
+        CHECK(expected.prefixes.count("192.0.2.0/24") == 1);
+        CHECK(expected.prefixes[seed.prefix].origins.count(other) == 1);
+        CHECK(expected.rov_invalid_routes > 0);
+
+        for (unsigned threads : {1u, 3u}) {
+            checkSummary(summarizeRibs(graph, threads), expected, AS_COUNT);
+        }
+        checkJson(summarizeRibs(graph, 3), expected, dir);
+    }
+}
+
+int main() {
+    test::TempDir dir("rib_summary_test");
+    testSummary(dir);
+    return test::finish("rib_summary_test");
+}
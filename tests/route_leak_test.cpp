@@ -0,0 +1,151 @@
+#include "bgp_policy.h"
+#include "route_leak.h"
+#include "test_common.h"
+
+// Route leaks: export rules, a single leak, convergence and engine agreement
+
+namespace {
+    const char* const PREFIX = "10.5.0.0/16";
+
+    // Next hop of asn's route for PREFIX after propagating (0 without a route)
+    ASN nextHop(const ASGraph& graph, ASN asn) {
+        const Announcement* ann = graph.getNode(asn)->policy->getAnnouncement(Prefix::parse(PREFIX));
+        return ann ? ann->next_hop_asn : 0;
+    }
+
+    void testExports() {
+        Announcement from_provider;
+        from_provider.received_from = RelationshipType::PROVIDER;
+        Announcement from_customer;
+        from_customer.received_from = RelationshipType::CUSTOMER;
+
+        // Valley-free without a policy
+        CHECK(exportsRoute(from_customer, RelationshipType::CUSTOMER, 0));
+        CHECK(exportsRoute(from_provider, RelationshipType::PROVIDER, 0));
+        CHECK(!exportsRoute(from_provider, RelationshipType::CUSTOMER, 0));
+        CHECK(!exportsRoute(from_provider, RelationshipType::PEER, 0));
+
+        uint8_t providers = static_cast<uint8_t>(LeakPolicy::PROVIDERS);
+        uint8_t peers = static_cast<uint8_t>(LeakPolicy::PEERS);
+        CHECK(exportsRoute(from_provider, RelationshipType::CUSTOMER, providers));
+        CHECK(!exportsRoute(from_provider, RelationshipType::PEER, providers));
+        CHECK(exportsRoute(from_provider, RelationshipType::PEER, peers));
+        CHECK(!exportsRoute(from_provider, RelationshipType::CUSTOMER, peers));
+
+        LeakPolicy parsed;
+        CHECK(parseLeakPolicy("peers", parsed) && parsed == LeakPolicy::PEERS);
+        CHECK(std::string(leakPolicyName(LeakPolicy::ALL)) == "all");
+        CHECK(!parseLeakPolicy("customers", parsed));
+    }
+
+    // Origin 5 is a customer of 100, which peers with 200. 10 is a customer of
+    // both; leaking to providers, it hands 200 a customer route to 5.
+    void buildScenario(ASGraph& graph, const std::unordered_map<ASN, LeakPolicy>& leakers) {
+        graph.addRelationship(100, 5, RelationType::CUSTOMER);
+        graph.addRelationship(100, 10, RelationType::CUSTOMER);
+        graph.addRelationship(200, 10, RelationType::CUSTOMER);
+        graph.addRelationship(100, 200, RelationType::PEER);
+        graph.addRelationship(300, 200, RelationType::CUSTOMER);
+        graph.setLeakers(leakers);
+        graph.initializeBGP();
+        graph.flattenGraph();
+        graph.seedAnnouncement(5, PREFIX);
+        graph.propagateAnnouncements();
+    }
+
+    void testLeak() {
+        ASGraph plain;
+        buildScenario(plain, {});
+        CHECK(nextHop(plain, 200) == 100);  // Peer route
+        CHECK(nextHop(plain, 300) == 0);    // Not exported to providers
+
+        ASGraph peers_only;
+        buildScenario(peers_only, {{10, LeakPolicy::PEERS}});
+        CHECK(nextHop(peers_only, 200) == 100);  // 10 has no peers to leak to
+
+        ASGraph leaked;
+        buildScenario(leaked, {{10, LeakPolicy::PROVIDERS}});
+        CHECK(leaked.getLeakStats().converged);
+        CHECK(leaked.getLeakStats().updates > 0);
+        CHECK(nextHop(leaked, 200) == 10);  // The leaked route comes from a customer
+        CHECK(nextHop(leaked, 300) == 200);
+        const Announcement* ann = leaked.getNode(300)->policy->getAnnouncement(Prefix::parse(PREFIX));
+        CHECK(ann && ann->as_path.size() == 5);  // 300, 200, 10, 100, 5
+    }
+
+    // Every step-th AS leaks, policies in turn
+    std::unordered_map<ASN, LeakPolicy> leakersOf(size_t as_count, size_t step) {
+        std::unordered_map<ASN, LeakPolicy> leakers;
+        const LeakPolicy policies[] = {LeakPolicy::PROVIDERS, LeakPolicy::PEERS, LeakPolicy::ALL};
+        for (ASN asn = 7; asn <= as_count; asn += step) {
+            leakers[asn] = policies[asn % 3];
+        }
+        return leakers;
+    }
+
+    void runLeaks(ASGraph& graph, size_t as_count, const std::string& anns, size_t step,
+                  unsigned threads, size_t round_limit) {
+        test::buildGraph(graph, as_count, 91);
+        test::seedAnnouncements(graph, anns);
+        graph.setLeakers(leakersOf(as_count, step));
+        graph.setLeakRoundLimit(round_limit);
+        graph.setPropagationThreads(threads);
+        graph.propagateAnnouncements();
+    }
+
+    // Leaks converge to the same RIBs whichever engine ran first, without
+    // route loops. Leaks void the Gao-Rexford guarantee, so a run may also
+    // oscillate; hitting the round limit must then be reported.
+    void testConvergence(const test::TempDir& dir) {
+        const size_t as_count = 500;
+        std::string anns = test::announcementsCsv(as_count, 60, 92);
+        RibExportOptions sorted;
+        sorted.sorted = true;
+
+        ASGraph plain;
+        test::buildGraph(plain, as_count, 91);
+        test::seedAnnouncements(plain, anns);
+        plain.propagateAnnouncements();
+        std::string expected = test::exportRibs(plain, dir.file("plain.csv"), sorted);
+
+        std::vector<std::string> outputs;
+        size_t rounds = 0;
+        for (unsigned threads : {1u, 4u}) {
+            ASGraph graph;
+            runLeaks(graph, as_count, anns, 100, threads, 1000);
+            const LeakStats& stats = graph.getLeakStats();
+            CHECK(stats.converged);
+            CHECK(stats.rounds > 1 && stats.updates > 0);
+            rounds = stats.rounds;
+            outputs.push_back(test::exportRibs(graph, dir.file("leaked.csv"), sorted));
+
+            for (ASN asn = 1; asn <= as_count; asn++) {
+                graph.getNode(asn)->policy->forEachRoute([&](const Prefix&, const Announcement& ann) {
+                    std::set<ASN> seen(ann.as_path.begin(), ann.as_path.end());
+                    CHECK(seen.size() == ann.as_path.size());
+                });
+            }
+        }
+        CHECK(outputs[0] == outputs[1]);
+        CHECK(outputs[0] != expected);
+
+        ASGraph limited;
+        runLeaks(limited, as_count, anns, 100, 1, rounds - 1);
+        CHECK(!limited.getLeakStats().converged);
+        CHECK(limited.getLeakStats().rounds == rounds - 1);
+
+        // With a leaker every 25 ASes, leaked routes keep displacing each other
+        ASGraph oscillating;
+        runLeaks(oscillating, as_count, anns, 25, 1, 20);
+        CHECK(!oscillating.getLeakStats().converged);
+        CHECK(oscillating.getLeakStats().rounds == 20);
+    }
+}
+
+int main() {
+    test::TempDir dir("route_leak_test");
+    testExports();
+    testLeak();
+    testConvergence(dir);
+    return test::finish("route_leak_test");
+}
@@ -0,0 +1,109 @@
+#include "bgp_policy.h"
+#include "route_resolver.h"
+#include "test_common.h"
+
+// On-demand route resolution: every answer matches the propagated RIBs
+
+namespace {
+    const size_t AS_COUNT = 400;
+
+    bool sameRoute(const Announcement* a, const Announcement* b) {
+        if (!a || !b) return a == b;
+        return a->next_hop_asn == b->next_hop_asn && a->received_from == b->received_from &&
+               a->rov_invalid == b->rov_invalid &&
+               std::vector<ASN>(a->as_path.begin(), a->as_path.end()) ==
+                   std::vector<ASN>(b->as_path.begin(), b->as_path.end());
+    }
+
+    // ROV at every tenth AS, ASPA at every seventh and path-end at every
+    // eleventh, with some records wrong so that each of them drops routes
+    void buildScenario(ASGraph& graph, const test::TempDir& dir, RouteSelection selection) {
+        std::string rov;
+        for (size_t asn = 10; asn <= AS_COUNT; asn += 10) {
+            rov += std::to_string(asn) + "\n";
+        }
+        test::writeFile(dir.file("rov.txt"), rov);
+
+        std::vector<GraphEdge> edges = test::makeTopology(AS_COUNT, 101);
+        std::vector<std::pair<ASN, ASN>> aspa, pathend;
+        for (const GraphEdge& e : edges) {
+            if (e.rel == RelationType::CUSTOMER) {
+                aspa.push_back({e.as2, aspa.size() % 4 == 0 ? e.as1 + 1 : e.as1});
+            }
+            if (pathend.size() % 5 != 0) pathend.push_back({e.as1, e.as2});
+            pathend.push_back({e.as2, e.as1});
+        }
+        std::unordered_set<ASN> aspa_asns, pathend_asns;
+        for (ASN asn = 3; asn <= AS_COUNT; asn += 7) aspa_asns.insert(asn);
+        for (ASN asn = 5; asn <= AS_COUNT; asn += 11) pathend_asns.insert(asn);
+
+        graph.loadROVASNs(dir.file("rov.txt"));
+        test::addEdges(graph, edges);
+        graph.setASPA(aspa);
+        graph.setASPAASNs(aspa_asns);
+        graph.setPathEnd(pathend);
+        graph.setPathEndASNs(pathend_asns);
+        graph.initializeBGP();
+        graph.flattenGraph();
+        test::seedAnnouncements(graph, test::announcementsCsv(AS_COUNT, 40, 102));
+        test::seedAnnouncements(graph, test::announcementsCsv(AS_COUNT, 10, 103, true));
+        graph.setRouteSelection(selection, 17);
+    }
+
+    void testMatchesPropagation(const test::TempDir& dir) {
+        for (RouteSelection selection : {RouteSelection::STANDARD, RouteSelection::IGNORE_PATH_LENGTH,
+                                         RouteSelection::HASH_TIE_BREAK, RouteSelection::LOWEST_ORIGIN}) {
+            ASGraph graph;
+            buildScenario(graph, dir, selection);
+            RouteResolver resolver(graph);
+
+            // Resolve before propagating: the resolver reads only seeds and topology
+            std::set<std::string> seeded;
+            for (const SeedAnnouncement& seed : graph.getSeeds()) {
+                seeded.insert(seed.prefix);
+            }
+            std::vector<Prefix> prefixes;
+            for (const std::string& prefix : seeded) {
+                prefixes.push_back(Prefix::parse(prefix));
+            }
+            std::vector<Announcement> resolved;
+            std::vector<bool> present;
+            for (const Prefix& prefix : prefixes) {
+                for (ASN asn = 1; asn <= AS_COUNT; asn++) {
+                    const Announcement* ann = resolver.resolve(asn, prefix);
+                    present.push_back(ann != nullptr);
+                    resolved.push_back(ann ? *ann : Announcement());
+                }
+            }
+            CHECK(resolver.resolve(AS_COUNT + 1, prefixes[0]) == nullptr);
+
+            graph.propagateAnnouncements();
+            size_t i = 0, found = 0, mismatches = 0;
+            for (const Prefix& prefix : prefixes) {
+                for (ASN asn = 1; asn <= AS_COUNT; asn++, i++) {
+                    const Announcement* expected = graph.getNode(asn)->policy->getAnnouncement(prefix);
+                    if (!sameRoute(present[i] ? &resolved[i] : nullptr, expected)) mismatches++;
+                    if (expected) found++;
+                }
+            }
+            CHECK(mismatches == 0);
+            CHECK(found > AS_COUNT && found < i);  // Some routes were dropped
+
+            // Memoized answers survive later queries, and clear() recomputes them
+            size_t computed = resolver.getComputedRouteCount();
+            CHECK(computed > 0);
+            resolver.resolve(1, prefixes[0]);
+            CHECK(resolver.getComputedRouteCount() == computed);
+            resolver.clear();
+            CHECK(resolver.getComputedRouteCount() == 0);
+            CHECK(sameRoute(resolver.resolve(1, prefixes[0]),
+                            graph.getNode(1)->policy->getAnnouncement(prefixes[0])));
+        }
+    }
+}
+
+int main() {
+    test::TempDir dir("route_resolver_test");
+    testMatchesPropagation(dir);
+    return test::finish("route_resolver_test");
+}
@@ -0,0 +1,155 @@
+#include "bgp_policy.h"
+#include "route_selection.h"
+#include "test_common.h"
+
+// Route-selection policies: keys, outcomes on small topologies, engine agreement
+
+namespace {
+    const char* const PREFIX = "10.0.0.0/16";
+
+    Announcement route(RelationshipType rel, ASN next_hop, std::vector<ASN> path) {
+        Announcement ann;
+        ann.received_from = rel;
+        ann.next_hop_asn = next_hop;
+        for (ASN asn : path) {
+            ann.as_path.push_back(asn);
+        }
+        return ann;
+    }
+
+    // Next hop of asn's route for PREFIX after propagating (0 without a route)
+    ASN nextHop(const ASGraph& graph, ASN asn) {
+        const Announcement* ann = graph.getNode(asn)->policy->getAnnouncement(Prefix::parse(PREFIX));
+        return ann ? ann->next_hop_asn : 0;
+    }
+
+    // AS 100 has customers 10 and 20; origin 5 is a customer of 20 and, through
+    // 30, an indirect customer of 10 (100-10-30-5 vs 100-20-5)
+    void buildLengthScenario(ASGraph& graph, RouteSelection selection) {
+        graph.addRelationship(100, 10, RelationType::CUSTOMER);
+        graph.addRelationship(100, 20, RelationType::CUSTOMER);
+        graph.addRelationship(10, 30, RelationType::CUSTOMER);
+        graph.addRelationship(30, 5, RelationType::CUSTOMER);
+        graph.addRelationship(20, 5, RelationType::CUSTOMER);
+        graph.initializeBGP();
+        graph.flattenGraph();
+        graph.seedAnnouncement(5, PREFIX);
+        graph.setRouteSelection(selection);
+        graph.propagateAnnouncements();
+    }
+
+    // AS 100 has customers 10 and 20, which serve origins 6 and 5 of the same prefix
+    void buildTieScenario(ASGraph& graph, RouteSelection selection, uint32_t seed = 0) {
+        graph.addRelationship(100, 10, RelationType::CUSTOMER);
+        graph.addRelationship(100, 20, RelationType::CUSTOMER);
+        graph.addRelationship(10, 6, RelationType::CUSTOMER);
+        graph.addRelationship(20, 5, RelationType::CUSTOMER);
+        graph.initializeBGP();
+        graph.flattenGraph();
+        graph.seedAnnouncement(6, PREFIX);
+        graph.seedAnnouncement(5, PREFIX);
+        graph.setRouteSelection(selection, seed);
+        graph.propagateAnnouncements();
+    }
+
+    void testKeys() {
+        Announcement customer_long = route(RelationshipType::CUSTOMER, 30, {30, 40, 50, 60});
+        Announcement peer_short = route(RelationshipType::PEER, 10, {10, 60});
+        Announcement customer_short = route(RelationshipType::CUSTOMER, 40, {40, 60});
+        Announcement customer_short_low = route(RelationshipType::CUSTOMER, 20, {20, 70});
+
+        // Relationship comes first under every policy
+        for (RouteSelection selection : {RouteSelection::STANDARD, RouteSelection::IGNORE_PATH_LENGTH,
+                                         RouteSelection::HASH_TIE_BREAK, RouteSelection::LOWEST_ORIGIN}) {
+            withRouteSelection(selection, 7, [&](const auto& policy) {
+                CHECK(policy.key(customer_long) < policy.key(peer_short));
+                return 0;
+            });
+        }
+
+        StandardSelection standard;
+        CHECK(standard.key(customer_short) < standard.key(customer_long));
+        CHECK(standard.key(customer_short_low) < standard.key(customer_short));
+
+        IgnorePathLengthSelection ignore_length;
+        CHECK(ignore_length.key(customer_long) < ignore_length.key(customer_short));
+
+        LowestOriginSelection lowest_origin;
+        CHECK(lowest_origin.key(customer_short) < lowest_origin.key(customer_short_low));
+        CHECK(lowest_origin.key(customer_short) < lowest_origin.key(customer_long));
+
+        // isBetterThan follows the standard policy
+        CHECK(customer_short.isBetterThan(customer_long));
+        CHECK(customer_short_low.isBetterThan(customer_short));
+        CHECK(!customer_short.isBetterThan(customer_short));
+        CHECK(customer_long.isBetterThan(peer_short));
+
+        RouteSelection parsed;
+        CHECK(parseRouteSelection("lowest-origin", parsed) && parsed == RouteSelection::LOWEST_ORIGIN);
+        CHECK(std::string(routeSelectionName(RouteSelection::HASH_TIE_BREAK)) == "hash-tie-break");
+        CHECK(!parseRouteSelection("shortest", parsed));
+    }
+
+    void testOutcomes() {
+        ASGraph standard, ignore_length;
+        buildLengthScenario(standard, RouteSelection::STANDARD);
+        buildLengthScenario(ignore_length, RouteSelection::IGNORE_PATH_LENGTH);
+        CHECK(nextHop(standard, 100) == 20);       // Shorter path
+        CHECK(nextHop(ignore_length, 100) == 10);  // Lower next hop despite the longer path
+
+        ASGraph tie_standard, tie_origin;
+        buildTieScenario(tie_standard, RouteSelection::STANDARD);
+        buildTieScenario(tie_origin, RouteSelection::LOWEST_ORIGIN);
+        CHECK(nextHop(tie_standard, 100) == 10);   // Lower next hop, origin 6
+        CHECK(nextHop(tie_origin, 100) == 20);     // Lower origin 5
+
+        // The hashed tie break picks whichever next hop hashes lower, and the
+        // seed changes that choice
+        std::set<ASN> chosen;
+        for (uint32_t seed = 0; seed < 16; seed++) {
+            HashTieBreakSelection hashed;
+            hashed.seed = seed;
+            ASN expected = hashed.key(route(RelationshipType::CUSTOMER, 10, {10, 6})) <
+                                   hashed.key(route(RelationshipType::CUSTOMER, 20, {20, 5}))
+                               ? 10 : 20;
+
+            ASGraph graph;
+            buildTieScenario(graph, RouteSelection::HASH_TIE_BREAK, seed);
+            CHECK(nextHop(graph, 100) == expected);
+            chosen.insert(nextHop(graph, 100));
+        }
+        CHECK(chosen.size() == 2);
+    }
+
+    // Serial and parallel engines agree under every policy
+    void testEngines(const test::TempDir& dir) {
+        const size_t as_count = 500;
+        std::string anns = test::announcementsCsv(as_count, 60, 42);
+
+        for (RouteSelection selection : {RouteSelection::STANDARD, RouteSelection::IGNORE_PATH_LENGTH,
+                                         RouteSelection::HASH_TIE_BREAK, RouteSelection::LOWEST_ORIGIN}) {
+            std::vector<std::string> outputs;
+            for (unsigned threads : {1u, 4u}) {
+                ASGraph graph;
+                test::buildGraph(graph, as_count, 41);
+                test::seedAnnouncements(graph, anns);
+                graph.setRouteSelection(selection, 99);
+                graph.setPropagationThreads(threads);
+                graph.propagateAnnouncements();
+
+                RibExportOptions options;
+                options.sorted = true;
+                outputs.push_back(test::exportRibs(graph, dir.file("ribs.csv"), options));
+            }
+            CHECK(!outputs[0].empty() && outputs[0] == outputs[1]);
+        }
+    }
+}
+
+int main() {
+    test::TempDir dir("route_selection_test");
+    testKeys();
+    testOutcomes();
+    testEngines(dir);
+    return test::finish("route_selection_test");
+}
@@ -0,0 +1,140 @@
+#include "rpki.h"
+#include "test_common.h"
+
+// RPKI origin validation: RFC 6811 verdicts, seeds, agreement with a linear scan
+
+namespace {
+    struct Vrp {
+        Prefix prefix;
+        unsigned max_length;
+        ASN asn;
+    };
+
+    unsigned lengthOf(const Prefix& prefix) {
+        return prefix.is_ipv6 ? prefix.v6.prefix_len : prefix.v4.prefix_len;
+    }
+
+    // Whether vrp's prefix covers prefix (same family, shorter or equal, same leading bits)
+    bool covers(const Prefix& vrp, const Prefix& prefix) {
+        if (vrp.is_ipv6 != prefix.is_ipv6 || lengthOf(vrp) > lengthOf(prefix)) {
+            return false;
+        }
+        unsigned length = lengthOf(vrp);
+        if (!prefix.is_ipv6) {
+            uint32_t mask = length == 0 ? 0 : ~uint32_t(0) << (32 - length);
+            return (vrp.v4.address & mask) == (prefix.v4.address & mask);
+        }
+        unsigned __int128 a = (static_cast<unsigned __int128>(vrp.v6.high) << 64) | vrp.v6.low;
+        unsigned __int128 b = (static_cast<unsigned __int128>(prefix.v6.high) << 64) | prefix.v6.low;
+        unsigned __int128 mask = length == 0 ? 0 : ~static_cast<unsigned __int128>(0) << (128 - length);
+        return (a & mask) == (b & mask);
+    }
+
+    // RFC 6811 by scanning every VRP
+    RpkiState referenceState(const std::vector<Vrp>& vrps, const Prefix& prefix, ASN origin) {
+        bool covered = false;
+        for (const Vrp& vrp : vrps) {
+            if (!covers(vrp.prefix, prefix)) continue;
+            covered = true;
+            if (vrp.asn == origin && origin != 0 && lengthOf(prefix) <= vrp.max_length) {
+                return RpkiState::VALID;
+            }
+        }
+        return covered ? RpkiState::INVALID : RpkiState::NOT_FOUND;
+    }
+
+    void testVerdicts(const test::TempDir& dir) {
+        std::string file = dir.file("vrps.csv");
+        test::writeFile(file,
+            "prefix,maxLength,asn\n"
+            "10.0.0.0/16,24,100\n"
+            "10.0.1.0/24,24,AS200\n"
+            "10.1.0.0/16,,0\n"
+            "10.1.0.0/16,16,5\n"
+            "2001:db8::/32,48,300\n"
+            "AS400,192.0.2.0/24,24,ARIN\n");
+
+        RpkiIndex index;
+        CHECK(index.loadFromFile(file, 2));
+        CHECK(index.size() == 6);
+        CHECK(index.getIPv6Count() == 1);
+
+        auto state = [&](const char* prefix, ASN origin) { return index.validate(Prefix::parse(prefix), origin); };
+        CHECK(state("10.0.0.0/16", 100) == RpkiState::VALID);
+        CHECK(state("10.0.0.0/24", 100) == RpkiState::VALID);      // Up to maxLength
+        CHECK(state("10.0.0.0/25", 100) == RpkiState::INVALID);    // Beyond maxLength
+        CHECK(state("10.0.0.0/16", 999) == RpkiState::INVALID);    // Unauthorized origin
+        CHECK(state("10.0.1.0/24", 200) == RpkiState::VALID);      // Nested VRP
+        CHECK(state("10.0.1.0/24", 100) == RpkiState::VALID);      // Enclosing VRP
+        CHECK(state("10.1.0.0/16", 0) == RpkiState::INVALID);      // AS 0 never matches
+        CHECK(state("10.1.0.0/16", 5) == RpkiState::VALID);
+        CHECK(state("10.1.2.0/24", 5) == RpkiState::INVALID);      // Empty maxLength = prefix length
+        CHECK(state("10.0.0.0/8", 100) == RpkiState::NOT_FOUND);   // Less specific than every VRP
+        CHECK(state("11.0.0.0/16", 100) == RpkiState::NOT_FOUND);
+        CHECK(state("2001:db8:1::/48", 300) == RpkiState::VALID);
+        CHECK(state("2001:db8:1::/49", 300) == RpkiState::INVALID);
+        CHECK(state("2001:db9::/32", 300) == RpkiState::NOT_FOUND);
+        CHECK(state("192.0.2.0/24", 400) == RpkiState::VALID);     // Routinator row
+
+        // Forged origin: valid at the origin, invalid at the AS that injected it
+        std::vector<RpkiState> states;
+        index.validatePath(Prefix::parse("10.0.0.0/16"), {999, 100}, states);
+        CHECK(states == std::vector<RpkiState>({RpkiState::INVALID, RpkiState::VALID}));
+
+        std::vector<SeedAnnouncement> seeds = {
+            {100, "10.0.0.0/16", true},
+            {999, "10.0.0.0/16", false},
+            {100, "11.0.0.0/16", false},
+            {300, "2001:db8:1::/48", false},
+        };
+        RpkiSeedCounts counts = index.validateSeeds(seeds, 2);
+        CHECK(counts.valid == 2 && counts.invalid == 1 && counts.not_found == 1);
+        CHECK(counts.changed == 2);
+        CHECK(!seeds[0].rov_invalid && seeds[1].rov_invalid && !seeds[2].rov_invalid && !seeds[3].rov_invalid);
+    }
+
+    // Random nested VRPs: the index agrees with the linear scan for any thread count
+    void testAgainstReference(const test::TempDir& dir) {
+        std::mt19937 rng(61);
+        std::vector<Vrp> vrps;
+        std::ostringstream csv;
+        for (int i = 0; i < 400; i++) {
+            unsigned length = 12 + rng() % 13;
+            uint32_t address = (10u << 24) | (rng() & 0x00FFFFFF);
+            address &= ~uint32_t(0) << (32 - length);
+            unsigned max_length = length + rng() % 5;
+            ASN asn = rng() % 8;
+            std::string prefix = IPv4Prefix(address, static_cast<uint8_t>(length)).toString();
+            vrps.push_back({Prefix::parse(prefix), max_length, asn});
+            csv << prefix << "," << max_length << "," << asn << "\n";
+        }
+        std::string file = dir.file("random_vrps.csv");
+        test::writeFile(file, csv.str());
+
+        RpkiIndex serial, parallel;
+        CHECK(serial.loadFromFile(file, 1));
+        CHECK(parallel.loadFromFile(file, 4));
+
+        size_t states[3] = {0, 0, 0};
+        for (int i = 0; i < 5000; i++) {
+            unsigned length = 8 + rng() % 25;
+            uint32_t address = (10u << 24) | (rng() & 0x00FFFFFF);
+            address &= ~uint32_t(0) << (32 - length);
+            Prefix prefix = Prefix::parse(IPv4Prefix(address, static_cast<uint8_t>(length)).toString());
+            ASN origin = rng() % 8;
+
+            RpkiState expected = referenceState(vrps, prefix, origin);
+            CHECK(serial.validate(prefix, origin) == expected);
+            CHECK(parallel.validate(prefix, origin) == expected);
+            states[static_cast<size_t>(expected)]++;
+        }
+        CHECK(states[0] > 0 && states[1] > 0 && states[2] > 0);
+    }
+}
+
+int main() {
+    test::TempDir dir("rpki_test");
+    testVerdicts(dir);
+    testAgainstReference(dir);
+    return test::finish("rpki_test");
+}
@@ -0,0 +1,212 @@
+#include "topology_diff.h"
+#include "test_common.h"
+#include <cstring>
+#include <map>
+
+// Topology fingerprint, binary snapshots and topology diffs
+
+namespace {
+    void testOrderIndependence() {
+        std::vector<GraphEdge> edges = test::makeTopology(300, 11);
+
+        ASGraph forward, backward, swapped;
+        test::addEdges(forward, edges);
+        test::addEdges(backward, std::vector<GraphEdge>(edges.rbegin(), edges.rend()));
+
+        // Same relationships written from the other side
+        for (const GraphEdge& e : edges) {
+            RelationType rel = e.rel == RelationType::CUSTOMER ? RelationType::PROVIDER : e.rel;
+            swapped.addRelationship(e.as2, e.as1, rel);
+        }
+
+        Hash128 fp = forward.fingerprint();
+        CHECK(fp == backward.fingerprint());
+        CHECK(fp == swapped.fingerprint());
+        CHECK(fp == forward.fingerprint(1));
+
+        ASGraph fewer;
+        test::addEdges(fewer, std::vector<GraphEdge>(edges.begin(), edges.end() - 1));
+        CHECK(fp != fewer.fingerprint());
+    }
+
+    void testRoundTrip(const test::TempDir& dir) {
+        ASGraph graph;
+        test::addEdges(graph, test::makeTopology(300, 12));
+        std::string snapshot = dir.file("graph.snap");
+        CHECK(graph.saveSnapshot(snapshot));
+        CHECK(ASGraph::isSnapshotFile(snapshot));
+
+        ASGraph loaded;
+        CHECK(loaded.loadSnapshot(snapshot));
+        CHECK(loaded.fingerprint() == graph.fingerprint());
+        CHECK(loaded.getCanonicalEdges() == graph.getCanonicalEdges());
+        CHECK(loaded.getNodeCount() == graph.getNodeCount());
+
+        // Text files and snapshots of the same topology agree
+        std::string text = dir.file("graph.txt");
+        test::writeFile(text, test::caidaText(graph.getCanonicalEdges()));
+        ASGraph parsed;
+        CHECK(parsed.buildFromFile(text));
+        CHECK(parsed.fingerprint() == loaded.fingerprint());
+    }
+
+    void testCorruptSnapshots(const test::TempDir& dir) {
+        ASGraph graph;
+        test::addEdges(graph, test::makeTopology(100, 13));
+        std::string snapshot = dir.file("good.snap");
+        CHECK(graph.saveSnapshot(snapshot));
+        std::string bytes = test::readFile(snapshot);
+
+        // Truncated payload
+        std::string truncated = dir.file("truncated.snap");
+        test::writeFile(truncated, bytes.substr(0, bytes.size() - 5));
+        ASGraph a;
+        CHECK(!a.loadSnapshot(truncated));
+        CHECK(a.getNodeCount() == 0);
+
+        // Header claiming far more nodes than the file holds
+        std::string huge = bytes;
+        uint64_t node_count = ~0ULL / 2;
+        std::memcpy(&huge[32], &node_count, sizeof(node_count));
+        std::string oversized = dir.file("oversized.snap");
+        test::writeFile(oversized, huge);
+        ASGraph b;
+        CHECK(!b.loadSnapshot(oversized));
+
+        // Payload edited without updating the fingerprint
+        std::string edited = bytes;
+        edited[48] ^= 1;  // First ASN
+        std::string mismatched = dir.file("mismatched.snap");
+        test::writeFile(mismatched, edited);
+        ASGraph c;
+        CHECK(!c.loadSnapshot(mismatched));
+        CHECK(c.getNodeCount() == 0);
+    }
+
+    // The base topology with edges removed, relationships changed, the last
+    // AS dropped and ten new ASes added (providers stay below customers)
+    // ASes that lose all their edges drop out as well.
+    std::vector<GraphEdge> changedTopology(const std::vector<GraphEdge>& edges, size_t as_count) {
+        ASN dropped = static_cast<ASN>(as_count);
+        std::vector<GraphEdge> next;
+        for (size_t i = 0; i < edges.size(); i++) {
+            GraphEdge e = edges[i];
+            if (e.as2 == dropped || i % 17 == 5) continue;
+            if (i % 23 == 7) {
+                e.rel = e.rel == RelationType::PEER ? RelationType::CUSTOMER : RelationType::PEER;
+            }
+            next.push_back(e);
+        }
+        for (ASN asn = dropped + 1; asn <= dropped + 10; asn++) {
+            next.push_back({asn / 2, asn, RelationType::CUSTOMER});
+            next.push_back({asn / 3, asn, RelationType::CUSTOMER});
+        }
+        return next;
+    }
+
+    bool sameDiff(const TopologyDiff& a, const TopologyDiff& b) {
+        if (a.changed_edges.size() != b.changed_edges.size()) return false;
+        for (size_t i = 0; i < a.changed_edges.size(); i++) {
+            const EdgeChange& x = a.changed_edges[i];
+            const EdgeChange& y = b.changed_edges[i];
+            if (x.as1 != y.as1 || x.as2 != y.as2 || x.old_rel != y.old_rel || x.new_rel != y.new_rel) {
+                return false;
+            }
+        }
+        return a.old_fingerprint == b.old_fingerprint && a.new_fingerprint == b.new_fingerprint &&
+               a.added_nodes == b.added_nodes && a.removed_nodes == b.removed_nodes &&
+               a.added_edges == b.added_edges && a.removed_edges == b.removed_edges;
+    }
+
+    // Diff of two canonical edge lists by map lookups, without any merge
+    TopologyDiff expectedDiff(const ASGraph& old_graph, const ASGraph& new_graph) {
+        std::map<std::pair<ASN, ASN>, RelationType> old_edges, new_edges;
+        for (const GraphEdge& e : old_graph.getCanonicalEdges()) old_edges[{e.as1, e.as2}] = e.rel;
+        for (const GraphEdge& e : new_graph.getCanonicalEdges()) new_edges[{e.as1, e.as2}] = e.rel;
+
+        TopologyDiff diff;
+        for (const auto& pair : old_edges) {
+            auto it = new_edges.find(pair.first);
+            if (it == new_edges.end()) {
+                diff.removed_edges.push_back({pair.first.first, pair.first.second, pair.second});
+            } else if (it->second != pair.second) {
+                diff.changed_edges.push_back({pair.first.first, pair.first.second, pair.second, it->second});
+            }
+        }
+        for (const auto& pair : new_edges) {
+            if (!old_edges.count(pair.first)) {
+                diff.added_edges.push_back({pair.first.first, pair.first.second, pair.second});
+            }
+        }
+
+        std::set<ASN> old_nodes, new_nodes;
+        for (const auto& pair : old_graph.getNodes()) old_nodes.insert(pair.first);
+        for (const auto& pair : new_graph.getNodes()) new_nodes.insert(pair.first);
+        std::set_difference(old_nodes.begin(), old_nodes.end(), new_nodes.begin(), new_nodes.end(),
+                            std::back_inserter(diff.removed_nodes));
+        std::set_difference(new_nodes.begin(), new_nodes.end(), old_nodes.begin(), old_nodes.end(),
+                            std::back_inserter(diff.added_nodes));
+        diff.old_fingerprint = old_graph.fingerprint();
+        diff.new_fingerprint = new_graph.fingerprint();
+        return diff;
+    }
+
+    // Applying the diff to a copy of the old graph gives the new graph
+    void checkApply(const std::vector<GraphEdge>& old_edges, const ASGraph& new_graph, const TopologyDiff& diff) {
+        ASGraph graph;
+        test::addEdges(graph, old_edges);
+        CHECK(graph.fingerprint() == diff.old_fingerprint);
+        CHECK(graph.applyDiff(diff));
+        CHECK(graph.fingerprint() == new_graph.fingerprint());
+        CHECK(graph.getCanonicalEdges() == new_graph.getCanonicalEdges());
+        CHECK(graph.getNodeCount() == new_graph.getNodeCount());
+
+        // The same diff no longer matches
+        CHECK(!graph.applyDiff(diff));
+    }
+
+    // as_count 70000 gives about 140K nodes and 310K edges over both inputs,
+    // so with 4 threads the node and edge merges run on several ranges
+    void testDiffApply(const test::TempDir& dir, size_t as_count) {
+        std::vector<GraphEdge> old_edges = test::makeTopology(as_count, 14);
+        ASGraph old_graph, new_graph;
+        test::addEdges(old_graph, old_edges);
+        test::addEdges(new_graph, changedTopology(old_edges, as_count));
+
+        TopologyDiff expected = expectedDiff(old_graph, new_graph);
+        CHECK(expected.added_nodes.size() == 10 && !expected.removed_nodes.empty());
+        CHECK(!expected.added_edges.empty() && !expected.removed_edges.empty());
+        CHECK(!expected.changed_edges.empty());
+
+        for (unsigned threads : {1u, 4u}) {
+            TopologyDiff diff = diffTopologies(old_graph, new_graph, threads);
+            CHECK(sameDiff(diff, expected));
+        }
+        checkApply(old_edges, new_graph, expected);
+
+        // Text round trip
+        std::string text = dir.file("topology.diff");
+        CHECK(writeTopologyDiff(expected, text));
+        TopologyDiff read;
+        CHECK(readTopologyDiff(text, read));
+        CHECK(sameDiff(read, expected));
+        checkApply(old_edges, new_graph, read);
+
+        // Straight from snapshots
+        CHECK(old_graph.saveSnapshot(dir.file("old.snap")));
+        CHECK(new_graph.saveSnapshot(dir.file("new.snap")));
+        TopologyDiff from_snapshots;
+        CHECK(diffSnapshotFiles(dir.file("old.snap"), dir.file("new.snap"), from_snapshots, 4));
+        CHECK(sameDiff(from_snapshots, expected));
+    }
+}
+
+int main() {
+    test::TempDir dir("snapshot_test");
+    testOrderIndependence();
+    testRoundTrip(dir);
+    testCorruptSnapshots(dir);
+    testDiffApply(dir, 300);
+    testDiffApply(dir, 70000);
+    return test::finish("snapshot_test");
+}
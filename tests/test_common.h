@@ -0,0 +1,198 @@
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+// Helpers shared by the regression tests
+// Each test is one executable run by CTest; it prints every failed check and
+// exits non-zero if any failed.
+
+#include "as_graph.h"
+#include "rib_export.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace test {
+
+inline int& failureCount() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                                  \
+    do {                                                                                  \
+        if (!(condition)) {                                                               \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #condition     \
+                      << std::endl;                                                       \
+            test::failureCount()++;                                                       \
+        }                                                                                 \
+    } while (0)
+
+// Print the outcome; the return value is the exit code
+inline int finish(const char* name) {
+    if (failureCount() == 0) {
+        std::cout << name << ": all checks passed" << std::endl;
+        return 0;
+    }
+    std::cerr << name << ": " << failureCount() << " checks failed" << std::endl;
+    return 1;
+}
+
+// Scratch directory, removed with its contents on destruction
+class TempDir {
+private:
+    std::filesystem::path dir;
+
+public:
+    explicit TempDir(const std::string& name) {
+        dir = std::filesystem::temp_directory_path() /
+              (name + "_" + std::to_string(std::random_device()()));
+        std::filesystem::create_directories(dir);
+    }
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+    }
+
+    std::string file(const std::string& name) const { return (dir / name).string(); }
+    const std::filesystem::path& path() const { return dir; }
+};
+
+inline void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream out(path, std::ios::binary);
+    out << content;
+}
+
+inline std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream content;
+    content << in.rdbuf();
+    return content.str();
+}
+
+// Lines of a text file, sorted (for comparing outputs whose row order may differ)
+inline std::vector<std::string> sortedLines(const std::string& path) {
+    std::ifstream in(path);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(in, line)) {
+        lines.push_back(line);
+    }
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+
+// Deterministic acyclic topology of as_count ASes (ASN = index + 1)
+// The first 8 ASes form a peering clique; every other AS gets 1-3 providers
+// among the ASes before it (biased towards the top) and sometimes a peer.
+// Edges are canonical: as1 < as2, CUSTOMER means as1 is as2's provider.
+inline std::vector<GraphEdge> makeTopology(size_t as_count, uint32_t seed) {
+    const size_t clique = 8;
+    std::mt19937 rng(seed);
+    std::set<std::pair<ASN, ASN>> linked;
+    std::vector<GraphEdge> edges;
+
+    auto link = [&](size_t a, size_t b, RelationType rel) {
+        ASN as1 = static_cast<ASN>(a + 1);
+        ASN as2 = static_cast<ASN>(b + 1);
+        if (linked.insert({as1, as2}).second) {
+            edges.push_back({as1, as2, rel});
+        }
+    };
+
+    for (size_t i = 0; i < clique && i < as_count; i++) {
+        for (size_t j = i + 1; j < clique && j < as_count; j++) {
+            link(i, j, RelationType::PEER);
+        }
+    }
+
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (size_t i = clique; i < as_count; i++) {
+        size_t providers = 1 + rng() % 3;
+        for (size_t k = 0; k < providers; k++) {
+            double u = unit(rng);
+            link(static_cast<size_t>(u * u * i), i, RelationType::CUSTOMER);
+        }
+        if (unit(rng) < 0.3) {
+            size_t peer = i / 2 + rng() % (i - i / 2);
+            if (peer != i) {
+                link(peer, i, RelationType::PEER);
+            }
+        }
+    }
+    return edges;
+}
+
+inline void addEdges(ASGraph& graph, const std::vector<GraphEdge>& edges) {
+    for (const GraphEdge& edge : edges) {
+        graph.addRelationship(edge.as1, edge.as2, edge.rel);
+    }
+}
+
+// CAIDA "as1|as2|rel|source" text of edges
+inline std::string caidaText(const std::vector<GraphEdge>& edges) {
+    std::ostringstream text;
+    for (const GraphEdge& edge : edges) {
+        text << edge.as1 << "|" << edge.as2 << "|" << static_cast<int>(edge.rel) << "|test\n";
+    }
+    return text.str();
+}
+
+// Announcements CSV (header included): count prefixes, each seeded at one or
+// two random origins, about a fifth of the seeds ROV-invalid
+inline std::string announcementsCsv(size_t as_count, size_t count, uint32_t seed, bool ipv6 = false) {
+    std::mt19937 rng(seed);
+    std::ostringstream csv;
+    csv << "seed_asn,prefix,rov_invalid\n";
+    for (size_t i = 0; i < count; i++) {
+        std::string prefix = ipv6 ? "2001:db8:" + std::to_string(i + 1) + "::/48"
+                                  : "10." + std::to_string(i + 1) + ".0.0/16";
+        size_t origins = 1 + rng() % 2;
+        for (size_t k = 0; k < origins; k++) {
+            ASN origin = static_cast<ASN>(1 + rng() % as_count);
+            csv << origin << "," << prefix << "," << (rng() % 5 == 0 ? "True" : "False") << "\n";
+        }
+    }
+    return csv.str();
+}
+
+// Seed the rows of announcementsCsv() into graph
+inline void seedAnnouncements(ASGraph& graph, const std::string& csv) {
+    std::istringstream in(csv);
+    std::string line;
+    std::getline(in, line);  // Header
+    while (std::getline(in, line)) {
+        std::istringstream row(line);
+        std::string asn, prefix, invalid;
+        std::getline(row, asn, ',');
+        std::getline(row, prefix, ',');
+        std::getline(row, invalid);
+        graph.seedAnnouncement(static_cast<ASN>(std::stoul(asn)), prefix, invalid == "True");
+    }
+}
+
+// Graph over makeTopology() with BGP policies and ranks, ready to seed
+inline void buildGraph(ASGraph& graph, size_t as_count, uint32_t seed) {
+    addEdges(graph, makeTopology(as_count, seed));
+    graph.initializeBGP();
+    graph.flattenGraph();
+}
+
+// Export graph's RIBs to path and return the file's content
+inline std::string exportRibs(const ASGraph& graph, const std::string& path,
+                              const RibExportOptions& options = RibExportOptions()) {
+    if (!exportRibsCsv(graph, path, options)) {
+        return std::string();
+    }
+    return readFile(path);
+}
+
+}  // namespace test
+
+#endif // TEST_COMMON_H
@@ -0,0 +1,141 @@
+#include "bgp_policy.h"
+#include "time_series.h"
+#include "topology_diff.h"
+#include "test_common.h"
+
+// Time series: every month matches a standalone run, whether its topology was
+// loaded, applied as a diff (text or snapshot) or reused unchanged
+
+namespace {
+    const size_t AS_COUNT = 400;
+
+    // The base topology with edges removed, relationships changed, one AS
+    // dropped and ten new ASes added (providers stay below customers)
+    std::vector<GraphEdge> nextMonth(const std::vector<GraphEdge>& edges, ASN dropped) {
+        std::vector<GraphEdge> next;
+        for (size_t i = 0; i < edges.size(); i++) {
+            GraphEdge e = edges[i];
+            if (e.as1 == dropped || e.as2 == dropped || i % 17 == 5) continue;
+            if (i % 23 == 7) {
+                e.rel = e.rel == RelationType::PEER ? RelationType::CUSTOMER : RelationType::PEER;
+            }
+            next.push_back(e);
+        }
+        for (ASN asn = AS_COUNT + 1; asn <= AS_COUNT + 10; asn++) {
+            next.push_back({asn - 300, asn, RelationType::CUSTOMER});
+            next.push_back({asn - 150, asn, RelationType::CUSTOMER});
+        }
+        return next;
+    }
+
+    // Propagate from scratch on topology_file, as a single-month run does
+    void runStandalone(ASGraph& graph, const std::string& topology_file, const std::string& rov_file,
+                       const std::vector<SeedAnnouncement>& seeds) {
+        CHECK(graph.buildFromFile(topology_file));
+        graph.initializeBGP();
+        CHECK(graph.loadROVASNs(rov_file));
+        graph.flattenGraph();
+        for (const SeedAnnouncement& seed : seeds) {
+            graph.seedAnnouncement(seed.origin_asn, seed.prefix, seed.rov_invalid);
+        }
+        graph.propagateAnnouncements();
+    }
+
+    void testMonths(const test::TempDir& dir) {
+        std::string anns = test::announcementsCsv(AS_COUNT, 40, 112);
+        std::vector<SeedAnnouncement> seeds;
+        std::istringstream in(anns);
+        std::string line;
+        std::getline(in, line);
+        std::set<ASN> origins;
+        while (std::getline(in, line)) {
+            std::istringstream row(line);
+            std::string asn, prefix, invalid;
+            std::getline(row, asn, ',');
+            std::getline(row, prefix, ',');
+            std::getline(row, invalid, ',');
+            seeds.push_back({static_cast<ASN>(std::stoul(asn)), prefix, invalid == "True"});
+            origins.insert(seeds.back().origin_asn);
+        }
+
+        std::string rov;
+        for (size_t asn = 10; asn <= AS_COUNT + 10; asn += 10) {
+            rov += std::to_string(asn) + "\n";
+        }
+        std::string rov_file = dir.file("rov.txt");
+        test::writeFile(rov_file, rov);
+
+        ASN dropped = AS_COUNT;
+        while (origins.count(dropped)) dropped--;
+        std::vector<GraphEdge> base = test::makeTopology(AS_COUNT, 111);
+        std::vector<GraphEdge> next = nextMonth(base, dropped);
+
+        test::writeFile(dir.file("a.txt"), test::caidaText(base));
+        test::writeFile(dir.file("b.txt"), test::caidaText(next));
+        test::writeFile(dir.file("b_reversed.txt"),
+                        test::caidaText(std::vector<GraphEdge>(next.rbegin(), next.rend())));
+        ASGraph a_graph, b_graph;
+        test::addEdges(a_graph, base);
+        test::addEdges(b_graph, next);
+        CHECK(a_graph.saveSnapshot(dir.file("a.snap")));
+        CHECK(b_graph.saveSnapshot(dir.file("b.snap")));
+
+        // Loaded, text diff, unchanged, text-to-snapshot diff, snapshot diff
+        const std::vector<std::string> months = {"a.txt", "b.txt", "b_reversed.txt", "a.snap", "b.snap"};
+        RibExportOptions sorted;
+        sorted.sorted = true;
+
+        TimeSeriesRunner runner(seeds, rov_file);
+        MonthSummary previous;
+        for (size_t m = 0; m < months.size(); m++) {
+            MonthSummary summary;
+            CHECK(runner.runMonth(months[m], dir.file(months[m]), summary));
+
+            ASGraph standalone;
+            runStandalone(standalone, dir.file(months[m]), rov_file, seeds);
+            std::string expected = test::exportRibs(standalone, dir.file("standalone.csv"), sorted);
+            CHECK(test::exportRibs(runner.getGraph(), dir.file("month.csv"), sorted) == expected);
+
+            // The row describes the same graph and RIBs
+            CHECK(summary.label == months[m]);
+            CHECK(summary.fingerprint == standalone.fingerprint().toHex());
+            CHECK(summary.nodes == standalone.getNodeCount());
+            CHECK(summary.edges == standalone.getProviderCustomerEdges() + standalone.getPeerEdges());
+            size_t rib_entries = 0, rov_invalid = 0;
+            for (const auto& pair : standalone.getNodes()) {
+                pair.second.policy->forEachRoute([&](const Prefix&, const Announcement& ann) {
+                    rib_entries++;
+                    if (ann.rov_invalid) rov_invalid++;
+                });
+            }
+            CHECK(summary.rib_entries == rib_entries);
+            CHECK(summary.rov_invalid_routes == rov_invalid);
+
+            if (m == 1 || m == 3 || m == 4) {
+                // Diff counts against the previous month
+                TopologyDiff diff = diffTopologies(m == 1 || m == 4 ? a_graph : b_graph,
+                                                   m == 1 || m == 4 ? b_graph : a_graph);
+                CHECK(summary.nodes_added == diff.added_nodes.size());
+                CHECK(summary.nodes_removed == diff.removed_nodes.size());
+                CHECK(summary.edges_added == diff.added_edges.size());
+                CHECK(summary.edges_removed == diff.removed_edges.size());
+                CHECK(summary.edges_changed == diff.changed_edges.size());
+                CHECK(summary.nodes_added > 0 && summary.nodes_removed > 0 && summary.edges_changed > 0);
+            }
+            if (m == 2) {
+                // Unchanged topology: last month's row, not propagated again
+                CHECK(summary.propagate_ms == 0);
+                CHECK(summary.edges_added == 0 && summary.edges_removed == 0);
+                CHECK(summary.rib_entries == previous.rib_entries);
+                CHECK(summary.avg_path_length == previous.avg_path_length);
+            }
+            previous = summary;
+        }
+    }
+}
+
+int main() {
+    test::TempDir dir("time_series_test");
+    testMonths(dir);
+    return test::finish("time_series_test");
+}